@@ -44,16 +44,43 @@ public:
 	QMatrix4x4 getWorldMatrix();
 	QMatrix4x4 getLocalMatrix();
 
+	// Moves many transforms at once, in any nesting; each affected subtree is walked a single
+	// time instead of once per setter
+	static void setWorldPoses(Transform* const* transforms, const QVector3D* positions, const QQuaternion* rotations, int count);
+
+	// Snapshot taken before each simulation step; rendering blends from it to the current state
+	void storePreviousState();
+	QVector3D getInterpolatedWorldPosition(float alpha);
+	QQuaternion getInterpolatedWorldRotation(float alpha);
+	QMatrix4x4 getInterpolatedWorldMatrix(float alpha);
+	QVector3D getPreviousWorldPosition();
+	QQuaternion getPreviousWorldRotation();
+	QVector3D getPreviousWorldScale();
+
 private:
 
 	void addChild(Transform* child);
 	void removeChild(Transform* child);
+	void updateLocalFromWorld();
+	void updateWorldFromLocal();
 	void updateChildrenWorldMatrix();
+	void updateSetPoses();
 
 	QVector3D mWorldPosition;
 	QQuaternion mWorldRotation;
 	QVector3D mWorldScale;
 
+	// Relative to the parent, composed as position, rotation, then scale; equal to the world pose without one
+	QVector3D mLocalPosition;
+	QQuaternion mLocalRotation;
+	QVector3D mLocalScale;
+
+	bool mIsPoseSet; // World pose written by setWorldPoses, local pose not yet derived
+	bool mHasPreviousState;
+	QVector3D mPreviousWorldPosition;
+	QQuaternion mPreviousWorldRotation;
+	QVector3D mPreviousWorldScale;
+
 	Transform* mParent;
 	std::vector<Transform*> mChildren; // Use unique_ptr for children
 
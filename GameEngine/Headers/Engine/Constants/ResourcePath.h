@@ -4,6 +4,7 @@
 const QString DEFAULT_MODEL_PATH = "Resources/Models/Default/";
 const QString DEFAULT_TEXTURE_PATH = "Resources/Textures/Default/";
 const QString DEFAULT_SHADER_PATH = "Resources/Shaders/Default/";
+const QString DEFAULT_INPUT_CONFIG_PATH = ":/Resources/Configs/input.json";
 
 // Model paths
 const QString MODEL_CUBE = DEFAULT_MODEL_PATH + "cube";
@@ -8,6 +8,10 @@ const QString SERIALIZE_MESH_PATH = "path";
 const QString SERIALIZE_MESH_TEXTURES = "textures";
 const QString SERIALIZE_MESH_DRAW_MODE = "draw_mode";
 
+// Texture
+const QString SERIALIZE_TEXTURE_PATH = "path";
+const QString SERIALIZE_TEXTURE_TYPE = "type";
+
 // Node
 const QString SERIALIZE_NODE_NAME = "name";
 const QString SERIALIZE_NODE_CHILDREN = "children";
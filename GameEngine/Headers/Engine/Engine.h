@@ -17,7 +17,13 @@ class Renderer;
 class Camera;
 class Container;
 class MeshRenderer;
+class Light;
+class Collider;
+class RigidBody;
 class Mesh;
 
+// Renders
+struct RenderSnapshot;
+
 
 #endif // ENGINE_H
\ No newline at end of file
@@ -0,0 +1,9 @@
+#pragma once
+
+
+enum class ColliderShape {
+    SPHERE = 0,
+    AABB,
+    OBB,
+    CAPSULE
+};
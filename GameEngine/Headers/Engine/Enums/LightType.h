@@ -0,0 +1,8 @@
+#pragma once
+
+
+enum class LightType {
+    DIRECTIONAL = 0,
+    POINT,
+    SPOT
+};
@@ -22,4 +22,16 @@ enum class DrawBufferMode {
     AUX1 = 0x040A,
     AUX2 = 0x040B,
     AUX3 = 0x040C
-};
\ No newline at end of file
+};
+
+enum class CullMode {
+    NONE = 0,
+    BACK = 0x0405,
+    FRONT = 0x0404
+};
+
+enum class BlendMode {
+    NONE = 0, // Opaque, blending disabled
+    ALPHA,
+    ADDITIVE
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QStringList>
+
+
+// Feature bits of the default shader's variant key, in the order of getDefaultShaderKeywords()
+enum ShaderKeyword : unsigned int {
+    SHADER_KEYWORD_NONE = 0,
+    SHADER_KEYWORD_USE_TEXTURE = 1 << 0,
+    SHADER_KEYWORD_USE_COLOR = 1 << 1,
+    SHADER_KEYWORD_USE_LIGHTING = 1 << 2
+};
+
+inline QStringList getDefaultShaderKeywords()
+{
+    return QStringList{ "USE_TEXTURE", "USE_COLOR", "USE_LIGHTING" };
+}
@@ -10,6 +10,9 @@ public:
 	virtual void* visitContainer(Container* node) = 0;
 	virtual void* visitMeshRenderer(MeshRenderer* node) = 0;
 	virtual void* visitCamera(Camera* node) = 0;
+	virtual void* visitLight(Light* node) = 0;
+	virtual void* visitCollider(Collider* node) = 0;
+	virtual void* visitRigidBody(RigidBody* node) = 0;
 
 	virtual ~INodeVisitor() = default;
 };
\ No newline at end of file
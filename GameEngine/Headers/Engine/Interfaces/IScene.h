@@ -1,7 +1,20 @@
 #ifndef ISCENE_H
 #define ISCENE_H
 
+#include "Engine/Renders/CascadedShadowMaps.h"
+#include "Engine/Renders/ClusteredLighting.h"
+#include "Engine/Renders/IdBufferPicker.h"
 #include "Engine/Renders/Mesh.h"
+#include "Engine/Renders/IndirectRenderer.h"
+#include "Engine/Renders/MaterialLibrary.h"
+#include "Engine/Renders/OverdrawCounter.h"
+#include "Engine/Renders/RenderQueue.h"
+#include "Engine/Renders/RenderStats.h"
+#include "Engine/Renders/RenderTarget.h"
+#include "Engine/Renders/UploadRingBuffer.h"
+#include "Engine/Physics/CollisionWorld.h"
+#include "Engine/Physics/PhysicsWorld.h"
+#include "Engine/Spatial/SpatialIndex.h"
 #include "Qt/Inputs/InputPublisher.h"
 #include "Engine/Interfaces/ISerializable.h"
 #include "Engine/Scenes/Node.h"
@@ -11,6 +24,7 @@
 #include <memory>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QMutex>
 
 class IScene
 {
@@ -26,6 +40,16 @@ public:
     virtual void render() = 0;
 	virtual void clear() = 0;
 
+    // Fixed-timestep support: snapshot before each step, blend factor for the render in between
+    virtual void storePreviousState() = 0;
+    virtual void setInterpolationAlpha(float alpha) = 0;
+    virtual float getInterpolationAlpha() const = 0;
+
+    // Threaded mode: the simulation fills a snapshot under the mutex, the renderer draws it without
+    virtual void buildSnapshot(RenderSnapshot& snapshot) = 0;
+    virtual void renderSnapshot(const RenderSnapshot& snapshot, float alpha) = 0;
+    virtual QMutex& getSimulationMutex() = 0;
+
     virtual QString getName() const = 0;
     virtual void setName(const QString& name) = 0;
 
@@ -35,6 +59,8 @@ public:
 
     virtual void addNode(Node* node) = 0;
     virtual void removeNode(Node* node) = 0;
+    // Hands a top-level node's ownership back to the caller; null if it is not one
+    virtual std::unique_ptr<Node> takeNode(Node* node) = 0;
     virtual std::vector<Node*> getNodes() const = 0;
 
 	virtual void setInputPublisher(InputPublisher* inputPublisher) = 0;
@@ -42,6 +68,32 @@ public:
 
     virtual InputPublisher* getInputPublisher() const = 0;
     virtual Camera* getCamera() const = 0;
+
+    virtual IndirectRenderer* getIndirectRenderer() const = 0;
+    virtual MaterialLibrary* getMaterialLibrary() const = 0;
+    virtual RenderQueue* getRenderQueue() const = 0;
+    virtual UploadRingBuffer* getUploadBuffer() const = 0;
+    virtual RenderStats& getRenderStats() = 0;
+    // Set by the owner of the framebuffer before each frame it renders into
+    virtual void setRenderTarget(const RenderTarget& target) = 0;
+    virtual const RenderTarget& getRenderTarget() const = 0;
+
+    // Lays down opaque depth before the colour passes so each pixel is shaded once
+    virtual void setIsDepthPrePass(bool isDepthPrePass) = 0;
+    virtual bool getIsDepthPrePass() const = 0;
+    virtual OverdrawCounter* getOverdrawCounter() const = 0;
+
+    // Light nodes submit to it while rendering
+    virtual ClusteredLighting* getLighting() const = 0;
+    // Mesh nodes submit their shadow casters to it while rendering
+    virtual CascadedShadowMaps* getShadows() const = 0;
+    // Mesh nodes insert their world bounds while rendering, for picking what was drawn
+    virtual SpatialIndex* getSpatialIndex() const = 0;
+    virtual IdBufferPicker* getIdPicker() const = 0;
+    // Collider nodes register with it when they start; it steps after every update
+    virtual CollisionWorld* getCollisionWorld() const = 0;
+    // RigidBody nodes register with it when they start; it steps on the collision world's contacts
+    virtual PhysicsWorld* getPhysicsWorld() const = 0;
 };
 
 #endif // ISCENE_H
\ No newline at end of file
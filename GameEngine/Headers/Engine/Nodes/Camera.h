@@ -17,6 +17,9 @@ public:
 	void setAspectRatio(float width, float height);
 	void setIsOrtho(bool isOrtho);
 	void setWidth(float width);
+	// Near maps to depth 1 and far to 0, and perspective projections get an infinite far plane.
+	// Float depth spreads its precision evenly that way; the scene's depth tests follow along.
+	void setIsReversedZ(bool isReversedZ);
 
 	float getFov() const;
 	float getNear() const;
@@ -24,9 +27,14 @@ public:
 	float getAspectRatio() const;
 	bool getIsOrtho() const;
 	float getWidth() const;
+	bool getIsReversedZ() const;
 
 	QMatrix4x4 getViewMatrix();
 	QMatrix4x4 getProjectionMatrix();
+	// Also selects the depth convention of the frame
+	void clearFramebuffer();
+
+	static QMatrix4x4 makeViewMatrix(const QVector3D& position, const QQuaternion& rotation);
 
 public: // Interfaces
 	virtual void write(QJsonObject& json) const override;
@@ -45,5 +53,6 @@ protected:
 	float mAspectRatio;
 	float mWidth;
 	float mIsOrtho;
+	bool mIsReversedZ;
 	bool mDirty;
 };
\ No newline at end of file
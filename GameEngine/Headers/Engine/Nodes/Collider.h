@@ -0,0 +1,63 @@
+#ifndef COLLIDER_H
+#define COLLIDER_H
+
+#include "Engine/Enums/ColliderShape.h"
+#include "Engine/Nodes/Container.h"
+#include "Engine/Physics/ColliderData.h"
+
+class RigidBody;
+
+// Collision shape that follows its transform; parent it to the Container it belongs to. While
+// started it is a body of the scene's CollisionWorld, which reads its world shape each fixed
+// step, and belongs to the nearest RigidBody above it, if any; without one it is static. The shape is scaled by the world scale: spheres by the largest axis, capsules by the
+// largest of X and Z for the radius and by Y for the length, boxes per axis.
+class Collider : public Container
+{
+public:
+	Collider();
+	Collider(ColliderShape shape);
+	virtual ~Collider() noexcept;
+
+	virtual void clear() override;
+
+	void setShape(ColliderShape shape);
+	ColliderShape getShape() const;
+
+	// Offset of the shape from the transform, in local space
+	void setCenter(const QVector3D& center);
+	QVector3D getCenter() const;
+	void setRadius(float radius);
+	float getRadius() const;
+	void setHalfExtents(const QVector3D& halfExtents);
+	QVector3D getHalfExtents() const;
+	// Half the length of a capsule's segment, not counting its caps
+	void setHalfHeight(float halfHeight);
+	float getHalfHeight() const;
+
+	ColliderData getColliderData();
+
+	// Kept by the CollisionWorld, -1 while not registered
+	void setBodyIndex(int bodyIndex);
+	int getBodyIndex() const;
+	// Found when it starts
+	RigidBody* getRigidBody() const;
+
+public: // Interfaces
+	virtual void write(QJsonObject& json) const override;
+	virtual void read(const QJsonObject& json) override;
+	virtual void* accept(INodeVisitor* visitor) override;
+
+protected:
+	virtual void start(IScene* scene) override;
+
+protected:
+	ColliderShape mShape;
+	QVector3D mCenter;
+	float mRadius;
+	QVector3D mHalfExtents;
+	float mHalfHeight;
+	int mBodyIndex;
+	RigidBody* mRigidBody;
+};
+
+#endif // COLLIDER_H
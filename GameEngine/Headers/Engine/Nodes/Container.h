@@ -11,13 +11,15 @@ public:
 	Container();  
 	virtual ~Container() noexcept;
 
-	virtual void setParent(Node* parent) override;
-
 public: // Interfaces
 	virtual void write(QJsonObject& json) const override;
 	virtual void read(const QJsonObject& json) override;
 	virtual void* accept(INodeVisitor* visitor) override;
 
+protected:
+	virtual void storePreviousState() override;
+	virtual void onParentChanged() override;
+
 public:  
 	std::shared_ptr<Transform> transform; // Use shared_ptr
 };
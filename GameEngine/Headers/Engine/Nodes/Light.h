@@ -0,0 +1,63 @@
+#ifndef LIGHT_H
+#define LIGHT_H
+
+#include <QColor>
+
+#include "Engine/Enums/LightType.h"
+#include "Engine/Nodes/Container.h"
+#include "Engine/Renders/LightData.h"
+
+// Light source placed by its transform; spot and directional lights shine along the local -Z
+// axis, like the camera looks. Each render it hands its world-space data to the scene's
+// ClusteredLighting, which only shades geometry in the clusters the light reaches.
+class Light : public Container
+{
+public:
+	Light();
+	Light(LightType type);
+	virtual ~Light() noexcept;
+
+	void setType(LightType type);
+	LightType getType() const;
+
+	void setColor(const QColor& color);
+	QColor getColor() const;
+	void setIntensity(float intensity);
+	float getIntensity() const;
+
+	// Point and spot lights fade to zero at this distance, which also bounds the clusters they touch
+	void setRange(float range);
+	float getRange() const;
+
+	// Full cone angles in degrees: full intensity inside the inner one, none outside the outer one
+	void setSpotAngles(float innerAngle, float outerAngle);
+	float getInnerAngle() const;
+	float getOuterAngle() const;
+
+	// Only the first shadow-casting directional light of a frame gets cascaded shadow maps
+	void setIsCastingShadows(bool isCastingShadows);
+	bool getIsCastingShadows() const;
+
+	// World-space data between the last two simulation states
+	LightData getLightData(float alpha);
+
+public: // Interfaces
+	virtual void write(QJsonObject& json) const override;
+	virtual void read(const QJsonObject& json) override;
+	virtual void* accept(INodeVisitor* visitor) override;
+
+protected:
+	virtual void render(ShaderProgram& shaderProgram) override;
+	virtual void snapshot(RenderSnapshot& snapshot) override;
+
+protected:
+	LightType mType;
+	QColor mColor;
+	float mIntensity;
+	float mRange;
+	float mInnerAngle;
+	float mOuterAngle;
+	bool mIsCastingShadows;
+};
+
+#endif // LIGHT_H
@@ -6,6 +6,7 @@
 
 #include "Engine/Enums/RenderMode.h"
 #include "Engine/Nodes/Container.h"
+#include "Engine/Renders/Material.h"
 #include "Engine/Renders/Mesh.h"
 
 class MeshRenderer : public Container, public QOpenGLExtraFunctions
@@ -21,9 +22,18 @@ public:
 	std::shared_ptr<Mesh> getMesh() const;
 	void setRenderMode(PolygonMode polygonMode, DrawBufferMode drawBufferMode = DrawBufferMode::FRONT_AND_BACK);
 
+	// Interned by the scene's MaterialLibrary on start; defaults to the scene's default material
+	void setMaterial(std::shared_ptr<Material> material);
+	std::shared_ptr<Material> getMaterial() const;
+
+	// Static renderers are batched into the scene's multi-draw-indirect submission
+	void setIsStatic(bool isStatic);
+	bool getIsStatic() const;
+
 	virtual void start(IScene* scene) override;
 	virtual void update(float deltaTime) override;
 	virtual void render(ShaderProgram& shaderProgram) override;
+	virtual void snapshot(RenderSnapshot& snapshot) override;
 
 public: // Interfaces
 	virtual void write(QJsonObject& json) const override;
@@ -32,8 +42,10 @@ public: // Interfaces
 
 protected:
 	std::shared_ptr<Mesh> mMesh;
+	std::shared_ptr<Material> mMaterial;
 	PolygonMode mPolygonMode;
 	DrawBufferMode mDrawBufferMode;
+	bool mIsStatic;
 };
 
 #endif // !MESH_RENDERER_H
\ No newline at end of file
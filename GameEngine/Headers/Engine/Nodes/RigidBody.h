@@ -0,0 +1,75 @@
+#ifndef RIGID_BODY_H
+#define RIGID_BODY_H
+
+#include "Engine/Nodes/Container.h"
+
+// Container moved by the scene's PhysicsWorld; parent its Collider and its visuals to it. While
+// started it is a body of the world, which reads its pose back from the transform every fixed
+// step, so teleporting it by hand works. Its centre of mass is its position, and its inertia
+// comes from the first Collider child, with the collider's offset and rotation left out.
+// Kinematic bodies move by their velocity alone and push dynamic ones without being pushed back.
+class RigidBody : public Container
+{
+public:
+	RigidBody();
+	virtual ~RigidBody() noexcept;
+
+	virtual void clear() override;
+
+	// Kept above zero
+	void setMass(float mass);
+	float getMass() const;
+	void setIsKinematic(bool isKinematic);
+	bool getIsKinematic() const;
+	// Contacts use the geometric mean of both frictions and the larger restitution
+	void setFriction(float friction);
+	float getFriction() const;
+	void setRestitution(float restitution);
+	float getRestitution() const;
+	// Fraction of the velocity lost per second
+	void setLinearDamping(float damping);
+	float getLinearDamping() const;
+	void setAngularDamping(float damping);
+	float getAngularDamping() const;
+	void setGravityScale(float gravityScale);
+	float getGravityScale() const;
+
+	// Go through to the PhysicsWorld once started; forces and impulses are dropped before that
+	void setLinearVelocity(const QVector3D& velocity);
+	QVector3D getLinearVelocity() const;
+	void setAngularVelocity(const QVector3D& velocity);
+	QVector3D getAngularVelocity() const;
+	void addForce(const QVector3D& force);
+	void addTorque(const QVector3D& torque);
+	void addImpulse(const QVector3D& impulse, const QVector3D& point);
+
+	// Principal moments of inertia for its mass, a solid ball of radius 0.5 without a collider
+	QVector3D computeInertia();
+
+	// Kept by the PhysicsWorld, -1 while not registered
+	void setBodyIndex(int bodyIndex);
+	int getBodyIndex() const;
+
+public: // Interfaces
+	virtual void write(QJsonObject& json) const override;
+	virtual void read(const QJsonObject& json) override;
+	virtual void* accept(INodeVisitor* visitor) override;
+
+protected:
+	virtual void start(IScene* scene) override;
+	void updateBody();
+
+protected:
+	float mMass;
+	bool mIsKinematic;
+	float mFriction;
+	float mRestitution;
+	float mLinearDamping;
+	float mAngularDamping;
+	float mGravityScale;
+	QVector3D mLinearVelocity;  // Until registered
+	QVector3D mAngularVelocity;
+	int mBodyIndex;
+};
+
+#endif // RIGID_BODY_H
@@ -0,0 +1,28 @@
+#ifndef COLLIDER_DATA_H
+#define COLLIDER_DATA_H
+
+#include <QQuaternion>
+#include <QVector3D>
+
+#include "Engine/Enums/ColliderShape.h"
+
+// One collision shape as handed to the CollisionWorld, in world space with scale applied
+struct ColliderData
+{
+	ColliderShape shape = ColliderShape::SPHERE;
+	QVector3D center;
+	QQuaternion rotation;                                 // OBB and capsule; an AABB ignores it
+	QVector3D halfExtents = QVector3D(0.5f, 0.5f, 0.5f); // AABB and OBB
+	float radius = 0.5f;                                  // Sphere and capsule
+	float halfHeight = 0.5f;                              // Capsule segment, along its local Y axis
+};
+
+// Where two shapes overlap
+struct ContactPoint
+{
+	QVector3D normal; // Unit, pointing from the first shape towards the second
+	QVector3D point;  // World space, halfway through the overlap
+	float depth = 0.0f;
+};
+
+#endif // COLLIDER_DATA_H
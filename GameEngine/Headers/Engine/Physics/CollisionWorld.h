@@ -0,0 +1,129 @@
+#ifndef COLLISION_WORLD_H
+#define COLLISION_WORLD_H
+
+#include <vector>
+
+#include "Engine/Physics/ColliderData.h"
+
+class Collider;
+
+// Two bodies whose bounds overlap, the lower index first
+struct CollisionPair
+{
+	int bodyA;
+	int bodyB;
+};
+
+struct Contact
+{
+	int bodyA = -1;
+	int bodyB = -1;
+	Collider* colliderA = nullptr; // Null for bodies added without a node
+	Collider* colliderB = nullptr;
+	QVector3D normal; // From A towards B
+	QVector3D point;
+	float depth = 0.0f;
+};
+
+struct CollisionStats
+{
+	int bodies = 0;
+	int pairs = 0;
+	int contacts = 0;
+	int sortShifts = 0;       // Insertion sort moves this step
+	bool isResorted = false;  // The order was rebuilt from scratch instead
+	double broadphaseMs = 0.0;
+	double narrowphaseMs = 0.0;
+};
+
+// Finds the touching bodies of a scene once per fixed step. The broadphase is sweep and prune:
+// bodies stay sorted by the start of their bounds on one axis between steps, so an insertion sort
+// fixes the order in close to linear time while they move coherently, falling back to a full
+// sort when bodies are added or removed or too much moved. A single sweep degrades as a crowd
+// grows, since the bodies overlapping on one axis pile up, so the sorted bodies are bucketed into
+// a coarse grid over the other two axes and each cell is swept on its own, on the thread pool.
+// Pairs and narrowphase contacts are merged in cell and chunk order, so both come out the same
+// whichever thread ran what. Bodies are either Collider nodes, read from their transform every
+// step, or plain shapes set from code.
+class CollisionWorld
+{
+public:
+	static const int BOUNDS_GRAIN = 1024;       // Bodies per bounds update chunk
+	static const int CELL_BODIES = 128;         // Aimed for per grid cell
+	static const int MAX_GRID_SIDE = 64;
+	static const int CELL_GRAIN = 4;            // Grid cells per sweep chunk
+	static const int NARROWPHASE_GRAIN = 4096;  // Pairs per narrowphase chunk
+	static const int PARALLEL_BODIES = 4096;    // Fewer run on the stepping thread alone
+	static const int MAX_SHIFTS_PER_BODY = 32;  // Insertion sort budget before a full sort
+
+	CollisionWorld();
+	~CollisionWorld();
+
+	void clear();
+
+	// The collider's body index is set and kept up to date
+	int add(Collider* collider);
+	void remove(Collider* collider);
+
+	// Removing a body moves the last one into its index
+	int addBody(const ColliderData& shape);
+	void setBody(int body, const ColliderData& shape);
+	void removeBody(int body);
+	const ColliderData& getBody(int body) const;
+	Collider* getCollider(int body) const;
+	int getBodyCount() const;
+
+	// Off steps on the calling thread only
+	void setIsMultithreaded(bool isMultithreaded);
+	bool getIsMultithreaded() const;
+
+	void step();
+
+	const std::vector<CollisionPair>& getPairs() const;
+	const std::vector<Contact>& getContacts() const;
+	const CollisionStats& getStats() const;
+
+protected:
+	struct Bounds
+	{
+		float min[3]; // Inverted for bodies that collide with nothing
+		float max[3];
+	};
+
+	struct SortEntry
+	{
+		float key; // Start of the body's bounds on mAxis
+		int body;
+	};
+
+	void updateBounds(bool isParallel);
+	void sortBodies();
+	void sweep(bool isParallel);
+	void collidePairs(bool isParallel);
+
+protected:
+	std::vector<ColliderData> mShapes;
+	std::vector<Collider*> mColliders;
+	std::vector<Bounds> mBounds;       // Per body
+	std::vector<Bounds> mSortedBounds; // In sweep order
+
+	int mAxis;                        // Swept axis, the one the centres spread along the most
+	std::vector<SortEntry> mOrder;
+	bool mIsOrderDirty;
+
+	std::vector<int> mCellStarts;     // Per grid cell, into the arrays below
+	std::vector<int> mCellFill;
+	std::vector<int> mCellBodies;     // Each cell's bodies in sweep order
+	std::vector<float> mCellMin[3];   // Their bounds, the swept axis first
+	std::vector<float> mCellMax[3];
+
+	std::vector<std::vector<CollisionPair>> mChunkPairs;
+	std::vector<std::vector<Contact>> mChunkContacts;
+	std::vector<CollisionPair> mPairs;
+	std::vector<Contact> mContacts;
+
+	bool mIsMultithreaded;
+	CollisionStats mStats;
+};
+
+#endif // COLLISION_WORLD_H
@@ -0,0 +1,30 @@
+#ifndef NARROWPHASE_H
+#define NARROWPHASE_H
+
+#include "Engine/Physics/ColliderData.h"
+
+// Exact overlap tests between collider shapes. Spheres and capsules are both handled as a
+// segment swept by a radius, boxes against them by the point of the segment closest to the box,
+// and boxes against boxes by the separating axis test over their 15 candidate axes. Sphere pairs,
+// the common case, also have a batched test that checks BATCH_SIZE pairs with SSE at once.
+class Narrowphase
+{
+public:
+	static const int BATCH_SIZE = 4;
+	static const int MAX_MANIFOLD_POINTS = 4;
+
+	static void getBounds(const ColliderData& shape, QVector3D& boundsMin, QVector3D& boundsMax);
+
+	// The contact normal points from a towards b
+	static bool collide(const ColliderData& a, const ColliderData& b, ContactPoint& contact);
+	// Up to BATCH_SIZE sphere pairs; returns a bit per pair that touches, its contact filled in
+	static int collideSpheres(const ColliderData* const* a, const ColliderData* const* b, int count, ContactPoint* contacts);
+
+	// Spreads a contact from collide over the faces that touch, so a box resting on a box gets up
+	// to four points and a capsule lying on one two, instead of balancing on a single point. The
+	// incident face, or segment, is clipped to the sides of the reference face. Other pairs and
+	// edge contacts keep the one point. Returns how many points were written.
+	static int getManifold(const ColliderData& a, const ColliderData& b, const ContactPoint& contact, ContactPoint* points);
+};
+
+#endif // NARROWPHASE_H
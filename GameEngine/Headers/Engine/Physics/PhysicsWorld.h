@@ -0,0 +1,160 @@
+#ifndef PHYSICS_WORLD_H
+#define PHYSICS_WORLD_H
+
+#include <vector>
+#include <QQuaternion>
+#include <QVector3D>
+
+#include "Engine/Physics/CollisionWorld.h"
+
+class RigidBody;
+class Transform;
+
+struct PhysicsStats
+{
+	int bodies = 0;
+	int constraints = 0;
+	int islands = 0;          // With at least one contact
+	int largestIsland = 0;    // In constraints
+	double solveMs = 0.0;     // Constraint setup, islands and solver iterations
+	double integrateMs = 0.0; // Velocities, positions and the write-back
+};
+
+// Moves the scene's RigidBody nodes once per fixed step, after the CollisionWorld found what
+// touches. Bodies are kept as one array per property. Each contact is spread into a manifold of
+// up to four points, each a constraint along the normal and two friction directions, solved with
+// sequential impulses: constraints are applied one after the other, over and over, warm started
+// from the impulses the same points ended the last step with. Contacts join dynamic bodies into
+// islands that share nothing that gets written, so islands are solved apart on the thread pool;
+// inside one the order only depends on body and contact order, so a step gives the same result
+// on one thread or many, as replays need. Poses go back to the transforms in a single batch.
+// Colliders without a RigidBody are static.
+class PhysicsWorld
+{
+public:
+	static const int DEFAULT_ITERATIONS = 10;
+	static const int BODY_GRAIN = 1024;      // Bodies per integration chunk
+	static const int ISLAND_GRAIN = 16;      // Islands per solver chunk
+	static const int PARALLEL_BODIES = 1024; // Fewer run on the stepping thread alone
+
+	PhysicsWorld();
+	~PhysicsWorld();
+
+	void clear();
+
+	// The body's index is set and kept up to date; removing a body moves the last one into its index
+	int add(RigidBody* body);
+	void remove(RigidBody* body);
+	RigidBody* getBody(int body) const;
+	int getBodyCount() const;
+	// Reads mass, material and inertia from the node again
+	void updateBody(int body);
+
+	void setLinearVelocity(int body, const QVector3D& velocity);
+	QVector3D getLinearVelocity(int body) const;
+	void setAngularVelocity(int body, const QVector3D& velocity);
+	QVector3D getAngularVelocity(int body) const;
+	// Applied over the next step only
+	void addForce(int body, const QVector3D& force);
+	void addTorque(int body, const QVector3D& torque);
+	// Changes the velocity right away; the point is in world space
+	void addImpulse(int body, const QVector3D& impulse, const QVector3D& point);
+
+	void setGravity(const QVector3D& gravity);
+	QVector3D getGravity() const;
+	void setIterations(int iterations);
+	int getIterations() const;
+	// Off steps on the calling thread only
+	void setIsMultithreaded(bool isMultithreaded);
+	bool getIsMultithreaded() const;
+
+	void step(float deltaTime, const CollisionWorld& collisions);
+
+	const PhysicsStats& getStats() const;
+
+protected:
+	struct Matrix3
+	{
+		QVector3D rows[3];
+
+		QVector3D operator*(const QVector3D& vector) const;
+	};
+
+	struct Constraint
+	{
+		int bodyA;             // -1 for a static collider
+		int bodyB;
+		QVector3D normal;      // From A towards B
+		QVector3D tangents[2];
+		QVector3D offsetA;     // From each centre of mass to the contact point
+		QVector3D offsetB;
+		float normalMass;
+		float tangentMass[2];
+		float bias;            // Separating speed aimed for, to push out of overlap or bounce
+		float friction;
+		float normalImpulse;   // Accumulated over the step
+		float tangentImpulse[2];
+		quint64 key;           // The collision bodies, for warm starting
+		QVector3D point;
+	};
+
+	struct CachedImpulse
+	{
+		quint64 key;
+		QVector3D point;
+		float normal;
+		float tangents[2];
+	};
+
+	void gatherBodies(bool isParallel);
+	void integrateVelocities(float deltaTime, bool isParallel);
+	void buildConstraints(float deltaTime, const CollisionWorld& collisions);
+	void buildIslands();
+	void solveIsland(int island);
+	void integratePositions(float deltaTime, bool isParallel);
+	void writePoses();
+	void storeImpulses(int collisionBodies);
+
+	void updateWorldInverseInertia(int body);
+	QVector3D getPointVelocity(int body, const QVector3D& offset) const;
+	void applyImpulse(int body, const QVector3D& offset, const QVector3D& impulse);
+	float getEffectiveMass(const Constraint& constraint, const QVector3D& direction) const;
+
+protected:
+	std::vector<RigidBody*> mBodies;
+	std::vector<Transform*> mTransforms;
+	std::vector<QVector3D> mPositions;
+	std::vector<QQuaternion> mRotations;
+	std::vector<QVector3D> mLinearVelocities;
+	std::vector<QVector3D> mAngularVelocities;
+	std::vector<QVector3D> mForces;
+	std::vector<QVector3D> mTorques;
+	std::vector<float> mInverseMasses;        // 0 for kinematic bodies
+	std::vector<QVector3D> mInverseInertias;  // Principal, in body space
+	std::vector<Matrix3> mWorldInverseInertias;
+	std::vector<float> mLinearDampings;
+	std::vector<float> mAngularDampings;
+	std::vector<float> mGravityScales;
+	std::vector<float> mFrictions;
+	std::vector<float> mRestitutions;
+	std::vector<char> mIsKinematic;
+
+	std::vector<int> mColliderBodies;         // Per collision body, its rigid body or -1
+	std::vector<Constraint> mUnsorted;        // In contact order
+	std::vector<Constraint> mConstraints;     // Grouped by island, contact order within one
+	std::vector<int> mConstraintIslands;      // Per unsorted constraint
+	std::vector<int> mIslandParents;          // Union-find over bodies, the lowest index the root
+	std::vector<int> mRootIslands;            // Island of each root, numbered by first contact
+	std::vector<int> mIslandStarts;           // Into mConstraints, with the end of the last island last
+	std::vector<int> mIslandFill;
+	std::vector<CachedImpulse> mImpulses;     // Last step's, sorted by key
+	int mImpulseBodies;                       // Collision bodies when they were stored
+	bool mIsImpulseCacheValid;
+
+	QVector3D mGravity;
+	int mIterations;
+	bool mIsMultithreaded;
+	PhysicsStats mStats;
+};
+
+#endif // PHYSICS_WORLD_H
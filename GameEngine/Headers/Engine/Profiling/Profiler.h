@@ -0,0 +1,159 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <QString>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+
+#include "Engine/Renders/GLExtensions.h"
+
+// One timed scope of a frame. Times are in milliseconds from the start of the frame;
+// GPU times stay negative until the timer queries of the frame have been read back.
+struct ProfileEvent
+{
+	const char* name = "";
+	int thread = 0; // 0 for the frame thread, others count up in the order they first record a scope
+	int depth = 0;  // Within its thread
+	double cpuStartMs = 0.0;
+	double cpuDurationMs = 0.0;
+	double gpuStartMs = -1.0;
+	double gpuDurationMs = -1.0;
+};
+
+struct ProfileFrame
+{
+	long long frameIndex = -1;
+	double cpuStartMs = 0.0; // From the start of the profiler
+	double cpuDurationMs = 0.0;
+	double gpuDurationMs = -1.0;
+	std::vector<ProfileEvent> events; // By thread, then in begin order, parents before children
+};
+
+// Hierarchical frame profiler. CPU scopes are timed with a monotonic clock; GPU scopes place
+// GL_TIMESTAMP queries, which unlike GL_TIME_ELAPSED can nest. Queries are double-buffered
+// and read back when their slot comes around again, without waiting if the GPU is behind.
+// The last FRAME_CAPACITY frames are kept in a ring. Scopes on threads other than the one
+// calling beginFrame()/endFrame() are CPU-only; each thread buffers its own and endFrame()
+// merges the ones closed since, so they may start before the frame they land in.
+// getThreadNames() and the trace export give each thread its own row.
+class Profiler
+{
+public:
+	static const int FRAME_CAPACITY = 240;
+	static const int QUERY_SLOTS = 2;
+
+	static Profiler& instance();
+
+	void setIsEnabled(bool isEnabled);
+	bool getIsEnabled() const;
+
+	// GPU timing needs the context the frames are rendered with to be current
+	void initGpu();
+	void clearGpu();
+	bool getIsGpuActive() const;
+
+	void beginFrame();
+	void endFrame();
+
+	void beginScope(const char* name, bool isGpu = false);
+	void endScope();
+
+	// Completed frames, oldest first
+	std::vector<ProfileFrame> getFrames() const;
+	const ProfileFrame* getLastFrame() const;
+	long long getFrameCount() const;
+
+	// Names of the threads other than the frame thread, indexed by ProfileEvent::thread - 1
+	std::vector<QString> getThreadNames() const;
+
+	bool exportChromeTrace(const QString& path) const;
+
+private:
+	Profiler();
+
+	static const int MAX_THREAD_EVENTS = 65536; // Per thread between two frames
+
+	// Written by its own thread; the closed scopes are handed to the frame thread under the mutex
+	struct ThreadEvents
+	{
+		int thread = 0;
+		std::vector<ProfileEvent> openEvents; // Start times from the start of the profiler
+		QMutex mutex;
+		std::vector<ProfileEvent> events;
+	};
+
+	struct PendingQuery
+	{
+		int eventIndex; // -1 for the frame itself
+		int startQuery;
+		int endQuery;
+	};
+
+	struct QuerySlot
+	{
+		long long frameIndex = -1;
+		std::vector<GLuint> queries;
+		int usedQueries = 0;
+		std::vector<PendingQuery> pending;
+	};
+
+	double nowMs() const;
+	bool getIsFrameThread() const;
+	int takeQuery(QuerySlot& slot);
+	void resolveSlot(QuerySlot& slot);
+	ProfileFrame* findFrame(long long frameIndex);
+	ThreadEvents& getThreadEvents();
+	void mergeThreadEvents();
+
+private:
+	std::atomic<bool> mIsEnabled;
+	bool mIsInFrame;
+	std::atomic<Qt::HANDLE> mFrameThread;
+	QElapsedTimer mClock;
+
+	std::vector<ProfileFrame> mFrames;
+	long long mFrameCount;
+	ProfileFrame mCurrentFrame;
+	std::vector<int> mOpenEvents;
+	std::vector<int> mOpenQueries;
+
+	mutable QMutex mThreadsMutex;
+	std::vector<std::unique_ptr<ThreadEvents>> mThreads;
+	std::vector<QString> mThreadNames;
+
+	QOpenGLContext* mContext;
+	QOpenGLExtraFunctions* mFunctions;
+	GLExtensions mExtensions;
+	QuerySlot mQuerySlots[QUERY_SLOTS];
+	int mFrameStartQuery;
+};
+
+// Times the enclosing block; the GPU variant also brackets the GL commands it issues
+class ProfileScope
+{
+public:
+	ProfileScope(const char* name, bool isGpu = false)
+	{
+		Profiler::instance().beginScope(name, isGpu);
+	}
+
+	~ProfileScope()
+	{
+		Profiler::instance().endScope();
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_GPU_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name, true)
+
+#endif // PROFILER_H
@@ -0,0 +1,32 @@
+#ifndef BUFFER_ALLOCATOR_H
+#define BUFFER_ALLOCATOR_H
+
+#include <map>
+#include <iterator>
+
+// First-fit free-list suballocator. Offsets and sizes are expressed in elements
+// (vertices or indices), not bytes. Freed ranges are coalesced with their neighbours.
+class BufferAllocator
+{
+public:
+	static const unsigned int INVALID_OFFSET = 0xFFFFFFFFu;
+
+	BufferAllocator(unsigned int capacity = 0);
+
+	unsigned int allocate(unsigned int size);
+	void free(unsigned int offset, unsigned int size);
+
+	void grow(unsigned int newCapacity);
+	void reset(unsigned int capacity);
+
+	unsigned int getCapacity() const;
+	unsigned int getUsed() const;
+	unsigned int getLargestFreeBlock() const;
+
+private:
+	std::map<unsigned int, unsigned int> mFreeBlocks; // offset -> size
+	unsigned int mCapacity;
+	unsigned int mUsed;
+};
+
+#endif // BUFFER_ALLOCATOR_H
@@ -0,0 +1,133 @@
+#ifndef CASCADED_SHADOW_MAPS_H
+#define CASCADED_SHADOW_MAPS_H
+
+#include <memory>
+#include <vector>
+#include <QMatrix4x4>
+#include <QOpenGLExtraFunctions>
+#include <QVector3D>
+
+#include "Engine/Renders/LightData.h"
+#include "Engine/Renders/Material.h"
+#include "Engine/Renders/Mesh.h"
+#include "Engine/Renders/RenderStats.h"
+#include "Engine/Renders/RenderTarget.h"
+#include "Engine/Renders/ShaderProgram.h"
+
+// Cascaded shadow maps of the scene's shadow-casting directional light. The camera range up to
+// the shadow distance is split into cascades, each fitted with a bounding sphere of its slice
+// and snapped to whole texels, so the maps do not shimmer as the camera turns or moves.
+// Casters are submitted every frame and culled per cascade. Far cascades keep their static
+// casters in a cache array, re-rendered only when the light turns, the static casters change,
+// or the camera leaves the padded sphere the cache was fitted to; each frame they copy the cache
+// and draw only the dynamic casters on top. Near cascades move with the camera and are redrawn.
+// The maps are read by the USE_LIGHTING variant of default.frag, see ClusteredLighting.
+class CascadedShadowMaps : protected QOpenGLExtraFunctions
+{
+public:
+	static const int MAX_CASCADES = 4;
+	static const int DEFAULT_RESOLUTION = 1024;
+	static const int SHADOW_TEXTURE_UNIT = 12;
+	static constexpr float CACHE_MARGIN = 0.25f; // Padding of cached cascades, relative to their radius
+
+	CascadedShadowMaps();
+	~CascadedShadowMaps();
+
+	void init();
+	void tryStart();
+	void clear();
+
+	void setIsEnabled(bool isEnabled);
+	bool getIsEnabled() const;
+
+	void setCascadeCount(int cascadeCount);
+	int getCascadeCount() const;
+	// Texels per side of every cascade
+	void setResolution(int resolution);
+	int getResolution() const;
+	// Shadows end here or at the camera's far plane, whichever is nearer
+	void setShadowDistance(float distance);
+	float getShadowDistance() const;
+	// Blend of logarithmic (1) and uniform (0) split distances
+	void setSplitLambda(float lambda);
+	float getSplitLambda() const;
+	// Cascades from this index on cache their static casters
+	void setCachedCascadeStart(int cascade);
+	int getCachedCascadeStart() const;
+
+	// Maps were rendered this frame
+	bool getIsActive() const;
+	// View-space depth where the cascade ends
+	float getSplitDistance(int cascade) const;
+
+	void begin();
+	// Blended materials cast no shadow
+	void submit(Mesh* mesh, const Material* material, const QMatrix4x4& world, bool isStatic);
+
+	// Renders the cascades of the frame's casters for the camera, then binds the target with its
+	// full viewport again and restores the depth convention
+	void render(const QMatrix4x4& view, const QMatrix4x4& projection, float nearPlane, float farPlane, const LightData& light,
+		const RenderTarget& target, RenderStats& stats);
+	// Points a USE_LIGHTING program at the maps
+	void apply(ShaderProgram& shader) const;
+
+protected:
+	struct Caster
+	{
+		Mesh* mesh;
+		QMatrix4x4 world;
+		QVector3D center; // World-space bounding sphere
+		float radius;
+		bool isStatic;
+	};
+
+	struct Cascade
+	{
+		QVector3D center; // In light space, snapped to whole texels
+		float radius = 0.0f;
+		QMatrix4x4 viewProjection;
+		bool isStaticCached = false;
+		bool hasDynamic = false; // Dynamic casters were drawn over the cache last frame
+	};
+
+	void start();
+	void allocate();
+	void release();
+
+	void computeSplits(float nearPlane, float farPlane);
+	// Refits the cascade to the slice unless its cache still covers it; returns whether it moved
+	bool fitCascade(int cascade, const QMatrix4x4& projection, float sliceNear, float sliceFar);
+	void cullCasters(const Cascade& cascade, bool isStatic, std::vector<int>& visible) const;
+	void attachLayer(GLenum target, GLuint framebuffer, GLuint texture, int layer);
+	int drawCasters(const Cascade& cascade, const std::vector<int>& casters);
+
+protected:
+	bool mIsStarted;
+	bool mIsEnabled;
+	bool mIsActive;
+	int mCascadeCount;
+	int mResolution;
+	int mAllocatedResolution;
+	float mShadowDistance;
+	float mSplitLambda;
+	int mCachedCascadeStart;
+
+	std::unique_ptr<ShaderProgram> mDepthShader;
+	GLuint mShadowTexture; // Depth array sampled by the lit shader, one layer per cascade
+	GLuint mStaticTexture; // Static casters of the cached cascades
+	GLuint mDrawFramebuffer;
+	GLuint mReadFramebuffer;
+
+	std::vector<Caster> mCasters;
+	size_t mStaticHash; // Of this frame's static casters, so any change invalidates the caches
+	size_t mCachedStaticHash;
+	QVector3D mLightDirection;
+	QMatrix4x4 mLightView; // Rotation into light space, shared by every cascade
+
+	Cascade mCascades[MAX_CASCADES];
+	float mSplits[MAX_CASCADES];
+	QMatrix4x4 mInverseView; // Of the camera the maps were rendered for
+	std::vector<int> mVisible;
+};
+
+#endif // CASCADED_SHADOW_MAPS_H
@@ -0,0 +1,120 @@
+#ifndef CLUSTERED_LIGHTING_H
+#define CLUSTERED_LIGHTING_H
+
+#include <vector>
+#include <QColor>
+#include <QMatrix4x4>
+#include <QOpenGLExtraFunctions>
+#include <QVector4D>
+
+#include "Engine/Renders/CascadedShadowMaps.h"
+#include "Engine/Renders/GLExtensions.h"
+#include "Engine/Renders/LightData.h"
+#include "Engine/Renders/RenderStats.h"
+#include "Engine/Renders/RenderTarget.h"
+#include "Engine/Renders/ShaderProgram.h"
+
+// Clustered forward lighting. The view frustum is cut into TILE_COUNT_X x TILE_COUNT_Y screen
+// tiles by SLICE_COUNT exponential depth slices, and every frame the point and spot lights are
+// binned on the CPU into the clusters their range sphere reaches. A fragment then loops only
+// over the lights of its own cluster, so the cost per pixel stays flat however many small lights
+// there are. Directional lights reach everything and are looped over by every fragment.
+// Lights, cluster ranges and the light index list reach the shader as buffer textures, which
+// the GL 3.3 default shader can read; see USE_LIGHTING in default.frag.
+class ClusteredLighting : protected QOpenGLExtraFunctions
+{
+public:
+	static const int TILE_COUNT_X = 16;
+	static const int TILE_COUNT_Y = 9;
+	static const int SLICE_COUNT = 24;
+	static const int CLUSTER_COUNT = TILE_COUNT_X * TILE_COUNT_Y * SLICE_COUNT;
+	static const int MAX_LIGHTS = 16384;
+	static const int TEXELS_PER_LIGHT = 3;
+	// Kept clear of material textures, which take units from 0 up; CascadedShadowMaps takes 12
+	static const int LIGHT_TEXTURE_UNIT = 13;
+	static const int CLUSTER_TEXTURE_UNIT = 14;
+	static const int INDEX_TEXTURE_UNIT = 15;
+
+	ClusteredLighting();
+	~ClusteredLighting();
+
+	void init();
+	void tryStart();
+	void clear();
+
+	bool getIsSupported() const;
+	// Lights were built this frame, so programs should draw with their USE_LIGHTING variant
+	bool getIsActive() const;
+
+	// The first shadow-casting directional light is shaded with these maps
+	void setShadows(CascadedShadowMaps* shadows);
+	// Of the built frame; null when no directional light casts shadows
+	const LightData* getShadowLight() const;
+
+	void setAmbientColor(const QColor& color);
+	QColor getAmbientColor() const;
+
+	void begin();
+	void submit(const LightData& light);
+
+	// Bins the frame's lights into the clusters of the view and uploads them. Tiles cover the target;
+	// depth slices span nearPlane to farPlane, and lights past the far plane share the last slice.
+	// Past MAX_LIGHTS local lights are dropped before directional ones and counted in the stats.
+	void build(const QMatrix4x4& view, const QMatrix4x4& projection, float nearPlane, float farPlane,
+		const RenderTarget& target, RenderStats& stats);
+	// Points a USE_LIGHTING program at the buffers and the shadow maps
+	void apply(ShaderProgram& shader) const;
+
+	int getLightCount() const;
+
+protected:
+	void start();
+	void upload(GLuint buffer, const void* data, GLsizeiptr size);
+	int getSlice(float depth) const;
+
+	struct LightRange
+	{
+		int light;
+		int minX, maxX;
+		int minY, maxY;
+		int minZ, maxZ;
+	};
+
+protected:
+	bool mIsStarted;
+	bool mIsActive;
+	bool mIsOverflowReported;
+	GLExtensions mExtensions;
+	QColor mAmbientColor;
+	CascadedShadowMaps* mShadows;
+
+	GLuint mLightBuffer;
+	GLuint mClusterBuffer;
+	GLuint mIndexBuffer;
+	GLuint mLightTexture;
+	GLuint mClusterTexture;
+	GLuint mIndexTexture;
+
+	std::vector<LightData> mLights; // Submitted this frame
+
+	// Binning works on one array per component, and measures every light against one tile
+	// plane at a time, so the hot loops are straight float arithmetic the compiler vectorizes
+	std::vector<float> mViewX;
+	std::vector<float> mViewY;
+	std::vector<float> mViewZ;
+	std::vector<float> mRadii;
+	std::vector<float> mPlaneDistances; // (TILE_COUNT_X + 1 + TILE_COUNT_Y + 1) planes by light
+	std::vector<LightRange> mRanges;
+
+	std::vector<float> mLightTexels;
+	std::vector<GLuint> mClusters; // Offset into mIndices and light count per cluster
+	std::vector<GLuint> mIndices;
+
+	int mDirectionalCount;
+	int mShadowLightIndex; // Into mLights, -1 without one
+	QVector4D mViewport; // x, y, tile width, tile height in pixels
+	float mDepthScale;
+	float mDepthBias;
+};
+
+#endif // CLUSTERED_LIGHTING_H
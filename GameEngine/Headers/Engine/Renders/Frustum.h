@@ -0,0 +1,54 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <QMatrix4x4>
+#include <QVector3D>
+#include <QVector4D>
+
+// Six normalized planes (xyz normal pointing inside, w distance) extracted from a view-projection matrix.
+// Reversed-Z and [0, 1] clip depth only loosen the far plane, and an infinite one degenerates to
+// a plane every point is inside, so the tests stay conservative under any depth convention.
+struct Frustum
+{
+	enum Plane { PLANE_LEFT = 0, PLANE_RIGHT, PLANE_BOTTOM, PLANE_TOP, PLANE_NEAR, PLANE_FAR, PLANE_COUNT };
+
+	QVector4D planes[PLANE_COUNT];
+
+	static Frustum fromMatrix(const QMatrix4x4& viewProjection)
+	{
+		Frustum frustum;
+		QVector4D row0 = viewProjection.row(0);
+		QVector4D row1 = viewProjection.row(1);
+		QVector4D row2 = viewProjection.row(2);
+		QVector4D row3 = viewProjection.row(3);
+
+		frustum.planes[PLANE_LEFT] = row3 + row0;
+		frustum.planes[PLANE_RIGHT] = row3 - row0;
+		frustum.planes[PLANE_BOTTOM] = row3 + row1;
+		frustum.planes[PLANE_TOP] = row3 - row1;
+		frustum.planes[PLANE_NEAR] = row3 + row2;
+		frustum.planes[PLANE_FAR] = row3 - row2;
+
+		for (auto& plane : frustum.planes)
+		{
+			float length = plane.toVector3D().length();
+			if (length > 0.0f)
+			{
+				plane /= length;
+			}
+		}
+		return frustum;
+	}
+
+	bool intersectsSphere(const QVector3D& center, float radius) const
+	{
+		for (const auto& plane : planes)
+		{
+			if (QVector3D::dotProduct(plane.toVector3D(), center) + plane.w() < -radius)
+				return false;
+		}
+		return true;
+	}
+};
+
+#endif // FRUSTUM_H
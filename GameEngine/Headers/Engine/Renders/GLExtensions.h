@@ -0,0 +1,99 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+
+#ifndef GL_PARAMETER_BUFFER
+#define GL_PARAMETER_BUFFER 0x80EE
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_DYNAMIC_STORAGE_BIT
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#endif
+#ifndef GL_TIMESTAMP
+#define GL_TIMESTAMP 0x8E28
+#endif
+#ifndef GL_SAMPLES_PASSED
+#define GL_SAMPLES_PASSED 0x8914
+#endif
+#ifndef GL_TEXTURE_BUFFER
+#define GL_TEXTURE_BUFFER 0x8C2A
+#endif
+#ifndef GL_LOWER_LEFT
+#define GL_LOWER_LEFT 0x8CA1
+#endif
+#ifndef GL_NEGATIVE_ONE_TO_ONE
+#define GL_NEGATIVE_ONE_TO_ONE 0x935E
+#endif
+#ifndef GL_ZERO_TO_ONE
+#define GL_ZERO_TO_ONE 0x935F
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+// Entry points and capabilities above the GLES 3.x baseline of QOpenGLExtraFunctions.
+// Resolved from the current context, so init() must be called with a context current.
+class GLExtensions
+{
+public:
+	typedef void (QOPENGLF_APIENTRYP MultiDrawElementsIndirect)(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride);
+	typedef void (QOPENGLF_APIENTRYP MultiDrawElementsIndirectCount)(GLenum mode, GLenum type, const void* indirect, GLintptr drawCount, GLsizei maxDrawCount, GLsizei stride);
+	typedef void (QOPENGLF_APIENTRYP ClearBufferData)(GLenum target, GLenum internalFormat, GLenum format, GLenum type, const void* data);
+	typedef void (QOPENGLF_APIENTRYP BufferStorage)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+	typedef void (QOPENGLF_APIENTRYP QueryCounter)(GLuint id, GLenum target);
+	typedef void (QOPENGLF_APIENTRYP GetQueryObjectui64v)(GLuint id, GLenum pname, GLuint64* params);
+	typedef void (QOPENGLF_APIENTRYP MaxShaderCompilerThreads)(GLuint count);
+	typedef void (QOPENGLF_APIENTRYP ClipControl)(GLenum origin, GLenum depth);
+	typedef void (QOPENGLF_APIENTRYP TexBuffer)(GLenum target, GLenum internalFormat, GLuint buffer);
+
+	GLExtensions();
+
+	void init();
+
+	bool hasVersion(int major, int minor) const;
+	bool hasExtension(const char* name) const;
+	// Context init() resolved against, i.e. the one owning objects created alongside
+	QOpenGLContext* getContext() const;
+
+public:
+	bool isDesktop;
+	int majorVersion;
+	int minorVersion;
+
+	bool hasMultiDrawIndirect;
+	bool hasShaderDrawParameters;
+	bool hasShaderStorageBuffer;
+	bool hasComputeShader;
+	bool hasIndirectParameters;
+	bool hasBufferStorage;
+	bool hasTimerQuery;
+	bool hasParallelShaderCompile;
+	bool hasTextureCompressionBC; // S3TC/DXT, i.e. BC1-3
+	bool hasClipControl;
+	bool hasTextureBuffer;
+
+	MultiDrawElementsIndirect glMultiDrawElementsIndirect;
+	MultiDrawElementsIndirectCount glMultiDrawElementsIndirectCount;
+	ClearBufferData glClearBufferData;
+	BufferStorage glBufferStorage;
+	QueryCounter glQueryCounter;
+	GetQueryObjectui64v glGetQueryObjectui64v;
+	MaxShaderCompilerThreads glMaxShaderCompilerThreads;
+	ClipControl glClipControl;
+	TexBuffer glTexBuffer;
+
+private:
+	QOpenGLContext* mContext;
+};
+
+#endif // GL_EXTENSIONS_H
@@ -0,0 +1,143 @@
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H
+
+#include <vector>
+#include <QOpenGLExtraFunctions>
+
+#include "Engine/Renders/GLExtensions.h"
+
+// Shadow copy of the GL state the engine touches, so setting what is already set costs no driver
+// call. Engine code binds programs, vertex arrays, buffers and textures and toggles capabilities
+// through here instead of calling GL directly. State changed behind its back, by Qt or by
+// deleting a bound object, is forgotten with invalidate() or the delete* helpers.
+// Depth functions are always given for the conventional depth range, where smaller is nearer;
+// with reversed-Z on they are flipped here, so passes need not know which convention is active.
+class GLStateCache : protected QOpenGLExtraFunctions
+{
+public:
+	static const int MAX_TEXTURE_UNITS = 32;
+
+	static GLStateCache& instance();
+
+	// With the context current; forgets the state of any previous context
+	void init();
+	// The next call of every kind is issued
+	void invalidate();
+
+	// Resets the counters and forgets what Qt may have changed since the last frame
+	void beginFrame();
+	int getIssuedCount() const;
+	int getElidedCount() const;
+
+	void useProgram(GLuint program);
+	GLuint getProgram() const;
+
+	// The element array binding belongs to the vertex array, so it is tracked per bind
+	void bindVertexArray(GLuint vertexArray);
+	void bindBuffer(GLenum target, GLuint buffer);
+	// Indexed binds are always issued, but they also replace the target's generic binding
+	void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+	void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+	void activeTexture(int unit);
+	void bindTexture(int unit, GLenum target, GLuint texture);
+
+	void setIsEnabled(GLenum capability, bool isEnabled);
+	// A mode for GL_FRONT or GL_BACK alone leaves the other face filled
+	void setPolygonMode(GLenum mode, GLenum face = GL_FRONT_AND_BACK);
+	void setCullFace(GLenum face);
+	void setBlendFunc(GLenum source, GLenum destination);
+	void setDepthFunc(GLenum function);
+	void setClearDepth(float depth);
+	void setDepthMask(bool isEnabled);
+	void setColorMask(bool isEnabled);
+	void setClearColor(float red, float green, float blue, float alpha);
+
+	// Near maps to depth 1 and far to 0; flips every depth function set from then on
+	void setIsDepthReversed(bool isReversed);
+	bool getIsDepthReversed() const;
+	// Clip-space z in [0, 1] instead of [-1, 1] through glClipControl, which keeps the precision
+	// of reversed-Z; ignored without clip control support
+	void setIsDepthZeroToOne(bool isZeroToOne);
+	bool getIsDepthZeroToOne() const;
+	bool getIsClipControlSupported() const;
+	// Depth a cleared buffer holds under the current convention
+	float getFarDepth() const;
+
+	// GL unbinds deleted objects and recycles their names, so stale entries must go with them
+	void deleteVertexArray(GLuint& vertexArray);
+	void deleteBuffer(GLuint& buffer);
+	void deleteTexture(GLuint& texture);
+
+private:
+	GLStateCache();
+
+	static constexpr GLuint UNKNOWN = 0xFFFFFFFF;
+
+	enum BufferTarget
+	{
+		BUFFER_ARRAY,
+		BUFFER_ELEMENT_ARRAY,
+		BUFFER_COPY_READ,
+		BUFFER_COPY_WRITE,
+		BUFFER_DRAW_INDIRECT,
+		BUFFER_PARAMETER,
+		BUFFER_SHADER_STORAGE,
+		BUFFER_UNIFORM,
+		BUFFER_PIXEL_PACK,
+		BUFFER_PIXEL_UNPACK,
+		BUFFER_TARGET_COUNT,
+	};
+
+	enum TextureTarget
+	{
+		TEXTURE_2D,
+		TEXTURE_2D_ARRAY,
+		TEXTURE_3D,
+		TEXTURE_CUBE_MAP,
+		TEXTURE_BUFFER,
+		TEXTURE_TARGET_COUNT,
+	};
+
+	struct Capability
+	{
+		GLenum capability;
+		GLuint isEnabled; // UNKNOWN, 0 or 1
+	};
+
+	static int getBufferSlot(GLenum target);
+	static int getTextureSlot(GLenum target);
+	static GLenum getReversedDepthFunc(GLenum function);
+
+	// Counts the call and returns whether it has to reach the driver
+	bool update(GLuint& cached, GLuint value);
+
+private:
+	int mIssuedCount;
+	int mElidedCount;
+	GLExtensions mExtensions;
+	bool mIsDepthReversed;
+	bool mIsDepthZeroToOne;
+
+	GLuint mProgram;
+	GLuint mVertexArray;
+	GLuint mBuffers[BUFFER_TARGET_COUNT];
+	GLuint mActiveTexture;
+	GLuint mTextures[MAX_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+	std::vector<Capability> mCapabilities;
+	GLuint mFrontPolygonMode;
+	GLuint mBackPolygonMode;
+	GLuint mCullFace;
+	GLuint mBlendSource;
+	GLuint mBlendDestination;
+	GLuint mDepthFunc;
+	GLuint mClipDepthMode;
+	float mClearDepth;
+	bool mIsClearDepthKnown;
+	GLuint mDepthMask;
+	GLuint mColorMask;
+	float mClearColor[4];
+	bool mIsClearColorKnown;
+};
+
+#endif // GL_STATE_CACHE_H
@@ -0,0 +1,75 @@
+#ifndef GEOMETRY_BUFFER_H
+#define GEOMETRY_BUFFER_H
+
+#include <vector>
+#include <QOpenGLExtraFunctions>
+
+#include "Engine/Renders/Vertex.h"
+#include "Engine/Renders/BufferAllocator.h"
+
+// Range of a mesh inside the shared vertex and index buffers, in elements
+struct GeometryAllocation
+{
+	unsigned int vertexOffset = BufferAllocator::INVALID_OFFSET;
+	unsigned int vertexCount = 0;
+	unsigned int indexOffset = BufferAllocator::INVALID_OFFSET;
+	unsigned int indexCount = 0;
+
+	bool isValid() const
+	{
+		return vertexOffset != BufferAllocator::INVALID_OFFSET && indexOffset != BufferAllocator::INVALID_OFFSET;
+	}
+};
+
+// Packs the static meshes of a scene into one large vertex buffer and one large
+// index buffer that share a single VAO for the Vertex layout. Meshes are drawn with
+// glDrawElementsBaseVertex, so the VAO only has to be bound once per pass.
+// A second, position-only copy of the vertices has its own VAO for depth-only passes.
+class GeometryBuffer : protected QOpenGLExtraFunctions
+{
+public:
+	static const unsigned int DEFAULT_VERTEX_CAPACITY = 1 << 18;
+	static const unsigned int DEFAULT_INDEX_CAPACITY = 1 << 20;
+
+	GeometryBuffer(unsigned int vertexCapacity = DEFAULT_VERTEX_CAPACITY, unsigned int indexCapacity = DEFAULT_INDEX_CAPACITY);
+	~GeometryBuffer();
+
+	void init();
+	void tryStart();
+	void clear();
+
+	GeometryAllocation allocate(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+	void free(GeometryAllocation& allocation);
+
+	void bind();
+	// Position at location 0 only, with the same indices and base vertices
+	void bindDepth();
+	void unbind();
+
+	GLuint getVAO() const;
+	GLuint getVertexBuffer() const;
+	GLuint getIndexBuffer() const;
+
+	const BufferAllocator& getVertexAllocator() const;
+	const BufferAllocator& getIndexAllocator() const;
+
+protected:
+	void start();
+	void setupVertexArrays();
+	void setupVertexLayout();
+	void growBuffer(GLuint& buffer, GLsizeiptr oldSize, GLsizeiptr newSize);
+	static unsigned int getGrownCapacity(unsigned int capacity, unsigned int minCapacity);
+
+protected:
+	bool mIsStarted;
+	GLuint mVAO;
+	GLuint mDepthVAO;
+	GLuint mVertexBuffer;
+	GLuint mPositionBuffer;
+	GLuint mIndexBuffer;
+
+	BufferAllocator mVertexAllocator;
+	BufferAllocator mIndexAllocator;
+};
+
+#endif // GEOMETRY_BUFFER_H
@@ -0,0 +1,77 @@
+#ifndef GPU_CULLER_H
+#define GPU_CULLER_H
+
+#include <vector>
+#include <memory>
+#include <QOpenGLExtraFunctions>
+#include <QMatrix4x4>
+
+#include "Engine/Renders/GLExtensions.h"
+#include "Engine/Renders/HiZPyramid.h"
+#include "Engine/Renders/RenderStats.h"
+#include "Engine/Renders/RenderTarget.h"
+#include "Engine/Renders/ShaderProgram.h"
+#include "Engine/Renders/UploadRingBuffer.h"
+
+// Compute-shader culling of indirect draw commands. Every command carries a world-space
+// bounding sphere; visible commands are compacted to the front of their bucket in the
+// output buffer and the rest of the bucket is left zeroed (instanceCount 0). Culled counts
+// are read back through a fence a couple of frames later so the CPU never waits on the GPU.
+class GpuCuller : protected QOpenGLExtraFunctions
+{
+public:
+	// Counter layout of the counter buffer: two totals followed by one visible count per bucket
+	static const int COUNTER_FRUSTUM_CULLED = 0;
+	static const int COUNTER_OCCLUSION_CULLED = 1;
+	static const int COUNTER_VISIBLE_BASE = 2;
+	static const int READBACK_FRAMES = 2;
+
+	struct BucketRange
+	{
+		GLuint firstCommand;
+		GLuint commandCount;
+	};
+
+	GpuCuller();
+	~GpuCuller();
+
+	void init(const GLExtensions& extensions);
+	void tryStart();
+	void clear();
+
+	void setUseOcclusion(bool useOcclusion);
+	bool getUseOcclusion() const;
+
+	// Runs the cull pass; the input command and bounds buffers must be filled for every bucket
+	void cull(const UploadAllocation& inputCommands, const UploadAllocation& bounds, const std::vector<BucketRange>& buckets,
+		const QMatrix4x4& viewProjection, RenderStats& stats);
+
+	// Builds the Hi-Z pyramid from the frame that was just rendered, for next frame's occlusion test
+	void endFrame(const QMatrix4x4& viewProjection, const RenderTarget& target);
+
+	GLuint getOutputCommandBuffer() const;
+	GLuint getCounterBuffer() const;
+	GLintptr getVisibleCountOffset(int bucketIndex) const;
+
+protected:
+	void start();
+	void readBackCounters(int frame);
+
+protected:
+	bool mIsStarted;
+	bool mUseOcclusion;
+
+	GLExtensions mExtensions;
+	std::unique_ptr<ShaderProgram> mCullShader;
+	HiZPyramid mHiZPyramid;
+
+	GLuint mOutputCommandBuffer;
+	GLuint mCounterBuffers[READBACK_FRAMES];
+	GLsync mCounterFences[READBACK_FRAMES];
+	int mFrameIndex;
+
+	int mLastFrustumCulled;
+	int mLastOcclusionCulled;
+};
+
+#endif // GPU_CULLER_H
@@ -0,0 +1,63 @@
+#ifndef HIZ_PYRAMID_H
+#define HIZ_PYRAMID_H
+
+#include <memory>
+#include <QOpenGLExtraFunctions>
+#include <QMatrix4x4>
+
+#include "Engine/Renders/RenderTarget.h"
+#include "Engine/Renders/ShaderProgram.h"
+
+// Hierarchical depth pyramid built from the depth buffer of the frame that was just rendered.
+// Each texel of level N holds the farthest depth of the 2x2 (or 3x3 on odd edges) texels of
+// level N-1 it covers, so a single fetch conservatively bounds the occluders of a screen rect.
+// The depth convention in use when it was built is kept with it, since "farthest" flips with reversed-Z.
+class HiZPyramid : protected QOpenGLExtraFunctions
+{
+public:
+	HiZPyramid();
+	~HiZPyramid();
+
+	void init();
+	void tryStart();
+	void clear();
+
+	// Copies the depth of the target and rebuilds the mip chain; the target is bound again afterwards
+	void build(const QMatrix4x4& viewProjection, const RenderTarget& target);
+
+	bool getIsValid() const;
+	GLuint getTexture() const;
+	int getWidth() const;
+	int getHeight() const;
+	int getLevelCount() const;
+	const QMatrix4x4& getViewProjection() const;
+	bool getIsReversedZ() const;
+	bool getIsZeroToOne() const;
+
+protected:
+	void start();
+	void resize(const RenderTarget& target);
+	// Blit-compatible format of the target's depth buffer, or GL_NONE if there is none to copy
+	GLenum getDepthFormat(GLuint framebuffer);
+	void releaseTextures();
+
+protected:
+	bool mIsStarted;
+	bool mIsValid;
+	bool mIsBlitSupported; // Decided with each resize, so frames never probe for blit errors
+
+	std::unique_ptr<ShaderProgram> mReduceShader;
+
+	GLuint mDepthFramebuffer;
+	GLuint mDepthTexture;
+	GLuint mPyramidTexture;
+
+	int mWidth;
+	int mHeight;
+	int mLevelCount;
+	QMatrix4x4 mViewProjection;
+	bool mIsReversedZ;
+	bool mIsZeroToOne;
+};
+
+#endif // HIZ_PYRAMID_H
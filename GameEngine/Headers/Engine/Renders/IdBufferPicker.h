@@ -0,0 +1,57 @@
+#ifndef ID_BUFFER_PICKER_H
+#define ID_BUFFER_PICKER_H
+
+#include <memory>
+#include <vector>
+#include <QOpenGLExtraFunctions>
+#include <QPointF>
+#include <QSizeF>
+
+#include "Engine/Renders/ShaderProgram.h"
+#include "Engine/Spatial/SpatialIndex.h"
+
+class Node;
+
+// Picks on the GPU: the objects whose sphere the pick ray enters are drawn with their id into a
+// one-pixel integer target, through a projection narrowed to the picked pixel. The id is copied
+// into a pixel pack buffer behind a fence and mapped once the fence has passed, a frame or two
+// later, so the pipeline never waits on the readback. One pick is in flight at a time.
+class IdBufferPicker : protected QOpenGLExtraFunctions
+{
+public:
+	IdBufferPicker();
+	~IdBufferPicker();
+
+	void init();
+	void tryStart();
+	void clear();
+
+	// Queued for the next render; replaces a request that has not been drawn yet
+	void request(const QPointF& pixel, const QSizeF& viewportSize);
+	bool getIsBusy() const;
+
+	// Draws the queued request from the frame's index; restores the framebuffer and viewport it found
+	void render(const SpatialIndex& index, const QMatrix4x4& view, const QMatrix4x4& projection);
+	// True once the readback landed; node is null when the pixel showed no object
+	bool poll(Node*& node);
+
+protected:
+	void start();
+
+protected:
+	bool mIsStarted;
+	std::unique_ptr<ShaderProgram> mIdShader;
+	GLuint mFramebuffer;
+	GLuint mColorBuffer; // GL_R32UI
+	GLuint mDepthBuffer;
+	GLuint mPixelBuffer;
+	GLsync mFence;
+
+	bool mIsRequested;
+	QPointF mPixel;
+	QSizeF mViewportSize;
+	std::vector<Node*> mPendingNodes; // Id i + 1 of the pick in flight
+	std::vector<SpatialIndex::Candidate> mCandidates;
+};
+
+#endif // ID_BUFFER_PICKER_H
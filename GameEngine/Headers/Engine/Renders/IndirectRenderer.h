@@ -0,0 +1,119 @@
+#ifndef INDIRECT_RENDERER_H
+#define INDIRECT_RENDERER_H
+
+#include <vector>
+#include <memory>
+#include <QOpenGLExtraFunctions>
+#include <QMatrix4x4>
+
+#include "Engine/Enums/RenderMode.h"
+#include "Engine/Renders/ClusteredLighting.h"
+#include "Engine/Renders/GLExtensions.h"
+#include "Engine/Renders/GpuCuller.h"
+#include "Engine/Renders/Mesh.h"
+#include "Engine/Renders/RenderStats.h"
+#include "Engine/Renders/RenderTarget.h"
+#include "Engine/Renders/ShaderVariants.h"
+#include "Engine/Renders/UploadRingBuffer.h"
+
+// Layout mandated by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+// Collects static meshes during the render traversal and submits them with one
+// glMultiDrawElementsIndirect per draw mode / polygon mode bucket. Commands, world matrices
+// and bounds are streamed through the scene's UploadRingBuffer; each command's baseInstance holds its matrix index, which the vertex
+// shader reads back as gl_BaseInstanceARB so it survives GPU compaction.
+// A frame is prepare()d once, which uploads and culls, and then drawn by drawDepth() for the
+// depth pre-pass and by draw() for colour, both from the same command buffer.
+// Requires GL 4.3 (or ARB_multi_draw_indirect) and ARB_shader_draw_parameters; when
+// unavailable, submit() refuses and callers draw directly.
+class IndirectRenderer : protected QOpenGLExtraFunctions
+{
+public:
+	IndirectRenderer();
+	~IndirectRenderer();
+
+	void init();
+	void tryStart();
+	void clear();
+
+	void setIsEnabled(bool isEnabled);
+	bool getIsEnabled() const;
+	bool getIsSupported() const;
+	bool getIsActive() const;
+
+	// Optional compute-shader frustum and Hi-Z occlusion culling of the submitted commands
+	void setIsGpuCulling(bool isGpuCulling);
+	bool getIsGpuCulling() const;
+	GpuCuller& getGpuCuller();
+
+	// Cutout meshes are refused while on, since the depth shader cannot discard their holes
+	void setIsDepthPrePass(bool isDepthPrePass);
+	bool getIsDepthPrePass() const;
+
+	// While its lights are built, draw() shades with the USE_LIGHTING variant once that has compiled
+	void setLighting(ClusteredLighting* lighting);
+
+	void begin();
+	bool submit(const Mesh& mesh, const QMatrix4x4& world, PolygonMode polygonMode);
+	// Uploads and culls the frame's commands; false when there is nothing to draw
+	bool prepare(const QMatrix4x4& view, const QMatrix4x4& projection, UploadRingBuffer& uploadBuffer, RenderStats& stats);
+	// Colour writes are masked off by the caller; returns whether the depth was laid down
+	bool drawDepth(const QMatrix4x4& view, const QMatrix4x4& projection, RenderStats& stats);
+	// Tests GL_EQUAL without writing depth if drawDepth() ran this frame
+	void draw(const QMatrix4x4& view, const QMatrix4x4& projection, RenderStats& stats);
+	void endFrame(const QMatrix4x4& view, const QMatrix4x4& projection, const RenderTarget& target);
+
+protected:
+	void start();
+
+	struct Bucket
+	{
+		GLenum drawMode;
+		PolygonMode polygonMode;
+		std::vector<DrawElementsIndirectCommand> commands;
+		std::vector<float> worlds; // 16 floats per command, column-major
+		std::vector<float> bounds; // world-space sphere per command: center xyz, radius
+	};
+
+	Bucket& getBucket(GLenum drawMode, PolygonMode polygonMode);
+	// Binds the prepared command and matrix buffers, then issues one multi-draw per bucket
+	int drawBuckets(ShaderProgram& shader, const QMatrix4x4& view, const QMatrix4x4& projection);
+
+protected:
+	bool mIsStarted;
+	bool mIsEnabled;
+	bool mIsGpuCulling;
+	bool mIsDepthPrePass;
+
+	GLExtensions mExtensions;
+	GpuCuller mGpuCuller;
+	std::unique_ptr<ShaderVariants> mShaders;
+	ShaderProgram* mShader; // Owned by mShaders
+	ShaderProgram* mLitShader; // Owned by mShaders, requested with the first lit frame
+	ClusteredLighting* mLighting;
+	std::unique_ptr<ShaderProgram> mDepthShader;
+
+	std::vector<Bucket> mBuckets;
+	std::vector<DrawElementsIndirectCommand> mCommands;
+	std::vector<float> mWorlds;
+	std::vector<float> mBounds;
+	std::vector<GpuCuller::BucketRange> mBucketRanges;
+
+	// Of the prepared frame
+	bool mIsPrepared;
+	bool mIsDepthDrawn;
+	bool mUseGpuCulling;
+	GLuint mCommandBuffer;
+	GLintptr mCommandOffset;
+	UploadAllocation mWorldAllocation;
+};
+
+#endif // INDIRECT_RENDERER_H
@@ -0,0 +1,21 @@
+#ifndef LIGHT_DATA_H
+#define LIGHT_DATA_H
+
+#include <QVector3D>
+
+#include "Engine/Enums/LightType.h"
+
+// One light as handed to the ClusteredLighting, in world space
+struct LightData
+{
+	LightType type = LightType::POINT;
+	QVector3D position;
+	QVector3D direction = QVector3D(0.0f, 0.0f, -1.0f); // Where the light travels; spot and directional
+	QVector3D color = QVector3D(1.0f, 1.0f, 1.0f);      // Linear, intensity included
+	float range = 10.0f;                                // Point and spot lights reach zero here
+	float innerConeCos = 1.0f;                          // Spot cone, full intensity inside
+	float outerConeCos = 0.0f;                          // Spot cone, dark outside
+	bool isCastingShadows = false;                      // Directional only, see CascadedShadowMaps
+};
+
+#endif // LIGHT_DATA_H
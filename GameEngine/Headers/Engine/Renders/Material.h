@@ -0,0 +1,117 @@
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+#include <vector>
+#include <QByteArray>
+#include <QColor>
+#include <QMatrix4x4>
+#include <QString>
+#include <QVector2D>
+#include <QVector3D>
+#include <QVector4D>
+
+#include "Engine/Enums/RenderMode.h"
+#include "Engine/Renders/ShaderVariants.h"
+#include "Engine/Renders/Texture.h"
+#include "Engine/Renders/TextureManager.h"
+
+// Fixed-function state a material draws with
+struct RasterState
+{
+	PolygonMode polygonMode = PolygonMode::FILL;
+	DrawBufferMode drawBufferMode = DrawBufferMode::FRONT_AND_BACK; // Faces polygonMode applies to
+	CullMode cullMode = CullMode::NONE;
+	BlendMode blendMode = BlendMode::NONE;
+	bool isDepthTest = true;
+	bool isDepthWrite = true;
+
+	bool operator==(const RasterState& other) const;
+	bool operator!=(const RasterState& other) const;
+};
+
+// Everything a draw needs besides its mesh and transform: a shader variant, uniform values,
+// textures and raster state. Equal materials hash equally, so the MaterialLibrary keeps one
+// instance per distinct material and the RenderQueue can group draws by it.
+class Material
+{
+public:
+	static const int INVALID_ID = -1;
+
+	Material();
+	Material(ShaderVariants* shaders, ShaderVariants::Key variant);
+
+	void setShader(ShaderVariants* shaders, ShaderVariants::Key variant);
+	ShaderVariants* getShaders() const;
+	ShaderVariants::Key getVariant() const;
+	// Compiles the variant on first use, so a context must be current. Frame-wide keywords, such
+	// as USE_LIGHTING, are added to the material's own.
+	ShaderProgram* getShaderProgram(ShaderVariants::Key keywords = 0) const;
+
+	void setUniform(const QByteArray& name, int value);
+	void setUniform(const QByteArray& name, float value);
+	void setUniform(const QByteArray& name, const QVector2D& value);
+	void setUniform(const QByteArray& name, const QVector3D& value);
+	void setUniform(const QByteArray& name, const QVector4D& value);
+	void setUniform(const QByteArray& name, const QColor& value);
+	void setUniform(const QByteArray& name, const QMatrix4x4& value);
+
+	// Texture arrays go to consecutive units; the layer is written to layerUniform
+	void setTexture(const QString& path, const QByteArray& sampler = "sampler", const QByteArray& layerUniform = "mTextureLayer");
+	int getTextureCount() const;
+
+	void setRasterState(const RasterState& rasterState);
+	const RasterState& getRasterState() const;
+
+	size_t getHash() const;
+	bool operator==(const Material& other) const;
+
+	// Assigned by the MaterialLibrary
+	int getId() const;
+
+	// Uniforms and textures; raster state is left to the caller so it can apply deltas
+	void apply(ShaderProgram& shader, TextureManager* textureManager);
+
+private:
+	enum class UniformType
+	{
+		Int,
+		Float,
+		Vec2,
+		Vec3,
+		Vec4,
+		Mat4,
+	};
+
+	struct UniformValue
+	{
+		QByteArray name;
+		UniformType type;
+		std::vector<float> values;
+
+		bool operator==(const UniformValue& other) const;
+	};
+
+	struct TextureBinding
+	{
+		QString path;
+		QByteArray sampler;
+		QByteArray layerUniform;
+		int textureId = Texture::INVALID_ID;
+
+		bool operator==(const TextureBinding& other) const;
+	};
+
+	void setUniformValue(const QByteArray& name, UniformType type, const float* values, int count);
+
+private:
+	friend class MaterialLibrary;
+
+	int mId;
+	ShaderVariants* mShaders;
+	ShaderVariants::Key mVariant;
+	RasterState mRasterState;
+	std::vector<UniformValue> mUniforms;
+	std::vector<TextureBinding> mTextures;
+};
+
+#endif // MATERIAL_H
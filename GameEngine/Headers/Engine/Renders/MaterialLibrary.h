@@ -0,0 +1,36 @@
+#ifndef MATERIAL_LIBRARY_H
+#define MATERIAL_LIBRARY_H
+
+#include <memory>
+#include <unordered_map>
+
+#include "Engine/Renders/Material.h"
+
+// Interns materials so equal ones share one instance and one id. Renderers hold the shared
+// instances; the RenderQueue sorts on their ids, so equal state is only applied once per run.
+class MaterialLibrary
+{
+public:
+	MaterialLibrary();
+
+	void setDefaultShaders(ShaderVariants* shaders, ShaderVariants::Key variant);
+	std::shared_ptr<Material> getDefaultMaterial() const;
+
+	// Returns the existing instance equal to the material, or adds a copy of it
+	std::shared_ptr<Material> intern(const Material& material);
+	std::shared_ptr<Material> withPolygonMode(const std::shared_ptr<Material>& material, PolygonMode polygonMode,
+		DrawBufferMode drawBufferMode = DrawBufferMode::FRONT_AND_BACK);
+
+	// Draws the indirect renderer's fixed shading could reproduce
+	bool getIsIndirectCompatible(const Material& material) const;
+
+	int getMaterialCount() const;
+	void clear();
+
+private:
+	std::unordered_multimap<size_t, std::shared_ptr<Material>> mMaterials;
+	std::shared_ptr<Material> mDefaultMaterial;
+	int mNextId;
+};
+
+#endif // MATERIAL_LIBRARY_H
@@ -1,17 +1,24 @@
 #ifndef MESH_H
 #define MESH_H
 
+#include <memory>
 #include <vector>
 #include <QOpenGLExtraFunctions>
 
 #include "Vertex.h"
 #include "Texture.h"
 #include "ShaderProgram.h"
+#include "GeometryBuffer.h"
+#include "TextureManager.h"
 
 #include "Engine/Interfaces/ISerializable.h"
+#include "Engine/Spatial/MeshBVH.h"
 
 class Mesh : public QOpenGLExtraFunctions, public ISerializable {
 public:
+    // default.frag discards fragments at or below this alpha
+    static constexpr float CUTOUT_ALPHA = 0.01f;
+
     QString path = "";
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
@@ -24,12 +31,30 @@ public:
     
 
     void init();
-    void tryStart();
+    void tryStart(GeometryBuffer* geometryBuffer, TextureManager* textureManager);
     virtual void write(QJsonObject& json) const;
     virtual void read(const QJsonObject& json);
 	virtual void clear();
 
+    // Binds the owning GeometryBuffer, which the state cache elides while it stays bound across a
+    // pass. Binds the first texture's array to unit 0
+    // and selects its layer; shaders built without USE_TEXTURE simply ignore it
     virtual void draw(ShaderProgram& shader);
+    // Position-only stream for depth passes; the shader only needs mWorld, mView and mProj
+    void drawDepth();
+
+    const GeometryAllocation& getAllocation() const;
+    GLenum getDrawMode() const;
+
+    // Local-space bounds, valid once the mesh is started
+    QVector3D getBoundsMin() const;
+    QVector3D getBoundsMax() const;
+    QVector4D getBoundingSphere() const; // xyz center, w radius
+    // Some vertex alpha falls under CUTOUT_ALPHA, so a depth-only pass would fill the holes
+    bool getIsCutout() const;
+    // Triangle hierarchy for ray and overlap queries, built from the CPU copy on first use or
+    // read from the BVH cache; not thread-safe
+    const MeshBVH& getBVH();
 
 
 protected:
@@ -37,10 +62,19 @@ protected:
 
     //  render data
 	bool mIsStarted;
-    unsigned int mVAO, mVBO, mEBO;
+    GeometryBuffer* mGeometryBuffer;
+    TextureManager* mTextureManager;
+    GeometryAllocation mAllocation; // Range inside the shared vertex/index buffers
     GLenum mDrawMode; // Member variable to store the drawing mode
 
+    QVector3D mBoundsMin;
+    QVector3D mBoundsMax;
+    QVector4D mBoundingSphere;
+    bool mIsCutout;
+    std::unique_ptr<MeshBVH> mBVH;
+
     void setupMesh();
+    void computeBounds();
 };
 
 #endif // MESH_H
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef OVERDRAW_COUNTER_H
+#define OVERDRAW_COUNTER_H
+
+#include <QOpenGLExtraFunctions>
+
+#include "Engine/Renders/GLExtensions.h"
+#include "Engine/Renders/RenderStats.h"
+
+// Counts the fragments that pass the depth test during the colour passes with a
+// GL_SAMPLES_PASSED query; divided by the viewport area, that is the average number of times
+// each pixel was shaded. Queries rotate through QUERY_FRAMES slots and are read back once
+// available, so the figures trail the frame by a couple of frames. Desktop GL only.
+class OverdrawCounter : protected QOpenGLExtraFunctions
+{
+public:
+	static const int QUERY_FRAMES = 3;
+
+	OverdrawCounter();
+	~OverdrawCounter();
+
+	void init();
+	void clear();
+
+	void setIsEnabled(bool isEnabled);
+	bool getIsEnabled() const;
+	bool getIsSupported() const;
+
+	// Around the colour passes of a frame; nothing is counted while disabled
+	void begin();
+	void end();
+
+	// Writes the latest available result
+	void resolve(RenderStats& stats);
+
+protected:
+	void start();
+	void collect(int slot);
+
+protected:
+	bool mIsStarted;
+	bool mIsEnabled;
+	bool mIsCounting;
+	GLExtensions mExtensions;
+
+	GLuint mQueries[QUERY_FRAMES];
+	bool mIsPending[QUERY_FRAMES];
+	long long mViewportAreas[QUERY_FRAMES];
+	int mSlot;
+
+	long long mFragments;
+	long long mViewportArea;
+};
+
+#endif // OVERDRAW_COUNTER_H
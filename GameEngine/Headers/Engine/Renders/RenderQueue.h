@@ -0,0 +1,72 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <vector>
+#include <QMatrix4x4>
+
+#include "Engine/Renders/ClusteredLighting.h"
+#include "Engine/Renders/Material.h"
+#include "Engine/Renders/Mesh.h"
+#include "Engine/Renders/RenderStats.h"
+#include "Engine/Renders/ShaderProgram.h"
+#include "Engine/Renders/TextureManager.h"
+
+// Collects the directly drawn meshes of a frame and draws them with a 64-bit sort key per draw:
+//  - Opaque draws come first, bucketed coarsely front to back, then grouped by program and
+//    material. Draws already laid down by the depth pre-pass ignore depth, since they cost no
+//    overdraw, and sort purely by state.
+//  - Blended draws come last and back to front.
+// Programs are bound and materials applied only when they change between consecutive draws;
+// raster state goes through the GLStateCache, so only the parts that differ reach the driver.
+class RenderQueue
+{
+public:
+	RenderQueue();
+
+	// While its lights are built, materials draw with their USE_LIGHTING variant
+	void setLighting(ClusteredLighting* lighting);
+
+	void begin();
+	void submit(Mesh* mesh, Material* material, const QMatrix4x4& world);
+
+	// Builds the sort keys for the camera; flush() sorts without a pre-pass if this was skipped
+	void sort(const QMatrix4x4& view, bool isDepthPrePass);
+	// Draws the pre-passable meshes front to back into depth only; colour writes are masked off by the caller
+	void flushDepth(ShaderProgram& depthShader, const QMatrix4x4& view, const QMatrix4x4& projection, RenderStats& stats);
+	// Expects the scene's GeometryBuffer to be bound
+	void flush(const QMatrix4x4& view, const QMatrix4x4& projection, TextureManager* textureManager, RenderStats& stats);
+
+	int getCommandCount() const;
+
+	// Opaque, depth-writing and untextured: the colour pass shades exactly what the depth pass wrote
+	static bool getIsDepthPrePassable(const Mesh& mesh, const Material& material);
+
+protected:
+	struct Command
+	{
+		quint64 sortKey;
+		float depth; // View-space distance of the bounding sphere center
+		bool isPrePassed;
+		Mesh* mesh;
+		Material* material;
+		QMatrix4x4 world;
+	};
+
+	// Logarithmic, so nearby draws keep more precision than distant ones
+	static quint64 getDepthBits(float depth);
+
+	ShaderVariants::Key getKeywords() const;
+	void applyRasterState(const RasterState& rasterState, bool isPrePassed, RenderStats& stats);
+
+protected:
+	ClusteredLighting* mLighting;
+	std::vector<Command> mCommands;
+	std::vector<unsigned int> mOrder; // Sorted indices, so the matrices are not moved around
+	std::vector<unsigned int> mDepthOrder; // Pre-passed draws, front to back
+	RasterState mRasterState; // Of the previous material, for the change counter
+	bool mIsPrePassed; // Whether mRasterState was applied for a pre-passed draw
+	bool mHasRasterState;
+	bool mIsSorted;
+};
+
+#endif // RENDER_QUEUE_H
@@ -0,0 +1,83 @@
+#ifndef RENDER_SNAPSHOT_H
+#define RENDER_SNAPSHOT_H
+
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <QMatrix4x4>
+#include <QQuaternion>
+#include <QVector3D>
+
+#include "Engine/Enums/RenderMode.h"
+#include "Engine/Renders/Frustum.h"
+#include "Engine/Renders/LightData.h"
+
+class Mesh;
+class Material;
+class Node;
+
+// One mesh to draw, with the poses of the last two simulation steps for interpolation.
+// Shares the mesh and material, so the renderer never reads anything the simulation may free meanwhile.
+struct RenderItem
+{
+	std::shared_ptr<Mesh> mesh;
+	Node* node = nullptr; // Owner, reported by picking; only compared, never dereferenced by the renderer
+	std::shared_ptr<Material> material;
+	PolygonMode polygonMode = PolygonMode::FILL;
+	bool isStatic = false;
+	bool isVisible = true; // Outside the camera frustum, the item is only kept as a shadow caster
+
+	QMatrix4x4 world; // Pose after the last step; static items use it as is
+	QVector3D previousPosition;
+	QQuaternion previousRotation;
+	QVector3D previousScale;
+	QVector3D position;
+	QQuaternion rotation;
+	QVector3D scale;
+
+	QMatrix4x4 getWorldMatrix(float alpha) const;
+};
+
+// One light with its position and direction of the last two simulation steps
+struct LightItem
+{
+	LightData light; // After the last step
+	QVector3D previousPosition;
+	QVector3D previousDirection;
+
+	LightData getLightData(float alpha) const;
+};
+
+// Immutable view of the scene produced by the simulation after a step and consumed by the
+// renderer: the camera and the meshes and lights that passed frustum culling. Owns no GL state, so it
+// can be built on any thread, and holds copies or shared references only, so it can be drawn
+// without the simulation mutex.
+struct RenderSnapshot
+{
+	long long stepIndex = -1;
+	float fixedDeltaTime = 0.0f;
+	std::chrono::steady_clock::time_point publishTime;
+
+	QVector3D previousCameraPosition;
+	QQuaternion previousCameraRotation;
+	QVector3D cameraPosition;
+	QQuaternion cameraRotation;
+	QMatrix4x4 projection;
+	float nearPlane = 0.1f;
+	float farPlane = 1000.0f;
+	Frustum frustum; // Of the camera after the last step
+	bool isShadowCasting = false; // Keep items outside the frustum, which may still cast into it
+
+	std::vector<RenderItem> items;
+	std::vector<LightItem> lights;
+
+	// Keeps the item storage so steady-state snapshots do not allocate
+	void reset();
+	bool isValid() const;
+
+	QMatrix4x4 getViewMatrix(float alpha) const;
+	// Fraction of a step elapsed since the snapshot was published
+	float getAlpha(std::chrono::steady_clock::time_point now) const;
+};
+
+#endif // RENDER_SNAPSHOT_H
@@ -0,0 +1,51 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+// Counters collected by the scene while rendering one frame
+struct RenderStats
+{
+	int drawCalls = 0;          // Individual glDraw* calls issued from the CPU
+	int indirectDrawCalls = 0;  // glMultiDrawElementsIndirect calls
+	int indirectCommands = 0;   // Draw commands consumed by the indirect calls
+	double cpuSubmitMs = 0.0;   // CPU time spent in Scene::render
+	int depthDrawCalls = 0;     // Draws of the depth pre-pass, direct ones and indirect calls alike
+
+	// Directly drawn meshes, sorted by the RenderQueue
+	int shaderBinds = 0;        // Program switches
+	int materialBinds = 0;      // Material switches, uniforms and textures applied
+	int rasterStateChanges = 0; // Raster state deltas applied between materials
+
+	// State changes routed through the GLStateCache
+	int stateCallsIssued = 0;   // Reached the driver
+	int stateCallsElided = 0;   // Dropped because the state was already set
+
+	// GPU culling; culled counts lag a couple of frames behind because they are read back without stalling
+	int gpuCullCandidates = 0;
+	int frustumCulled = 0;
+	int occlusionCulled = 0;
+
+	// Colour passes, from a samples-passed query; lags like the culling counters
+	long long fragmentsShaded = 0;
+	double overdraw = 0.0;      // Fragments shaded per viewport pixel
+
+	// Clustered lighting
+	int lights = 0;             // Lights binned this frame, directional ones included
+	int lightIndices = 0;       // Entries of the cluster light lists
+	int lightsDropped = 0;      // Lights past ClusteredLighting::MAX_LIGHTS, left unshaded
+
+	// Cascaded shadow maps
+	int shadowCascades = 0;       // Cascades rendered this frame
+	int shadowCachedCascades = 0; // Of those, cascades whose static casters came from the cache
+	int shadowDrawCalls = 0;      // Caster draws over all cascades
+
+	// Dynamic uploads through the ring buffer
+	long long uploadBytes = 0;
+	double uploadWaitMs = 0.0;  // CPU time blocked on fences of frames still in flight
+
+	void reset()
+	{
+		*this = RenderStats();
+	}
+};
+
+#endif // RENDER_STATS_H
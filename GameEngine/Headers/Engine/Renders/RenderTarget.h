@@ -0,0 +1,15 @@
+#ifndef RENDER_TARGET_H
+#define RENDER_TARGET_H
+
+#include <qopengl.h>
+
+// Framebuffer the scene draws into and its size in pixels, handed in by whoever owns it so
+// passes that switch framebuffers can return to it without reading GL state back
+struct RenderTarget
+{
+	GLuint framebuffer = 0;
+	int width = 0;
+	int height = 0;
+};
+
+#endif // RENDER_TARGET_H
@@ -0,0 +1,45 @@
+#ifndef SHADER_CACHE_H
+#define SHADER_CACHE_H
+
+#include <QByteArray>
+#include <QOpenGLContext>
+#include <QString>
+
+// On-disk store of linked program binaries, one file per key. Keys are built by ShaderProgram
+// from the sources, attribute bindings and the GL vendor, renderer and version strings, so an
+// edited shader or a driver update simply misses. Entries the driver rejects are removed.
+class ShaderCache
+{
+public:
+	static ShaderCache& instance();
+
+	void setIsEnabled(bool isEnabled);
+	bool getIsEnabled() const;
+
+	// Defaults to the application cache location
+	void setDirectory(const QString& directory);
+	QString getDirectory() const;
+
+	bool read(const QByteArray& key, GLenum& format, QByteArray& binary);
+	void write(const QByteArray& key, GLenum format, const QByteArray& binary);
+	void remove(const QByteArray& key);
+
+	int getHitCount() const;
+	int getMissCount() const;
+
+private:
+	ShaderCache();
+
+	QString getPath(const QByteArray& key) const;
+
+private:
+	static const quint32 FILE_MAGIC = 0x42504547; // "GEPB"
+	static const quint32 FILE_VERSION = 1;
+
+	bool mIsEnabled;
+	QString mDirectory;
+	int mHitCount;
+	int mMissCount;
+};
+
+#endif // SHADER_CACHE_H
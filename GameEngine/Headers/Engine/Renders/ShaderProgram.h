@@ -2,33 +2,90 @@
 #define SHADER_PROGRAM_H
 
 #include <QOpenGLExtraFunctions>
-#include <QOpenGLShaderProgram>
+#include <QByteArray>
+#include <QColor>
+#include <QHash>
+#include <QMatrix4x4>
+#include <QStringList>
+#include <QTransform>
 
+#include <functional>
+#include <memory>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
 
+#include "Engine/Renders/GLExtensions.h"
+
+// GL program built from vertex/fragment or compute sources. Linked binaries are kept in the
+// ShaderCache, so later runs skip compilation entirely. With setIsAsync() and
+// KHR/ARB_parallel_shader_compile the link runs on the driver's compiler threads: start() returns
+// immediately, bind() polls for completion and binds the fallback program until then, and
+// uniforms set in the meantime are replayed onto the finished program.
 class ShaderProgram : protected QOpenGLExtraFunctions
 {
 public:
+	enum class Status
+	{
+		Empty,
+		Compiling,
+		Ready,
+		Failed,
+	};
+
 	QString vertexPath;
 	QString fragmentPath;
 
 	QString vertexCode;
 	QString fragmentCode;
 
+	QString computePath;
+	QString computeCode;
+
     bool mIsStarted;
 
     // constructor reads and builds the shader
     ShaderProgram(QString vertexPath, QString fragmentPath);
+    // constructor reads and builds a compute shader
+    ShaderProgram(QString computePath);
+    ~ShaderProgram();
     void init();
     void start();
     void clear();
 
+    // Injected as #define lines after #version, so one source can build specialised variants.
+    // Must be set before start()
+    void setDefines(const QStringList& defines);
+    QStringList getDefines() const;
+
+    // Must be set before start(); ignored without parallel shader compile support
+    void setIsAsync(bool isAsync);
+    bool getIsAsync() const;
+    // Bound in place of this program while it is still compiling
+    void setFallback(ShaderProgram* fallback);
+
+    // Finishes a pending link once the driver reports completion, without blocking
+    void poll();
+    Status getStatus() const;
+    // Compile and link errors of the last build or reload, empty on success
+    QString getLog() const;
+    QString getName() const;
+    bool getIsReady() const;
+    bool getIsFromCache() const;
+    GLuint getProgramId() const;
+
+    // Rebuilds from the source files into a separate program, swapped in by poll() once it
+    // links with the current uniform values; a failed build leaves the current program in
+    // place. False if nothing changed.
+    bool reload();
+    bool getIsReloading() const;
+
     void bind();
 	void release();
 
+    // Must be called before start()
     void bindAttributeLocation(const char* name, int location);
     void setUniformValue(const char* name, bool value);
     void setUniformValue(const char* name, int value);
@@ -43,12 +100,58 @@ public:
     void setUniformValue(const char* name, const QSize& size);
     void setUniformValue(const char* name, const QSizeF& size);
     void setUniformValue(const char* name, const QTransform& value);
+    void setUniformValueArray(const char* name, const QVector4D* values, int count);
+    void setUniformValueArray(const char* name, const QMatrix4x4* values, int count);
+
+protected:
+    typedef std::function<void(GLint location)> UniformSetter;
 
+    struct PendingUniform
+    {
+        QByteArray name;
+        UniformSetter setter;
+    };
 
+    static bool readSource(const QString& path, QString& code);
+    QByteArray injectDefines(const QString& code) const;
+
+    void createProgram();
+    QByteArray makeCacheKey();
+    bool loadBinary();
+    void storeBinary();
+    void compileStage(GLenum type, const QString& code);
+    void finishLink();
+    void logStageErrors();
+    void finishReload();
+    // Sets every active uniform of the current program to its value in the source program
+    void copyUniforms(GLuint sourceId);
+
+    // Uploads straight to the cached location once linked; only boxed for replay while compiling
+    template <typename Upload>
+    void setUniform(const char* name, const Upload& upload);
+    void deferUniform(const char* name, const UniformSetter& setter);
+    void applyUniform(const char* name, const UniformSetter& setter);
+    GLint getUniformLocation(const char* name);
 
 protected:
-	QOpenGLShaderProgram* mProgram;
-    
+	GLExtensions mExtensions;
+	GLuint mProgramId;
+	Status mStatus;
+	bool mIsAsync;
+	bool mIsFromCache;
+	bool mIsFallbackBound;
+	ShaderProgram* mFallback;
+	QByteArray mCacheKey;
+	QStringList mDefines;
+
+	std::vector<GLuint> mStages;
+	std::vector<std::pair<QByteArray, int>> mAttributeLocations;
+	std::vector<PendingUniform> mPendingUniforms;
+	QHash<QByteArray, GLint> mUniformLocations; // Resolved once per linked program
+	std::vector<GLfloat> mMatrixScratch;
+	QString mLog;
+	std::unique_ptr<ShaderProgram> mReload;
+	bool mIsReloadCopy;
 };
 
-#endif // SHADER_PROGRAM_H
\ No newline at end of file
+#endif // SHADER_PROGRAM_H
@@ -0,0 +1,52 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Engine/Renders/ShaderProgram.h"
+
+// Specialised programs built from one vertex/fragment source pair. Keyword i becomes
+// "#define <keyword>" when bit i of the variant key is set, so features are compiled in or out
+// rather than branched on per fragment. Variants are compiled on first request and kept in a
+// table by key; warmUp() builds the ones known up front so they can link in the background.
+class ShaderVariants
+{
+public:
+	typedef unsigned int Key;
+
+	ShaderVariants(const QString& vertexPath, const QString& fragmentPath, const QStringList& keywords);
+	~ShaderVariants();
+
+	// Applied to every variant created afterwards
+	void setIsAsync(bool isAsync);
+	void setFallback(ShaderProgram* fallback);
+	void bindAttributeLocation(const char* name, int location);
+
+	Key getKeywordBit(const QString& keyword) const;
+	Key makeKey(const QStringList& keywords) const;
+	QStringList getKeywords(Key key) const;
+
+	// Requires a current context; unknown bits are ignored
+	ShaderProgram* getVariant(Key key);
+	void warmUp(Key key);
+	void clear();
+
+	int getVariantCount() const;
+
+private:
+	QString mVertexPath;
+	QString mFragmentPath;
+	QStringList mKeywords;
+	bool mIsAsync;
+	ShaderProgram* mFallback;
+	std::vector<std::pair<QByteArray, int>> mAttributeLocations;
+
+	std::unordered_map<Key, std::unique_ptr<ShaderProgram>> mVariants;
+};
+
+#endif // SHADER_VARIANTS_H
@@ -0,0 +1,57 @@
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include <QFileSystemWatcher>
+#include <QString>
+
+#include <functional>
+#include <vector>
+
+class ShaderProgram;
+
+// Hot reload of shader sources. With a source directory set, ShaderPrograms read
+// ":/Resources/Shaders/<file>" from "<directory>/<file>" instead and are rebuilt whenever the file
+// changes on disk. File events only mark programs dirty; update() does the GL work from the render
+// thread, and each rebuilt program keeps drawing with its old binary until the new one links.
+class ShaderWatcher
+{
+public:
+	typedef std::function<void(const QString& name, bool isSuccess, const QString& log)> ReloadCallback;
+
+	static ShaderWatcher& instance();
+
+	// Must be set before the scene loads its shaders; empty disables hot reload
+	void setSourceDirectory(const QString& directory);
+	QString getSourceDirectory() const;
+	bool getIsEnabled() const;
+
+	QString resolvePath(const QString& path) const;
+
+	void watch(ShaderProgram* program);
+	void unwatch(ShaderProgram* program);
+
+	// Called with the program's context current, once per frame
+	void update();
+
+	void setReloadCallback(const ReloadCallback& callback);
+
+private:
+	ShaderWatcher();
+	~ShaderWatcher();
+
+	void onFileChanged(const QString& path);
+	static bool isProgramPath(const ShaderProgram* program, const QString& path);
+
+private:
+	static constexpr const char* RESOURCE_SHADER_PREFIX = ":/Resources/Shaders/";
+
+	QString mSourceDirectory;
+	QFileSystemWatcher* mWatcher;
+	ReloadCallback mReloadCallback;
+
+	std::vector<ShaderProgram*> mPrograms;
+	std::vector<ShaderProgram*> mDirtyPrograms;
+	std::vector<ShaderProgram*> mReloadingPrograms;
+};
+
+#endif // SHADER_WATCHER_H
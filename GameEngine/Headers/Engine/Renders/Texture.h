@@ -2,15 +2,20 @@
 #define TEXTURE_H
 
 #include <string>
-#include <QOpenGLExtraFunctions>
+#include <QJsonObject>
+#include <QString>
 
-struct Texture : protected QOpenGLExtraFunctions {
-    Texture() {
-        initializeOpenGLFunctions();
-    }
+// Texture reference of a mesh. The pixels live in the scene's TextureManager, which assigns the
+// id when the mesh starts and streams the image in the background.
+struct Texture {
+    static const int INVALID_ID = -1;
 
-    unsigned int ID;
+    QString path;
     std::string type;
+    int id = INVALID_ID;
+
+    void write(QJsonObject& json) const;
+    void read(const QJsonObject& json);
 };
 
-#endif // TEXTURE_H
\ No newline at end of file
+#endif // TEXTURE_H
@@ -0,0 +1,35 @@
+#ifndef TEXTURE_COMPRESSOR_H
+#define TEXTURE_COMPRESSOR_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+#include <vector>
+
+// CPU transcoding of decoded mip chains into BC1 (DXT1) blocks, plus the on-disk cache that makes
+// it a one-time cost per source file. Runs on texture decode workers; nothing here touches GL.
+class TextureCompressor
+{
+public:
+	static const int BC1_BLOCK_BYTES = 8;
+
+	static bool isOpaque(const QImage& image);
+	static int getBC1LevelSize(int width, int height);
+
+	// Expects QImage::Format_RGBA8888
+	static QByteArray compressBC1(const QImage& image);
+
+	// Keyed by the source file's contents, so an edited image misses instead of going stale
+	static QByteArray makeCacheKey(const QByteArray& source);
+	static bool readCache(const QByteArray& key, int& size, std::vector<QByteArray>& levels);
+	static void writeCache(const QByteArray& key, int size, const std::vector<QByteArray>& levels);
+
+private:
+	static void compressBlock(const uchar* pixels[16], uchar* block);
+	static QString getCachePath(const QByteArray& key);
+
+	static const quint32 FILE_MAGIC = 0x31434247; // "GBC1"
+	static const quint32 FILE_VERSION = 1;
+};
+
+#endif // TEXTURE_COMPRESSOR_H
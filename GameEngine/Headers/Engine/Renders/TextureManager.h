@@ -0,0 +1,121 @@
+#ifndef TEXTURE_MANAGER_H
+#define TEXTURE_MANAGER_H
+
+#include <memory>
+#include <vector>
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QOpenGLExtraFunctions>
+#include <QString>
+
+#include "Engine/Renders/GLExtensions.h"
+
+// Where a texture's pixels live on the GPU: one layer of a GL_TEXTURE_2D_ARRAY
+struct TextureLocation
+{
+	GLuint array = 0;
+	int layer = 0;
+};
+
+// Loads the scene's textures and packs them into shared texture arrays.
+//  - request() returns at once; decoding, mip generation and optional BC1 transcoding run on the
+//    global thread pool, and update() uploads finished images from the render thread.
+//  - Images are resampled to square power-of-two layers, and every texture of the same size and
+//    format shares one array, so draws that switch textures only switch a layer uniform.
+//  - Until its upload, a texture resolves to the white default texture.
+class TextureManager : protected QOpenGLExtraFunctions
+{
+public:
+	static const int MAX_TEXTURE_SIZE = 2048;
+	static const int ARRAY_BYTE_BUDGET = 16 << 20; // Base level bytes per array
+	static const int MAX_UPLOADS_PER_FRAME = 4;
+	static constexpr int DEFAULT_TEXTURE_ID = 0;
+
+	TextureManager();
+	~TextureManager();
+
+	void init();
+	void tryStart();
+	void clear();
+
+	// Transcode opaque images to BC1 where supported; the result is cached on disk
+	void setIsCompressionEnabled(bool isEnabled);
+	bool getIsCompressionEnabled() const;
+
+	int request(const QString& path);
+	TextureLocation getLocation(int id) const;
+
+	// Binds the texture's array to the unit through the state cache; returns the layer
+	int bind(int id, int unit);
+
+	// Uploads decoded textures; called once per frame with the context current
+	void update();
+
+	int getTextureCount() const;
+	int getPendingCount() const;
+	int getArrayCount() const;
+
+protected:
+	void start();
+
+	enum class TextureState
+	{
+		Loading,
+		Ready,
+		Failed,
+	};
+
+	struct TextureEntry
+	{
+		QString path;
+		TextureState state = TextureState::Loading;
+		TextureLocation location;
+	};
+
+	struct TextureArray
+	{
+		GLuint texture = 0;
+		int size = 0;
+		GLenum internalFormat = 0;
+		int levelCount = 0;
+		int layerCount = 0;
+		int layerCapacity = 0;
+	};
+
+	struct DecodedTexture
+	{
+		int id = 0;
+		bool isValid = false;
+		bool isCompressed = false;
+		int size = 0;
+		std::vector<QByteArray> levels; // Largest first
+	};
+
+	// Shared with the decode jobs, which may finish after the manager is cleared
+	struct DecodeQueue
+	{
+		QMutex mutex;
+		std::vector<DecodedTexture> finished;
+	};
+
+	static DecodedTexture decode(int id, const QString& path, bool isCompressionEnabled);
+	static int getLevelCount(int size);
+
+	void upload(const DecodedTexture& decoded);
+	TextureArray& getArray(int size, GLenum internalFormat, int levelCount);
+
+protected:
+	bool mIsStarted;
+	bool mIsCompressionEnabled;
+	GLExtensions mExtensions;
+	GLint mMaxArrayLayers;
+
+	std::vector<TextureEntry> mTextures;
+	QHash<QString, int> mTextureIds;
+	std::vector<TextureArray> mArrays;
+	std::shared_ptr<DecodeQueue> mDecodeQueue;
+	int mPendingCount;
+};
+
+#endif // TEXTURE_MANAGER_H
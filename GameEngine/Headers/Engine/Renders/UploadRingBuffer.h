@@ -0,0 +1,86 @@
+#ifndef UPLOAD_RING_BUFFER_H
+#define UPLOAD_RING_BUFFER_H
+
+#include <vector>
+#include <QOpenGLExtraFunctions>
+
+#include "Engine/Renders/GLExtensions.h"
+
+// Range handed out by UploadRingBuffer; data points at mapped memory until it is committed
+struct UploadAllocation
+{
+	GLuint buffer = 0;
+	GLintptr offset = 0;
+	GLsizeiptr size = 0;
+	void* data = nullptr;
+
+	bool isValid() const
+	{
+		return data != nullptr;
+	}
+};
+
+// Streaming buffer for data rewritten every frame (matrices, draw commands, instance data,
+// dynamic vertices). The buffer is split into FRAME_COUNT regions used round-robin; each region
+// is fenced at endFrame() and only waited on when the ring comes back to it, so writes never
+// race the GPU and never go through a driver-side copy.
+// With GL 4.4 / ARB_buffer_storage the whole buffer stays persistently mapped. Otherwise every
+// allocation maps its range with GL_MAP_UNSYNCHRONIZED_BIT, which is safe for the same reason,
+// and must be committed before the next allocation.
+class UploadRingBuffer : protected QOpenGLExtraFunctions
+{
+public:
+	static const int FRAME_COUNT = 3;
+	static const GLsizeiptr DEFAULT_FRAME_SIZE = 4 << 20;
+
+	UploadRingBuffer(GLsizeiptr frameSize = DEFAULT_FRAME_SIZE);
+	~UploadRingBuffer();
+
+	void init();
+	void tryStart();
+	void clear();
+
+	void beginFrame();
+	void endFrame();
+
+	// Grows the ring when the frame region is full; earlier allocations of the frame stay valid
+	UploadAllocation allocate(GLsizeiptr size, GLsizeiptr alignment = 4);
+	void commit(const UploadAllocation& allocation);
+	UploadAllocation upload(const void* data, GLsizeiptr size, GLsizeiptr alignment = 4);
+
+	bool getIsStarted() const;
+	bool getIsPersistent() const;
+	GLsizeiptr getFrameSize() const;
+	GLsizeiptr getStorageAlignment() const;
+
+	long long getFrameUploadBytes() const;
+	double getFrameWaitMs() const;
+
+protected:
+	void start();
+	void createBuffer();
+	void retireBuffer();
+	void deleteRetiredBuffers();
+	void waitForFence(GLsync fence);
+
+protected:
+	bool mIsStarted;
+	bool mIsPersistent;
+
+	GLExtensions mExtensions;
+
+	GLuint mBuffer;
+	char* mMappedData; // Whole buffer when persistent, nullptr otherwise
+	GLsizeiptr mFrameSize;
+	GLsizeiptr mStorageAlignment;
+
+	int mFrameIndex;
+	GLsizeiptr mCursor;
+	GLsync mFences[FRAME_COUNT];
+	std::vector<GLuint> mRetiredBuffers;
+
+	long long mFrameUploadBytes;
+	double mFrameWaitMs;
+};
+
+#endif // UPLOAD_RING_BUFFER_H
@@ -0,0 +1,78 @@
+#ifndef ENGINE_LOOP_H
+#define ENGINE_LOOP_H
+
+#include <QElapsedTimer>
+
+#include "Engine/Interfaces/IScene.h"
+#include "Qt/Inputs/InputPublisher.h"
+
+// Wall-clock cost of each phase of one frame, in milliseconds
+struct FrameTimings
+{
+	double inputMs = 0.0;
+	double updateMs = 0.0;
+	double renderMs = 0.0;
+	double frameMs = 0.0;
+	int steps = 0;             // Simulation steps run this frame
+	float alpha = 0.0f;        // Interpolation factor the frame was rendered with
+	bool isCatchUpCapped = false; // Simulation time was dropped to avoid a spiral of death
+};
+
+// Runs the simulation at a fixed rate independent of the display. Elapsed frame time feeds an
+// accumulator that is drained in fixedDeltaTime steps (at most maxStepsPerFrame per frame);
+// the remainder becomes the alpha the scene renders with, blending each Transform between its
+// last two simulation states.
+class EngineLoop
+{
+public:
+	static constexpr float DEFAULT_FIXED_DELTA_TIME = 1.0f / 60.0f;
+	static const int DEFAULT_MAX_STEPS_PER_FRAME = 5;
+
+	EngineLoop(float fixedDeltaTime = DEFAULT_FIXED_DELTA_TIME, int maxStepsPerFrame = DEFAULT_MAX_STEPS_PER_FRAME);
+
+	void setScene(IScene* scene);
+	void setInputPublisher(InputPublisher* inputPublisher);
+
+	void setFixedDeltaTime(float fixedDeltaTime);
+	float getFixedDeltaTime() const;
+	void setMaxStepsPerFrame(int maxStepsPerFrame);
+	int getMaxStepsPerFrame() const;
+
+	// Restarts the clock and drops accumulated time, e.g. after the context was recreated
+	void reset();
+
+	// Advances by the wall-clock time since the previous tick
+	void tick();
+	// Advances by an explicit amount of time, for deterministic runs
+	void tick(double frameDeltaTime);
+	// Runs the pending simulation steps without rendering, for a loop driven off the render thread;
+	// returns the number of steps taken
+	int simulate(double frameDeltaTime);
+
+	const FrameTimings& getLastTimings() const;
+	const FrameTimings& getAverageTimings() const; // Exponential moving average
+	double getSimulationTime() const;
+	long long getStepCount() const;
+	double getTimeUntilNextStep() const;
+
+private:
+	void step();
+
+private:
+	IScene* mScene;
+	InputPublisher* mInputPublisher;
+
+	float mFixedDeltaTime;
+	int mMaxStepsPerFrame;
+
+	QElapsedTimer mClock;
+	qint64 mLastTickNs;
+	double mAccumulator;
+	double mSimulationTime;
+	long long mStepCount;
+
+	FrameTimings mLastTimings;
+	FrameTimings mAverageTimings;
+};
+
+#endif // ENGINE_LOOP_H
@@ -21,6 +21,8 @@ public:
     void tryStart(IScene* scene);
     void tryUpdate(float deltaTime);
     void tryRender(ShaderProgram& shaderProgram);
+    void tryStorePreviousState();
+    void trySnapshot(RenderSnapshot& snapshot);
 	virtual void clear();
 
     virtual void kill();
@@ -34,8 +36,12 @@ public:
     void setScene(IScene* scene);
     IScene* getScene() const;
 
-    virtual void setParent(Node* parent);
+    // Moves the node from its parent or its scene to the new parent; detached, it becomes a
+    // top-level node of its scene. A node nobody owns yet is given to a parent with addChild()
+    void setParent(Node* parent);
     Node* getParent() const;
+    // Takes ownership of a node nobody holds yet, as IScene::addNode does
+    void addChild(Node* child);
 
     int getChildCount() const;
     Node* getChild(int index) const;
@@ -50,9 +56,14 @@ protected:
     virtual void start(IScene* scene);
     virtual void update(float deltaTime);
     virtual void render(ShaderProgram& shaderProgram);
+    virtual void storePreviousState();
+    virtual void snapshot(RenderSnapshot& snapshot);
+    // Called after mParent changed
+    virtual void onParentChanged();
 
     void addChild(std::unique_ptr<Node> child);
-    void removeChild(Node* child);
+    // Hands the child's ownership back to the caller; null if it is not a child
+    std::unique_ptr<Node> takeChild(Node* child);
 
 protected:
     bool mIsAlive;
@@ -4,7 +4,23 @@
 #include "Engine/Interfaces/IScene.h"
 #include "Engine/Interfaces/ISerializable.h"
 
+#include "Engine/Renders/CascadedShadowMaps.h"
+#include "Engine/Renders/ClusteredLighting.h"
+#include "Engine/Renders/IdBufferPicker.h"
 #include "Engine/Renders/Mesh.h"
+#include "Engine/Renders/GeometryBuffer.h"
+#include "Engine/Renders/IndirectRenderer.h"
+#include "Engine/Renders/MaterialLibrary.h"
+#include "Engine/Renders/OverdrawCounter.h"
+#include "Engine/Renders/RenderQueue.h"
+#include "Engine/Renders/RenderStats.h"
+#include "Engine/Renders/RenderTarget.h"
+#include "Engine/Renders/ShaderVariants.h"
+#include "Engine/Renders/TextureManager.h"
+#include "Engine/Renders/UploadRingBuffer.h"
+#include "Engine/Physics/CollisionWorld.h"
+#include "Engine/Physics/PhysicsWorld.h"
+#include "Engine/Spatial/SpatialIndex.h"
 #include "Qt/Inputs/InputPublisher.h"
 
 
@@ -17,6 +33,8 @@
 
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QElapsedTimer>
+#include <QMutex>
 
 class Scene : public IScene, public ISerializable
 {
@@ -32,6 +50,14 @@ public:
 	virtual void update(float deltaTime);
 	virtual void render();
 	virtual void clear(); // Clear all context of current OpenGL context
+
+	virtual void storePreviousState();
+	virtual void setInterpolationAlpha(float alpha);
+	virtual float getInterpolationAlpha() const;
+
+	virtual void buildSnapshot(RenderSnapshot& snapshot);
+	virtual void renderSnapshot(const RenderSnapshot& snapshot, float alpha);
+	virtual QMutex& getSimulationMutex();
 	
 	virtual IScene* clone() const;
 
@@ -47,6 +73,7 @@ public:
 
 	void addNode(Node* node);
 	void removeNode(Node* node);
+	std::unique_ptr<Node> takeNode(Node* node);
 	virtual std::vector<Node*> getNodes() const;
 
 	void setInputPublisher(InputPublisher* inputPublisher);
@@ -55,10 +82,58 @@ public:
 	void setCamera(Camera* camera);
 	Camera* getCamera() const;
 
+	ShaderVariants* getDefaultShaders() const;
+	TextureManager* getTextureManager() const;
+	IndirectRenderer* getIndirectRenderer() const;
+	MaterialLibrary* getMaterialLibrary() const;
+	RenderQueue* getRenderQueue() const;
+	UploadRingBuffer* getUploadBuffer() const;
+	RenderStats& getRenderStats();
+	void setRenderTarget(const RenderTarget& target);
+	const RenderTarget& getRenderTarget() const;
+
+	void setIsDepthPrePass(bool isDepthPrePass);
+	bool getIsDepthPrePass() const;
+	OverdrawCounter* getOverdrawCounter() const;
+	ClusteredLighting* getLighting() const;
+	CascadedShadowMaps* getShadows() const;
+	SpatialIndex* getSpatialIndex() const;
+	IdBufferPicker* getIdPicker() const;
+	CollisionWorld* getCollisionWorld() const;
+	PhysicsWorld* getPhysicsWorld() const;
+
+protected:
+	void beginRenderFrame(QElapsedTimer& submitTimer);
+	void endRenderFrame(const QMatrix4x4& view, const QMatrix4x4& projection, const QElapsedTimer& submitTimer);
+	// Light binning and shadow maps, the depth pre-pass if enabled, the indirect and queued colour
+	// passes, then a queued ID buffer pick
+	void drawPasses(const QMatrix4x4& view, const QMatrix4x4& projection, float nearPlane, float farPlane);
+
 protected:
 	QString mName;
 
-	std::shared_ptr<ShaderProgram> mDefaultShader;
+	std::shared_ptr<ShaderVariants> mDefaultShaders;
+	ShaderProgram* mDefaultShader; // Variant used for scene geometry, owned by mDefaultShaders
+	std::shared_ptr<ShaderProgram> mFallbackShader; // Bound while mDefaultShader is still compiling
+	std::shared_ptr<ShaderProgram> mDepthShader; // Position-only, for the depth pre-pass
+	std::shared_ptr<GeometryBuffer> mGeometryBuffer; // Shared storage of every static mesh
+	std::shared_ptr<IndirectRenderer> mIndirectRenderer;
+	std::shared_ptr<MaterialLibrary> mMaterialLibrary;
+	std::shared_ptr<RenderQueue> mRenderQueue; // Dynamic meshes, sorted by material
+	std::shared_ptr<UploadRingBuffer> mUploadBuffer; // Per-frame dynamic data
+	std::shared_ptr<TextureManager> mTextureManager;
+	std::shared_ptr<OverdrawCounter> mOverdrawCounter;
+	std::shared_ptr<ClusteredLighting> mLighting;
+	std::shared_ptr<CascadedShadowMaps> mShadows;
+	std::shared_ptr<SpatialIndex> mSpatialIndex; // Meshes drawn last frame
+	std::shared_ptr<IdBufferPicker> mIdPicker;
+	std::shared_ptr<CollisionWorld> mCollisionWorld; // Outlives the nodes, whose colliders unregister from it
+	std::shared_ptr<PhysicsWorld> mPhysicsWorld;     // Same for rigid bodies
+	bool mIsDepthPrePass;
+	RenderStats mRenderStats;
+	RenderTarget mRenderTarget;
+	float mInterpolationAlpha;
+	QMutex mSimulationMutex; // Guards nodes and transforms while a game thread is stepping them
 
 	std::vector<std::unique_ptr<Node>> mChildrenNodes;
 	std::vector<std::shared_ptr<Mesh>> mMeshes;
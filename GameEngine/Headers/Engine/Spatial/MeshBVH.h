@@ -0,0 +1,94 @@
+#ifndef MESH_BVH_H
+#define MESH_BVH_H
+
+#include <vector>
+#include <QByteArray>
+#include <QOpenGLExtraFunctions>
+#include <QString>
+#include <QVector3D>
+
+#include "Engine/Renders/Vertex.h"
+#include "Engine/Spatial/Ray.h"
+
+// Closest triangle a ray hit, in the space the BVH was built in
+struct MeshRayHit
+{
+	float distance = 0.0f;
+	int triangle = -1; // In the order the mesh's indices produce them
+	float u = 0.0f;    // Barycentric weights of the second and third vertex
+	float v = 0.0f;
+};
+
+// Bounding volume hierarchy over a mesh's triangles, in mesh space. Triangle lists, strips and
+// fans are unrolled into separate triangles first; degenerate ones, such as the joins between
+// strip rows, are left out since they cover no area.
+// Splits are chosen by the surface area heuristic over BIN_COUNT centroid bins per axis. Nodes
+// are 32 bytes, two to a cache line, with siblings stored next to each other, and leaf triangles
+// are stored in traversal order as a vertex and two edges. Meshes of PARALLEL_TRIANGLES or more
+// build their lower subtrees on the global thread pool, and meshes of CACHE_TRIANGLES or more
+// are read from the on-disk cache when their positions and indices were seen before.
+class MeshBVH
+{
+public:
+	static const int MAX_LEAF_TRIANGLES = 8;
+	static const int BIN_COUNT = 12;
+	static const int PARALLEL_TRIANGLES = 65536;
+	static const int CACHE_TRIANGLES = 16384;
+	static const int PACKET_SIZE = 4;
+
+	struct Node
+	{
+		float boundsMin[3];
+		int first; // First triangle of a leaf, else the left child; the right one follows it
+		float boundsMax[3];
+		int count; // Triangles of a leaf, 0 for an inner node
+	};
+
+	struct Triangle
+	{
+		QVector3D vertex;
+		QVector3D edge1; // To the second vertex
+		QVector3D edge2; // To the third vertex
+	};
+
+	MeshBVH();
+
+	void build(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, GLenum drawMode);
+	// Same as build, going through the disk cache for large meshes
+	void buildCached(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, GLenum drawMode);
+
+	bool getIsEmpty() const;
+	int getTriangleCount() const;
+	int getNodeCount() const;
+	bool getIsFromCache() const;
+
+	bool raycast(const Ray& ray, float maxDistance, MeshRayHit& hit) const;
+	// Up to PACKET_SIZE rays traverse together, each node's box tested against all of them at
+	// once; coherent rays, such as neighbouring pixels, share most of their path. Returns a bit
+	// per ray that hit.
+	int raycastPacket(const Ray* rays, int count, float maxDistance, MeshRayHit* hits) const;
+	// Appends the triangles, in mesh order, whose bounds overlap the box
+	void queryBox(const QVector3D& boxMin, const QVector3D& boxMax, std::vector<int>& triangles) const;
+
+	// Unrolls the topology into index triples
+	static void getTriangles(const std::vector<unsigned int>& indices, GLenum drawMode, std::vector<unsigned int>& triangles);
+
+	// Keyed by positions, indices and topology, so an edited mesh misses instead of going stale
+	static QByteArray makeCacheKey(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, GLenum drawMode);
+	bool readCache(const QByteArray& key);
+	void writeCache(const QByteArray& key) const;
+
+protected:
+	static QString getCachePath(const QByteArray& key);
+
+	static const quint32 FILE_MAGIC = 0x48564247; // "GBVH"
+	static const quint32 FILE_VERSION = 1;
+
+protected:
+	std::vector<Node> mNodes;
+	std::vector<Triangle> mTriangles; // In leaf order
+	std::vector<int> mTriangleIds;    // Leaf order to mesh order
+	bool mIsFromCache;
+};
+
+#endif // MESH_BVH_H
@@ -0,0 +1,125 @@
+#ifndef RAY_H
+#define RAY_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <QMatrix4x4>
+#include <QPointF>
+#include <QSizeF>
+#include <QVector3D>
+
+// Half-line from origin along a unit direction; distances along it are in world units
+struct Ray
+{
+	QVector3D origin;
+	QVector3D direction = QVector3D(0.0f, 0.0f, -1.0f);
+
+	QVector3D at(float distance) const
+	{
+		return origin + direction * distance;
+	}
+
+	Ray transformed(const QMatrix4x4& matrix) const
+	{
+		// Renormalized, so distances are in the target space's units
+		Ray ray;
+		ray.origin = matrix.map(origin);
+		ray.direction = matrix.mapVector(direction).normalized();
+		return ray;
+	}
+
+	// Through the center of a pixel, with y growing downwards as in widget coordinates. Built from
+	// the projection's scale terms, so it works with infinite and reversed-Z perspectives too.
+	static Ray fromViewport(const QMatrix4x4& view, const QMatrix4x4& projection, const QPointF& pixel, const QSizeF& viewportSize)
+	{
+		float ndcX = static_cast<float>(2.0 * pixel.x() / viewportSize.width() - 1.0);
+		float ndcY = static_cast<float>(1.0 - 2.0 * pixel.y() / viewportSize.height());
+		QMatrix4x4 inverseView = view.inverted();
+
+		Ray ray;
+		if (projection(3, 3) == 0.0f)
+		{
+			QVector3D direction((ndcX + projection(0, 2)) / projection(0, 0), (ndcY + projection(1, 2)) / projection(1, 1), -1.0f);
+			ray.origin = inverseView.map(QVector3D());
+			ray.direction = inverseView.mapVector(direction).normalized();
+		}
+		else
+		{
+			QVector3D origin((ndcX - projection(0, 3)) / projection(0, 0), (ndcY - projection(1, 3)) / projection(1, 1), 0.0f);
+			ray.origin = inverseView.map(origin);
+			ray.direction = inverseView.mapVector(QVector3D(0.0f, 0.0f, -1.0f)).normalized();
+		}
+		return ray;
+	}
+
+	// Distance where the ray enters the sphere, 0 when it starts inside
+	bool intersectsSphere(const QVector3D& center, float radius, float& distance) const
+	{
+		QVector3D offset = origin - center;
+		float b = QVector3D::dotProduct(offset, direction);
+		float c = QVector3D::dotProduct(offset, offset) - radius * radius;
+		if (c > 0.0f && b > 0.0f)
+			return false;
+
+		float discriminant = b * b - c;
+		if (discriminant < 0.0f)
+			return false;
+
+		distance = std::max(-b - std::sqrt(discriminant), 0.0f);
+		return true;
+	}
+
+	// Slab test; inverseDirection is 1 / direction per component
+	static bool intersectsBox(const QVector3D& origin, const QVector3D& inverseDirection, const QVector3D& boxMin, const QVector3D& boxMax, float maxDistance, float& distance)
+	{
+		float tMin = 0.0f;
+		float tMax = maxDistance;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			float t0 = (boxMin[axis] - origin[axis]) * inverseDirection[axis];
+			float t1 = (boxMax[axis] - origin[axis]) * inverseDirection[axis];
+			tMin = std::max(tMin, std::min(t0, t1));
+			tMax = std::min(tMax, std::max(t0, t1));
+		}
+		distance = tMin;
+		return tMin <= tMax;
+	}
+
+	// Möller-Trumbore, double-sided; u and v weight the second and third vertex
+	bool intersectsTriangle(const QVector3D& v0, const QVector3D& v1, const QVector3D& v2, float& distance, float& u, float& v) const
+	{
+		const float epsilon = 1e-8f;
+		QVector3D edge1 = v1 - v0;
+		QVector3D edge2 = v2 - v0;
+		QVector3D p = QVector3D::crossProduct(direction, edge2);
+		float determinant = QVector3D::dotProduct(edge1, p);
+		if (std::abs(determinant) < epsilon)
+			return false;
+
+		float inverseDeterminant = 1.0f / determinant;
+		QVector3D s = origin - v0;
+		u = QVector3D::dotProduct(s, p) * inverseDeterminant;
+		if (u < 0.0f || u > 1.0f)
+			return false;
+
+		QVector3D q = QVector3D::crossProduct(s, edge1);
+		v = QVector3D::dotProduct(direction, q) * inverseDeterminant;
+		if (v < 0.0f || u + v > 1.0f)
+			return false;
+
+		distance = QVector3D::dotProduct(edge2, q) * inverseDeterminant;
+		return distance >= 0.0f;
+	}
+
+	QVector3D getInverseDirection() const
+	{
+		// Zero components become huge rather than infinite, so the slab test never sees 0 * inf
+		auto inverse = [](float value) {
+			return std::abs(value) > 1e-20f ? 1.0f / value : std::copysign(std::numeric_limits<float>::max(), value);
+		};
+		return QVector3D(inverse(direction.x()), inverse(direction.y()), inverse(direction.z()));
+	}
+};
+
+#endif // RAY_H
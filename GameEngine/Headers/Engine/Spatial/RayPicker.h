@@ -0,0 +1,38 @@
+#ifndef RAY_PICKER_H
+#define RAY_PICKER_H
+
+#include <vector>
+#include <QPointF>
+#include <QSizeF>
+#include <QVector3D>
+
+#include "Engine/Spatial/Ray.h"
+#include "Engine/Spatial/SpatialIndex.h"
+
+class Node;
+
+struct PickResult
+{
+	Node* node = nullptr;
+	float distance = 0.0f; // Along the ray, in world units
+	QVector3D position;    // World-space hit point
+	int triangle = -1;     // Of the node's mesh, see MeshRayHit
+};
+
+// Picks on the CPU: the ray is swept over the spatial index's spheres, and the candidates are
+// tested nearest first against their mesh's triangle BVH in mesh space, stopping once the next
+// sphere starts beyond the closest hit. Needs no GL, so it answers on the spot.
+class RayPicker
+{
+public:
+	RayPicker();
+
+	bool pick(const SpatialIndex& index, const Ray& ray, PickResult& result);
+	// Through a widget pixel, with the camera the index was last drawn for
+	bool pick(const SpatialIndex& index, const QPointF& pixel, const QSizeF& viewportSize, PickResult& result);
+
+protected:
+	std::vector<SpatialIndex::Candidate> mCandidates;
+};
+
+#endif // RAY_PICKER_H
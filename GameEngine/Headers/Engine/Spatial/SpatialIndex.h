@@ -0,0 +1,56 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <vector>
+#include <QMatrix4x4>
+#include <QVector3D>
+
+#include "Engine/Spatial/Ray.h"
+
+class Mesh;
+class Node;
+
+// World-space bounding spheres of the meshes drawn last frame, with the camera they were drawn
+// for, so queries see exactly what is on screen. Refilled during every render traversal; the
+// spheres are kept as separate coordinate arrays so a sweep over them stays in cache.
+// Pointers are only valid until the next frame rebuilds the index.
+class SpatialIndex
+{
+public:
+	struct Candidate
+	{
+		int index;
+		float distance; // Where the ray enters the sphere
+	};
+
+	SpatialIndex();
+
+	void begin();
+	void insert(Node* node, Mesh* mesh, const QMatrix4x4& world);
+
+	void setCamera(const QMatrix4x4& view, const QMatrix4x4& projection);
+	const QMatrix4x4& getViewMatrix() const;
+	const QMatrix4x4& getProjectionMatrix() const;
+
+	int getCount() const;
+	Node* getNode(int index) const;
+	Mesh* getMesh(int index) const;
+	const QMatrix4x4& getWorldMatrix(int index) const;
+
+	// Entries whose sphere the ray enters before maxDistance, nearest first
+	void raycast(const Ray& ray, float maxDistance, std::vector<Candidate>& candidates) const;
+
+protected:
+	std::vector<float> mCentersX;
+	std::vector<float> mCentersY;
+	std::vector<float> mCentersZ;
+	std::vector<float> mRadii;
+	std::vector<Node*> mNodes;
+	std::vector<Mesh*> mMeshes;
+	std::vector<QMatrix4x4> mWorlds;
+
+	QMatrix4x4 mView;
+	QMatrix4x4 mProjection;
+};
+
+#endif // SPATIAL_INDEX_H
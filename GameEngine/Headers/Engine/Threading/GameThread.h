@@ -0,0 +1,47 @@
+#ifndef GAME_THREAD_H
+#define GAME_THREAD_H
+
+#include <QMutex>
+#include <QThread>
+
+#include "Engine/Interfaces/IScene.h"
+#include "Engine/Renders/RenderSnapshot.h"
+#include "Engine/Scenes/EngineLoop.h"
+#include "Engine/Threading/TripleBuffer.h"
+
+// Runs the fixed-timestep simulation of a scene off the GUI thread. After every batch of steps
+// the scene is captured into a RenderSnapshot under the scene's simulation mutex and published
+// through a triple buffer, so the thread owning the GL context renders the newest snapshot
+// without waiting for the simulation and the simulation never waits for a frame.
+class GameThread : public QThread
+{
+public:
+	GameThread(IScene* scene, InputPublisher* inputPublisher, float fixedDeltaTime = EngineLoop::DEFAULT_FIXED_DELTA_TIME);
+	~GameThread();
+
+	// Blocks until the loop has exited
+	void stop();
+
+	// Render side: picks up the newest published snapshot, if any
+	bool acquireSnapshot();
+	const RenderSnapshot& getSnapshot() const;
+
+	FrameTimings getAverageTimings() const;
+	float getFixedDeltaTime() const;
+
+protected:
+	void run() override;
+
+private:
+	void publishSnapshot();
+
+private:
+	IScene* mScene;
+	EngineLoop mLoop;
+	TripleBuffer<RenderSnapshot> mSnapshots;
+
+	mutable QMutex mTimingsMutex;
+	FrameTimings mAverageTimings;
+};
+
+#endif // GAME_THREAD_H
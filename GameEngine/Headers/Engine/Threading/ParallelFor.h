@@ -0,0 +1,21 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <functional>
+
+// Splits [0, count) into chunks of grainSize and runs them on the global QThreadPool, the calling
+// thread taking chunks as well, returning once all of them ran. Only idle pool threads are
+// asked to help, so a pool busy with texture decodes cannot stall the caller. Which thread runs
+// a chunk varies, but chunk boundaries only depend on count and grainSize, so results written
+// per chunk and merged in chunk order come out the same every run.
+class ParallelFor
+{
+public:
+	using Body = std::function<void(int chunk, int begin, int end)>;
+
+	static int getChunkCount(int count, int grainSize);
+	// With isParallel false, or a single chunk, everything runs on the caller in chunk order
+	static void run(int count, int grainSize, const Body& body, bool isParallel = true);
+};
+
+#endif // PARALLEL_FOR_H
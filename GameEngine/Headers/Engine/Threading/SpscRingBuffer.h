@@ -0,0 +1,58 @@
+#ifndef SPSC_RING_BUFFER_H
+#define SPSC_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread. CAPACITY
+// must be a power of two; one slot stays empty to tell a full ring from an empty one. T should
+// be trivially copyable, values are copied in and out.
+template<typename T, size_t CAPACITY>
+class SpscRingBuffer
+{
+	static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+public:
+	SpscRingBuffer() : mHead(0), mTail(0)
+	{
+	}
+
+	// Producer side; returns false and drops the value when the ring is full
+	bool push(const T& value)
+	{
+		size_t head = mHead.load(std::memory_order_relaxed);
+		size_t next = (head + 1) & MASK;
+		if (next == mTail.load(std::memory_order_acquire))
+			return false;
+
+		mSlots[head] = value;
+		mHead.store(next, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side; returns false when the ring is empty
+	bool pop(T& value)
+	{
+		size_t tail = mTail.load(std::memory_order_relaxed);
+		if (tail == mHead.load(std::memory_order_acquire))
+			return false;
+
+		value = mSlots[tail];
+		mTail.store((tail + 1) & MASK, std::memory_order_release);
+		return true;
+	}
+
+	bool isEmpty() const
+	{
+		return mTail.load(std::memory_order_acquire) == mHead.load(std::memory_order_acquire);
+	}
+
+private:
+	static const size_t MASK = CAPACITY - 1;
+
+	T mSlots[CAPACITY];
+	alignas(64) std::atomic<size_t> mHead; // Written by the producer only
+	alignas(64) std::atomic<size_t> mTail; // Written by the consumer only
+};
+
+#endif // SPSC_RING_BUFFER_H
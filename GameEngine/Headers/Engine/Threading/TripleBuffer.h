@@ -0,0 +1,56 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// Lock-free single-producer / single-consumer triple buffer. The producer fills the write slot
+// and publishes it; the consumer always picks up the newest published slot. Neither side ever
+// waits for the other, and stale slots are simply overwritten. Slot contents are reused, so
+// containers inside T keep their capacity from frame to frame.
+template<typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() : mReadyState(1), mWriteIndex(0), mReadIndex(2)
+	{
+	}
+
+	// Producer side
+	T& getWriteBuffer()
+	{
+		return mBuffers[mWriteIndex];
+	}
+
+	void publish()
+	{
+		int previous = mReadyState.exchange(mWriteIndex | DIRTY_BIT, std::memory_order_acq_rel);
+		mWriteIndex = previous & INDEX_MASK;
+	}
+
+	// Consumer side; returns true when a newer buffer than the current read buffer was taken
+	bool acquire()
+	{
+		if ((mReadyState.load(std::memory_order_relaxed) & DIRTY_BIT) == 0)
+			return false;
+
+		int previous = mReadyState.exchange(mReadIndex, std::memory_order_acq_rel);
+		mReadIndex = previous & INDEX_MASK;
+		return true;
+	}
+
+	const T& getReadBuffer() const
+	{
+		return mBuffers[mReadIndex];
+	}
+
+private:
+	static const int INDEX_MASK = 0x3;
+	static const int DIRTY_BIT = 0x4;
+
+	T mBuffers[3];
+	std::atomic<int> mReadyState; // Index of the slot between the two sides, plus DIRTY_BIT when unread
+	int mWriteIndex;
+	int mReadIndex;
+};
+
+#endif // TRIPLE_BUFFER_H
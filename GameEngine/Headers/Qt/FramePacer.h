@@ -0,0 +1,84 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QOpenGLWidget>
+#include <QString>
+#include <QTimer>
+#include <vector>
+
+enum class FramePacingMode {
+    UNCAPPED,  // Swap interval 0, next frame as soon as the last one was swapped
+    VSYNC,     // Swap interval 1, the swap blocks until the vertical blank
+    ADAPTIVE,  // Swap interval -1, late frames tear instead of waiting a whole refresh (driver permitting)
+    FIXED_CAP  // Swap interval 0, frames started at a fixed rate
+};
+
+struct FramePacingStats {
+    double averageIntervalMs = 0.0;
+    double jitterMs = 0.0;       // Standard deviation of the swap-to-swap interval
+    double maxIntervalMs = 0.0;
+    bool isPaused = false;
+};
+
+// Schedules repaints of a QOpenGLWidget from its frameSwapped signal instead of a free-running
+// timer, so frames follow the display (or a fixed cap) rather than drifting against it.
+// Rendering stops while the widget is hidden or its window minimized and resumes on show.
+// The swap interval is part of the surface format, so the mode has to be chosen before the
+// widget is first shown; the target rate of FIXED_CAP can change at any time.
+class FramePacer : public QObject {
+    Q_OBJECT
+
+public:
+    static const int HISTORY_SIZE = 120;
+    static constexpr double DEFAULT_TARGET_FPS = 60.0;
+
+    FramePacer(QOpenGLWidget* widget);
+    ~FramePacer();
+
+    void setMode(FramePacingMode mode);
+    FramePacingMode getMode() const;
+    void setTargetFps(double targetFps);
+    double getTargetFps() const;
+
+    // Starts the first frame; later ones are scheduled as frames are swapped
+    void start();
+
+    bool getIsPaused() const;
+    FramePacingStats getStats() const;
+
+    // "uncapped", "vsync", "adaptive" or "cap:<fps>"
+    static bool parseMode(const QString& text, FramePacingMode& mode, double& targetFps);
+    static QString getModeName(FramePacingMode mode);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private slots:
+    void onFrameSwapped();
+    void requestFrame();
+
+private:
+    bool shouldRender() const;
+    void updatePaused();
+    void scheduleNextFrame();
+
+private:
+    QOpenGLWidget* mWidget;
+    FramePacingMode mMode;
+    double mTargetFps;
+
+    bool mIsStarted;
+    bool mIsPaused;
+    bool mIsFramePending;
+    QTimer mCapTimer;
+    QElapsedTimer mClock;
+    qint64 mNextDeadlineNs;
+    qint64 mLastSwapNs;
+
+    std::vector<double> mIntervalsMs; // Ring of the last HISTORY_SIZE swap intervals
+    int mIntervalCursor;
+};
+
+#endif // FRAMEPACER_H
@@ -0,0 +1,78 @@
+#ifndef HEADLESS_RUNNER_H
+#define HEADLESS_RUNNER_H
+
+#include <memory>
+#include <vector>
+#include <QString>
+#include <QStringList>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+
+#include "Engine/Interfaces/IScene.h"
+#include "Engine/Scenes/EngineLoop.h"
+
+struct HeadlessOptions
+{
+	int frameCount = 600;
+	float deltaTime = 1.0f / 60.0f;
+	int width = 1280;
+	int height = 720;
+	QString dumpDirectory;   // Frames are written as PNG here when set
+	int dumpInterval = 60;   // Every Nth frame, the last frame is always dumped
+	QString tracePath;       // Chrome trace of the run when set
+	bool isDepthPrePass = false;
+	bool isOverdrawMeasured = false;
+	bool isReversedZ = false;
+	int lightCount = 0;      // Random point lights added to the scene for the clustered lighting
+	bool isShadowed = true;
+	int pickObjectCount = 0; // Objects of the picking benchmark run after the frames, 0 skips it
+	bool isBroadphaseBenched = false;
+	int bodyCount = 0;       // Rigid bodies dropped onto a ground box, 0 adds none
+	bool isPhysicsMultithreaded = true;
+
+	// Reads --frames, --dt, --size WxH, --dump-dir, --dump-every, --trace, --depth-prepass,
+	// --overdraw, --reversed-z, --lights N, --no-shadows, --bench-picking N,
+	// --bench-broadphase, --bodies N and --physics-single-thread; returns false on bad input
+	bool parse(const QStringList& arguments);
+};
+
+// Runs a scene without a window: renders into a QOpenGLFramebufferObject on a QOffscreenSurface
+// for a fixed number of frames at a fixed timestep, as fast as the GL implementation allows,
+// and prints frame-time percentiles. Works with Mesa llvmpipe under QT_QPA_PLATFORM=offscreen.
+class HeadlessRunner : protected QOpenGLFunctions
+{
+public:
+	HeadlessRunner(const HeadlessOptions& options);
+	~HeadlessRunner();
+
+	// Returns the process exit code
+	int run(IScene* scene);
+
+private:
+	bool createContext();
+	// Small coloured point lights scattered with a fixed seed, so runs stay comparable
+	void addLights(IScene* scene) const;
+	// Boxes and balls stacked in layers over a static ground box, with the same fixed seed
+	void addBodies(IScene* scene) const;
+	// Over every rigid body's final pose, so two runs of the same arguments can be compared
+	quint64 getPoseChecksum(IScene* scene) const;
+	void dumpFrame(int frame);
+	// Casts rays through random pixels into copies of the last frame's meshes scattered in view,
+	// then times a fresh BVH build of the largest of them
+	void benchPicking(IScene* scene) const;
+	// Steps a CollisionWorld of moving bodies at a fixed density, 10k and then 100k of them,
+	// on one thread and on the pool, and prints the pairs found per second of broadphase
+	void benchBroadphase() const;
+	void printReport(const std::vector<double>& frameTimesMs, double totalMs, const FrameTimings& phaseTotals, const RenderStats& lastStats) const;
+
+private:
+	HeadlessOptions mOptions;
+
+	std::unique_ptr<QOpenGLContext> mContext;
+	std::unique_ptr<QOffscreenSurface> mSurface;
+	std::unique_ptr<QOpenGLFramebufferObject> mFramebuffer;
+};
+
+#endif // HEADLESS_RUNNER_H
@@ -14,6 +14,8 @@ public:
     ~HierarchyWidget();
 
     void populateHierarchyView(IScene* scene);
+    // Selects the node's item, which updates the inspector; clears the selection for null
+    void selectNode(Node* node);
 
 signals:
     void itemSelectionChanged(HierarchyItem* item);
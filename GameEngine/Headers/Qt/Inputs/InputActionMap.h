@@ -0,0 +1,83 @@
+#ifndef INPUTACTIONMAP_H
+#define INPUTACTIONMAP_H
+
+#include "Qt/Inputs/InputSnapshot.h"
+#include <QJsonObject>
+#include <QString>
+#include <vector>
+
+// Named actions and axes bound to keys, mouse buttons and mouse motion through a JSON config:
+//
+//   { "actions": { "Jump": ["Space"], "Fire": ["MouseLeft", "Ctrl"] },
+//     "axes": { "MoveRight": { "positive": ["D"], "negative": ["A"] },
+//               "LookX": { "source": "MouseX", "scale": 0.1 } } }
+//
+// Names are resolved to ids once with findAction()/findAxis(); update() evaluates every binding
+// once per step, after which queries by id are plain array reads.
+class InputActionMap {
+public:
+	static const int INVALID_ID = -1;
+
+	InputActionMap();
+
+	bool load(const QString& path);
+	bool read(const QJsonObject& json);
+	void clear();
+
+	int findAction(const QString& name) const;
+	int findAxis(const QString& name) const;
+
+	void update(const InputSnapshot& input);
+
+	bool isDown(int action) const;
+	bool wasPressed(int action) const;  // Went down this step, taps included
+	bool wasReleased(int action) const; // Went up this step, taps included
+	float getAxis(int axis) const;
+
+	int getActionCount() const;
+	int getAxisCount() const;
+
+private:
+	struct Binding
+	{
+		InputDevice device;
+		int slot;
+	};
+
+	struct Action
+	{
+		QString name;
+		std::vector<Binding> bindings;
+		bool isDown = false;
+		bool wasPressed = false;
+		bool wasReleased = false;
+	};
+
+	enum class AxisSource
+	{
+		Buttons,
+		MouseX,
+		MouseY,
+		Wheel,
+	};
+
+	struct Axis
+	{
+		QString name;
+		AxisSource source = AxisSource::Buttons;
+		std::vector<Binding> positive;
+		std::vector<Binding> negative;
+		float scale = 1.0f;
+		float value = 0.0f;
+	};
+
+	static bool parseBinding(const QString& text, Binding& binding);
+	static bool readBindings(const QJsonValue& value, const QString& owner, std::vector<Binding>& bindings);
+	static bool isAnyDown(const InputSnapshot& input, const std::vector<Binding>& bindings);
+
+private:
+	std::vector<Action> mActions;
+	std::vector<Axis> mAxes;
+};
+
+#endif // INPUTACTIONMAP_H
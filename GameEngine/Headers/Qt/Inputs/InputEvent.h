@@ -0,0 +1,27 @@
+#ifndef INPUTEVENT_H
+#define INPUTEVENT_H
+
+#include <QtGlobal>
+
+enum class InputEventType : quint8
+{
+	KeyPress,
+	KeyRelease,
+	MousePress,
+	MouseRelease,
+	MouseMove,
+	Wheel,
+	FocusOut,
+};
+
+// Compact copy of a Qt input event, queued from the GUI thread to the simulation
+struct InputEvent
+{
+	InputEventType type;
+	int code;          // Qt::Key for keys, Qt::MouseButton for buttons
+	float x;           // Cursor position, or wheel angle delta in degrees for Wheel
+	float y;
+	quint64 timestamp; // Milliseconds, as reported by QInputEvent::timestamp()
+};
+
+#endif // INPUTEVENT_H
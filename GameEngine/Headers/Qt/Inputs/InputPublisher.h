@@ -3,6 +3,11 @@
 
 #include "Qt/Inputs/InputState.h"
 #include "Qt/Inputs/InputSubscriber.h"
+#include "Qt/Inputs/InputEvent.h"
+#include "Qt/Inputs/InputSnapshot.h"
+#include "Qt/Inputs/InputActionMap.h"
+#include "Engine/Threading/SpscRingBuffer.h"
+#include <atomic>
 #include <QObject>
 #include <QKeyEvent>
 #include <QMouseEvent>
@@ -13,16 +18,29 @@ public:
 	InputSubscriber* subscriber;
 };
 
+// Key, button, motion and wheel events are copied into a lock-free queue by the Qt handlers
+// (GUI thread) and drained by update() once per simulation step (on whichever thread steps
+// the simulation), so a burst of events costs one subscriber update instead of one each.
+// Other events are still forwarded as they arrive, each only to the subscribers registered for
+// its group. Actions and axes are loaded from DEFAULT_INPUT_CONFIG_PATH.
 class InputPublisher  {
 public:
+    static const size_t EVENT_QUEUE_CAPACITY = 1024;
+
     InputPublisher();
 	virtual ~InputPublisher();
 private: 
+    void enqueue(InputEventType type, int code, float x, float y, quint64 timestamp);
+
+    QList<InputSubscriber*> mSubscribers[INPUT_SUBSCRIPTION_GROUP_COUNT];
 
-    QList<InputSubscriber*> mSubscribers;
+    SpscRingBuffer<InputEvent, EVENT_QUEUE_CAPACITY> mEventQueue;
+    InputSnapshot mInputSnapshot;
+    InputActionMap mActionMap;
+    std::atomic<int> mDroppedEventCount;
 
 public:
-	void subscribe(InputSubscriber* subscriber);
+	void subscribe(InputSubscriber* subscriber, unsigned int subscriptions = INPUT_SUBSCRIBE_ALL);
 	void unsubscribe(InputSubscriber* subscriber);
 
 	void clear();
@@ -30,6 +48,10 @@ public:
     void resizeGLEvent(int w, int h);
     void update(float deltaTime);
 
+    const InputSnapshot& getInputSnapshot() const;
+    InputActionMap& getActionMap();
+    int getDroppedEventCount() const;
+
     void keyPressEvent(QKeyEvent* event);
     void keyReleaseEvent(QKeyEvent* event);
     void mousePressEvent(QMouseEvent* event);
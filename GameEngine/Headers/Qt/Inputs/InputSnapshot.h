@@ -0,0 +1,83 @@
+#ifndef INPUTSNAPSHOT_H
+#define INPUTSNAPSHOT_H
+
+#include "Qt/Inputs/InputEvent.h"
+#include "Qt/Inputs/InputState.h"
+#include <QPointF>
+#include <bitset>
+
+enum class InputDevice : quint8
+{
+	Keyboard,
+	Mouse,
+};
+
+// Input as seen by one simulation step, kept in fixed-size bitsets so queries neither hash nor
+// allocate. Keys and buttons that are not down and did not change during the step have no
+// state. Pressed and Released last one step, Tap is a press and release within the same step,
+// Hold follows Pressed while the key stays down. Mouse motion of all the events in the step is
+// summed into one delta.
+class InputSnapshot {
+public:
+	// Latin-1 keys map to their code, Qt's special keys (0x010000xx) to 256 + xx
+	static const int KEY_SLOT_COUNT = 512;
+	// One slot per Qt::MouseButton bit
+	static const int BUTTON_SLOT_COUNT = 32;
+
+	static int getKeySlot(int key);       // -1 for keys without a slot
+	static int getButtonSlot(int button); // -1 for anything but a single button
+
+	InputSnapshot();
+
+	// Forgets the previous step's transitions, then the queued events are applied in order
+	void beginStep();
+	void apply(const InputEvent& event);
+
+	bool tryGetKeyState(int key, InputState& state) const;
+	bool isKeyDown(int key) const;
+	bool wasKeyPressed(int key) const;
+	bool wasKeyReleased(int key) const;
+
+	bool tryGetButtonState(int button, InputState& state) const;
+	bool isButtonDown(int button) const;
+	bool wasButtonPressed(int button) const;
+	bool wasButtonReleased(int button) const;
+
+	// Slot based, for bindings resolved ahead of time
+	bool isDown(InputDevice device, int slot) const;
+	bool wasPressed(InputDevice device, int slot) const;
+	bool wasReleased(InputDevice device, int slot) const;
+
+	QPointF getMousePosition() const;
+	QPointF getMouseDelta() const;
+	bool getIsMouseMoved() const;
+	float getWheelDelta() const;
+	int getEventCount() const;
+
+	void clear();
+
+private:
+	template<size_t SIZE>
+	struct Bits
+	{
+		std::bitset<SIZE> down;
+		std::bitset<SIZE> pressed;  // Went down during the step
+		std::bitset<SIZE> released; // Went up during the step
+
+		void press(int slot);
+		void release(int slot);
+		bool tryGetState(int slot, InputState& state) const;
+	};
+
+private:
+	Bits<KEY_SLOT_COUNT> mKeys;
+	Bits<BUTTON_SLOT_COUNT> mButtons;
+
+	bool mHasMousePosition;
+	QPointF mMousePosition;
+	QPointF mMouseDelta;
+	float mWheelDelta;
+	int mEventCount;
+};
+
+#endif // INPUTSNAPSHOT_H
@@ -1,3 +1,5 @@
+#ifndef INPUTSTATE_H
+#define INPUTSTATE_H
 
 
 enum class InputState
@@ -8,4 +10,6 @@ enum class InputState
 	Released,
 	Moved,
 
-};
\ No newline at end of file
+};
+
+#endif // INPUTSTATE_H
\ No newline at end of file
@@ -5,23 +5,37 @@
 #include <QKeyEvent>
 #include <QMouseEvent>
 
+#include "Qt/Inputs/InputSnapshot.h"
+#include "Qt/Inputs/InputActionMap.h"
+
+// Groups of callbacks a subscriber registers for with InputPublisher::subscribe
+enum InputSubscriptionGroup {
+	INPUT_SUBSCRIPTION_STEP = 0,      // updateInput() and update(deltaTime), once per simulation step
+	INPUT_SUBSCRIPTION_RESIZE_GL,
+	INPUT_SUBSCRIPTION_FOCUS,
+	INPUT_SUBSCRIPTION_WIDGET,        // Enter, leave, paint, move, resize, close, show and hide
+	INPUT_SUBSCRIPTION_OTHER,         // Context menu, tablet, action and drag and drop
+	INPUT_SUBSCRIPTION_GROUP_COUNT
+};
+
+const unsigned int INPUT_SUBSCRIBE_STEP = 1u << INPUT_SUBSCRIPTION_STEP;
+const unsigned int INPUT_SUBSCRIBE_RESIZE_GL = 1u << INPUT_SUBSCRIPTION_RESIZE_GL;
+const unsigned int INPUT_SUBSCRIBE_FOCUS = 1u << INPUT_SUBSCRIPTION_FOCUS;
+const unsigned int INPUT_SUBSCRIBE_WIDGET = 1u << INPUT_SUBSCRIPTION_WIDGET;
+const unsigned int INPUT_SUBSCRIBE_OTHER = 1u << INPUT_SUBSCRIPTION_OTHER;
+const unsigned int INPUT_SUBSCRIBE_ALL = (1u << INPUT_SUBSCRIPTION_GROUP_COUNT) - 1;
+
 class InputSubscriber {
 
 public:
 	InputSubscriber() {};
 	virtual ~InputSubscriber() {};
-	virtual void update() {};
 	virtual void update(float deltaTime) {};
 	virtual void updateResizeGL(int w, int h) {};
+	// Once per simulation step, before update(deltaTime); keys, buttons, motion and wheel only arrive here
+	virtual void updateInput(const InputSnapshot& input, const InputActionMap& actions, float deltaTime) {};
 
-	virtual void updateKeyPress(QKeyEvent* event) {};
-	virtual void updateKeyRelease(QKeyEvent* event) {};
 	virtual void updateResize(QResizeEvent* event) {};
-    virtual void updateMousePress(QMouseEvent* event) {};
-    virtual void updateMouseRelease(QMouseEvent* event) {};
-    virtual void updateMouseDoubleClick(QMouseEvent* event) {};
-    virtual void updateMouseMove(QMouseEvent* event) {};
-    virtual void updateWheel(QWheelEvent* event) {};
     virtual void updateFocusIn(QFocusEvent* event) {};
     virtual void updateFocusOut(QFocusEvent* event) {};
     virtual void updateEnter(QEnterEvent* event) {};
@@ -17,6 +17,9 @@ public:
 	virtual void* visitContainer(Container* node) override;
 	virtual void* visitMeshRenderer(MeshRenderer* node) override;
 	virtual void* visitCamera(Camera* node) override;
+	virtual void* visitLight(Light* node) override;
+	virtual void* visitCollider(Collider* node) override;
+	virtual void* visitRigidBody(RigidBody* node) override;
 
 private:
 	QList<QWidget*> mStackItems;
@@ -9,6 +9,7 @@
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QMutex>
 #include <memory> 
 
 #include "Engine/Components/Transform.h"
@@ -24,6 +25,8 @@ public:
     ~TransformWidget();
     void setTransform(std::shared_ptr<Transform> transform);
     void clearTransform();
+    // Edits lock this while a game thread may be stepping the transform
+    void setSimulationMutex(QMutex* simulationMutex);
 
     QVector3D getPosition() const;
     QQuaternion getRotation() const;
@@ -41,6 +44,7 @@ private:
     bool mIsUpdating;
 
     std::weak_ptr<Transform> mTransform;
+    QMutex* mSimulationMutex;
 	
     SectionWidget* mSection;
 
@@ -4,6 +4,7 @@
 
 #include "Qt/Hierarchy/HierarchyWidget.h"
 #include "Qt/Inspector/InspectorWidget.h"
+#include "Qt/Profiler/ProfilerWidget.h"
 #include "Qt/OpenGLWidget.h"
 
 #include "Engine/Interfaces/IScene.h"
@@ -17,6 +18,8 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QHBoxLayout>
+#include <QStatusBar>
+#include <QTimer>
 
 #include <QFile>
 #include <QJsonDocument>
@@ -37,9 +40,13 @@ private slots:
 private:
     void createDockWidgets();
     void createControlButtons();
+    void configureFramePacing(FramePacer* framePacer);
+    void configureShaderReload();
+    void updateFrameBudget();
 
 private:
     QDockWidget* mCameraViewDock;
+    OpenGLWidget* mOpenGLWidget;
     QDockWidget* mInspectorDock;
 
     IScene* mPlayingScene;
@@ -47,4 +54,6 @@ private:
 
     HierarchyWidget* mHierarchyWidget;
     InspectorWidget* mInspectorWidget;
+    ProfilerWidget* mProfilerWidget;
+    QLabel* mShaderStatusLabel; // Only with --shader-dir
 };
\ No newline at end of file
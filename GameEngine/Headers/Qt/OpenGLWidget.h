@@ -5,9 +5,15 @@
 #include <QOpenGLFunctions>
 #include <QKeyEvent>
 #include <QMouseEvent>
+#include <QPointF>
 #include <QTimer>
+#include <memory>
 
 #include <Engine/Interfaces/IScene.h>
+#include "Engine/Scenes/EngineLoop.h"
+#include "Engine/Spatial/RayPicker.h"
+#include "Engine/Threading/GameThread.h"
+#include "Qt/FramePacer.h"
 
 
 class OpenGLWidget : public QOpenGLWidget, protected QOpenGLFunctions {
@@ -17,19 +23,55 @@ public:
     OpenGLWidget(IScene* scene, QWidget* parent = nullptr);
 	~OpenGLWidget();
 
+    EngineLoop& getEngineLoop();
+    FramePacer* getFramePacer() const;
+
+    // Simulate on a GameThread and render its snapshots; takes effect when the context is (re)initialized
+    void setIsThreaded(bool isThreaded);
+    bool getIsThreaded() const;
+
+    FrameTimings getAverageTimings() const;
+    float getFixedDeltaTime() const;
+
+    // A left click picks through the scene's ID buffer instead of casting a ray on the CPU; the
+    // GPU answer arrives a frame or two later
+    void setIsGpuPicking(bool isGpuPicking);
+    bool getIsGpuPicking() const;
+
+signals:
+    // Null when the click hit nothing
+    void nodePicked(Node* node);
+
 protected:
     void initializeGL() override;
     void resizeGL(int w, int h) override;
     void paintGL() override;
     void keyPressEvent(QKeyEvent* event) override;
     void keyReleaseEvent(QKeyEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
     void mouseMoveEvent(QMouseEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void focusOutEvent(QFocusEvent* event) override;
 
 private:
-    float deltaTime;
-    float lastFrame;
-    QElapsedTimer* elapsedTimer;
-    
+    void stopGameThread();
+    void paintSnapshot();
+    void pick(const QPointF& pixel);
+    void pollGpuPick();
+
+private:
+    EngineLoop mEngineLoop;
+    FramePacer* mFramePacer;
+    bool mIsThreaded;
+    std::unique_ptr<GameThread> mGameThread;
+    double mAverageRenderMs;
+
+    bool mIsGpuPicking;
+    RayPicker mRayPicker;
+    QPointF mPressPosition; // Of the left button, so a drag does not count as a click
+
     IScene* mCurrentScene;
 	InputPublisher* mInputPublisher;
 
@@ -0,0 +1,36 @@
+#ifndef PROFILER_TIMELINE_VIEW_H
+#define PROFILER_TIMELINE_VIEW_H
+
+#include <vector>
+#include <QWidget>
+#include <QPainter>
+#include <QMouseEvent>
+
+#include "Engine/Profiling/Profiler.h"
+
+// Frame-time history on top, flame chart of the selected frame below (CPU lane, then GPU lane)
+class ProfilerTimelineView : public QWidget
+{
+public:
+    explicit ProfilerTimelineView(QWidget* parent = nullptr);
+
+    void setFrames(std::vector<ProfileFrame> frames);
+    const ProfileFrame* getSelectedFrame() const;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+
+private:
+    void paintHistory(QPainter& painter, const QRect& area);
+    void paintLane(QPainter& painter, const QRect& area, const QString& title, bool isGpu);
+
+private:
+    static const int HISTORY_HEIGHT = 70;
+    static const int ROW_HEIGHT = 18;
+
+    std::vector<ProfileFrame> mFrames;
+    long long mSelectedFrameIndex; // -1 follows the latest frame
+};
+
+#endif // PROFILER_TIMELINE_VIEW_H
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Qt/Profiler/ProfilerTimelineView.h"
+#include <QDockWidget>
+#include <QCheckBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QTimer>
+
+class ProfilerWidget : public QDockWidget {
+    Q_OBJECT
+
+public:
+    ProfilerWidget(QWidget* parent = nullptr);
+    ~ProfilerWidget();
+
+private slots:
+    void refresh();
+    void exportTrace();
+
+private:
+    ProfilerTimelineView* mTimelineView;
+    QLabel* mSummaryLabel;
+    QCheckBox* mPauseCheckBox;
+    QTimer* mRefreshTimer;
+};
@@ -9,31 +9,30 @@
 #include <QElapsedTimer>
 #include <QtMath>
 #include <QQuaternion>
-#include <unordered_map>
 
 class FPSCameraController : public InputSubscriber
 {
 public:
-    FPSCameraController(Camera* camera);
+    FPSCameraController(Camera* camera, const InputActionMap& actions);
 
-    void updateKeyPress(QKeyEvent* event) override;
-	void updateKeyRelease(QKeyEvent* event) override;
-    void updateMouseMove(QMouseEvent* event) override;
+    void updateInput(const InputSnapshot& input, const InputActionMap& actions, float deltaTime) override;
     void updateResizeGL(int w, int h) override;
-    void update(float deltaTime) override;
 
 private:
     Camera* mCamera;
 
     float mYaw;
     float mPitch;
-    bool mFirstMouse;
-    float mLastX;
-    float mLastY;
     float mSensitivity;
     float mSpeed;
-
-    std::unordered_map<int, bool> mKeyStates;
+    float mSprintMultiplier;
+
+    int mMoveForwardAxis;
+    int mMoveRightAxis;
+    int mMoveUpAxis;
+    int mLookXAxis;
+    int mLookYAxis;
+    int mSprintAction;
 };
 
 
@@ -2,6 +2,7 @@
 #include "Engine/Loaders/ModelLoader.h"
 #include "TestGame/Controllers/FPSCameraController.h"
 #include "Engine/Nodes/MeshRenderer.h"
+#include "Engine/Nodes/Light.h"
 
 class TestScene : public Scene
 {
@@ -7,27 +7,133 @@
 in vec4 fragColor;
 in vec3 fragNormal;
 in vec2 fragTexCoord;
+#ifdef USE_LIGHTING
+in vec3 fragViewPosition;
+in vec3 fragViewNormal;
+#endif
+
+// Features are compiled in per variant (ShaderVariants): USE_TEXTURE, USE_COLOR, USE_LIGHTING
+#ifdef USE_TEXTURE
+uniform sampler2DArray sampler; // Shared texture array, see TextureManager
+uniform float mTextureLayer;
+#endif
+
+#ifdef USE_LIGHTING
+// Clustered forward lighting, see ClusteredLighting. Every light is three texels in view space:
+// (position, range), (color, inner cone cosine), (direction, outer cone cosine)
+uniform samplerBuffer mLights;
+uniform usamplerBuffer mClusters;     // Offset into mLightIndices and light count per cluster
+uniform usamplerBuffer mLightIndices;
+uniform int mDirectionalLightCount;   // The first lights, applied to every fragment
+uniform vec3 mClusterCounts;
+uniform vec4 mClusterViewport;        // x, y, tile width, tile height in pixels
+uniform vec2 mClusterDepthParams;     // slice = log(depth) * x + y
+uniform vec3 mAmbientColor;
+
+// Cascaded shadow maps of one directional light, see CascadedShadowMaps
+uniform sampler2DArrayShadow mShadowMap;
+uniform mat4 mShadowMatrices[4];      // View space to the cascade's texture coordinates and depth
+uniform vec4 mShadowSplits;           // View-space depth where each cascade ends
+uniform vec4 mShadowTexelSizes;       // World size of a texel per cascade
+uniform int mShadowCascadeCount;      // 0 without shadows
+uniform int mShadowLightIndex;
+
+float sampleShadow(vec3 position, vec3 normal)
+{
+    float depth = -position.z;
+    if (mShadowCascadeCount == 0 || depth > mShadowSplits[mShadowCascadeCount - 1]) {
+        return 1.0;
+    }
+
+    int cascade = 0;
+    while (cascade < mShadowCascadeCount - 1 && depth > mShadowSplits[cascade]) {
+        ++cascade;
+    }
+
+    // Offsetting along the normal keeps lit surfaces from shadowing themselves at grazing angles
+    vec3 offsetPosition = position + normal * mShadowTexelSizes[cascade] * 1.5;
+    vec3 coord = (mShadowMatrices[cascade] * vec4(offsetPosition, 1.0)).xyz;
+    vec2 texel = 1.0 / vec2(textureSize(mShadowMap, 0).xy);
+
+    float lit = 0.0;
+    lit += texture(mShadowMap, vec4(coord.xy + vec2(-0.5, -0.5) * texel, float(cascade), coord.z));
+    lit += texture(mShadowMap, vec4(coord.xy + vec2(0.5, -0.5) * texel, float(cascade), coord.z));
+    lit += texture(mShadowMap, vec4(coord.xy + vec2(-0.5, 0.5) * texel, float(cascade), coord.z));
+    lit += texture(mShadowMap, vec4(coord.xy + vec2(0.5, 0.5) * texel, float(cascade), coord.z));
+    return lit * 0.25;
+}
+
+vec3 shadeLight(int light, vec3 position, vec3 normal)
+{
+    vec4 positionRange = texelFetch(mLights, light * 3);
+    vec4 colorInner = texelFetch(mLights, light * 3 + 1);
+    vec4 directionOuter = texelFetch(mLights, light * 3 + 2);
+
+    vec3 toLight = positionRange.xyz - position;
+    float distanceSquared = dot(toLight, toLight);
+    float rangeSquared = positionRange.w * positionRange.w;
+    if (distanceSquared >= rangeSquared) {
+        return vec3(0.0);
+    }
+
+    // Inverse square falloff windowed to reach zero at the range
+    vec3 lightDirection = toLight * inversesqrt(max(distanceSquared, 1e-8));
+    float window = clamp(1.0 - (distanceSquared / rangeSquared) * (distanceSquared / rangeSquared), 0.0, 1.0);
+    float attenuation = window * window / (distanceSquared + 1.0);
+    attenuation *= smoothstep(directionOuter.w, colorInner.w, dot(-lightDirection, directionOuter.xyz));
+
+    return colorInner.rgb * max(dot(normal, lightDirection), 0.0) * attenuation;
+}
+
+vec3 shadeLighting()
+{
+    vec3 normal = normalize(fragViewNormal);
+    if (!gl_FrontFacing) {
+        normal = -normal;
+    }
+
+    vec3 lighting = mAmbientColor;
+    for (int i = 0; i < mDirectionalLightCount; ++i) {
+        vec4 colorInner = texelFetch(mLights, i * 3 + 1);
+        vec3 direction = texelFetch(mLights, i * 3 + 2).xyz;
+        float shadow = i == mShadowLightIndex ? sampleShadow(fragViewPosition, normal) : 1.0;
+        lighting += colorInner.rgb * max(dot(normal, -direction), 0.0) * shadow;
+    }
+
+    ivec3 counts = ivec3(mClusterCounts);
+    ivec2 tile = ivec2((gl_FragCoord.xy - mClusterViewport.xy) / mClusterViewport.zw);
+    int slice = int(log(max(-fragViewPosition.z, 1e-4)) * mClusterDepthParams.x + mClusterDepthParams.y);
+    ivec3 cluster = clamp(ivec3(tile, slice), ivec3(0), counts - 1);
+
+    uvec2 range = texelFetch(mClusters, (cluster.z * counts.y + cluster.y) * counts.x + cluster.x).xy;
+    for (uint i = 0u; i < range.y; ++i) {
+        int light = int(texelFetch(mLightIndices, int(range.x + i)).x);
+        lighting += shadeLight(light, fragViewPosition, normal);
+    }
+    return lighting;
+}
+#endif
 
-uniform sampler2D sampler; // Texture sampler
-uniform vec2 mTexScale;
-uniform bool mUseTexture;
-uniform bool mUseColor;
 out vec4 color;
 
 void main()
 {
     color = vec4(1.0, 1.0, 1.0, 1.0);
 
-    if (mUseTexture) {
-        vec4 texColor = texture(sampler, fragTexCoord);
-        color = color * texColor;
-    }
+#ifdef USE_TEXTURE
+    vec4 texColor = texture(sampler, vec3(fragTexCoord, mTextureLayer));
+    color = color * texColor;
+#endif
 
-    if (mUseColor) {
-        color = color * fragColor;
-    }
+#ifdef USE_COLOR
+    color = color * fragColor;
+#endif
 
     if (color.a <= 0.01) {
         discard;
     }
+
+#ifdef USE_LIGHTING
+    color.rgb *= shadeLighting();
+#endif
 }
\ No newline at end of file
@@ -8,18 +8,28 @@ layout(location = 3) in vec4 vertColor;
 out vec4 fragColor;
 out vec3 fragNormal;
 out vec2 fragTexCoord;
+#ifdef USE_LIGHTING
+out vec3 fragViewPosition;
+out vec3 fragViewNormal;
+#endif
 
 uniform mat4 mWorld;
 uniform mat4 mView;
 uniform mat4 mProj;
 uniform vec2 mTexScale;
-uniform bool mUseTexture;
-uniform bool mUseColor;
+
+// The depth pre-pass (depth.vert) has to produce identical depths
+invariant gl_Position;
 
 void main()
 {
     fragColor = vertColor;
     fragTexCoord = vertTexCoord * mTexScale;
     fragNormal = vertNormal;
+#ifdef USE_LIGHTING
+    mat4 worldView = mView * mWorld;
+    fragViewPosition = (worldView * vec4(vertPosition, 1.0)).xyz;
+    fragViewNormal = transpose(inverse(mat3(worldView))) * vertNormal;
+#endif
     gl_Position = mProj * mView * mWorld * vec4(vertPosition, 1.0);
 }
\ No newline at end of file
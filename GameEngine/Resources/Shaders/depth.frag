@@ -0,0 +1,6 @@
+#version 330 core
+
+// Depth pre-pass: colour writes are masked off, only the depth test and write matter
+void main()
+{
+}
\ No newline at end of file
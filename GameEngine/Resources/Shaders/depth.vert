@@ -0,0 +1,15 @@
+#version 330 core
+
+layout(location = 0) in vec3 vertPosition;
+
+uniform mat4 mWorld;
+uniform mat4 mView;
+uniform mat4 mProj;
+
+// Must match default.vert bit for bit, or the colour pass fails its GL_EQUAL test
+invariant gl_Position;
+
+void main()
+{
+    gl_Position = mProj * mView * mWorld * vec4(vertPosition, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#version 430 core
+#extension GL_ARB_shader_draw_parameters : require
+
+layout(location = 0) in vec3 vertPosition;
+
+layout(std430, binding = 0) readonly buffer DrawData
+{
+    mat4 mWorlds[];
+};
+
+uniform mat4 mView;
+uniform mat4 mProj;
+
+// Must match indirect.vert bit for bit, or the colour pass fails its GL_EQUAL test
+invariant gl_Position;
+
+void main()
+{
+    mat4 world = mWorlds[gl_BaseInstanceARB];
+    gl_Position = mProj * mView * world * vec4(vertPosition, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#version 330 core
+
+in vec4 fragColor;
+
+out vec4 color;
+
+void main()
+{
+    color = vec4(fragColor.rgb, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 330 core
+
+layout(location = 0) in vec3 vertPosition;
+layout(location = 3) in vec4 vertColor;
+
+out vec4 fragColor;
+
+uniform mat4 mWorld;
+uniform mat4 mView;
+uniform mat4 mProj;
+
+// Stand-in while the scene shader is still compiling; keeps the vertex stage trivial
+void main()
+{
+    fragColor = vertColor;
+    gl_Position = mProj * mView * mWorld * vec4(vertPosition, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#version 330 core
+
+// Object picking: writes the drawn object's id into an integer target, 0 is left for the background
+uniform int mObjectId;
+
+layout(location = 0) out uint objectId;
+
+void main()
+{
+    objectId = uint(mObjectId);
+}
@@ -0,0 +1,43 @@
+#version 430 core
+#extension GL_ARB_shader_draw_parameters : require
+
+layout(location = 0) in vec3 vertPosition;
+layout(location = 1) in vec3 vertNormal;
+layout(location = 2) in vec2 vertTexCoord;
+layout(location = 3) in vec4 vertColor;
+
+out vec4 fragColor;
+out vec3 fragNormal;
+out vec2 fragTexCoord;
+#ifdef USE_LIGHTING
+out vec3 fragViewPosition;
+out vec3 fragViewNormal;
+#endif
+
+// One world matrix per draw command; the command's baseInstance holds its index
+layout(std430, binding = 0) readonly buffer DrawData
+{
+    mat4 mWorlds[];
+};
+
+uniform mat4 mView;
+uniform mat4 mProj;
+uniform vec2 mTexScale;
+
+// The depth pre-pass (depth_indirect.vert) has to produce identical depths
+invariant gl_Position;
+
+void main()
+{
+    mat4 world = mWorlds[gl_BaseInstanceARB];
+
+    fragColor = vertColor;
+    fragTexCoord = vertTexCoord * mTexScale;
+    fragNormal = vertNormal;
+#ifdef USE_LIGHTING
+    mat4 worldView = mView * world;
+    fragViewPosition = (worldView * vec4(vertPosition, 1.0)).xyz;
+    fragViewNormal = transpose(inverse(mat3(worldView))) * vertNormal;
+#endif
+    gl_Position = mProj * mView * world * vec4(vertPosition, 1.0);
+}
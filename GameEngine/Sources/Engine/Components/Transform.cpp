@@ -1,17 +1,37 @@
 #include "Engine/Components/Transform.h"
 
+#include <algorithm>
 
-Transform::Transform() : mParent(nullptr)
+
+Transform::Transform() : mIsPoseSet(false), mHasPreviousState(false), mParent(nullptr)
 {
 	mWorldPosition = QVector3D(0.0f, 0.0f, 0.0f);
 	mWorldRotation = QQuaternion(1.0f, 0.0f, 0.0f, 0.0f);
 	mWorldScale = QVector3D(1.0f, 1.0f, 1.0f);
 
+	mLocalPosition = mWorldPosition;
+	mLocalRotation = mWorldRotation;
+	mLocalScale = mWorldScale;
+
+	mPreviousWorldPosition = mWorldPosition;
+	mPreviousWorldRotation = mWorldRotation;
+	mPreviousWorldScale = mWorldScale;
+
 	mChildren = std::vector<Transform*>();
 }
 
 Transform::~Transform()
 {
+	// A parent's transform goes before its children's when a node is destroyed
+	for (Transform* child : mChildren)
+	{
+		child->mParent = nullptr;
+	}
+
+	if (mParent)
+	{
+		mParent->removeChild(this);
+	}
 }
 
 void Transform::position(const QVector3D& position)
@@ -30,18 +50,21 @@ void Transform::scale(const QVector3D& scale)
 void Transform::setWorldPosition(const QVector3D& position)
 {
 	mWorldPosition = position;
+	updateLocalFromWorld();
 	updateChildrenWorldMatrix();
 }
 
 void Transform::setWorldRotation(const QQuaternion& rotation)
 {
 	mWorldRotation = rotation;
+	updateLocalFromWorld();
 	updateChildrenWorldMatrix();
 }
 
 void Transform::setWorldScale(const QVector3D& scale)
 {
 	mWorldScale = scale;
+	updateLocalFromWorld();
 	updateChildrenWorldMatrix();
 }
 
@@ -62,92 +85,47 @@ QVector3D Transform::getWorldScale()
 
 void Transform::setLocalPosition(const QVector3D& position)
 {
-    if (mParent)
-    {
-        QMatrix4x4 parentInverse = mParent->getWorldMatrix().inverted();
-        QMatrix4x4 translationMatrix;
-        translationMatrix.translate(position);
-		mWorldPosition = parentInverse.map(translationMatrix.map(QVector3D(0.0f, 0.0f, 0.0f)));
-    }
-    else
-    {
-        mWorldPosition = position;
-    }
+	mLocalPosition = position;
+	updateWorldFromLocal();
 	updateChildrenWorldMatrix();
 }
 
-void Transform::setLocalRotation(const QQuaternion& rotation)  
-{  
-   if (mParent)  
-   {  
-       QMatrix4x4 parentInverse = mParent->getWorldMatrix().inverted();  
-       QMatrix4x4 rotationMatrix;  
-       rotationMatrix.rotate(rotation);  
-       QMatrix4x4 resultMatrix = parentInverse * rotationMatrix;  
-       mWorldRotation = QQuaternion::fromRotationMatrix(resultMatrix.toGenericMatrix<3, 3>());  
-   }  
-   else  
-   {  
-       mWorldRotation = rotation;  
-   }  
-   updateChildrenWorldMatrix();  
+void Transform::setLocalRotation(const QQuaternion& rotation)
+{
+	mLocalRotation = rotation;
+	updateWorldFromLocal();
+	updateChildrenWorldMatrix();
 }
 
 void Transform::setLocalScale(const QVector3D& scale)
 {
-	if (mParent)
-	{
-		QMatrix4x4 parentInverse = mParent->getWorldMatrix().inverted();
-		QMatrix4x4 scaleMatrix;
-		scaleMatrix.scale(scale);
-		QMatrix4x4 resultMatrix = parentInverse * scaleMatrix;
-		mWorldScale = resultMatrix.map(QVector3D(1.0f, 1.0f, 1.0f));
-	}
-	else
-	{
-		mWorldScale = scale;
-	}
+	mLocalScale = scale;
+	updateWorldFromLocal();
 	updateChildrenWorldMatrix();
 }
 
 QVector3D Transform::getLocalPosition()
 {
-	if (mParent)
-	{
-		QMatrix4x4 parentMatrix = mParent->getWorldMatrix();
-		QMatrix4x4 parentInverse = parentMatrix.inverted();
-		QVector3D result = parentInverse.map(QVector3D(0.0f, 0.0f, 0.0f));
-		return result;
-	}
-	return mWorldPosition;
+	return mLocalPosition;
 }
 
 QQuaternion Transform::getLocalRotation()
 {
-	if (mParent)
-	{
-		QMatrix4x4 parentMatrix = mParent->getWorldMatrix();
-		QMatrix4x4 parentInverse = parentMatrix.inverted();
-		QMatrix4x4 rotationMatrix = parentInverse * getWorldMatrix();
-		return QQuaternion::fromRotationMatrix(rotationMatrix.toGenericMatrix<3, 3>());
-	}
-	return mWorldRotation;
+	return mLocalRotation;
 }
 
 QVector3D Transform::getLocalScale()
 {
-	if (mParent)
-	{
-		QMatrix4x4 parentMatrix = mParent->getWorldMatrix();
-		QMatrix4x4 parentInverse = parentMatrix.inverted();
-		QVector3D result = parentInverse.map(QVector3D(1.0f, 1.0f, 1.0f));
-		return result;
-	}
-	return mWorldScale;
+	return mLocalScale;
 }
 
 void Transform::setParent(Transform* parent)
 {
+	if (parent == mParent || parent == this)
+	{
+		return;
+	}
+
 	if (mParent)
 	{
 		mParent->removeChild(this);
@@ -159,6 +137,9 @@ void Transform::setParent(Transform* parent)
 	{
 		mParent->addChild(this);
 	}
+
+	// Stays where it is in the world
+	updateLocalFromWorld();
 }
 
 Transform* Transform::getParent() const
@@ -171,7 +152,6 @@ void Transform::addChild(Transform* child) {
 		return;
 	}
 
-	child->setParent(this);
 	mChildren.push_back(child);
 }
 
@@ -181,7 +161,6 @@ void Transform::removeChild(Transform* child) {
 			return ptr == child;
 		});
 	if (it != mChildren.end()) {
-		(*it)->setParent(nullptr);
 		mChildren.erase(it, mChildren.end());
 	}
 }
@@ -218,25 +197,158 @@ QMatrix4x4 Transform::getWorldMatrix()
 
 QMatrix4x4 Transform::getLocalMatrix()
 {
-	Transform* parent = getParent();
 	QMatrix4x4 matrix;
-	if (parent)
+	matrix.translate(mLocalPosition);
+	matrix.rotate(mLocalRotation);
+	matrix.scale(mLocalScale);
+	return matrix;
+}
+
+void Transform::setWorldPoses(Transform* const* transforms, const QVector3D* positions, const QQuaternion* rotations, int count)
+{
+	// All targets first, so a nested transform's local pose is taken against its parent's new one
+	for (int i = 0; i < count; ++i)
 	{
-		return parent->getWorldMatrix().inverted() * getWorldMatrix();
+		Transform* transform = transforms[i];
+		transform->mWorldPosition = positions[i];
+		transform->mWorldRotation = rotations[i];
+		transform->mIsPoseSet = true;
 	}
-	else
+
+	// Then one pass per outermost moved transform; those below it are covered by that pass
+	for (int i = 0; i < count; ++i)
 	{
+		Transform* transform = transforms[i];
+		if (!transform->mIsPoseSet)
+			continue;
+
+		bool isNested = false;
+		for (Transform* parent = transform->mParent; parent && !isNested; parent = parent->mParent)
+		{
+			isNested = parent->mIsPoseSet;
+		}
+		if (!isNested)
+		{
+			transform->updateSetPoses();
+		}
+	}
+}
+
+void Transform::storePreviousState()
+{
+	mPreviousWorldPosition = mWorldPosition;
+	mPreviousWorldRotation = mWorldRotation;
+	mPreviousWorldScale = mWorldScale;
+	mHasPreviousState = true;
+}
+
+QVector3D Transform::getInterpolatedWorldPosition(float alpha)
+{
+	if (!mHasPreviousState)
+		return mWorldPosition;
+
+	return mPreviousWorldPosition + (mWorldPosition - mPreviousWorldPosition) * alpha;
+}
+
+QQuaternion Transform::getInterpolatedWorldRotation(float alpha)
+{
+	if (!mHasPreviousState)
+		return mWorldRotation;
+
+	return QQuaternion::slerp(mPreviousWorldRotation, mWorldRotation, alpha);
+}
+
+QMatrix4x4 Transform::getInterpolatedWorldMatrix(float alpha)
+{
+	if (!mHasPreviousState || alpha >= 1.0f)
 		return getWorldMatrix();
+
+	QMatrix4x4 matrix;
+	matrix.translate(getInterpolatedWorldPosition(alpha));
+	matrix.rotate(getInterpolatedWorldRotation(alpha));
+	matrix.scale(mPreviousWorldScale + (mWorldScale - mPreviousWorldScale) * alpha);
+	return matrix;
+}
+
+QVector3D Transform::getPreviousWorldPosition()
+{
+	return mHasPreviousState ? mPreviousWorldPosition : mWorldPosition;
+}
+
+QQuaternion Transform::getPreviousWorldRotation()
+{
+	return mHasPreviousState ? mPreviousWorldRotation : mWorldRotation;
+}
+
+QVector3D Transform::getPreviousWorldScale()
+{
+	return mHasPreviousState ? mPreviousWorldScale : mWorldScale;
+}
+
+void Transform::updateLocalFromWorld()
+{
+	if (!mParent)
+	{
+		mLocalPosition = mWorldPosition;
+		mLocalRotation = mWorldRotation;
+		mLocalScale = mWorldScale;
+		return;
+	}
+
+	// A parent scaled to zero along an axis keeps the child's local value on it
+	QQuaternion inverseRotation = mParent->mWorldRotation.conjugated();
+	QVector3D parentScale = mParent->mWorldScale;
+	QVector3D offset = inverseRotation.rotatedVector(mWorldPosition - mParent->mWorldPosition);
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if (parentScale[axis] != 0.0f)
+		{
+			mLocalPosition[axis] = offset[axis] / parentScale[axis];
+			mLocalScale[axis] = mWorldScale[axis] / parentScale[axis];
+		}
 	}
+	mLocalRotation = inverseRotation * mWorldRotation;
 }
 
+void Transform::updateWorldFromLocal()
+{
+	if (!mParent)
+	{
+		mWorldPosition = mLocalPosition;
+		mWorldRotation = mLocalRotation;
+		mWorldScale = mLocalScale;
+		return;
+	}
+
+	mWorldPosition = mParent->mWorldPosition + mParent->mWorldRotation.rotatedVector(mLocalPosition * mParent->mWorldScale);
+	mWorldRotation = mParent->mWorldRotation * mLocalRotation;
+	mWorldScale = mParent->mWorldScale * mLocalScale;
+}
+
+void Transform::updateSetPoses()
+{
+	if (mIsPoseSet)
+	{
+		updateLocalFromWorld();
+		mIsPoseSet = false;
+	}
+	else
+	{
+		updateWorldFromLocal();
+	}
+
+	for (Transform* child : mChildren)
+	{
+		child->updateSetPoses();
+	}
+}
 
 void Transform::updateChildrenWorldMatrix()
 {
-	for (const auto& child : mChildren)
+	// One pass down the subtree; each child keeps its local pose and gets a new world one
+	for (Transform* child : mChildren)
 	{
-		child->setWorldPosition(child->getLocalPosition());
-		child->setWorldRotation(child->getLocalRotation());
-		child->setWorldScale(child->getLocalScale());
+		child->updateWorldFromLocal();
+		child->updateChildrenWorldMatrix();
 	}
 }
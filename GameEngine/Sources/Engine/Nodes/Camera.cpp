@@ -1,4 +1,9 @@
 #include "Engine/Nodes/Camera.h"
+#include "Engine/Interfaces/IScene.h"
+#include "Engine/Renders/GLStateCache.h"
+
+#include <cmath>
+#include <QtMath>
 
 Camera::Camera()
 {
@@ -7,6 +12,7 @@ Camera::Camera()
 	mFar = 1000.0f;
 	mAspectRatio = 16.0f/9.0f;
 	mIsOrtho = false;
+	mIsReversedZ = false;
 
 	setName("Camera");
 }
@@ -22,8 +28,9 @@ void Camera::init()
 
 void Camera::start(IScene* scene)
 {
+	Container::start(scene);
 
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::instance().setIsEnabled(GL_DEPTH_TEST, true);
 }
 
 void Camera::update(float deltaTime)
@@ -33,8 +40,7 @@ void Camera::update(float deltaTime)
 
 void Camera::render(ShaderProgram& shaderProgram)
 {
-	glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	clearFramebuffer();
 
 	QMatrix4x4 view = getViewMatrix();
 
@@ -84,6 +90,12 @@ void Camera::setWidth(float width)
 	mDirty = true;
 }
 
+void Camera::setIsReversedZ(bool isReversedZ)
+{
+	mIsReversedZ = isReversedZ;
+	mDirty = true;
+}
+
 float Camera::getFov() const
 {
 	return mFov;
@@ -114,17 +126,40 @@ float Camera::getWidth() const
 	return mWidth;
 }
 
+bool Camera::getIsReversedZ() const
+{
+	return mIsReversedZ;
+}
+
 QMatrix4x4 Camera::getViewMatrix()
+{
+	float alpha = mScenePtr ? mScenePtr->getInterpolationAlpha() : 1.0f;
+	return makeViewMatrix(transform->getInterpolatedWorldPosition(alpha), transform->getInterpolatedWorldRotation(alpha));
+}
+
+QMatrix4x4 Camera::makeViewMatrix(const QVector3D& position, const QQuaternion& rotation)
 {
 	QMatrix4x4 view;
-	QVector3D mPosition = transform->getWorldPosition();
-	QVector3D mFront = transform->getWorldRotation() * QVector3D(0.0f, 0.0f, -1.0f);
-	QVector3D mUp = transform->getWorldRotation() * QVector3D(0.0f, 1.0f, 0.0f);
+	QVector3D front = rotation * QVector3D(0.0f, 0.0f, -1.0f);
+	QVector3D up = rotation * QVector3D(0.0f, 1.0f, 0.0f);
 
-	view.lookAt(mPosition, mPosition + mFront, mUp);
+	view.lookAt(position, position + front, up);
 	return view;
 }
 
+void Camera::clearFramebuffer()
+{
+	// Clears honour the write masks, so the last material's depth mask must not leak into them
+	GLStateCache& state = GLStateCache::instance();
+	state.setIsDepthReversed(mIsReversedZ);
+	state.setIsDepthZeroToOne(mIsReversedZ);
+	state.setClearDepth(state.getFarDepth());
+	state.setClearColor(0.2f, 0.2f, 0.2f, 1.0f);
+	state.setDepthMask(true);
+	state.setColorMask(true);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
 QMatrix4x4 Camera::getProjectionMatrix()
 {
 	QMatrix4x4 projection;
@@ -135,10 +170,29 @@ QMatrix4x4 Camera::getProjectionMatrix()
 		float orthoHeight = orthoWidth / mAspectRatio;
 		projection.ortho(-orthoWidth / 2, orthoWidth / 2, -orthoHeight / 2, orthoHeight / 2, mNear, mFar);
 	}
-	else {
+	else if (!mIsReversedZ) {
 		// Create a perspective projection matrix
 		projection.perspective(mFov, mAspectRatio, mNear, mFar);
 	}
+	else {
+		// Infinite far plane, written out directly so no far - near difference eats the precision
+		float focal = 1.0f / std::tan(qDegreesToRadians(mFov) / 2.0f);
+		bool isZeroToOne = GLStateCache::instance().getIsClipControlSupported();
+		return QMatrix4x4(
+			focal / mAspectRatio, 0.0f, 0.0f, 0.0f,
+			0.0f, focal, 0.0f, 0.0f,
+			0.0f, 0.0f, isZeroToOne ? 0.0f : 1.0f, isZeroToOne ? mNear : 2.0f * mNear,
+			0.0f, 0.0f, -1.0f, 0.0f);
+	}
+
+	if (mIsReversedZ) {
+		// Flip the orthographic depth into the reversed range
+		bool isZeroToOne = GLStateCache::instance().getIsClipControlSupported();
+		QMatrix4x4 reverse;
+		reverse(2, 2) = isZeroToOne ? -0.5f : -1.0f;
+		reverse(2, 3) = isZeroToOne ? 0.5f : 0.0f;
+		projection = reverse * projection;
+	}
 
 	return projection;
 }
@@ -0,0 +1,154 @@
+#include "Engine/Nodes/Collider.h"
+#include "Engine/Interfaces/IScene.h"
+#include "Engine/Nodes/RigidBody.h"
+
+#include <algorithm>
+#include <cmath>
+
+Collider::Collider() : Collider(ColliderShape::SPHERE)
+{
+}
+
+Collider::Collider(ColliderShape shape) : Container()
+{
+	mShape = shape;
+	mRadius = 0.5f;
+	mHalfExtents = QVector3D(0.5f, 0.5f, 0.5f);
+	mHalfHeight = 0.5f;
+	mBodyIndex = -1;
+	mRigidBody = nullptr;
+
+	setName("Collider");
+}
+
+Collider::~Collider() noexcept
+{
+	if (mScenePtr && mBodyIndex >= 0)
+	{
+		mScenePtr->getCollisionWorld()->remove(this);
+	}
+}
+
+void Collider::clear()
+{
+	if (mScenePtr && mBodyIndex >= 0)
+	{
+		mScenePtr->getCollisionWorld()->remove(this);
+	}
+
+	// Registers again on the next start
+	mRigidBody = nullptr;
+	mIsStarted = false;
+	Container::clear();
+}
+
+void Collider::start(IScene* scene)
+{
+	Container::start(scene);
+
+	mRigidBody = nullptr;
+	for (Node* parent = getParent(); parent && !mRigidBody; parent = parent->getParent())
+	{
+		mRigidBody = dynamic_cast<RigidBody*>(parent);
+	}
+
+	if (mScenePtr && mBodyIndex < 0)
+	{
+		mScenePtr->getCollisionWorld()->add(this);
+	}
+}
+
+void Collider::setShape(ColliderShape shape)
+{
+	mShape = shape;
+}
+
+ColliderShape Collider::getShape() const
+{
+	return mShape;
+}
+
+void Collider::setCenter(const QVector3D& center)
+{
+	mCenter = center;
+}
+
+QVector3D Collider::getCenter() const
+{
+	return mCenter;
+}
+
+void Collider::setRadius(float radius)
+{
+	mRadius = std::max(radius, 0.0f);
+}
+
+float Collider::getRadius() const
+{
+	return mRadius;
+}
+
+void Collider::setHalfExtents(const QVector3D& halfExtents)
+{
+	mHalfExtents = QVector3D(std::abs(halfExtents.x()), std::abs(halfExtents.y()), std::abs(halfExtents.z()));
+}
+
+QVector3D Collider::getHalfExtents() const
+{
+	return mHalfExtents;
+}
+
+void Collider::setHalfHeight(float halfHeight)
+{
+	mHalfHeight = std::max(halfHeight, 0.0f);
+}
+
+float Collider::getHalfHeight() const
+{
+	return mHalfHeight;
+}
+
+ColliderData Collider::getColliderData()
+{
+	QVector3D scale = transform->getWorldScale();
+	scale = QVector3D(std::abs(scale.x()), std::abs(scale.y()), std::abs(scale.z()));
+
+	ColliderData collider;
+	collider.shape = mShape;
+	collider.rotation = transform->getWorldRotation();
+	collider.center = transform->getWorldPosition() + collider.rotation.rotatedVector(mCenter * scale);
+	collider.halfExtents = mHalfExtents * scale;
+	collider.radius = mShape == ColliderShape::CAPSULE
+		? mRadius * std::max(scale.x(), scale.z())
+		: mRadius * std::max({ scale.x(), scale.y(), scale.z() });
+	collider.halfHeight = mHalfHeight * scale.y();
+	return collider;
+}
+
+void Collider::setBodyIndex(int bodyIndex)
+{
+	mBodyIndex = bodyIndex;
+}
+
+int Collider::getBodyIndex() const
+{
+	return mBodyIndex;
+}
+
+RigidBody* Collider::getRigidBody() const
+{
+	return mRigidBody;
+}
+
+void Collider::write(QJsonObject& json) const
+{
+}
+
+void Collider::read(const QJsonObject& json)
+{
+}
+
+void* Collider::accept(INodeVisitor* visitor)
+{
+	return visitor->visitCollider(this);
+}
@@ -10,20 +10,15 @@ Container::~Container() noexcept
 {
 }
 
-void Container::setParent(Node* parent)
+void Container::storePreviousState()
 {
-    Node::setParent(parent);
+    transform->storePreviousState();
+}
 
-    // Check if the parent is an instance of Container
-    Container* parentContainer = dynamic_cast<Container*>(parent);
-    if (parentContainer)
-    {
-        transform->setParent(parentContainer->transform.get());
-    }
-    else
-    {
-        transform->setParent(nullptr);
-    }
+void Container::onParentChanged()
+{
+    Container* parentContainer = dynamic_cast<Container*>(mParent);
+    transform->setParent(parentContainer ? parentContainer->transform.get() : nullptr);
 }
 
 void Container::write(QJsonObject& json) const
@@ -0,0 +1,154 @@
+#include "Engine/Nodes/Light.h"
+#include "Engine/Interfaces/IScene.h"
+#include "Engine/Renders/RenderSnapshot.h"
+
+#include <algorithm>
+#include <cmath>
+#include <QtMath>
+
+Light::Light() : Light(LightType::POINT)
+{
+}
+
+Light::Light(LightType type) : Container()
+{
+	mType = type;
+	mColor = QColor(255, 255, 255);
+	mIntensity = 1.0f;
+	mRange = 10.0f;
+	mInnerAngle = 30.0f;
+	mOuterAngle = 45.0f;
+	mIsCastingShadows = false;
+
+	setName("Light");
+}
+
+Light::~Light() noexcept
+{
+}
+
+void Light::setType(LightType type)
+{
+	mType = type;
+}
+
+LightType Light::getType() const
+{
+	return mType;
+}
+
+void Light::setColor(const QColor& color)
+{
+	mColor = color;
+}
+
+QColor Light::getColor() const
+{
+	return mColor;
+}
+
+void Light::setIntensity(float intensity)
+{
+	mIntensity = std::max(intensity, 0.0f);
+}
+
+float Light::getIntensity() const
+{
+	return mIntensity;
+}
+
+void Light::setRange(float range)
+{
+	mRange = std::max(range, 0.0f);
+}
+
+float Light::getRange() const
+{
+	return mRange;
+}
+
+void Light::setSpotAngles(float innerAngle, float outerAngle)
+{
+	mOuterAngle = std::clamp(outerAngle, 0.0f, 179.0f);
+	mInnerAngle = std::clamp(innerAngle, 0.0f, mOuterAngle);
+}
+
+float Light::getInnerAngle() const
+{
+	return mInnerAngle;
+}
+
+float Light::getOuterAngle() const
+{
+	return mOuterAngle;
+}
+
+void Light::setIsCastingShadows(bool isCastingShadows)
+{
+	mIsCastingShadows = isCastingShadows;
+}
+
+bool Light::getIsCastingShadows() const
+{
+	return mIsCastingShadows;
+}
+
+LightData Light::getLightData(float alpha)
+{
+	LightData light;
+	light.type = mType;
+	light.position = transform->getInterpolatedWorldPosition(alpha);
+	light.direction = (transform->getInterpolatedWorldRotation(alpha) * QVector3D(0.0f, 0.0f, -1.0f)).normalized();
+	light.color = QVector3D(mColor.redF(), mColor.greenF(), mColor.blueF()) * mIntensity;
+	light.range = mRange;
+	light.isCastingShadows = mIsCastingShadows && mType == LightType::DIRECTIONAL;
+
+	if (mType == LightType::SPOT)
+	{
+		light.innerConeCos = std::cos(qDegreesToRadians(mInnerAngle) * 0.5f);
+		light.outerConeCos = std::cos(qDegreesToRadians(mOuterAngle) * 0.5f);
+	}
+	else
+	{
+		// Every direction passes the cone test
+		light.innerConeCos = -1.0f;
+		light.outerConeCos = -2.0f;
+	}
+	return light;
+}
+
+void Light::render(ShaderProgram& shaderProgram)
+{
+	if (!mScenePtr || mIntensity <= 0.0f)
+		return;
+
+	mScenePtr->getLighting()->submit(getLightData(mScenePtr->getInterpolationAlpha()));
+}
+
+void Light::snapshot(RenderSnapshot& snapshot)
+{
+	if (mIntensity <= 0.0f)
+		return;
+
+	LightItem item;
+	item.light = getLightData(1.0f);
+	if (mType != LightType::DIRECTIONAL && !snapshot.frustum.intersectsSphere(item.light.position, mRange))
+		return;
+
+	item.previousPosition = transform->getPreviousWorldPosition();
+	item.previousDirection = (transform->getPreviousWorldRotation() * QVector3D(0.0f, 0.0f, -1.0f)).normalized();
+	snapshot.lights.push_back(item);
+}
+
+void Light::write(QJsonObject& json) const
+{
+}
+
+void Light::read(const QJsonObject& json)
+{
+}
+
+void* Light::accept(INodeVisitor* visitor)
+{
+	return visitor->visitLight(this);
+}
@@ -1,10 +1,15 @@
 
 #include "Engine/Nodes/MeshRenderer.h"
+#include "Engine/Interfaces/IScene.h"
+#include "Engine/Renders/RenderSnapshot.h"
+
+#include <algorithm>
 
 MeshRenderer::MeshRenderer() : Container()
 {
 	mPolygonMode = PolygonMode::FILL;
 	mDrawBufferMode = DrawBufferMode::FRONT_AND_BACK;
+	mIsStatic = false;
 
 	setName("Mesh Renderer");
 }
@@ -14,6 +19,7 @@ MeshRenderer::MeshRenderer(std::shared_ptr<Mesh> meshID) : Container()
 	mMesh = meshID;
 	mPolygonMode = PolygonMode::FILL;
 	mDrawBufferMode = DrawBufferMode::FRONT_AND_BACK;
+	mIsStatic = false;
 
 	setName("Mesh Renderer");
 }
@@ -41,10 +47,46 @@ void MeshRenderer::setRenderMode(PolygonMode polygonMode, DrawBufferMode drawBuf
 {
 	mPolygonMode = polygonMode;
 	mDrawBufferMode = drawBufferMode;
+
+	// Both modes are part of the material, so a change swaps in the matching interned instance
+	if (mIsStarted && mScenePtr)
+	{
+		mMaterial = mScenePtr->getMaterialLibrary()->withPolygonMode(mMaterial, mPolygonMode, mDrawBufferMode);
+	}
+}
+
+void MeshRenderer::setMaterial(std::shared_ptr<Material> material)
+{
+	mMaterial = material;
+	if (mIsStarted && mScenePtr && mMaterial)
+	{
+		mMaterial = mScenePtr->getMaterialLibrary()->intern(*mMaterial);
+		mMaterial = mScenePtr->getMaterialLibrary()->withPolygonMode(mMaterial, mPolygonMode, mDrawBufferMode);
+	}
+}
+
+std::shared_ptr<Material> MeshRenderer::getMaterial() const
+{
+	return mMaterial;
+}
+
+void MeshRenderer::setIsStatic(bool isStatic)
+{
+	mIsStatic = isStatic;
+}
+
+bool MeshRenderer::getIsStatic() const
+{
+	return mIsStatic;
 }
 
 void MeshRenderer::start(IScene* scene)
 {
+	Container::start(scene);
+
+	MaterialLibrary* materialLibrary = scene->getMaterialLibrary();
+	mMaterial = mMaterial ? materialLibrary->intern(*mMaterial) : materialLibrary->getDefaultMaterial();
+	mMaterial = materialLibrary->withPolygonMode(mMaterial, mPolygonMode, mDrawBufferMode);
 }
 
 void MeshRenderer::update(float deltaTime)
@@ -54,12 +96,71 @@ void MeshRenderer::update(float deltaTime)
 
 void MeshRenderer::render(ShaderProgram& shaderProgram)
 {
-	QMatrix4x4 world = transform->getWorldMatrix();
-	shaderProgram.setUniformValue("mWorld", world);
+	// Dynamic meshes are drawn between their last two simulation states
+	QMatrix4x4 world = mScenePtr && !mIsStatic ? transform->getInterpolatedWorldMatrix(mScenePtr->getInterpolationAlpha()) : transform->getWorldMatrix();
+	if (mScenePtr)
+	{
+		mScenePtr->getShadows()->submit(mMesh.get(), mMaterial.get(), world, mIsStatic);
+		mScenePtr->getSpatialIndex()->insert(this, mMesh.get(), world);
+	}
+
+	if (mIsStatic && mScenePtr && mMaterial && mScenePtr->getMaterialLibrary()->getIsIndirectCompatible(*mMaterial))
+	{
+		IndirectRenderer* indirectRenderer = mScenePtr->getIndirectRenderer();
+		if (indirectRenderer && indirectRenderer->submit(*mMesh, world, mPolygonMode))
+			return;
+	}
+
+	// Queued draws are sorted by material and issued after the traversal
+	if (mScenePtr && mMaterial)
+	{
+		mScenePtr->getRenderQueue()->submit(mMesh.get(), mMaterial.get(), world);
+		return;
+	}
 
+	shaderProgram.setUniformValue("mWorld", world);
 	mMesh->draw(shaderProgram);
+}
+
+void MeshRenderer::snapshot(RenderSnapshot& snapshot)
+{
+	if (!mMesh)
+		return;
 
-	glPolygonMode(static_cast<GLenum>(mDrawBufferMode), static_cast<GLenum>(mPolygonMode));
+	QVector3D position = transform->getWorldPosition();
+	QVector3D previousPosition = transform->getPreviousWorldPosition();
+	QVector3D scale = transform->getWorldScale();
+
+	// Cull the sphere swept between the two poses the renderer may interpolate across
+	QVector4D sphere = mMesh->getBoundingSphere();
+	QMatrix4x4 world = transform->getWorldMatrix();
+	QVector3D center = world.map(sphere.toVector3D());
+	float radius = sphere.w() * std::max({ std::abs(scale.x()), std::abs(scale.y()), std::abs(scale.z()) });
+	if (!mIsStatic)
+	{
+		QVector3D offset = (previousPosition - position) * 0.5f;
+		center += offset;
+		radius += offset.length();
+	}
+	bool isVisible = snapshot.frustum.intersectsSphere(center, radius);
+	if (!isVisible && !snapshot.isShadowCasting)
+		return;
+
+	RenderItem item;
+	item.mesh = mMesh;
+	item.node = this;
+	item.material = mMaterial;
+	item.polygonMode = mPolygonMode;
+	item.isStatic = mIsStatic;
+	item.isVisible = isVisible;
+	item.world = world;
+	item.previousPosition = previousPosition;
+	item.previousRotation = transform->getPreviousWorldRotation();
+	item.previousScale = transform->getPreviousWorldScale();
+	item.position = position;
+	item.rotation = transform->getWorldRotation();
+	item.scale = scale;
+	snapshot.items.push_back(std::move(item));
 }
 
 void MeshRenderer::write(QJsonObject& json) const
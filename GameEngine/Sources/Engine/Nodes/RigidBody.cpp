@@ -0,0 +1,270 @@
+#include "Engine/Nodes/RigidBody.h"
+#include "Engine/Interfaces/IScene.h"
+#include "Engine/Nodes/Collider.h"
+
+#include <algorithm>
+
+RigidBody::RigidBody() : Container()
+{
+	mMass = 1.0f;
+	mIsKinematic = false;
+	mFriction = 0.5f;
+	mRestitution = 0.0f;
+	mLinearDamping = 0.0f;
+	mAngularDamping = 0.05f;
+	mGravityScale = 1.0f;
+	mBodyIndex = -1;
+
+	setName("RigidBody");
+}
+
+RigidBody::~RigidBody() noexcept
+{
+	if (mScenePtr && mBodyIndex >= 0)
+	{
+		mScenePtr->getPhysicsWorld()->remove(this);
+	}
+}
+
+void RigidBody::clear()
+{
+	if (mScenePtr && mBodyIndex >= 0)
+	{
+		mLinearVelocity = getLinearVelocity();
+		mAngularVelocity = getAngularVelocity();
+		mScenePtr->getPhysicsWorld()->remove(this);
+	}
+
+	// Registers again on the next start
+	mIsStarted = false;
+	Container::clear();
+}
+
+void RigidBody::start(IScene* scene)
+{
+	Container::start(scene);
+
+	if (mScenePtr && mBodyIndex < 0)
+	{
+		PhysicsWorld* world = mScenePtr->getPhysicsWorld();
+		int body = world->add(this);
+		world->setLinearVelocity(body, mLinearVelocity);
+		world->setAngularVelocity(body, mAngularVelocity);
+	}
+}
+
+void RigidBody::updateBody()
+{
+	if (mScenePtr && mBodyIndex >= 0)
+	{
+		mScenePtr->getPhysicsWorld()->updateBody(mBodyIndex);
+	}
+}
+
+void RigidBody::setMass(float mass)
+{
+	mMass = std::max(mass, 0.0001f);
+	updateBody();
+}
+
+float RigidBody::getMass() const
+{
+	return mMass;
+}
+
+void RigidBody::setIsKinematic(bool isKinematic)
+{
+	mIsKinematic = isKinematic;
+	updateBody();
+}
+
+bool RigidBody::getIsKinematic() const
+{
+	return mIsKinematic;
+}
+
+void RigidBody::setFriction(float friction)
+{
+	mFriction = std::max(friction, 0.0f);
+	updateBody();
+}
+
+float RigidBody::getFriction() const
+{
+	return mFriction;
+}
+
+void RigidBody::setRestitution(float restitution)
+{
+	mRestitution = std::clamp(restitution, 0.0f, 1.0f);
+	updateBody();
+}
+
+float RigidBody::getRestitution() const
+{
+	return mRestitution;
+}
+
+void RigidBody::setLinearDamping(float damping)
+{
+	mLinearDamping = std::max(damping, 0.0f);
+	updateBody();
+}
+
+float RigidBody::getLinearDamping() const
+{
+	return mLinearDamping;
+}
+
+void RigidBody::setAngularDamping(float damping)
+{
+	mAngularDamping = std::max(damping, 0.0f);
+	updateBody();
+}
+
+float RigidBody::getAngularDamping() const
+{
+	return mAngularDamping;
+}
+
+void RigidBody::setGravityScale(float gravityScale)
+{
+	mGravityScale = gravityScale;
+	updateBody();
+}
+
+float RigidBody::getGravityScale() const
+{
+	return mGravityScale;
+}
+
+void RigidBody::setLinearVelocity(const QVector3D& velocity)
+{
+	if (mScenePtr && mBodyIndex >= 0)
+	{
+		mScenePtr->getPhysicsWorld()->setLinearVelocity(mBodyIndex, velocity);
+	}
+	else
+	{
+		mLinearVelocity = velocity;
+	}
+}
+
+QVector3D RigidBody::getLinearVelocity() const
+{
+	if (mScenePtr && mBodyIndex >= 0)
+	{
+		return mScenePtr->getPhysicsWorld()->getLinearVelocity(mBodyIndex);
+	}
+	return mLinearVelocity;
+}
+
+void RigidBody::setAngularVelocity(const QVector3D& velocity)
+{
+	if (mScenePtr && mBodyIndex >= 0)
+	{
+		mScenePtr->getPhysicsWorld()->setAngularVelocity(mBodyIndex, velocity);
+	}
+	else
+	{
+		mAngularVelocity = velocity;
+	}
+}
+
+QVector3D RigidBody::getAngularVelocity() const
+{
+	if (mScenePtr && mBodyIndex >= 0)
+	{
+		return mScenePtr->getPhysicsWorld()->getAngularVelocity(mBodyIndex);
+	}
+	return mAngularVelocity;
+}
+
+void RigidBody::addForce(const QVector3D& force)
+{
+	if (mScenePtr && mBodyIndex >= 0)
+	{
+		mScenePtr->getPhysicsWorld()->addForce(mBodyIndex, force);
+	}
+}
+
+void RigidBody::addTorque(const QVector3D& torque)
+{
+	if (mScenePtr && mBodyIndex >= 0)
+	{
+		mScenePtr->getPhysicsWorld()->addTorque(mBodyIndex, torque);
+	}
+}
+
+void RigidBody::addImpulse(const QVector3D& impulse, const QVector3D& point)
+{
+	if (mScenePtr && mBodyIndex >= 0)
+	{
+		mScenePtr->getPhysicsWorld()->addImpulse(mBodyIndex, impulse, point);
+	}
+}
+
+QVector3D RigidBody::computeInertia()
+{
+	Collider* collider = nullptr;
+	for (Node* child : getChildren())
+	{
+		collider = dynamic_cast<Collider*>(child);
+		if (collider)
+			break;
+	}
+
+	if (!collider)
+	{
+		float moment = 0.4f * mMass * 0.25f;
+		return QVector3D(moment, moment, moment);
+	}
+
+	ColliderData shape = collider->getColliderData();
+	switch (shape.shape)
+	{
+	case ColliderShape::SPHERE:
+	{
+		float moment = 0.4f * mMass * shape.radius * shape.radius;
+		return QVector3D(moment, moment, moment);
+	}
+	case ColliderShape::AABB:
+	case ColliderShape::OBB:
+	{
+		QVector3D squared = shape.halfExtents * shape.halfExtents;
+		return mMass / 3.0f * QVector3D(squared.y() + squared.z(), squared.x() + squared.z(), squared.x() + squared.y());
+	}
+	case ColliderShape::CAPSULE:
+	{
+		// As a cylinder spanning the caps, along Y
+		float radiusSquared = shape.radius * shape.radius;
+		float length = 2.0f * (shape.halfHeight + shape.radius);
+		float across = mMass * (3.0f * radiusSquared + length * length) / 12.0f;
+		return QVector3D(across, 0.5f * mMass * radiusSquared, across);
+	}
+	}
+	return QVector3D(1.0f, 1.0f, 1.0f);
+}
+
+void RigidBody::setBodyIndex(int bodyIndex)
+{
+	mBodyIndex = bodyIndex;
+}
+
+int RigidBody::getBodyIndex() const
+{
+	return mBodyIndex;
+}
+
+void RigidBody::write(QJsonObject& json) const
+{
+}
+
+void RigidBody::read(const QJsonObject& json)
+{
+}
+
+void* RigidBody::accept(INodeVisitor* visitor)
+{
+	return visitor->visitRigidBody(this);
+}
@@ -0,0 +1,496 @@
+#include "Engine/Physics/CollisionWorld.h"
+#include "Engine/Nodes/Collider.h"
+#include "Engine/Physics/Narrowphase.h"
+#include "Engine/Profiling/Profiler.h"
+#include "Engine/Threading/ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <QElapsedTimer>
+
+CollisionWorld::CollisionWorld() : mAxis(0), mIsOrderDirty(true), mIsMultithreaded(true)
+{
+}
+
+CollisionWorld::~CollisionWorld()
+{
+	clear();
+}
+
+void CollisionWorld::clear()
+{
+	for (Collider* collider : mColliders)
+	{
+		if (collider)
+		{
+			collider->setBodyIndex(-1);
+		}
+	}
+
+	mShapes.clear();
+	mColliders.clear();
+	mBounds.clear();
+	mSortedBounds.clear();
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		mCellMin[axis].clear();
+		mCellMax[axis].clear();
+	}
+	mOrder.clear();
+	mIsOrderDirty = true;
+	mCellStarts.clear();
+	mCellBodies.clear();
+	mCellFill.clear();
+	mChunkPairs.clear();
+	mChunkContacts.clear();
+	mPairs.clear();
+	mContacts.clear();
+	mStats = CollisionStats();
+}
+
+int CollisionWorld::add(Collider* collider)
+{
+	if (collider->getBodyIndex() >= 0)
+		return collider->getBodyIndex();
+
+	int body = addBody(collider->getColliderData());
+	mColliders[body] = collider;
+	collider->setBodyIndex(body);
+	return body;
+}
+
+void CollisionWorld::remove(Collider* collider)
+{
+	int body = collider->getBodyIndex();
+	if (body < 0 || body >= getBodyCount() || mColliders[body] != collider)
+		return;
+
+	removeBody(body);
+	collider->setBodyIndex(-1);
+}
+
+int CollisionWorld::addBody(const ColliderData& shape)
+{
+	mShapes.push_back(shape);
+	mColliders.push_back(nullptr);
+	mIsOrderDirty = true;
+	return static_cast<int>(mShapes.size()) - 1;
+}
+
+void CollisionWorld::setBody(int body, const ColliderData& shape)
+{
+	mShapes[body] = shape;
+}
+
+void CollisionWorld::removeBody(int body)
+{
+	int last = getBodyCount() - 1;
+	if (body != last)
+	{
+		mShapes[body] = mShapes[last];
+		mColliders[body] = mColliders[last];
+		if (mColliders[body])
+		{
+			mColliders[body]->setBodyIndex(body);
+		}
+	}
+	mShapes.pop_back();
+	mColliders.pop_back();
+	mIsOrderDirty = true;
+
+	// Last step's results may name the removed body
+	mPairs.clear();
+	mContacts.clear();
+}
+
+const ColliderData& CollisionWorld::getBody(int body) const
+{
+	return mShapes[body];
+}
+
+Collider* CollisionWorld::getCollider(int body) const
+{
+	return mColliders[body];
+}
+
+int CollisionWorld::getBodyCount() const
+{
+	return static_cast<int>(mShapes.size());
+}
+
+void CollisionWorld::setIsMultithreaded(bool isMultithreaded)
+{
+	mIsMultithreaded = isMultithreaded;
+}
+
+bool CollisionWorld::getIsMultithreaded() const
+{
+	return mIsMultithreaded;
+}
+
+void CollisionWorld::step()
+{
+	PROFILE_SCOPE("CollisionWorld::step");
+
+	mStats = CollisionStats();
+	mStats.bodies = getBodyCount();
+	bool isParallel = mIsMultithreaded && mStats.bodies >= PARALLEL_BODIES;
+
+	QElapsedTimer timer;
+	timer.start();
+	updateBounds(isParallel);
+	sortBodies();
+	sweep(isParallel);
+	mStats.broadphaseMs = timer.nsecsElapsed() / 1000000.0;
+
+	timer.restart();
+	collidePairs(isParallel);
+	mStats.narrowphaseMs = timer.nsecsElapsed() / 1000000.0;
+
+	mStats.pairs = static_cast<int>(mPairs.size());
+	mStats.contacts = static_cast<int>(mContacts.size());
+}
+
+const std::vector<CollisionPair>& CollisionWorld::getPairs() const
+{
+	return mPairs;
+}
+
+const std::vector<Contact>& CollisionWorld::getContacts() const
+{
+	return mContacts;
+}
+
+const CollisionStats& CollisionWorld::getStats() const
+{
+	return mStats;
+}
+
+void CollisionWorld::updateBounds(bool isParallel)
+{
+	int count = getBodyCount();
+	mBounds.resize(count);
+
+	ParallelFor::run(count, BOUNDS_GRAIN, [this](int, int begin, int end) {
+		for (int body = begin; body < end; ++body)
+		{
+			Collider* collider = mColliders[body];
+			if (collider && !collider->getIsAlive())
+			{
+				// Inverted bounds overlap nothing and sort to the end
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					mBounds[body].min[axis] = std::numeric_limits<float>::max();
+					mBounds[body].max[axis] = -std::numeric_limits<float>::max();
+				}
+				continue;
+			}
+
+			if (collider)
+			{
+				mShapes[body] = collider->getColliderData();
+			}
+
+			QVector3D boundsMin;
+			QVector3D boundsMax;
+			Narrowphase::getBounds(mShapes[body], boundsMin, boundsMax);
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				mBounds[body].min[axis] = boundsMin[axis];
+				mBounds[body].max[axis] = boundsMax[axis];
+			}
+		}
+	}, isParallel);
+}
+
+void CollisionWorld::sortBodies()
+{
+	int count = getBodyCount();
+	bool isResorted = mIsOrderDirty || static_cast<int>(mOrder.size()) != count;
+
+	// Ties are broken by index, so the order does not depend on the order it came from
+	auto isBefore = [](const SortEntry& a, const SortEntry& b) {
+		return a.key < b.key || (a.key == b.key && a.body < b.body);
+	};
+
+	if (!isResorted)
+	{
+		for (SortEntry& entry : mOrder)
+		{
+			entry.key = mBounds[entry.body].min[mAxis];
+		}
+
+		int budget = count * MAX_SHIFTS_PER_BODY;
+		for (int i = 1; i < count && !isResorted; ++i)
+		{
+			SortEntry entry = mOrder[i];
+			int j = i;
+			while (j > 0 && isBefore(entry, mOrder[j - 1]))
+			{
+				mOrder[j] = mOrder[j - 1];
+				--j;
+				if (++mStats.sortShifts > budget)
+				{
+					isResorted = true;
+					break;
+				}
+			}
+			mOrder[j] = entry;
+		}
+	}
+
+	if (isResorted)
+	{
+		// The axis is picked again whenever the order is rebuilt
+		double sums[3] = {};
+		double squares[3] = {};
+		int liveCount = 0;
+		for (int body = 0; body < count; ++body)
+		{
+			if (mBounds[body].min[0] > mBounds[body].max[0])
+				continue;
+
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				double center = 0.5 * (static_cast<double>(mBounds[body].min[axis]) + mBounds[body].max[axis]);
+				sums[axis] += center;
+				squares[axis] += center * center;
+			}
+			liveCount++;
+		}
+		if (liveCount > 0)
+		{
+			double bestVariance = -1.0;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				double mean = sums[axis] / liveCount;
+				double variance = squares[axis] / liveCount - mean * mean;
+				if (variance > bestVariance)
+				{
+					bestVariance = variance;
+					mAxis = axis;
+				}
+			}
+		}
+
+		mOrder.resize(count);
+		for (int body = 0; body < count; ++body)
+		{
+			mOrder[body] = { mBounds[body].min[mAxis], body };
+		}
+		std::sort(mOrder.begin(), mOrder.end(), isBefore);
+		mIsOrderDirty = false;
+	}
+	mStats.isResorted = isResorted;
+}
+
+void CollisionWorld::sweep(bool isParallel)
+{
+	int count = getBodyCount();
+	const int axes[3] = { mAxis, (mAxis + 1) % 3, (mAxis + 2) % 3 };
+
+	// The grid spans the live bodies on the two other axes
+	float gridMin[2] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+	float gridMax[2] = { -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() };
+	for (int body = 0; body < count; ++body)
+	{
+		if (mBounds[body].min[0] > mBounds[body].max[0])
+			continue;
+
+		for (int i = 0; i < 2; ++i)
+		{
+			gridMin[i] = std::min(gridMin[i], mBounds[body].min[axes[i + 1]]);
+			gridMax[i] = std::max(gridMax[i], mBounds[body].max[axes[i + 1]]);
+		}
+	}
+
+	int side = std::clamp(static_cast<int>(std::sqrt(count / static_cast<float>(CELL_BODIES))), 1, static_cast<int>(MAX_GRID_SIDE));
+	float cellScale[2];
+	for (int i = 0; i < 2; ++i)
+	{
+		float extent = gridMax[i] - gridMin[i];
+		cellScale[i] = extent > 0.0f ? side / extent : 0.0f;
+	}
+	auto getCell = [&gridMin, &cellScale, side](int i, float value) {
+		return std::clamp(static_cast<int>((value - gridMin[i]) * cellScale[i]), 0, side - 1);
+	};
+
+	// Bucketed in sweep order, which keeps every cell's list sorted as well, with each cell's
+	// bounds copied next to each other so its sweep walks memory forwards. The first pass also
+	// copies the bounds into sweep order, so the second one reads them in sequence.
+	int cellCount = side * side;
+	mCellStarts.assign(cellCount + 1, 0);
+	mSortedBounds.resize(count);
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		for (int index = 0; index < count; ++index)
+		{
+			int body = mOrder[index].body;
+			if (pass == 0)
+			{
+				mSortedBounds[index] = mBounds[body];
+			}
+
+			const Bounds& bounds = mSortedBounds[index];
+			if (bounds.min[0] > bounds.max[0])
+				continue;
+
+			int firstX = getCell(0, bounds.min[axes[1]]);
+			int lastX = getCell(0, bounds.max[axes[1]]);
+			int firstY = getCell(1, bounds.min[axes[2]]);
+			int lastY = getCell(1, bounds.max[axes[2]]);
+			for (int y = firstY; y <= lastY; ++y)
+			{
+				for (int x = firstX; x <= lastX; ++x)
+				{
+					int cell = y * side + x;
+					if (pass == 0)
+					{
+						mCellStarts[cell + 1]++;
+						continue;
+					}
+
+					int position = mCellFill[cell]++;
+					mCellBodies[position] = body;
+					for (int i = 0; i < 3; ++i)
+					{
+						mCellMin[i][position] = bounds.min[axes[i]];
+						mCellMax[i][position] = bounds.max[axes[i]];
+					}
+				}
+			}
+		}
+
+		if (pass == 0)
+		{
+			for (int cell = 0; cell < cellCount; ++cell)
+			{
+				mCellStarts[cell + 1] += mCellStarts[cell];
+			}
+			int entryCount = mCellStarts[cellCount];
+			mCellBodies.resize(entryCount);
+			for (int i = 0; i < 3; ++i)
+			{
+				mCellMin[i].resize(entryCount);
+				mCellMax[i].resize(entryCount);
+			}
+			mCellFill.assign(mCellStarts.begin(), mCellStarts.end() - 1);
+		}
+	}
+
+	mChunkPairs.resize(ParallelFor::getChunkCount(cellCount, CELL_GRAIN));
+	ParallelFor::run(cellCount, CELL_GRAIN, [&](int chunk, int begin, int end) {
+		std::vector<CollisionPair>& pairs = mChunkPairs[chunk];
+		pairs.clear();
+		const float* min0 = mCellMin[0].data();
+		const float* max0 = mCellMax[0].data();
+		const float* min1 = mCellMin[1].data();
+		const float* max1 = mCellMax[1].data();
+		const float* min2 = mCellMin[2].data();
+		const float* max2 = mCellMax[2].data();
+		for (int cell = begin; cell < end; ++cell)
+		{
+			int cellEnd = mCellStarts[cell + 1];
+			for (int i = mCellStarts[cell]; i < cellEnd; ++i)
+			{
+				// Everything starting before this body ends on the swept axis, the other two checked here
+				for (int j = i + 1; j < cellEnd && min0[j] <= max0[i]; ++j)
+				{
+					if (min1[j] > max1[i] || max1[j] < min1[i] || min2[j] > max2[i] || max2[j] < min2[i])
+						continue;
+
+					// Bodies spanning several cells meet in each; only the cell holding the start
+					// of their overlap reports them
+					int owner = getCell(1, std::max(min2[i], min2[j])) * side + getCell(0, std::max(min1[i], min1[j]));
+					if (owner != cell)
+						continue;
+
+					int bodyA = mCellBodies[i];
+					int bodyB = mCellBodies[j];
+					pairs.push_back({ std::min(bodyA, bodyB), std::max(bodyA, bodyB) });
+				}
+			}
+		}
+	}, isParallel);
+
+	mPairs.clear();
+	for (const auto& pairs : mChunkPairs)
+	{
+		mPairs.insert(mPairs.end(), pairs.begin(), pairs.end());
+	}
+}
+
+void CollisionWorld::collidePairs(bool isParallel)
+{
+	int pairCount = static_cast<int>(mPairs.size());
+	mChunkContacts.resize(ParallelFor::getChunkCount(pairCount, NARROWPHASE_GRAIN));
+	ParallelFor::run(pairCount, NARROWPHASE_GRAIN, [this](int chunk, int begin, int end) {
+		std::vector<Contact>& contacts = mChunkContacts[chunk];
+		contacts.clear();
+
+		auto addContact = [this, &contacts](const CollisionPair& pair, const ContactPoint& point) {
+			Contact contact;
+			contact.bodyA = pair.bodyA;
+			contact.bodyB = pair.bodyB;
+			contact.colliderA = mColliders[pair.bodyA];
+			contact.colliderB = mColliders[pair.bodyB];
+			contact.normal = point.normal;
+			contact.point = point.point;
+			contact.depth = point.depth;
+			contacts.push_back(contact);
+		};
+
+		// Sphere pairs are gathered and tested a batch at a time, everything else one by one
+		const ColliderData* spheresA[Narrowphase::BATCH_SIZE];
+		const ColliderData* spheresB[Narrowphase::BATCH_SIZE];
+		int batchPairs[Narrowphase::BATCH_SIZE];
+		ContactPoint batchPoints[Narrowphase::BATCH_SIZE];
+		int batchCount = 0;
+		auto flush = [&]() {
+			int mask = Narrowphase::collideSpheres(spheresA, spheresB, batchCount, batchPoints);
+			for (int i = 0; i < batchCount; ++i)
+			{
+				if (mask & (1 << i))
+				{
+					addContact(mPairs[batchPairs[i]], batchPoints[i]);
+				}
+			}
+			batchCount = 0;
+		};
+
+		for (int index = begin; index < end; ++index)
+		{
+			const CollisionPair& pair = mPairs[index];
+			const ColliderData& a = mShapes[pair.bodyA];
+			const ColliderData& b = mShapes[pair.bodyB];
+			if (a.shape == ColliderShape::SPHERE && b.shape == ColliderShape::SPHERE)
+			{
+				spheresA[batchCount] = &a;
+				spheresB[batchCount] = &b;
+				batchPairs[batchCount] = index;
+				if (++batchCount == Narrowphase::BATCH_SIZE)
+				{
+					flush();
+				}
+				continue;
+			}
+
+			ContactPoint point;
+			if (Narrowphase::collide(a, b, point))
+			{
+				addContact(pair, point);
+			}
+		}
+		if (batchCount > 0)
+		{
+			flush();
+		}
+	}, isParallel);
+
+	mContacts.clear();
+	for (const auto& contacts : mChunkContacts)
+	{
+		mContacts.insert(mContacts.end(), contacts.begin(), contacts.end());
+	}
+}
@@ -0,0 +1,703 @@
+#include "Engine/Physics/Narrowphase.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define NARROWPHASE_SSE
+#endif
+
+namespace
+{
+	const float EPSILON = 1e-6f;
+	// Edge-edge axes have to separate clearly better than a face axis to be picked, or resting
+	// boxes flicker between face and edge normals
+	const float EDGE_AXIS_BIAS = 1.05f;
+	// A contact normal this close to a face normal is a face contact and gets a manifold
+	const float FACE_ALIGNMENT = 0.98f;
+
+	struct Box
+	{
+		QVector3D center;
+		QVector3D axes[3];
+		float halfExtents[3];
+	};
+
+	bool getIsBox(const ColliderData& shape)
+	{
+		return shape.shape == ColliderShape::AABB || shape.shape == ColliderShape::OBB;
+	}
+
+	Box makeBox(const ColliderData& shape)
+	{
+		Box box;
+		box.center = shape.center;
+		box.axes[0] = QVector3D(1.0f, 0.0f, 0.0f);
+		box.axes[1] = QVector3D(0.0f, 1.0f, 0.0f);
+		box.axes[2] = QVector3D(0.0f, 0.0f, 1.0f);
+		for (int i = 0; i < 3; ++i)
+		{
+			if (shape.shape == ColliderShape::OBB)
+			{
+				box.axes[i] = shape.rotation.rotatedVector(box.axes[i]);
+			}
+			box.halfExtents[i] = std::abs(shape.halfExtents[i]);
+		}
+		return box;
+	}
+
+	// A sphere is a capsule whose segment has no length
+	void getSegment(const ColliderData& shape, QVector3D& start, QVector3D& end)
+	{
+		QVector3D axis = shape.shape == ColliderShape::CAPSULE
+			? shape.rotation.rotatedVector(QVector3D(0.0f, shape.halfHeight, 0.0f))
+			: QVector3D();
+		start = shape.center - axis;
+		end = shape.center + axis;
+	}
+
+	// Closest points between two segments, as fractions along each
+	void closestSegmentPoints(const QVector3D& startA, const QVector3D& endA, const QVector3D& startB, const QVector3D& endB, float& s, float& t)
+	{
+		QVector3D directionA = endA - startA;
+		QVector3D directionB = endB - startB;
+		QVector3D offset = startA - startB;
+		float a = directionA.lengthSquared();
+		float e = directionB.lengthSquared();
+		float f = QVector3D::dotProduct(directionB, offset);
+
+		s = 0.0f;
+		t = 0.0f;
+		if (a <= EPSILON && e <= EPSILON)
+			return;
+
+		if (a <= EPSILON)
+		{
+			t = std::clamp(f / e, 0.0f, 1.0f);
+			return;
+		}
+
+		float c = QVector3D::dotProduct(directionA, offset);
+		if (e <= EPSILON)
+		{
+			s = std::clamp(-c / a, 0.0f, 1.0f);
+			return;
+		}
+
+		float b = QVector3D::dotProduct(directionA, directionB);
+		float denominator = a * e - b * b;
+		s = denominator > EPSILON ? std::clamp((b * f - c * e) / denominator, 0.0f, 1.0f) : 0.0f;
+		t = (b * s + f) / e;
+		if (t < 0.0f)
+		{
+			t = 0.0f;
+			s = std::clamp(-c / a, 0.0f, 1.0f);
+		}
+		else if (t > 1.0f)
+		{
+			t = 1.0f;
+			s = std::clamp((b - c) / a, 0.0f, 1.0f);
+		}
+	}
+
+	QVector3D closestPointOnBox(const Box& box, const QVector3D& point)
+	{
+		QVector3D offset = point - box.center;
+		QVector3D closest = box.center;
+		for (int i = 0; i < 3; ++i)
+		{
+			float distance = std::clamp(QVector3D::dotProduct(offset, box.axes[i]), -box.halfExtents[i], box.halfExtents[i]);
+			closest += box.axes[i] * distance;
+		}
+		return closest;
+	}
+
+	// Fraction along the segment closest to the box. The squared distance is a quadratic between
+	// the points where the segment crosses a face plane, so each piece is minimised in turn.
+	float closestSegmentBoxFraction(const Box& box, const QVector3D& start, const QVector3D& end)
+	{
+		float origin[3];
+		float direction[3];
+		float breaks[8] = { 0.0f, 1.0f };
+		int breakCount = 2;
+		for (int i = 0; i < 3; ++i)
+		{
+			origin[i] = QVector3D::dotProduct(start - box.center, box.axes[i]);
+			direction[i] = QVector3D::dotProduct(end - start, box.axes[i]);
+			if (std::abs(direction[i]) <= EPSILON)
+				continue;
+
+			for (float face : { -box.halfExtents[i], box.halfExtents[i] })
+			{
+				// Kept sorted as they come; there are six at most
+				float t = (face - origin[i]) / direction[i];
+				if (t <= 0.0f || t >= 1.0f)
+					continue;
+
+				int index = breakCount++;
+				for (; breaks[index - 1] > t; --index)
+				{
+					breaks[index] = breaks[index - 1];
+				}
+				breaks[index] = t;
+			}
+		}
+
+		float bestFraction = 0.0f;
+		float bestDistance = std::numeric_limits<float>::max();
+		for (int piece = 0; piece + 1 < breakCount; ++piece)
+		{
+			// Which side of each slab the piece is on decides the terms of its quadratic
+			float middle = 0.5f * (breaks[piece] + breaks[piece + 1]);
+			float slope = 0.0f;
+			float curvature = 0.0f;
+			float faces[3];
+			for (int i = 0; i < 3; ++i)
+			{
+				float value = origin[i] + direction[i] * middle;
+				faces[i] = value > box.halfExtents[i] ? box.halfExtents[i] : value < -box.halfExtents[i] ? -box.halfExtents[i] : value;
+				if (faces[i] != value)
+				{
+					slope += (origin[i] - faces[i]) * direction[i];
+					curvature += direction[i] * direction[i];
+				}
+			}
+			float t = curvature > EPSILON ? std::clamp(-slope / curvature, breaks[piece], breaks[piece + 1]) : breaks[piece];
+
+			float distance = 0.0f;
+			for (int i = 0; i < 3; ++i)
+			{
+				float value = origin[i] + direction[i] * t;
+				float excess = std::max(std::abs(value) - box.halfExtents[i], 0.0f);
+				distance += excess * excess;
+			}
+			if (distance < bestDistance)
+			{
+				bestDistance = distance;
+				bestFraction = t;
+			}
+		}
+		return bestFraction;
+	}
+
+	bool collideSpherePoints(const QVector3D& centerA, float radiusA, const QVector3D& centerB, float radiusB, ContactPoint& contact)
+	{
+		QVector3D offset = centerB - centerA;
+		float radii = radiusA + radiusB;
+		float distanceSquared = offset.lengthSquared();
+		if (distanceSquared > radii * radii)
+			return false;
+
+		float distance = std::sqrt(distanceSquared);
+		contact.normal = distance > EPSILON ? offset / distance : QVector3D(0.0f, 1.0f, 0.0f);
+		contact.depth = radii - distance;
+		contact.point = centerA + contact.normal * (radiusA - contact.depth * 0.5f);
+		return true;
+	}
+
+	// Normal from the box towards the sphere
+	bool collideBoxSphere(const Box& box, const QVector3D& center, float radius, ContactPoint& contact)
+	{
+		QVector3D offset = center - box.center;
+		float local[3];
+		bool isInside = true;
+		for (int i = 0; i < 3; ++i)
+		{
+			local[i] = QVector3D::dotProduct(offset, box.axes[i]);
+			isInside = isInside && std::abs(local[i]) <= box.halfExtents[i];
+		}
+
+		if (!isInside)
+		{
+			QVector3D closest = closestPointOnBox(box, center);
+			QVector3D difference = center - closest;
+			float distanceSquared = difference.lengthSquared();
+			if (distanceSquared > radius * radius)
+				return false;
+
+			float distance = std::sqrt(distanceSquared);
+			contact.normal = distance > EPSILON ? difference / distance : (offset.lengthSquared() > EPSILON ? offset.normalized() : QVector3D(0.0f, 1.0f, 0.0f));
+			contact.depth = radius - distance;
+			contact.point = closest - contact.normal * (contact.depth * 0.5f);
+			return true;
+		}
+
+		// Centre inside: out through the nearest face
+		int face = 0;
+		float faceDistance = std::numeric_limits<float>::max();
+		for (int i = 0; i < 3; ++i)
+		{
+			float distance = box.halfExtents[i] - std::abs(local[i]);
+			if (distance < faceDistance)
+			{
+				faceDistance = distance;
+				face = i;
+			}
+		}
+		contact.normal = local[face] >= 0.0f ? box.axes[face] : -box.axes[face];
+		contact.depth = radius + faceDistance;
+		contact.point = center + contact.normal * ((faceDistance - radius) * 0.5f);
+		return true;
+	}
+
+	// A segment outside the box is tested as a sphere at its point nearest the box. One reaching into the box is pushed out along the
+	// axis of least overlap among the box's faces and the crossings of the segment with them.
+	bool collideBoxRound(const Box& box, const ColliderData& round, ContactPoint& contact)
+	{
+		QVector3D start;
+		QVector3D end;
+		getSegment(round, start, end);
+		if (round.shape != ColliderShape::CAPSULE)
+			return collideBoxSphere(box, round.center, round.radius, contact);
+
+		QVector3D point = start + (end - start) * closestSegmentBoxFraction(box, start, end);
+		if ((point - closestPointOnBox(box, point)).lengthSquared() > EPSILON)
+			return collideBoxSphere(box, point, round.radius, contact);
+
+		QVector3D direction = end - start;
+		QVector3D offset = round.center - box.center;
+		float bestOverlap = std::numeric_limits<float>::max();
+		QVector3D bestAxis;
+		auto testAxis = [&](QVector3D axis) {
+			float lengthSquared = axis.lengthSquared();
+			if (lengthSquared < EPSILON)
+				return;
+
+			axis /= std::sqrt(lengthSquared);
+			float radius = round.radius + std::abs(QVector3D::dotProduct(direction, axis)) * 0.5f;
+			for (int i = 0; i < 3; ++i)
+			{
+				radius += box.halfExtents[i] * std::abs(QVector3D::dotProduct(box.axes[i], axis));
+			}
+			float distance = QVector3D::dotProduct(offset, axis);
+			float overlap = radius - std::abs(distance);
+			if (overlap < bestOverlap)
+			{
+				bestOverlap = overlap;
+				bestAxis = distance < 0.0f ? -axis : axis;
+			}
+		};
+		for (int i = 0; i < 3; ++i)
+		{
+			testAxis(box.axes[i]);
+			testAxis(QVector3D::crossProduct(direction, box.axes[i]));
+		}
+
+		contact.normal = bestAxis;
+		contact.depth = bestOverlap;
+		contact.point = point;
+		return true;
+	}
+
+	bool collideBoxes(const Box& boxA, const Box& boxB, ContactPoint& contact)
+	{
+		QVector3D offset = boxB.center - boxA.center;
+		float bestOverlap = std::numeric_limits<float>::max();
+		float bestScore = std::numeric_limits<float>::max();
+		QVector3D bestAxis;
+
+		auto testAxis = [&](QVector3D axis, float bias) {
+			float lengthSquared = axis.lengthSquared();
+			if (lengthSquared < EPSILON)
+				return true; // Parallel edges; a face axis covers it
+
+			axis /= std::sqrt(lengthSquared);
+			float radiusA = 0.0f;
+			float radiusB = 0.0f;
+			for (int i = 0; i < 3; ++i)
+			{
+				radiusA += boxA.halfExtents[i] * std::abs(QVector3D::dotProduct(boxA.axes[i], axis));
+				radiusB += boxB.halfExtents[i] * std::abs(QVector3D::dotProduct(boxB.axes[i], axis));
+			}
+			float distance = QVector3D::dotProduct(offset, axis);
+			float overlap = radiusA + radiusB - std::abs(distance);
+			if (overlap < 0.0f)
+				return false;
+
+			if (overlap * bias < bestScore)
+			{
+				bestScore = overlap * bias;
+				bestOverlap = overlap;
+				bestAxis = distance < 0.0f ? -axis : axis;
+			}
+			return true;
+		};
+
+		for (int i = 0; i < 3; ++i)
+		{
+			if (!testAxis(boxA.axes[i], 1.0f) || !testAxis(boxB.axes[i], 1.0f))
+				return false;
+		}
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				if (!testAxis(QVector3D::crossProduct(boxA.axes[i], boxB.axes[j]), EDGE_AXIS_BIAS))
+					return false;
+			}
+		}
+
+		contact.normal = bestAxis;
+		contact.depth = bestOverlap;
+		// One point for the whole overlap, between the parts of each box nearest the other's centre
+		contact.point = (closestPointOnBox(boxA, boxB.center) + closestPointOnBox(boxB, boxA.center)) * 0.5f;
+		return true;
+	}
+
+	// Face whose outward normal is nearest the direction; returns how well they line up
+	float findFace(const Box& box, const QVector3D& direction, int& axis, float& sign)
+	{
+		float best = -1.0f;
+		for (int i = 0; i < 3; ++i)
+		{
+			float alignment = QVector3D::dotProduct(box.axes[i], direction);
+			if (std::abs(alignment) > best)
+			{
+				best = std::abs(alignment);
+				axis = i;
+				sign = alignment < 0.0f ? -1.0f : 1.0f;
+			}
+		}
+		return best;
+	}
+
+	// Keeps the part of a convex polygon where dot(normal, p) <= offset; the output holds up to count + 1 points
+	int clipPolygon(const QVector3D* input, int count, const QVector3D& normal, float offset, QVector3D* output)
+	{
+		int outputCount = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			const QVector3D& current = input[i];
+			const QVector3D& next = input[(i + 1) % count];
+			float currentDistance = QVector3D::dotProduct(normal, current) - offset;
+			float nextDistance = QVector3D::dotProduct(normal, next) - offset;
+			if (currentDistance <= 0.0f)
+			{
+				output[outputCount++] = current;
+			}
+			if ((currentDistance <= 0.0f) != (nextDistance <= 0.0f))
+			{
+				output[outputCount++] = current + (next - current) * (currentDistance / (currentDistance - nextDistance));
+			}
+		}
+		return outputCount;
+	}
+
+	int getBoxManifold(const Box& boxA, const Box& boxB, const QVector3D& normal, ContactPoint* points)
+	{
+		int axisA = 0;
+		int axisB = 0;
+		float signA = 1.0f;
+		float signB = 1.0f;
+		float alignmentA = findFace(boxA, normal, axisA, signA);
+		float alignmentB = findFace(boxB, -normal, axisB, signB);
+		if (std::max(alignmentA, alignmentB) < FACE_ALIGNMENT)
+			return 0;
+
+		// The reference face is the one facing the normal best, A on a tie so it does not flip
+		bool isReferenceA = alignmentA + EPSILON >= alignmentB;
+		const Box& reference = isReferenceA ? boxA : boxB;
+		const Box& incident = isReferenceA ? boxB : boxA;
+		int referenceAxis = isReferenceA ? axisA : axisB;
+		QVector3D referenceNormal = reference.axes[referenceAxis] * (isReferenceA ? signA : signB);
+
+		int incidentAxis = 0;
+		float incidentSign = 1.0f;
+		findFace(incident, -referenceNormal, incidentAxis, incidentSign);
+		int u = (incidentAxis + 1) % 3;
+		int v = (incidentAxis + 2) % 3;
+		QVector3D faceCenter = incident.center + incident.axes[incidentAxis] * (incidentSign * incident.halfExtents[incidentAxis]);
+		QVector3D edgeU = incident.axes[u] * incident.halfExtents[u];
+		QVector3D edgeV = incident.axes[v] * incident.halfExtents[v];
+
+		QVector3D polygon[8] = { faceCenter + edgeU + edgeV, faceCenter - edgeU + edgeV, faceCenter - edgeU - edgeV, faceCenter + edgeU - edgeV };
+		QVector3D clipped[8];
+		int count = 4;
+		for (int side = 1; side < 3 && count > 0; ++side)
+		{
+			int axis = (referenceAxis + side) % 3;
+			float center = QVector3D::dotProduct(reference.axes[axis], reference.center);
+			count = clipPolygon(polygon, count, reference.axes[axis], center + reference.halfExtents[axis], clipped);
+			count = clipPolygon(clipped, count, -reference.axes[axis], reference.halfExtents[axis] - center, polygon);
+		}
+
+		// Only what is below the reference face touches
+		float faceOffset = QVector3D::dotProduct(referenceNormal, reference.center) + reference.halfExtents[referenceAxis];
+		QVector3D contactNormal = isReferenceA ? referenceNormal : -referenceNormal;
+		ContactPoint candidates[8];
+		int candidateCount = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			float separation = QVector3D::dotProduct(referenceNormal, polygon[i]) - faceOffset;
+			if (separation <= 0.0f)
+			{
+				ContactPoint& candidate = candidates[candidateCount++];
+				candidate.normal = contactNormal;
+				candidate.point = polygon[i] - referenceNormal * (separation * 0.5f);
+				candidate.depth = -separation;
+			}
+		}
+		if (candidateCount <= Narrowphase::MAX_MANIFOLD_POINTS)
+		{
+			std::copy(candidates, candidates + candidateCount, points);
+			return candidateCount;
+		}
+
+		// Down to the outermost along both directions of the reference face, which keeps its area
+		int extremes[4] = { 0, 0, 0, 0 };
+		float extremeValues[4] = { -std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+		for (int i = 0; i < candidateCount; ++i)
+		{
+			for (int side = 1; side < 3; ++side)
+			{
+				float value = QVector3D::dotProduct(reference.axes[(referenceAxis + side) % 3], candidates[i].point);
+				int slot = (side - 1) * 2;
+				if (value > extremeValues[slot])
+				{
+					extremeValues[slot] = value;
+					extremes[slot] = i;
+				}
+				if (value < extremeValues[slot + 1])
+				{
+					extremeValues[slot + 1] = value;
+					extremes[slot + 1] = i;
+				}
+			}
+		}
+
+		int pointCount = 0;
+		for (int slot = 0; slot < 4; ++slot)
+		{
+			if (std::find(extremes, extremes + slot, extremes[slot]) == extremes + slot)
+			{
+				points[pointCount++] = candidates[extremes[slot]];
+			}
+		}
+		return pointCount;
+	}
+
+	// The normal points from the box towards the capsule
+	int getBoxCapsuleManifold(const Box& box, const ColliderData& capsule, const QVector3D& normal, ContactPoint* points)
+	{
+		int axis = 0;
+		float sign = 1.0f;
+		if (findFace(box, normal, axis, sign) < FACE_ALIGNMENT)
+			return 0;
+
+		QVector3D faceNormal = box.axes[axis] * sign;
+		QVector3D start;
+		QVector3D end;
+		getSegment(capsule, start, end);
+
+		// The part of the segment over the face
+		float clipStart = 0.0f;
+		float clipEnd = 1.0f;
+		for (int side = 1; side < 3; ++side)
+		{
+			int sideAxis = (axis + side) % 3;
+			for (float direction : { 1.0f, -1.0f })
+			{
+				QVector3D planeNormal = box.axes[sideAxis] * direction;
+				float offset = QVector3D::dotProduct(planeNormal, box.center) + box.halfExtents[sideAxis];
+				float startDistance = QVector3D::dotProduct(planeNormal, start) - offset;
+				float endDistance = QVector3D::dotProduct(planeNormal, end) - offset;
+				if (startDistance > 0.0f && endDistance > 0.0f)
+					return 0;
+
+				if (startDistance > 0.0f)
+				{
+					clipStart = std::max(clipStart, startDistance / (startDistance - endDistance));
+				}
+				else if (endDistance > 0.0f)
+				{
+					clipEnd = std::min(clipEnd, startDistance / (startDistance - endDistance));
+				}
+			}
+		}
+		if (clipStart > clipEnd)
+			return 0;
+
+		float faceOffset = QVector3D::dotProduct(faceNormal, box.center) + box.halfExtents[axis];
+		int pointCount = 0;
+		for (float fraction : { clipStart, clipEnd })
+		{
+			QVector3D center = start + (end - start) * fraction;
+			float separation = QVector3D::dotProduct(faceNormal, center) - capsule.radius - faceOffset;
+			if (separation <= 0.0f)
+			{
+				ContactPoint& point = points[pointCount++];
+				point.normal = faceNormal;
+				point.point = center - faceNormal * (capsule.radius + separation * 0.5f);
+				point.depth = -separation;
+			}
+		}
+		return pointCount;
+	}
+}
+
+void Narrowphase::getBounds(const ColliderData& shape, QVector3D& boundsMin, QVector3D& boundsMax)
+{
+	QVector3D extent;
+	switch (shape.shape)
+	{
+	case ColliderShape::SPHERE:
+		extent = QVector3D(shape.radius, shape.radius, shape.radius);
+		break;
+	case ColliderShape::AABB:
+		extent = QVector3D(std::abs(shape.halfExtents.x()), std::abs(shape.halfExtents.y()), std::abs(shape.halfExtents.z()));
+		break;
+	case ColliderShape::OBB:
+	{
+		Box box = makeBox(shape);
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				extent[axis] += std::abs(box.axes[i][axis]) * box.halfExtents[i];
+			}
+		}
+		break;
+	}
+	case ColliderShape::CAPSULE:
+	{
+		QVector3D axis = shape.rotation.rotatedVector(QVector3D(0.0f, shape.halfHeight, 0.0f));
+		extent = QVector3D(std::abs(axis.x()), std::abs(axis.y()), std::abs(axis.z())) + QVector3D(shape.radius, shape.radius, shape.radius);
+		break;
+	}
+	}
+	boundsMin = shape.center - extent;
+	boundsMax = shape.center + extent;
+}
+
+bool Narrowphase::collide(const ColliderData& a, const ColliderData& b, ContactPoint& contact)
+{
+	bool isBoxA = getIsBox(a);
+	bool isBoxB = getIsBox(b);
+	if (isBoxA && isBoxB)
+		return collideBoxes(makeBox(a), makeBox(b), contact);
+
+	if (isBoxA)
+		return collideBoxRound(makeBox(a), b, contact);
+
+	if (isBoxB)
+	{
+		if (!collideBoxRound(makeBox(b), a, contact))
+			return false;
+
+		contact.normal = -contact.normal;
+		return true;
+	}
+
+	// Spheres and capsules: the closest points of their segments, as two spheres
+	QVector3D startA;
+	QVector3D endA;
+	QVector3D startB;
+	QVector3D endB;
+	getSegment(a, startA, endA);
+	getSegment(b, startB, endB);
+	float s = 0.0f;
+	float t = 0.0f;
+	closestSegmentPoints(startA, endA, startB, endB, s, t);
+	return collideSpherePoints(startA + (endA - startA) * s, a.radius, startB + (endB - startB) * t, b.radius, contact);
+}
+
+int Narrowphase::collideSpheres(const ColliderData* const* a, const ColliderData* const* b, int count, ContactPoint* contacts)
+{
+	count = std::min(count, static_cast<int>(BATCH_SIZE));
+	int mask = 0;
+#ifdef NARROWPHASE_SSE
+	// Unused lanes stay zero and are masked off below
+	alignas(16) float centers[6][BATCH_SIZE] = {};
+	alignas(16) float radiiA[BATCH_SIZE] = {};
+	alignas(16) float radiiB[BATCH_SIZE] = {};
+	for (int i = 0; i < count; ++i)
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			centers[axis][i] = a[i]->center[axis];
+			centers[axis + 3][i] = b[i]->center[axis];
+		}
+		radiiA[i] = a[i]->radius;
+		radiiB[i] = b[i]->radius;
+	}
+
+	__m128 dx = _mm_sub_ps(_mm_load_ps(centers[3]), _mm_load_ps(centers[0]));
+	__m128 dy = _mm_sub_ps(_mm_load_ps(centers[4]), _mm_load_ps(centers[1]));
+	__m128 dz = _mm_sub_ps(_mm_load_ps(centers[5]), _mm_load_ps(centers[2]));
+	__m128 radiusA = _mm_load_ps(radiiA);
+	__m128 radii = _mm_add_ps(radiusA, _mm_load_ps(radiiB));
+	__m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+	mask = _mm_movemask_ps(_mm_cmple_ps(distanceSquared, _mm_mul_ps(radii, radii))) & ((1 << count) - 1);
+	if (mask == 0)
+		return 0;
+
+	// Concentric spheres get an upward normal, as in the scalar test
+	__m128 distance = _mm_sqrt_ps(distanceSquared);
+	__m128 isSeparated = _mm_cmpgt_ps(distance, _mm_set1_ps(EPSILON));
+	__m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), _mm_max_ps(distance, _mm_set1_ps(EPSILON)));
+	__m128 nx = _mm_and_ps(isSeparated, _mm_mul_ps(dx, inverse));
+	__m128 ny = _mm_or_ps(_mm_and_ps(isSeparated, _mm_mul_ps(dy, inverse)), _mm_andnot_ps(isSeparated, _mm_set1_ps(1.0f)));
+	__m128 nz = _mm_and_ps(isSeparated, _mm_mul_ps(dz, inverse));
+	__m128 depth = _mm_sub_ps(radii, distance);
+	__m128 reach = _mm_sub_ps(radiusA, _mm_mul_ps(depth, _mm_set1_ps(0.5f)));
+
+	alignas(16) float results[7][BATCH_SIZE];
+	_mm_store_ps(results[0], nx);
+	_mm_store_ps(results[1], ny);
+	_mm_store_ps(results[2], nz);
+	_mm_store_ps(results[3], depth);
+	_mm_store_ps(results[4], _mm_add_ps(_mm_load_ps(centers[0]), _mm_mul_ps(nx, reach)));
+	_mm_store_ps(results[5], _mm_add_ps(_mm_load_ps(centers[1]), _mm_mul_ps(ny, reach)));
+	_mm_store_ps(results[6], _mm_add_ps(_mm_load_ps(centers[2]), _mm_mul_ps(nz, reach)));
+	for (int i = 0; i < count; ++i)
+	{
+		if (mask & (1 << i))
+		{
+			contacts[i].normal = QVector3D(results[0][i], results[1][i], results[2][i]);
+			contacts[i].depth = results[3][i];
+			contacts[i].point = QVector3D(results[4][i], results[5][i], results[6][i]);
+		}
+	}
+#else
+	for (int i = 0; i < count; ++i)
+	{
+		if (collideSpherePoints(a[i]->center, a[i]->radius, b[i]->center, b[i]->radius, contacts[i]))
+		{
+			mask |= 1 << i;
+		}
+	}
+#endif
+	return mask;
+}
+
+int Narrowphase::getManifold(const ColliderData& a, const ColliderData& b, const ContactPoint& contact, ContactPoint* points)
+{
+	int count = 0;
+	bool isBoxA = getIsBox(a);
+	bool isBoxB = getIsBox(b);
+	if (isBoxA && isBoxB)
+	{
+		count = getBoxManifold(makeBox(a), makeBox(b), contact.normal, points);
+	}
+	else if (isBoxA && b.shape == ColliderShape::CAPSULE)
+	{
+		count = getBoxCapsuleManifold(makeBox(a), b, contact.normal, points);
+	}
+	else if (isBoxB && a.shape == ColliderShape::CAPSULE)
+	{
+		count = getBoxCapsuleManifold(makeBox(b), a, -contact.normal, points);
+		for (int i = 0; i < count; ++i)
+		{
+			points[i].normal = -points[i].normal;
+		}
+	}
+
+	if (count == 0)
+	{
+		points[0] = contact;
+		count = 1;
+	}
+	return count;
+}
@@ -0,0 +1,625 @@
+#include "Engine/Physics/PhysicsWorld.h"
+#include "Engine/Nodes/Collider.h"
+#include "Engine/Nodes/RigidBody.h"
+#include "Engine/Physics/Narrowphase.h"
+#include "Engine/Profiling/Profiler.h"
+#include "Engine/Threading/ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <QElapsedTimer>
+
+namespace
+{
+	// Overlap left in place, so resting contacts stay touching instead of popping in and out
+	const float PENETRATION_SLOP = 0.01f;
+	// Fraction of the remaining overlap pushed out per step
+	const float BAUMGARTE = 0.2f;
+	// Slower impacts do not bounce, so bouncy bodies still come to rest
+	const float BOUNCE_SPEED = 1.0f;
+	// Static colliders have no RigidBody to carry a material
+	const float STATIC_FRICTION = 0.5f;
+
+	// Manifold points carry over from the last step when this close, since clipping may list them in another order
+	const float WARM_START_DISTANCE = 0.1f;
+
+	quint64 makeKey(int bodyA, int bodyB)
+	{
+		return (static_cast<quint64>(static_cast<quint32>(bodyA)) << 32) | static_cast<quint32>(bodyB);
+	}
+
+	void makeTangents(const QVector3D& normal, QVector3D& tangent1, QVector3D& tangent2)
+	{
+		// Any unit vector has a component below 1 / sqrt(3); that axis is far from parallel to it
+		QVector3D axis = std::abs(normal.x()) < 0.57735f ? QVector3D(1.0f, 0.0f, 0.0f)
+			: std::abs(normal.y()) < 0.57735f ? QVector3D(0.0f, 1.0f, 0.0f) : QVector3D(0.0f, 0.0f, 1.0f);
+		tangent1 = QVector3D::crossProduct(normal, axis).normalized();
+		tangent2 = QVector3D::crossProduct(normal, tangent1);
+	}
+
+	template <typename T>
+	void removeSwapped(std::vector<T>& values, int index)
+	{
+		values[index] = values.back();
+		values.pop_back();
+	}
+}
+
+QVector3D PhysicsWorld::Matrix3::operator*(const QVector3D& vector) const
+{
+	return QVector3D(QVector3D::dotProduct(rows[0], vector), QVector3D::dotProduct(rows[1], vector), QVector3D::dotProduct(rows[2], vector));
+}
+
+PhysicsWorld::PhysicsWorld()
+	: mImpulseBodies(0), mIsImpulseCacheValid(false), mGravity(0.0f, -9.81f, 0.0f), mIterations(DEFAULT_ITERATIONS), mIsMultithreaded(true)
+{
+}
+
+PhysicsWorld::~PhysicsWorld()
+{
+	clear();
+}
+
+void PhysicsWorld::clear()
+{
+	for (RigidBody* body : mBodies)
+	{
+		body->setBodyIndex(-1);
+	}
+
+	mBodies.clear();
+	mTransforms.clear();
+	mPositions.clear();
+	mRotations.clear();
+	mLinearVelocities.clear();
+	mAngularVelocities.clear();
+	mForces.clear();
+	mTorques.clear();
+	mInverseMasses.clear();
+	mInverseInertias.clear();
+	mWorldInverseInertias.clear();
+	mLinearDampings.clear();
+	mAngularDampings.clear();
+	mGravityScales.clear();
+	mFrictions.clear();
+	mRestitutions.clear();
+	mIsKinematic.clear();
+
+	mUnsorted.clear();
+	mConstraints.clear();
+	mImpulses.clear();
+	mIsImpulseCacheValid = false;
+	mStats = PhysicsStats();
+}
+
+int PhysicsWorld::add(RigidBody* body)
+{
+	if (body->getBodyIndex() >= 0)
+		return body->getBodyIndex();
+
+	Transform* transform = body->transform.get();
+	mBodies.push_back(body);
+	mTransforms.push_back(transform);
+	mPositions.push_back(transform->getWorldPosition());
+	mRotations.push_back(transform->getWorldRotation().normalized());
+	mLinearVelocities.push_back(QVector3D());
+	mAngularVelocities.push_back(QVector3D());
+	mForces.push_back(QVector3D());
+	mTorques.push_back(QVector3D());
+	mInverseMasses.push_back(0.0f);
+	mInverseInertias.push_back(QVector3D());
+	mWorldInverseInertias.push_back(Matrix3());
+	mLinearDampings.push_back(0.0f);
+	mAngularDampings.push_back(0.0f);
+	mGravityScales.push_back(1.0f);
+	mFrictions.push_back(0.0f);
+	mRestitutions.push_back(0.0f);
+	mIsKinematic.push_back(0);
+
+	int index = getBodyCount() - 1;
+	body->setBodyIndex(index);
+	updateBody(index);
+	mIsImpulseCacheValid = false;
+	return index;
+}
+
+void PhysicsWorld::remove(RigidBody* body)
+{
+	int index = body->getBodyIndex();
+	if (index < 0 || index >= getBodyCount() || mBodies[index] != body)
+		return;
+
+	removeSwapped(mBodies, index);
+	removeSwapped(mTransforms, index);
+	removeSwapped(mPositions, index);
+	removeSwapped(mRotations, index);
+	removeSwapped(mLinearVelocities, index);
+	removeSwapped(mAngularVelocities, index);
+	removeSwapped(mForces, index);
+	removeSwapped(mTorques, index);
+	removeSwapped(mInverseMasses, index);
+	removeSwapped(mInverseInertias, index);
+	removeSwapped(mWorldInverseInertias, index);
+	removeSwapped(mLinearDampings, index);
+	removeSwapped(mAngularDampings, index);
+	removeSwapped(mGravityScales, index);
+	removeSwapped(mFrictions, index);
+	removeSwapped(mRestitutions, index);
+	removeSwapped(mIsKinematic, index);
+
+	if (index < getBodyCount())
+	{
+		mBodies[index]->setBodyIndex(index);
+	}
+	body->setBodyIndex(-1);
+	mIsImpulseCacheValid = false;
+}
+
+RigidBody* PhysicsWorld::getBody(int body) const
+{
+	return mBodies[body];
+}
+
+int PhysicsWorld::getBodyCount() const
+{
+	return static_cast<int>(mBodies.size());
+}
+
+void PhysicsWorld::updateBody(int body)
+{
+	RigidBody* node = mBodies[body];
+	bool isKinematic = node->getIsKinematic();
+	QVector3D inertia = node->computeInertia();
+
+	mIsKinematic[body] = isKinematic ? 1 : 0;
+	mInverseMasses[body] = isKinematic ? 0.0f : 1.0f / node->getMass();
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		mInverseInertias[body][axis] = !isKinematic && inertia[axis] > 0.0f ? 1.0f / inertia[axis] : 0.0f;
+	}
+	mLinearDampings[body] = node->getLinearDamping();
+	mAngularDampings[body] = node->getAngularDamping();
+	mGravityScales[body] = node->getGravityScale();
+	mFrictions[body] = node->getFriction();
+	mRestitutions[body] = node->getRestitution();
+	updateWorldInverseInertia(body);
+}
+
+void PhysicsWorld::setLinearVelocity(int body, const QVector3D& velocity)
+{
+	mLinearVelocities[body] = velocity;
+}
+
+QVector3D PhysicsWorld::getLinearVelocity(int body) const
+{
+	return mLinearVelocities[body];
+}
+
+void PhysicsWorld::setAngularVelocity(int body, const QVector3D& velocity)
+{
+	mAngularVelocities[body] = velocity;
+}
+
+QVector3D PhysicsWorld::getAngularVelocity(int body) const
+{
+	return mAngularVelocities[body];
+}
+
+void PhysicsWorld::addForce(int body, const QVector3D& force)
+{
+	mForces[body] += force;
+}
+
+void PhysicsWorld::addTorque(int body, const QVector3D& torque)
+{
+	mTorques[body] += torque;
+}
+
+void PhysicsWorld::addImpulse(int body, const QVector3D& impulse, const QVector3D& point)
+{
+	applyImpulse(body, point - mPositions[body], impulse);
+}
+
+void PhysicsWorld::setGravity(const QVector3D& gravity)
+{
+	mGravity = gravity;
+}
+
+QVector3D PhysicsWorld::getGravity() const
+{
+	return mGravity;
+}
+
+void PhysicsWorld::setIterations(int iterations)
+{
+	mIterations = std::max(iterations, 1);
+}
+
+int PhysicsWorld::getIterations() const
+{
+	return mIterations;
+}
+
+void PhysicsWorld::setIsMultithreaded(bool isMultithreaded)
+{
+	mIsMultithreaded = isMultithreaded;
+}
+
+bool PhysicsWorld::getIsMultithreaded() const
+{
+	return mIsMultithreaded;
+}
+
+const PhysicsStats& PhysicsWorld::getStats() const
+{
+	return mStats;
+}
+
+void PhysicsWorld::step(float deltaTime, const CollisionWorld& collisions)
+{
+	PROFILE_SCOPE("PhysicsWorld::step");
+
+	mStats = PhysicsStats();
+	mStats.bodies = getBodyCount();
+	if (mStats.bodies == 0 || deltaTime <= 0.0f)
+		return;
+
+	bool isParallel = mIsMultithreaded && mStats.bodies >= PARALLEL_BODIES;
+
+	QElapsedTimer timer;
+	timer.start();
+	gatherBodies(isParallel);
+	integrateVelocities(deltaTime, isParallel);
+	qint64 integrateNs = timer.nsecsElapsed();
+
+	timer.restart();
+	buildConstraints(deltaTime, collisions);
+	buildIslands();
+	ParallelFor::run(mStats.islands, ISLAND_GRAIN, [this](int, int begin, int end) {
+		for (int island = begin; island < end; ++island)
+		{
+			solveIsland(island);
+		}
+	}, isParallel);
+	storeImpulses(collisions.getBodyCount());
+	mStats.solveMs = timer.nsecsElapsed() / 1000000.0;
+
+	timer.restart();
+	integratePositions(deltaTime, isParallel);
+	writePoses();
+	mStats.integrateMs = (integrateNs + timer.nsecsElapsed()) / 1000000.0;
+}
+
+void PhysicsWorld::gatherBodies(bool isParallel)
+{
+	// Picks up bodies moved by hand since the last step
+	ParallelFor::run(getBodyCount(), BODY_GRAIN, [this](int, int begin, int end) {
+		for (int body = begin; body < end; ++body)
+		{
+			mPositions[body] = mTransforms[body]->getWorldPosition();
+			mRotations[body] = mTransforms[body]->getWorldRotation().normalized();
+			updateWorldInverseInertia(body);
+		}
+	}, isParallel);
+}
+
+void PhysicsWorld::integrateVelocities(float deltaTime, bool isParallel)
+{
+	ParallelFor::run(getBodyCount(), BODY_GRAIN, [this, deltaTime](int, int begin, int end) {
+		for (int body = begin; body < end; ++body)
+		{
+			float inverseMass = mInverseMasses[body];
+			if (inverseMass > 0.0f)
+			{
+				QVector3D acceleration = mGravity * mGravityScales[body] + mForces[body] * inverseMass;
+				mLinearVelocities[body] += acceleration * deltaTime;
+				mAngularVelocities[body] += mWorldInverseInertias[body] * mTorques[body] * deltaTime;
+				mLinearVelocities[body] *= 1.0f / (1.0f + deltaTime * mLinearDampings[body]);
+				mAngularVelocities[body] *= 1.0f / (1.0f + deltaTime * mAngularDampings[body]);
+			}
+			mForces[body] = QVector3D();
+			mTorques[body] = QVector3D();
+		}
+	}, isParallel);
+}
+
+void PhysicsWorld::buildConstraints(float deltaTime, const CollisionWorld& collisions)
+{
+	int collisionBodies = collisions.getBodyCount();
+	mColliderBodies.resize(collisionBodies);
+	for (int i = 0; i < collisionBodies; ++i)
+	{
+		Collider* collider = collisions.getCollider(i);
+		RigidBody* body = collider ? collider->getRigidBody() : nullptr;
+		int index = body ? body->getBodyIndex() : -1;
+		mColliderBodies[i] = index >= 0 && index < getBodyCount() && mBodies[index] == body ? index : -1;
+	}
+
+	bool isWarmStarted = mIsImpulseCacheValid && mImpulseBodies == collisionBodies;
+	mUnsorted.clear();
+	for (const Contact& contact : collisions.getContacts())
+	{
+		int bodyA = mColliderBodies[contact.bodyA];
+		int bodyB = mColliderBodies[contact.bodyB];
+		bool isDynamicA = bodyA >= 0 && mInverseMasses[bodyA] > 0.0f;
+		bool isDynamicB = bodyB >= 0 && mInverseMasses[bodyB] > 0.0f;
+		if ((!isDynamicA && !isDynamicB) || bodyA == bodyB)
+			continue;
+
+		ContactPoint contactPoint;
+		contactPoint.normal = contact.normal;
+		contactPoint.point = contact.point;
+		contactPoint.depth = contact.depth;
+		ContactPoint points[Narrowphase::MAX_MANIFOLD_POINTS];
+		int pointCount = Narrowphase::getManifold(collisions.getBody(contact.bodyA), collisions.getBody(contact.bodyB), contactPoint, points);
+
+		float frictionA = bodyA >= 0 ? mFrictions[bodyA] : STATIC_FRICTION;
+		float frictionB = bodyB >= 0 ? mFrictions[bodyB] : STATIC_FRICTION;
+		float restitution = std::max(bodyA >= 0 ? mRestitutions[bodyA] : 0.0f, bodyB >= 0 ? mRestitutions[bodyB] : 0.0f);
+
+		for (int point = 0; point < pointCount; ++point)
+		{
+			Constraint constraint;
+			constraint.bodyA = bodyA;
+			constraint.bodyB = bodyB;
+			constraint.normal = points[point].normal;
+			makeTangents(constraint.normal, constraint.tangents[0], constraint.tangents[1]);
+			constraint.offsetA = bodyA >= 0 ? points[point].point - mPositions[bodyA] : QVector3D();
+			constraint.offsetB = bodyB >= 0 ? points[point].point - mPositions[bodyB] : QVector3D();
+
+			float normalMass = getEffectiveMass(constraint, constraint.normal);
+			constraint.normalMass = normalMass > 0.0f ? 1.0f / normalMass : 0.0f;
+			for (int k = 0; k < 2; ++k)
+			{
+				float tangentMass = getEffectiveMass(constraint, constraint.tangents[k]);
+				constraint.tangentMass[k] = tangentMass > 0.0f ? 1.0f / tangentMass : 0.0f;
+			}
+			constraint.friction = std::sqrt(frictionA * frictionB);
+
+			// Pushes out what overlaps past the slop, or bounces back at the approach speed if faster
+			float approachSpeed = QVector3D::dotProduct(getPointVelocity(bodyB, constraint.offsetB) - getPointVelocity(bodyA, constraint.offsetA), constraint.normal);
+			constraint.bias = BAUMGARTE / deltaTime * std::max(points[point].depth - PENETRATION_SLOP, 0.0f);
+			if (approachSpeed < -BOUNCE_SPEED)
+			{
+				constraint.bias = std::max(constraint.bias, -restitution * approachSpeed);
+			}
+
+			constraint.key = makeKey(contact.bodyA, contact.bodyB);
+			constraint.point = points[point].point;
+			constraint.normalImpulse = 0.0f;
+			constraint.tangentImpulse[0] = 0.0f;
+			constraint.tangentImpulse[1] = 0.0f;
+			if (isWarmStarted)
+			{
+				// The pair's nearest point from the last step
+				auto cached = std::lower_bound(mImpulses.begin(), mImpulses.end(), constraint.key,
+					[](const CachedImpulse& impulse, quint64 key) { return impulse.key < key; });
+				const CachedImpulse* nearest = nullptr;
+				float nearestDistance = WARM_START_DISTANCE * WARM_START_DISTANCE;
+				for (; cached != mImpulses.end() && cached->key == constraint.key; ++cached)
+				{
+					float distance = (cached->point - constraint.point).lengthSquared();
+					if (distance < nearestDistance)
+					{
+						nearestDistance = distance;
+						nearest = &*cached;
+					}
+				}
+				if (nearest)
+				{
+					constraint.normalImpulse = nearest->normal;
+					constraint.tangentImpulse[0] = nearest->tangents[0];
+					constraint.tangentImpulse[1] = nearest->tangents[1];
+				}
+			}
+			mUnsorted.push_back(constraint);
+		}
+	}
+	mStats.constraints = static_cast<int>(mUnsorted.size());
+}
+
+void PhysicsWorld::buildIslands()
+{
+	int bodyCount = getBodyCount();
+	mIslandParents.resize(bodyCount);
+	for (int body = 0; body < bodyCount; ++body)
+	{
+		mIslandParents[body] = body;
+	}
+
+	auto find = [this](int body) {
+		while (mIslandParents[body] != body)
+		{
+			mIslandParents[body] = mIslandParents[mIslandParents[body]];
+			body = mIslandParents[body];
+		}
+		return body;
+	};
+
+	// Kinematic bodies and static colliders are only read while solving, so they join nothing
+	for (const Constraint& constraint : mUnsorted)
+	{
+		if (constraint.bodyA >= 0 && constraint.bodyB >= 0 && mInverseMasses[constraint.bodyA] > 0.0f && mInverseMasses[constraint.bodyB] > 0.0f)
+		{
+			int rootA = find(constraint.bodyA);
+			int rootB = find(constraint.bodyB);
+			if (rootA != rootB)
+			{
+				mIslandParents[std::max(rootA, rootB)] = std::min(rootA, rootB);
+			}
+		}
+	}
+
+	int islandCount = 0;
+	int constraintCount = static_cast<int>(mUnsorted.size());
+	mRootIslands.assign(bodyCount, -1);
+	mConstraintIslands.resize(constraintCount);
+	for (int i = 0; i < constraintCount; ++i)
+	{
+		const Constraint& constraint = mUnsorted[i];
+		int dynamicBody = constraint.bodyA >= 0 && mInverseMasses[constraint.bodyA] > 0.0f ? constraint.bodyA : constraint.bodyB;
+		int root = find(dynamicBody);
+		if (mRootIslands[root] < 0)
+		{
+			mRootIslands[root] = islandCount++;
+		}
+		mConstraintIslands[i] = mRootIslands[root];
+	}
+
+	// Counting sort, which keeps contact order inside each island
+	mIslandStarts.assign(islandCount + 1, 0);
+	for (int island : mConstraintIslands)
+	{
+		++mIslandStarts[island + 1];
+	}
+	for (int island = 0; island < islandCount; ++island)
+	{
+		mStats.largestIsland = std::max(mStats.largestIsland, mIslandStarts[island + 1]);
+		mIslandStarts[island + 1] += mIslandStarts[island];
+	}
+
+	mIslandFill.assign(mIslandStarts.begin(), mIslandStarts.end() - 1);
+	mConstraints.resize(constraintCount);
+	for (int i = 0; i < constraintCount; ++i)
+	{
+		mConstraints[mIslandFill[mConstraintIslands[i]]++] = mUnsorted[i];
+	}
+	mStats.islands = islandCount;
+}
+
+void PhysicsWorld::solveIsland(int island)
+{
+	int begin = mIslandStarts[island];
+	int end = mIslandStarts[island + 1];
+
+	for (int i = begin; i < end; ++i)
+	{
+		const Constraint& constraint = mConstraints[i];
+		QVector3D impulse = constraint.normal * constraint.normalImpulse
+			+ constraint.tangents[0] * constraint.tangentImpulse[0]
+			+ constraint.tangents[1] * constraint.tangentImpulse[1];
+		applyImpulse(constraint.bodyA, constraint.offsetA, -impulse);
+		applyImpulse(constraint.bodyB, constraint.offsetB, impulse);
+	}
+
+	for (int iteration = 0; iteration < mIterations; ++iteration)
+	{
+		for (int i = begin; i < end; ++i)
+		{
+			Constraint& constraint = mConstraints[i];
+
+			// Friction first, bounded by the normal impulse so far
+			float maxFriction = constraint.friction * constraint.normalImpulse;
+			for (int k = 0; k < 2; ++k)
+			{
+				QVector3D relative = getPointVelocity(constraint.bodyB, constraint.offsetB) - getPointVelocity(constraint.bodyA, constraint.offsetA);
+				float lambda = -QVector3D::dotProduct(relative, constraint.tangents[k]) * constraint.tangentMass[k];
+				float accumulated = std::clamp(constraint.tangentImpulse[k] + lambda, -maxFriction, maxFriction);
+				lambda = accumulated - constraint.tangentImpulse[k];
+				constraint.tangentImpulse[k] = accumulated;
+
+				QVector3D impulse = constraint.tangents[k] * lambda;
+				applyImpulse(constraint.bodyA, constraint.offsetA, -impulse);
+				applyImpulse(constraint.bodyB, constraint.offsetB, impulse);
+			}
+
+			// Clamped as a total rather than per iteration, so later iterations can take back an overshoot
+			QVector3D relative = getPointVelocity(constraint.bodyB, constraint.offsetB) - getPointVelocity(constraint.bodyA, constraint.offsetA);
+			float lambda = constraint.normalMass * (constraint.bias - QVector3D::dotProduct(relative, constraint.normal));
+			float accumulated = std::max(constraint.normalImpulse + lambda, 0.0f);
+			lambda = accumulated - constraint.normalImpulse;
+			constraint.normalImpulse = accumulated;
+
+			QVector3D impulse = constraint.normal * lambda;
+			applyImpulse(constraint.bodyA, constraint.offsetA, -impulse);
+			applyImpulse(constraint.bodyB, constraint.offsetB, impulse);
+		}
+	}
+}
+
+void PhysicsWorld::integratePositions(float deltaTime, bool isParallel)
+{
+	ParallelFor::run(getBodyCount(), BODY_GRAIN, [this, deltaTime](int, int begin, int end) {
+		for (int body = begin; body < end; ++body)
+		{
+			mPositions[body] += mLinearVelocities[body] * deltaTime;
+
+			QQuaternion spin(0.0f, mAngularVelocities[body] * (0.5f * deltaTime));
+			mRotations[body] = (mRotations[body] + spin * mRotations[body]).normalized();
+		}
+	}, isParallel);
+}
+
+void PhysicsWorld::writePoses()
+{
+	// Children such as colliders and meshes follow in one walk per body subtree, nested bodies included
+	Transform::setWorldPoses(mTransforms.data(), mPositions.data(), mRotations.data(), getBodyCount());
+}
+
+void PhysicsWorld::storeImpulses(int collisionBodies)
+{
+	mImpulses.resize(mConstraints.size());
+	for (size_t i = 0; i < mConstraints.size(); ++i)
+	{
+		const Constraint& constraint = mConstraints[i];
+		mImpulses[i] = { constraint.key, constraint.point, constraint.normalImpulse, { constraint.tangentImpulse[0], constraint.tangentImpulse[1] } };
+	}
+	std::stable_sort(mImpulses.begin(), mImpulses.end(), [](const CachedImpulse& a, const CachedImpulse& b) {
+		return a.key < b.key;
+	});
+
+	mImpulseBodies = collisionBodies;
+	mIsImpulseCacheValid = true;
+}
+
+void PhysicsWorld::updateWorldInverseInertia(int body)
+{
+	// R * diag(inverse) * R^T, summed over the body's rotated axes
+	const QQuaternion& rotation = mRotations[body];
+	const QVector3D& inverse = mInverseInertias[body];
+	QVector3D axes[3] = {
+		rotation.rotatedVector(QVector3D(1.0f, 0.0f, 0.0f)),
+		rotation.rotatedVector(QVector3D(0.0f, 1.0f, 0.0f)),
+		rotation.rotatedVector(QVector3D(0.0f, 0.0f, 1.0f))
+	};
+
+	Matrix3& matrix = mWorldInverseInertias[body];
+	for (int row = 0; row < 3; ++row)
+	{
+		matrix.rows[row] = inverse[0] * axes[0][row] * axes[0] + inverse[1] * axes[1][row] * axes[1] + inverse[2] * axes[2][row] * axes[2];
+	}
+}
+
+QVector3D PhysicsWorld::getPointVelocity(int body, const QVector3D& offset) const
+{
+	if (body < 0)
+		return QVector3D();
+
+	return mLinearVelocities[body] + QVector3D::crossProduct(mAngularVelocities[body], offset);
+}
+
+void PhysicsWorld::applyImpulse(int body, const QVector3D& offset, const QVector3D& impulse)
+{
+	// Kinematic bodies may sit in several islands at once, so only dynamic ones are written
+	if (body < 0 || mInverseMasses[body] <= 0.0f)
+		return;
+
+	mLinearVelocities[body] += impulse * mInverseMasses[body];
+	mAngularVelocities[body] += mWorldInverseInertias[body] * QVector3D::crossProduct(offset, impulse);
+}
+
+float PhysicsWorld::getEffectiveMass(const Constraint& constraint, const QVector3D& direction) const
+{
+	float inverseMass = 0.0f;
+	if (constraint.bodyA >= 0)
+	{
+		QVector3D arm = QVector3D::crossProduct(constraint.offsetA, direction);
+		inverseMass += mInverseMasses[constraint.bodyA] + QVector3D::dotProduct(arm, mWorldInverseInertias[constraint.bodyA] * arm);
+	}
+	if (constraint.bodyB >= 0)
+	{
+		QVector3D arm = QVector3D::crossProduct(constraint.offsetB, direction);
+		inverseMass += mInverseMasses[constraint.bodyB] + QVector3D::dotProduct(arm, mWorldInverseInertias[constraint.bodyB] * arm);
+	}
+	return inverseMass;
+}
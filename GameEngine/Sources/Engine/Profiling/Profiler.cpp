@@ -0,0 +1,435 @@
+#include "Engine/Profiling/Profiler.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+
+Profiler& Profiler::instance()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+Profiler::Profiler()
+	: mIsEnabled(true), mIsInFrame(false), mFrameThread(nullptr), mFrameCount(0),
+	mContext(nullptr), mFunctions(nullptr), mFrameStartQuery(-1)
+{
+	mFrames.resize(FRAME_CAPACITY);
+	mClock.start();
+}
+
+void Profiler::setIsEnabled(bool isEnabled)
+{
+	mIsEnabled = isEnabled;
+}
+
+bool Profiler::getIsEnabled() const
+{
+	return mIsEnabled;
+}
+
+void Profiler::initGpu()
+{
+	clearGpu();
+
+	mContext = QOpenGLContext::currentContext();
+	if (!mContext)
+		return;
+
+	mFunctions = mContext->extraFunctions();
+	mExtensions.init();
+}
+
+void Profiler::clearGpu()
+{
+	for (auto& slot : mQuerySlots)
+	{
+		if (mFunctions && !slot.queries.empty() && QOpenGLContext::currentContext() == mContext)
+		{
+			mFunctions->glDeleteQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+		}
+		slot = QuerySlot();
+	}
+
+	mContext = nullptr;
+	mFunctions = nullptr;
+	mExtensions = GLExtensions();
+}
+
+bool Profiler::getIsGpuActive() const
+{
+	return mFunctions && mExtensions.hasTimerQuery && QOpenGLContext::currentContext() == mContext;
+}
+
+double Profiler::nowMs() const
+{
+	return mClock.nsecsElapsed() / 1000000.0;
+}
+
+bool Profiler::getIsFrameThread() const
+{
+	return mFrameThread.load(std::memory_order_relaxed) == QThread::currentThreadId();
+}
+
+int Profiler::takeQuery(QuerySlot& slot)
+{
+	if (slot.usedQueries == static_cast<int>(slot.queries.size()))
+	{
+		GLuint query = 0;
+		mFunctions->glGenQueries(1, &query);
+		slot.queries.push_back(query);
+	}
+
+	int index = slot.usedQueries++;
+	mExtensions.glQueryCounter(slot.queries[index], GL_TIMESTAMP);
+	return index;
+}
+
+Profiler::ThreadEvents& Profiler::getThreadEvents()
+{
+	thread_local ThreadEvents* threadEvents = nullptr;
+	if (!threadEvents)
+	{
+		QMutexLocker locker(&mThreadsMutex);
+		mThreads.push_back(std::make_unique<ThreadEvents>());
+		threadEvents = mThreads.back().get();
+		threadEvents->thread = static_cast<int>(mThreads.size());
+
+		QString name = QThread::currentThread()->objectName();
+		mThreadNames.push_back(name.isEmpty() ? QString("Thread %1").arg(threadEvents->thread) : name);
+	}
+	return *threadEvents;
+}
+
+void Profiler::mergeThreadEvents()
+{
+	QMutexLocker threadsLocker(&mThreadsMutex);
+	size_t firstMerged = mCurrentFrame.events.size();
+	for (auto& threadEvents : mThreads)
+	{
+		QMutexLocker locker(&threadEvents->mutex);
+		for (ProfileEvent& event : threadEvents->events)
+		{
+			event.cpuStartMs -= mCurrentFrame.cpuStartMs;
+			mCurrentFrame.events.push_back(event);
+		}
+		threadEvents->events.clear();
+	}
+
+	// Scopes close children first; the frame lists parents first. Frame thread indices stay put for the GPU queries.
+	std::stable_sort(mCurrentFrame.events.begin() + firstMerged, mCurrentFrame.events.end(), [](const ProfileEvent& a, const ProfileEvent& b) {
+		if (a.thread != b.thread)
+			return a.thread < b.thread;
+		if (a.cpuStartMs != b.cpuStartMs)
+			return a.cpuStartMs < b.cpuStartMs;
+		return a.depth < b.depth;
+	});
+}
+
+ProfileFrame* Profiler::findFrame(long long frameIndex)
+{
+	ProfileFrame& frame = mFrames[frameIndex % FRAME_CAPACITY];
+	return frame.frameIndex == frameIndex ? &frame : nullptr;
+}
+
+void Profiler::resolveSlot(QuerySlot& slot)
+{
+	if (slot.frameIndex < 0 || slot.pending.empty())
+		return;
+
+	// The last query of the slot lands last; if it is not there yet the frame is dropped rather than waited on
+	GLuint available = GL_FALSE;
+	mFunctions->glGetQueryObjectuiv(slot.queries[slot.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+	ProfileFrame* frame = findFrame(slot.frameIndex);
+	if (available == GL_TRUE && frame)
+	{
+		GLuint64 frameStart = 0;
+		for (const auto& pending : slot.pending)
+		{
+			if (pending.eventIndex < 0)
+			{
+				mExtensions.glGetQueryObjectui64v(slot.queries[pending.startQuery], GL_QUERY_RESULT, &frameStart);
+			}
+		}
+
+		for (const auto& pending : slot.pending)
+		{
+			GLuint64 start = 0;
+			GLuint64 end = 0;
+			mExtensions.glGetQueryObjectui64v(slot.queries[pending.startQuery], GL_QUERY_RESULT, &start);
+			mExtensions.glGetQueryObjectui64v(slot.queries[pending.endQuery], GL_QUERY_RESULT, &end);
+
+			double durationMs = (end - start) / 1000000.0;
+			if (pending.eventIndex < 0)
+			{
+				frame->gpuDurationMs = durationMs;
+			}
+			else if (pending.eventIndex < static_cast<int>(frame->events.size()))
+			{
+				ProfileEvent& event = frame->events[pending.eventIndex];
+				event.gpuStartMs = (start - frameStart) / 1000000.0;
+				event.gpuDurationMs = durationMs;
+			}
+		}
+	}
+
+	slot.pending.clear();
+	slot.usedQueries = 0;
+	slot.frameIndex = -1;
+}
+
+void Profiler::beginFrame()
+{
+	if (!mIsEnabled)
+		return;
+
+	if (mIsInFrame)
+	{
+		endFrame();
+	}
+
+	mFrameThread = QThread::currentThreadId();
+	mIsInFrame = true;
+	mCurrentFrame.frameIndex = mFrameCount;
+	mCurrentFrame.cpuStartMs = nowMs();
+	mCurrentFrame.cpuDurationMs = 0.0;
+	mCurrentFrame.gpuDurationMs = -1.0;
+	mCurrentFrame.events.clear();
+	mOpenEvents.clear();
+	mOpenQueries.clear();
+
+	mFrameStartQuery = -1;
+	if (getIsGpuActive())
+	{
+		QuerySlot& slot = mQuerySlots[mFrameCount % QUERY_SLOTS];
+		resolveSlot(slot);
+		slot.frameIndex = mFrameCount;
+		mFrameStartQuery = takeQuery(slot);
+	}
+}
+
+void Profiler::endFrame()
+{
+	if (!mIsInFrame)
+		return;
+
+	while (!mOpenEvents.empty())
+	{
+		endScope();
+	}
+	mergeThreadEvents();
+
+	mCurrentFrame.cpuDurationMs = nowMs() - mCurrentFrame.cpuStartMs;
+
+	if (mFrameStartQuery >= 0 && getIsGpuActive())
+	{
+		QuerySlot& slot = mQuerySlots[mFrameCount % QUERY_SLOTS];
+		PendingQuery pending;
+		pending.eventIndex = -1;
+		pending.startQuery = mFrameStartQuery;
+		pending.endQuery = takeQuery(slot);
+		slot.pending.push_back(pending);
+	}
+
+	// Swap rather than copy so the event storage is recycled
+	std::swap(mFrames[mFrameCount % FRAME_CAPACITY], mCurrentFrame);
+	mFrameCount++;
+	mIsInFrame = false;
+}
+
+void Profiler::beginScope(const char* name, bool isGpu)
+{
+	if (!getIsFrameThread())
+	{
+		// Only the frame thread has the context current, so other threads are timed on the CPU
+		if (mIsEnabled && mFrameThread.load(std::memory_order_relaxed))
+		{
+			ThreadEvents& threadEvents = getThreadEvents();
+			ProfileEvent event;
+			event.name = name;
+			event.thread = threadEvents.thread;
+			event.depth = static_cast<int>(threadEvents.openEvents.size());
+			event.cpuStartMs = nowMs();
+			threadEvents.openEvents.push_back(event);
+		}
+		return;
+	}
+	if (!mIsInFrame)
+		return;
+
+	ProfileEvent event;
+	event.name = name;
+	event.depth = static_cast<int>(mOpenEvents.size());
+	event.cpuStartMs = nowMs() - mCurrentFrame.cpuStartMs;
+
+	mOpenEvents.push_back(static_cast<int>(mCurrentFrame.events.size()));
+	mCurrentFrame.events.push_back(event);
+
+	int query = -1;
+	if (isGpu && mFrameStartQuery >= 0 && getIsGpuActive())
+	{
+		query = takeQuery(mQuerySlots[mFrameCount % QUERY_SLOTS]);
+	}
+	mOpenQueries.push_back(query);
+}
+
+void Profiler::endScope()
+{
+	if (!getIsFrameThread())
+	{
+		if (mIsEnabled && mFrameThread.load(std::memory_order_relaxed))
+		{
+			ThreadEvents& threadEvents = getThreadEvents();
+			if (threadEvents.openEvents.empty())
+				return;
+
+			ProfileEvent event = threadEvents.openEvents.back();
+			threadEvents.openEvents.pop_back();
+			event.cpuDurationMs = nowMs() - event.cpuStartMs;
+
+			// Nobody ending frames must not grow the buffer without bound
+			QMutexLocker locker(&threadEvents.mutex);
+			if (threadEvents.events.size() < static_cast<size_t>(MAX_THREAD_EVENTS))
+			{
+				threadEvents.events.push_back(event);
+			}
+		}
+		return;
+	}
+	if (!mIsInFrame || mOpenEvents.empty())
+		return;
+
+	int eventIndex = mOpenEvents.back();
+	int startQuery = mOpenQueries.back();
+	mOpenEvents.pop_back();
+	mOpenQueries.pop_back();
+
+	ProfileEvent& event = mCurrentFrame.events[eventIndex];
+	event.cpuDurationMs = nowMs() - mCurrentFrame.cpuStartMs - event.cpuStartMs;
+
+	if (startQuery >= 0 && getIsGpuActive())
+	{
+		QuerySlot& slot = mQuerySlots[mFrameCount % QUERY_SLOTS];
+		PendingQuery pending;
+		pending.eventIndex = eventIndex;
+		pending.startQuery = startQuery;
+		pending.endQuery = takeQuery(slot);
+		slot.pending.push_back(pending);
+	}
+}
+
+std::vector<ProfileFrame> Profiler::getFrames() const
+{
+	long long count = std::min<long long>(mFrameCount, FRAME_CAPACITY);
+
+	std::vector<ProfileFrame> frames;
+	frames.reserve(static_cast<size_t>(count));
+	for (long long i = mFrameCount - count; i < mFrameCount; ++i)
+	{
+		frames.push_back(mFrames[i % FRAME_CAPACITY]);
+	}
+	return frames;
+}
+
+const ProfileFrame* Profiler::getLastFrame() const
+{
+	if (mFrameCount == 0)
+		return nullptr;
+
+	return &mFrames[(mFrameCount - 1) % FRAME_CAPACITY];
+}
+
+long long Profiler::getFrameCount() const
+{
+	return mFrameCount;
+}
+
+std::vector<QString> Profiler::getThreadNames() const
+{
+	QMutexLocker locker(&mThreadsMutex);
+	return mThreadNames;
+}
+
+bool Profiler::exportChromeTrace(const QString& path) const
+{
+	const int cpuThread = 0;
+	const int gpuThread = 1;
+
+	QJsonArray traceEvents;
+
+	auto addThreadName = [&traceEvents](int tid, const QString& name) {
+		QJsonObject args;
+		args["name"] = name;
+
+		QJsonObject metadata;
+		metadata["name"] = "thread_name";
+		metadata["ph"] = "M";
+		metadata["pid"] = 0;
+		metadata["tid"] = tid;
+		metadata["args"] = args;
+		traceEvents.append(metadata);
+	};
+	addThreadName(cpuThread, "CPU");
+	addThreadName(gpuThread, "GPU");
+
+	// Other threads follow the GPU row, one tid each
+	std::vector<QString> threadNames = getThreadNames();
+	for (size_t i = 0; i < threadNames.size(); ++i)
+	{
+		addThreadName(gpuThread + 1 + static_cast<int>(i), threadNames[i]);
+	}
+
+	auto addEvent = [&traceEvents](const QString& name, const QString& category, int tid, double startMs, double durationMs) {
+		QJsonObject event;
+		event["name"] = name;
+		event["cat"] = category;
+		event["ph"] = "X";
+		event["pid"] = 0;
+		event["tid"] = tid;
+		event["ts"] = startMs * 1000.0;
+		event["dur"] = durationMs * 1000.0;
+		traceEvents.append(event);
+	};
+
+	// GPU clocks are not synchronised with the CPU one, so GPU work is laid out from the CPU start of its frame
+	for (const auto& frame : getFrames())
+	{
+		QString frameName = QString("Frame %1").arg(frame.frameIndex);
+		addEvent(frameName, "frame", cpuThread, frame.cpuStartMs, frame.cpuDurationMs);
+		if (frame.gpuDurationMs >= 0.0)
+		{
+			addEvent(frameName, "frame", gpuThread, frame.cpuStartMs, frame.gpuDurationMs);
+		}
+
+		for (const auto& event : frame.events)
+		{
+			int tid = event.thread == 0 ? cpuThread : gpuThread + event.thread;
+			addEvent(event.name, "cpu", tid, frame.cpuStartMs + event.cpuStartMs, event.cpuDurationMs);
+			if (event.gpuDurationMs >= 0.0)
+			{
+				addEvent(event.name, "gpu", gpuThread, frame.cpuStartMs + event.gpuStartMs, event.gpuDurationMs);
+			}
+		}
+	}
+
+	QJsonObject root;
+	root["traceEvents"] = traceEvents;
+	root["displayTimeUnit"] = "ms";
+
+	QFile file(path);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		std::cout << "ERROR::PROFILER::EXPORT_FAILED " << path.toStdString() << std::endl;
+		return false;
+	}
+
+	file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+	return true;
+}
@@ -0,0 +1,108 @@
+#include "Engine/Renders/BufferAllocator.h"
+
+BufferAllocator::BufferAllocator(unsigned int capacity) : mCapacity(0), mUsed(0)
+{
+	reset(capacity);
+}
+
+unsigned int BufferAllocator::allocate(unsigned int size)
+{
+	if (size == 0)
+		return INVALID_OFFSET;
+
+	for (auto it = mFreeBlocks.begin(); it != mFreeBlocks.end(); ++it)
+	{
+		if (it->second < size)
+			continue;
+
+		unsigned int offset = it->first;
+		unsigned int remaining = it->second - size;
+		mFreeBlocks.erase(it);
+
+		if (remaining > 0)
+		{
+			mFreeBlocks[offset + size] = remaining;
+		}
+
+		mUsed += size;
+		return offset;
+	}
+
+	return INVALID_OFFSET;
+}
+
+void BufferAllocator::free(unsigned int offset, unsigned int size)
+{
+	if (offset == INVALID_OFFSET || size == 0)
+		return;
+
+	mUsed -= size;
+
+	auto next = mFreeBlocks.lower_bound(offset);
+
+	// Merge with the following block
+	if (next != mFreeBlocks.end() && offset + size == next->first)
+	{
+		size += next->second;
+		next = mFreeBlocks.erase(next);
+	}
+
+	// Merge with the preceding block
+	if (next != mFreeBlocks.begin())
+	{
+		auto prev = std::prev(next);
+		if (prev->first + prev->second == offset)
+		{
+			prev->second += size;
+			return;
+		}
+	}
+
+	mFreeBlocks[offset] = size;
+}
+
+void BufferAllocator::grow(unsigned int newCapacity)
+{
+	if (newCapacity <= mCapacity)
+		return;
+
+	unsigned int oldCapacity = mCapacity;
+	mCapacity = newCapacity;
+
+	// The new tail is free space; reuse free() so it merges with a trailing free block
+	mUsed += newCapacity - oldCapacity;
+	free(oldCapacity, newCapacity - oldCapacity);
+}
+
+void BufferAllocator::reset(unsigned int capacity)
+{
+	mFreeBlocks.clear();
+	mCapacity = capacity;
+	mUsed = 0;
+
+	if (capacity > 0)
+	{
+		mFreeBlocks[0] = capacity;
+	}
+}
+
+unsigned int BufferAllocator::getCapacity() const
+{
+	return mCapacity;
+}
+
+unsigned int BufferAllocator::getUsed() const
+{
+	return mUsed;
+}
+
+unsigned int BufferAllocator::getLargestFreeBlock() const
+{
+	unsigned int largest = 0;
+	for (const auto& block : mFreeBlocks)
+	{
+		if (block.second > largest)
+			largest = block.second;
+	}
+	return largest;
+}
@@ -0,0 +1,460 @@
+#include "Engine/Renders/CascadedShadowMaps.h"
+#include "Engine/Profiling/Profiler.h"
+#include "Engine/Renders/Frustum.h"
+#include "Engine/Renders/GLStateCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <QHash>
+
+// Profiler scope names must outlive the frame
+static const char* const CASCADE_SCOPE_NAMES[CascadedShadowMaps::MAX_CASCADES] = {
+	"Shadow Cascade 0", "Shadow Cascade 1", "Shadow Cascade 2", "Shadow Cascade 3"
+};
+
+CascadedShadowMaps::CascadedShadowMaps()
+	: mIsStarted(false), mIsEnabled(true), mIsActive(false), mCascadeCount(MAX_CASCADES), mResolution(DEFAULT_RESOLUTION),
+	mAllocatedResolution(0), mShadowDistance(150.0f), mSplitLambda(0.75f), mCachedCascadeStart(2),
+	mShadowTexture(0), mStaticTexture(0), mDrawFramebuffer(0), mReadFramebuffer(0), mStaticHash(0), mCachedStaticHash(0)
+{
+	std::fill(std::begin(mSplits), std::end(mSplits), 0.0f);
+}
+
+CascadedShadowMaps::~CascadedShadowMaps()
+{
+}
+
+void CascadedShadowMaps::init()
+{
+	initializeOpenGLFunctions();
+	mDepthShader = std::make_unique<ShaderProgram>(":/Resources/Shaders/depth.vert", ":/Resources/Shaders/depth.frag");
+	mDepthShader->init();
+}
+
+void CascadedShadowMaps::tryStart()
+{
+	if (!mIsStarted)
+	{
+		mIsStarted = true;
+		start();
+	}
+}
+
+void CascadedShadowMaps::start()
+{
+	mDepthShader->start();
+
+	glGenFramebuffers(1, &mDrawFramebuffer);
+	glGenFramebuffers(1, &mReadFramebuffer);
+}
+
+void CascadedShadowMaps::allocate()
+{
+	release();
+
+	GLStateCache& state = GLStateCache::instance();
+	for (GLuint* texture : { &mShadowTexture, &mStaticTexture })
+	{
+		glGenTextures(1, texture);
+		state.bindTexture(SHADOW_TEXTURE_UNIT, GL_TEXTURE_2D_ARRAY, *texture);
+		// Mutable storage: glTexStorage3D needs GL 4.2, the rest of the shadow path only GL 3.3
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, mResolution, mResolution, MAX_CASCADES, 0,
+			GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		// Filtered depth comparison gives a 2x2 PCF per tap
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	}
+
+	// Depth-only framebuffers are incomplete on GL 3.3 while a colour buffer is selected
+	GLenum none = GL_NONE;
+	for (GLuint framebuffer : { mDrawFramebuffer, mReadFramebuffer })
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glDrawBuffers(1, &none);
+		glReadBuffer(GL_NONE);
+	}
+
+	mAllocatedResolution = mResolution;
+	for (auto& cascade : mCascades)
+	{
+		cascade = Cascade();
+	}
+}
+
+void CascadedShadowMaps::release()
+{
+	GLStateCache& state = GLStateCache::instance();
+	state.deleteTexture(mShadowTexture);
+	state.deleteTexture(mStaticTexture);
+	mAllocatedResolution = 0;
+}
+
+void CascadedShadowMaps::clear()
+{
+	if (mIsStarted)
+	{
+		release();
+		glDeleteFramebuffers(1, &mDrawFramebuffer);
+		glDeleteFramebuffers(1, &mReadFramebuffer);
+		mDrawFramebuffer = 0;
+		mReadFramebuffer = 0;
+		mDepthShader->clear();
+	}
+
+	mDepthShader.reset();
+	mCasters.clear();
+	mIsStarted = false;
+	mIsActive = false;
+}
+
+void CascadedShadowMaps::setIsEnabled(bool isEnabled)
+{
+	mIsEnabled = isEnabled;
+}
+
+bool CascadedShadowMaps::getIsEnabled() const
+{
+	return mIsEnabled;
+}
+
+void CascadedShadowMaps::setCascadeCount(int cascadeCount)
+{
+	mCascadeCount = std::clamp(cascadeCount, 1, static_cast<int>(MAX_CASCADES));
+}
+
+int CascadedShadowMaps::getCascadeCount() const
+{
+	return mCascadeCount;
+}
+
+void CascadedShadowMaps::setResolution(int resolution)
+{
+	// Reallocated by the next render
+	mResolution = std::clamp(resolution, 64, 8192);
+}
+
+int CascadedShadowMaps::getResolution() const
+{
+	return mResolution;
+}
+
+void CascadedShadowMaps::setShadowDistance(float distance)
+{
+	mShadowDistance = std::max(distance, 1.0f);
+}
+
+float CascadedShadowMaps::getShadowDistance() const
+{
+	return mShadowDistance;
+}
+
+void CascadedShadowMaps::setSplitLambda(float lambda)
+{
+	mSplitLambda = std::clamp(lambda, 0.0f, 1.0f);
+}
+
+float CascadedShadowMaps::getSplitLambda() const
+{
+	return mSplitLambda;
+}
+
+void CascadedShadowMaps::setCachedCascadeStart(int cascade)
+{
+	mCachedCascadeStart = std::max(cascade, 0);
+}
+
+int CascadedShadowMaps::getCachedCascadeStart() const
+{
+	return mCachedCascadeStart;
+}
+
+bool CascadedShadowMaps::getIsActive() const
+{
+	return mIsActive;
+}
+
+float CascadedShadowMaps::getSplitDistance(int cascade) const
+{
+	return mSplits[std::clamp(cascade, 0, mCascadeCount - 1)];
+}
+
+void CascadedShadowMaps::begin()
+{
+	mCasters.clear();
+	mStaticHash = 0;
+	mIsActive = false;
+}
+
+void CascadedShadowMaps::submit(Mesh* mesh, const Material* material, const QMatrix4x4& world, bool isStatic)
+{
+	if (!mIsEnabled || !mesh)
+		return;
+	if (material && material->getRasterState().blendMode != BlendMode::NONE)
+		return;
+
+	QVector4D sphere = mesh->getBoundingSphere();
+	float scale = std::max({ world.column(0).toVector3D().length(), world.column(1).toVector3D().length(), world.column(2).toVector3D().length() });
+
+	Caster caster;
+	caster.mesh = mesh;
+	caster.world = world;
+	caster.center = world.map(sphere.toVector3D());
+	caster.radius = sphere.w() * scale;
+	caster.isStatic = isStatic;
+	mCasters.push_back(caster);
+
+	if (isStatic)
+	{
+		mStaticHash = qHashMulti(mStaticHash, reinterpret_cast<quintptr>(mesh));
+		mStaticHash = qHashRange(world.constData(), world.constData() + 16, mStaticHash);
+	}
+}
+
+void CascadedShadowMaps::computeSplits(float nearPlane, float farPlane)
+{
+	// Logarithmic splits match the perspective's texel density, uniform ones keep the near cascades from getting tiny
+	for (int i = 0; i < mCascadeCount; ++i)
+	{
+		float part = static_cast<float>(i + 1) / mCascadeCount;
+		float logarithmic = nearPlane * std::pow(farPlane / nearPlane, part);
+		float uniform = nearPlane + (farPlane - nearPlane) * part;
+		mSplits[i] = mSplitLambda * logarithmic + (1.0f - mSplitLambda) * uniform;
+	}
+}
+
+bool CascadedShadowMaps::fitCascade(int index, const QMatrix4x4& projection, float sliceNear, float sliceFar)
+{
+	// Corners of the slice in view space, from the projection's scale terms, which both the
+	// conventional and the reversed infinite perspective share
+	bool isPerspective = projection(3, 3) == 0.0f;
+	float extentX = 1.0f / projection(0, 0);
+	float extentY = 1.0f / projection(1, 1);
+	QVector3D center;
+	QVector3D corners[8];
+	for (int i = 0; i < 8; ++i)
+	{
+		float depth = (i & 4) ? sliceFar : sliceNear;
+		float scale = isPerspective ? depth : 1.0f;
+		corners[i] = QVector3D((i & 1 ? 1.0f : -1.0f) * extentX * scale, (i & 2 ? 1.0f : -1.0f) * extentY * scale, -depth);
+		center += corners[i];
+	}
+	center /= 8.0f;
+
+	// A sphere does not change with the camera's orientation, and rounding keeps float noise out of its size
+	float radius = 0.0f;
+	for (const QVector3D& corner : corners)
+	{
+		radius = std::max(radius, (corner - center).length());
+	}
+	radius = std::ceil(radius * 16.0f) / 16.0f;
+
+	Cascade& cascade = mCascades[index];
+	QVector3D lightCenter = (mLightView * mInverseView).map(center);
+	bool isCached = index >= mCachedCascadeStart;
+	if (isCached && cascade.isStaticCached && (lightCenter - cascade.center).length() + radius <= cascade.radius)
+		return false;
+
+	if (isCached)
+	{
+		radius *= 1.0f + CACHE_MARGIN;
+	}
+
+	// Whole-texel steps, so a moving camera slides the map without resampling the casters
+	float texelSize = 2.0f * radius / mResolution;
+	lightCenter.setX(std::floor(lightCenter.x() / texelSize) * texelSize);
+	lightCenter.setY(std::floor(lightCenter.y() / texelSize) * texelSize);
+	cascade.center = lightCenter;
+	cascade.radius = radius;
+
+	// Light space looks down -Z; the box reaches back towards the light for casters outside the view
+	QMatrix4x4 orthographic;
+	orthographic.ortho(lightCenter.x() - radius, lightCenter.x() + radius, lightCenter.y() - radius, lightCenter.y() + radius,
+		-(lightCenter.z() + radius + mShadowDistance), -(lightCenter.z() - radius));
+	cascade.viewProjection = orthographic * mLightView;
+	cascade.isStaticCached = false;
+	return true;
+}
+
+void CascadedShadowMaps::cullCasters(const Cascade& cascade, bool isStatic, std::vector<int>& visible) const
+{
+	visible.clear();
+	Frustum frustum = Frustum::fromMatrix(cascade.viewProjection);
+	for (int i = 0; i < static_cast<int>(mCasters.size()); ++i)
+	{
+		const Caster& caster = mCasters[i];
+		if (caster.isStatic == isStatic && frustum.intersectsSphere(caster.center, caster.radius))
+		{
+			visible.push_back(i);
+		}
+	}
+}
+
+void CascadedShadowMaps::attachLayer(GLenum target, GLuint framebuffer, GLuint texture, int layer)
+{
+	glBindFramebuffer(target, framebuffer);
+	glFramebufferTextureLayer(target, GL_DEPTH_ATTACHMENT, texture, 0, layer);
+}
+
+int CascadedShadowMaps::drawCasters(const Cascade& cascade, const std::vector<int>& casters)
+{
+	mDepthShader->setUniformValue("mProj", cascade.viewProjection);
+	for (int index : casters)
+	{
+		const Caster& caster = mCasters[index];
+		mDepthShader->setUniformValue("mWorld", caster.world);
+		caster.mesh->drawDepth();
+	}
+	return static_cast<int>(casters.size());
+}
+
+void CascadedShadowMaps::render(const QMatrix4x4& view, const QMatrix4x4& projection, float nearPlane, float farPlane, const LightData& light,
+	const RenderTarget& target, RenderStats& stats)
+{
+	mIsActive = false;
+	if (!mIsEnabled || !mIsStarted || light.type != LightType::DIRECTIONAL || !mDepthShader->getIsReady())
+		return;
+
+	PROFILE_GPU_SCOPE("Shadow Maps");
+
+	if (mAllocatedResolution != mResolution)
+	{
+		allocate();
+	}
+
+	// Turning the light or changing any static caster invalidates every cache
+	QVector3D direction = light.direction.normalized();
+	if (QVector3D::dotProduct(direction, mLightDirection) < 0.99999f || mStaticHash != mCachedStaticHash)
+	{
+		for (auto& cascade : mCascades)
+		{
+			cascade.isStaticCached = false;
+		}
+	}
+	mLightDirection = direction;
+	mCachedStaticHash = mStaticHash;
+
+	QVector3D up = std::abs(direction.y()) > 0.99f ? QVector3D(1.0f, 0.0f, 0.0f) : QVector3D(0.0f, 1.0f, 0.0f);
+	mLightView.setToIdentity();
+	mLightView.lookAt(QVector3D(), direction, up);
+	mInverseView = view.inverted();
+
+	nearPlane = std::max(nearPlane, 1e-3f);
+	computeSplits(nearPlane, std::max(std::min(farPlane, mShadowDistance), nearPlane * 2.0f));
+
+	// Shadow maps always use the conventional depth range, whatever the camera draws with
+	GLStateCache& state = GLStateCache::instance();
+	bool wasDepthReversed = state.getIsDepthReversed();
+	bool wasDepthZeroToOne = state.getIsDepthZeroToOne();
+
+	state.setIsDepthReversed(false);
+	state.setIsDepthZeroToOne(false);
+	state.setClearDepth(1.0f);
+	state.setIsEnabled(GL_DEPTH_TEST, true);
+	state.setDepthFunc(GL_LESS);
+	state.setDepthMask(true);
+	state.setPolygonMode(GL_FILL);
+	// Open meshes such as planes must cast from either side
+	state.setIsEnabled(GL_CULL_FACE, false);
+	state.setIsEnabled(GL_POLYGON_OFFSET_FILL, true);
+	glPolygonOffset(2.0f, 4.0f);
+	glViewport(0, 0, mResolution, mResolution);
+
+	mDepthShader->bind();
+	mDepthShader->setUniformValue("mView", QMatrix4x4());
+
+	for (int i = 0; i < mCascadeCount; ++i)
+	{
+		PROFILE_GPU_SCOPE(CASCADE_SCOPE_NAMES[i]);
+
+		Cascade& cascade = mCascades[i];
+		fitCascade(i, projection, i == 0 ? nearPlane : mSplits[i - 1], mSplits[i]);
+		stats.shadowCascades++;
+
+		if (i < mCachedCascadeStart)
+		{
+			attachLayer(GL_DRAW_FRAMEBUFFER, mDrawFramebuffer, mShadowTexture, i);
+			glClear(GL_DEPTH_BUFFER_BIT);
+			cullCasters(cascade, true, mVisible);
+			stats.shadowDrawCalls += drawCasters(cascade, mVisible);
+			cullCasters(cascade, false, mVisible);
+			stats.shadowDrawCalls += drawCasters(cascade, mVisible);
+			continue;
+		}
+
+		bool isStaticRedrawn = !cascade.isStaticCached;
+		if (isStaticRedrawn)
+		{
+			attachLayer(GL_DRAW_FRAMEBUFFER, mDrawFramebuffer, mStaticTexture, i);
+			glClear(GL_DEPTH_BUFFER_BIT);
+			cullCasters(cascade, true, mVisible);
+			stats.shadowDrawCalls += drawCasters(cascade, mVisible);
+			cascade.isStaticCached = true;
+		}
+		else
+		{
+			stats.shadowCachedCascades++;
+		}
+
+		// The layer already holds the cache when nothing dynamic was drawn over it then or now
+		cullCasters(cascade, false, mVisible);
+		bool hasDynamic = !mVisible.empty();
+		if (isStaticRedrawn || hasDynamic || cascade.hasDynamic)
+		{
+			attachLayer(GL_READ_FRAMEBUFFER, mReadFramebuffer, mStaticTexture, i);
+			attachLayer(GL_DRAW_FRAMEBUFFER, mDrawFramebuffer, mShadowTexture, i);
+			glBlitFramebuffer(0, 0, mResolution, mResolution, 0, 0, mResolution, mResolution, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+			stats.shadowDrawCalls += drawCasters(cascade, mVisible);
+		}
+		cascade.hasDynamic = hasDynamic;
+	}
+
+	mDepthShader->release();
+
+	state.setIsEnabled(GL_POLYGON_OFFSET_FILL, false);
+	state.setIsDepthReversed(wasDepthReversed);
+	state.setIsDepthZeroToOne(wasDepthZeroToOne);
+	state.setClearDepth(state.getFarDepth());
+	glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+	glViewport(0, 0, target.width, target.height);
+
+	state.bindTexture(SHADOW_TEXTURE_UNIT, GL_TEXTURE_2D_ARRAY, mShadowTexture);
+	mIsActive = true;
+}
+
+void CascadedShadowMaps::apply(ShaderProgram& shader) const
+{
+	// Set even without shadows: left at unit 0 it would alias the material's texture array
+	shader.setUniformValue("mShadowMap", SHADOW_TEXTURE_UNIT);
+	if (!mIsActive)
+	{
+		shader.setUniformValue("mShadowCascadeCount", 0);
+		return;
+	}
+
+	// Fragments hand in view-space positions; the bias maps clip space to texture coordinates and depth
+	const QMatrix4x4 bias(
+		0.5f, 0.0f, 0.0f, 0.5f,
+		0.0f, 0.5f, 0.0f, 0.5f,
+		0.0f, 0.0f, 0.5f, 0.5f,
+		0.0f, 0.0f, 0.0f, 1.0f);
+
+	QMatrix4x4 matrices[MAX_CASCADES];
+	QVector4D splits;
+	QVector4D texelSizes;
+	for (int i = 0; i < mCascadeCount; ++i)
+	{
+		matrices[i] = bias * mCascades[i].viewProjection * mInverseView;
+		splits[i] = mSplits[i];
+		texelSizes[i] = 2.0f * mCascades[i].radius / mResolution;
+	}
+
+	shader.setUniformValueArray("mShadowMatrices", matrices, MAX_CASCADES);
+	shader.setUniformValue("mShadowSplits", splits);
+	shader.setUniformValue("mShadowTexelSizes", texelSizes);
+	shader.setUniformValue("mShadowCascadeCount", mCascadeCount);
+}
@@ -0,0 +1,352 @@
+#include "Engine/Renders/ClusteredLighting.h"
+#include "Engine/Profiling/Profiler.h"
+#include "Engine/Renders/GLStateCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+ClusteredLighting::ClusteredLighting()
+	: mIsStarted(false), mIsActive(false), mIsOverflowReported(false), mAmbientColor(51, 51, 51), mShadows(nullptr),
+	mLightBuffer(0), mClusterBuffer(0), mIndexBuffer(0), mLightTexture(0), mClusterTexture(0), mIndexTexture(0),
+	mDirectionalCount(0), mShadowLightIndex(-1), mDepthScale(0.0f), mDepthBias(0.0f)
+{
+}
+
+ClusteredLighting::~ClusteredLighting()
+{
+}
+
+void ClusteredLighting::init()
+{
+	initializeOpenGLFunctions();
+	mExtensions.init();
+}
+
+void ClusteredLighting::tryStart()
+{
+	if (!mIsStarted && getIsSupported())
+	{
+		mIsStarted = true;
+		start();
+	}
+}
+
+void ClusteredLighting::start()
+{
+	GLStateCache& state = GLStateCache::instance();
+
+	glGenBuffers(1, &mLightBuffer);
+	glGenBuffers(1, &mClusterBuffer);
+	glGenBuffers(1, &mIndexBuffer);
+	glGenTextures(1, &mLightTexture);
+	glGenTextures(1, &mClusterTexture);
+	glGenTextures(1, &mIndexTexture);
+
+	// The attachments survive the buffers being respecified every frame
+	state.bindTexture(LIGHT_TEXTURE_UNIT, GL_TEXTURE_BUFFER, mLightTexture);
+	mExtensions.glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, mLightBuffer);
+	state.bindTexture(CLUSTER_TEXTURE_UNIT, GL_TEXTURE_BUFFER, mClusterTexture);
+	mExtensions.glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, mClusterBuffer);
+	state.bindTexture(INDEX_TEXTURE_UNIT, GL_TEXTURE_BUFFER, mIndexTexture);
+	mExtensions.glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, mIndexBuffer);
+}
+
+void ClusteredLighting::clear()
+{
+	if (mIsStarted)
+	{
+		GLStateCache& state = GLStateCache::instance();
+		state.deleteTexture(mLightTexture);
+		state.deleteTexture(mClusterTexture);
+		state.deleteTexture(mIndexTexture);
+		state.deleteBuffer(mLightBuffer);
+		state.deleteBuffer(mClusterBuffer);
+		state.deleteBuffer(mIndexBuffer);
+	}
+
+	mLights.clear();
+	mIsStarted = false;
+	mIsActive = false;
+}
+
+bool ClusteredLighting::getIsSupported() const
+{
+	return mExtensions.hasTextureBuffer;
+}
+
+bool ClusteredLighting::getIsActive() const
+{
+	return mIsActive;
+}
+
+void ClusteredLighting::setShadows(CascadedShadowMaps* shadows)
+{
+	mShadows = shadows;
+}
+
+const LightData* ClusteredLighting::getShadowLight() const
+{
+	return mIsActive && mShadowLightIndex >= 0 ? &mLights[mShadowLightIndex] : nullptr;
+}
+
+void ClusteredLighting::setAmbientColor(const QColor& color)
+{
+	mAmbientColor = color;
+}
+
+QColor ClusteredLighting::getAmbientColor() const
+{
+	return mAmbientColor;
+}
+
+void ClusteredLighting::begin()
+{
+	mLights.clear();
+	mIsActive = false;
+}
+
+void ClusteredLighting::submit(const LightData& light)
+{
+	mLights.push_back(light);
+}
+
+int ClusteredLighting::getLightCount() const
+{
+	return static_cast<int>(mLights.size());
+}
+
+int ClusteredLighting::getSlice(float depth) const
+{
+	int slice = static_cast<int>(std::log(std::max(depth, 1e-4f)) * mDepthScale + mDepthBias);
+	return std::clamp(slice, 0, SLICE_COUNT - 1);
+}
+
+void ClusteredLighting::upload(GLuint buffer, const void* data, GLsizeiptr size)
+{
+	// Orphaned every frame, so the driver hands out fresh storage instead of waiting on the last frame's draws
+	GLStateCache::instance().bindBuffer(GL_TEXTURE_BUFFER, buffer);
+	glBufferData(GL_TEXTURE_BUFFER, size, data, GL_STREAM_DRAW);
+}
+
+void ClusteredLighting::build(const QMatrix4x4& view, const QMatrix4x4& projection, float nearPlane, float farPlane,
+	const RenderTarget& target, RenderStats& stats)
+{
+	mIsActive = false;
+	if (!mIsStarted || mLights.empty())
+		return;
+
+	PROFILE_SCOPE("ClusteredLighting::build");
+
+	if (target.width <= 0 || target.height <= 0)
+		return;
+
+	mViewport = QVector4D(0.0f, 0.0f, static_cast<float>(target.width) / TILE_COUNT_X, static_cast<float>(target.height) / TILE_COUNT_Y);
+	nearPlane = std::max(nearPlane, 1e-4f);
+	farPlane = std::max(farPlane, nearPlane * 2.0f);
+	mDepthScale = SLICE_COUNT / std::log(farPlane / nearPlane);
+	mDepthBias = -std::log(nearPlane) * mDepthScale;
+
+	// Directional lights go first so every fragment can loop over them without an index list
+	std::stable_partition(mLights.begin(), mLights.end(), [](const LightData& light) {
+		return light.type == LightType::DIRECTIONAL;
+	});
+	if (mLights.size() > static_cast<size_t>(MAX_LIGHTS))
+	{
+		stats.lightsDropped = static_cast<int>(mLights.size()) - MAX_LIGHTS;
+		if (!mIsOverflowReported)
+		{
+			std::cout << "WARNING::CLUSTERED_LIGHTING::TOO_MANY_LIGHTS " << mLights.size() << " submitted, only " << MAX_LIGHTS << " are shaded" << std::endl;
+			mIsOverflowReported = true;
+		}
+		mLights.resize(MAX_LIGHTS);
+	}
+
+	int lightCount = static_cast<int>(mLights.size());
+	mDirectionalCount = static_cast<int>(std::count_if(mLights.begin(), mLights.end(), [](const LightData& light) {
+		return light.type == LightType::DIRECTIONAL;
+	}));
+	int binnedCount = lightCount - mDirectionalCount;
+
+	mShadowLightIndex = -1;
+	for (int i = 0; i < mDirectionalCount && mShadowLightIndex < 0; ++i)
+	{
+		if (mLights[i].isCastingShadows)
+		{
+			mShadowLightIndex = i;
+		}
+	}
+
+	// Shading happens in view space: position and range, colour and inner cone, direction and outer cone
+	mLightTexels.resize(static_cast<size_t>(lightCount) * TEXELS_PER_LIGHT * 4);
+	mViewX.resize(binnedCount);
+	mViewY.resize(binnedCount);
+	mViewZ.resize(binnedCount);
+	mRadii.resize(binnedCount);
+	for (int i = 0; i < lightCount; ++i)
+	{
+		const LightData& light = mLights[i];
+		QVector3D position = view.map(light.position);
+		QVector3D direction = view.mapVector(light.direction).normalized();
+
+		float* texels = &mLightTexels[static_cast<size_t>(i) * TEXELS_PER_LIGHT * 4];
+		texels[0] = position.x();
+		texels[1] = position.y();
+		texels[2] = position.z();
+		texels[3] = light.range;
+		texels[4] = light.color.x();
+		texels[5] = light.color.y();
+		texels[6] = light.color.z();
+		texels[7] = light.innerConeCos;
+		texels[8] = direction.x();
+		texels[9] = direction.y();
+		texels[10] = direction.z();
+		texels[11] = light.outerConeCos;
+
+		if (i >= mDirectionalCount)
+		{
+			int binned = i - mDirectionalCount;
+			mViewX[binned] = position.x();
+			mViewY[binned] = position.y();
+			mViewZ[binned] = position.z();
+			mRadii[binned] = light.range;
+		}
+	}
+
+	// Tile boundaries are the view-space planes where clip x (or y) equals a fixed NDC value,
+	// normal pointing towards the higher tile; one pass over all lights per plane
+	const int planeCountX = TILE_COUNT_X + 1;
+	const int planeCountY = TILE_COUNT_Y + 1;
+	mPlaneDistances.resize(static_cast<size_t>(planeCountX + planeCountY) * binnedCount);
+	QVector4D rowW = projection.row(3);
+	for (int plane = 0; plane < planeCountX + planeCountY; ++plane)
+	{
+		bool isX = plane < planeCountX;
+		int boundary = isX ? plane : plane - planeCountX;
+		float ndc = -1.0f + 2.0f * boundary / (isX ? TILE_COUNT_X : TILE_COUNT_Y);
+		QVector4D equation = (isX ? projection.row(0) : projection.row(1)) - ndc * rowW;
+		equation /= std::max(equation.toVector3D().length(), 1e-6f);
+
+		const float a = equation.x();
+		const float b = equation.y();
+		const float c = equation.z();
+		const float d = equation.w();
+		float* distances = &mPlaneDistances[static_cast<size_t>(plane) * binnedCount];
+		const float* x = mViewX.data();
+		const float* y = mViewY.data();
+		const float* z = mViewZ.data();
+		for (int i = 0; i < binnedCount; ++i)
+		{
+			distances[i] = a * x[i] + b * y[i] + c * z[i] + d;
+		}
+	}
+
+	// Cluster box of every light; tile i lies between planes i and i + 1
+	mRanges.clear();
+	for (int i = 0; i < binnedCount; ++i)
+	{
+		float radius = mRadii[i];
+		float depth = -mViewZ[i];
+		if (depth + radius < nearPlane)
+			continue;
+
+		LightRange range;
+		range.light = mDirectionalCount + i;
+		range.minX = TILE_COUNT_X;
+		range.maxX = -1;
+		range.minY = TILE_COUNT_Y;
+		range.maxY = -1;
+		for (int tile = 0; tile < TILE_COUNT_X; ++tile)
+		{
+			float lower = mPlaneDistances[static_cast<size_t>(tile) * binnedCount + i];
+			float upper = mPlaneDistances[static_cast<size_t>(tile + 1) * binnedCount + i];
+			if (lower >= -radius && upper <= radius)
+			{
+				range.minX = std::min(range.minX, tile);
+				range.maxX = tile;
+			}
+		}
+		for (int tile = 0; tile < TILE_COUNT_Y; ++tile)
+		{
+			float lower = mPlaneDistances[static_cast<size_t>(planeCountX + tile) * binnedCount + i];
+			float upper = mPlaneDistances[static_cast<size_t>(planeCountX + tile + 1) * binnedCount + i];
+			if (lower >= -radius && upper <= radius)
+			{
+				range.minY = std::min(range.minY, tile);
+				range.maxY = tile;
+			}
+		}
+		if (range.maxX < 0 || range.maxY < 0)
+			continue;
+
+		range.minZ = getSlice(std::max(depth - radius, nearPlane));
+		range.maxZ = getSlice(depth + radius);
+		mRanges.push_back(range);
+	}
+
+	// Count, prefix-sum and fill, so the index list is one flat array without per-cluster storage
+	mClusters.assign(CLUSTER_COUNT * 2, 0);
+	for (const LightRange& range : mRanges)
+	{
+		for (int z = range.minZ; z <= range.maxZ; ++z)
+			for (int y = range.minY; y <= range.maxY; ++y)
+				for (int x = range.minX; x <= range.maxX; ++x)
+					mClusters[((z * TILE_COUNT_Y + y) * TILE_COUNT_X + x) * 2 + 1]++;
+	}
+
+	GLuint offset = 0;
+	for (int cluster = 0; cluster < CLUSTER_COUNT; ++cluster)
+	{
+		mClusters[cluster * 2] = offset;
+		offset += mClusters[cluster * 2 + 1];
+		mClusters[cluster * 2 + 1] = 0;
+	}
+
+	mIndices.resize(std::max<GLuint>(offset, 1));
+	for (const LightRange& range : mRanges)
+	{
+		for (int z = range.minZ; z <= range.maxZ; ++z)
+			for (int y = range.minY; y <= range.maxY; ++y)
+				for (int x = range.minX; x <= range.maxX; ++x)
+				{
+					GLuint* cluster = &mClusters[((z * TILE_COUNT_Y + y) * TILE_COUNT_X + x) * 2];
+					mIndices[cluster[0] + cluster[1]++] = static_cast<GLuint>(range.light);
+				}
+	}
+
+	upload(mLightBuffer, mLightTexels.data(), mLightTexels.size() * sizeof(float));
+	upload(mClusterBuffer, mClusters.data(), mClusters.size() * sizeof(GLuint));
+	upload(mIndexBuffer, mIndices.data(), mIndices.size() * sizeof(GLuint));
+
+	GLStateCache& state = GLStateCache::instance();
+	state.bindTexture(LIGHT_TEXTURE_UNIT, GL_TEXTURE_BUFFER, mLightTexture);
+	state.bindTexture(CLUSTER_TEXTURE_UNIT, GL_TEXTURE_BUFFER, mClusterTexture);
+	state.bindTexture(INDEX_TEXTURE_UNIT, GL_TEXTURE_BUFFER, mIndexTexture);
+
+	stats.lights = lightCount;
+	stats.lightIndices = static_cast<int>(offset);
+	mIsActive = true;
+}
+
+void ClusteredLighting::apply(ShaderProgram& shader) const
+{
+	shader.setUniformValue("mLights", LIGHT_TEXTURE_UNIT);
+	shader.setUniformValue("mClusters", CLUSTER_TEXTURE_UNIT);
+	shader.setUniformValue("mLightIndices", INDEX_TEXTURE_UNIT);
+	shader.setUniformValue("mDirectionalLightCount", mDirectionalCount);
+	shader.setUniformValue("mClusterCounts", QVector3D(TILE_COUNT_X, TILE_COUNT_Y, SLICE_COUNT));
+	shader.setUniformValue("mClusterViewport", mViewport);
+	shader.setUniformValue("mClusterDepthParams", QVector2D(mDepthScale, mDepthBias));
+	shader.setUniformValue("mAmbientColor", QVector3D(mAmbientColor.redF(), mAmbientColor.greenF(), mAmbientColor.blueF()));
+
+	shader.setUniformValue("mShadowLightIndex", mShadowLightIndex);
+	if (mShadows)
+	{
+		mShadows->apply(shader);
+	}
+	else
+	{
+		shader.setUniformValue("mShadowMap", CascadedShadowMaps::SHADOW_TEXTURE_UNIT);
+		shader.setUniformValue("mShadowCascadeCount", 0);
+	}
+}
@@ -1,20 +1,21 @@
 #include "Engine/Renders/EBO.h"
+#include "Engine/Renders/GLStateCache.h"
 
 EBO::EBO(const void* data, GLsizeiptr size) {
     initializeOpenGLFunctions();
     glGenBuffers(1, &mID);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mID);
+    GLStateCache::instance().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, mID);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
 }
 
 EBO::~EBO() {
-    glDeleteBuffers(1, &mID);
+    GLStateCache::instance().deleteBuffer(mID);
 }
 
 void EBO::bind() {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mID);
+    GLStateCache::instance().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, mID);
 }
 
 void EBO::unbind() {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GLStateCache::instance().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
\ No newline at end of file
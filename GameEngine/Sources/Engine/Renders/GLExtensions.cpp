@@ -0,0 +1,116 @@
+#include "Engine/Renders/GLExtensions.h"
+
+GLExtensions::GLExtensions()
+	: isDesktop(false), majorVersion(0), minorVersion(0),
+	hasMultiDrawIndirect(false), hasShaderDrawParameters(false), hasShaderStorageBuffer(false),
+	hasComputeShader(false), hasIndirectParameters(false), hasBufferStorage(false), hasTimerQuery(false), hasParallelShaderCompile(false), hasTextureCompressionBC(false), hasClipControl(false), hasTextureBuffer(false),
+	glMultiDrawElementsIndirect(nullptr), glMultiDrawElementsIndirectCount(nullptr), glClearBufferData(nullptr), glBufferStorage(nullptr),
+	glQueryCounter(nullptr), glGetQueryObjectui64v(nullptr), glMaxShaderCompilerThreads(nullptr), glClipControl(nullptr), glTexBuffer(nullptr),
+	mContext(nullptr)
+{
+}
+
+void GLExtensions::init()
+{
+	mContext = QOpenGLContext::currentContext();
+	if (!mContext)
+		return;
+
+	isDesktop = !mContext->isOpenGLES();
+	majorVersion = mContext->format().majorVersion();
+	minorVersion = mContext->format().minorVersion();
+
+	hasShaderStorageBuffer = isDesktop && (hasVersion(4, 3) || hasExtension("GL_ARB_shader_storage_buffer_object"));
+	hasShaderDrawParameters = isDesktop && (hasVersion(4, 6) || hasExtension("GL_ARB_shader_draw_parameters"));
+
+	if (isDesktop && (hasVersion(4, 3) || hasExtension("GL_ARB_multi_draw_indirect")))
+	{
+		glMultiDrawElementsIndirect = reinterpret_cast<MultiDrawElementsIndirect>(mContext->getProcAddress("glMultiDrawElementsIndirect"));
+	}
+	hasMultiDrawIndirect = glMultiDrawElementsIndirect != nullptr;
+
+	if (isDesktop && (hasVersion(4, 3) || hasExtension("GL_ARB_clear_buffer_object")))
+	{
+		glClearBufferData = reinterpret_cast<ClearBufferData>(mContext->getProcAddress("glClearBufferData"));
+	}
+	hasComputeShader = isDesktop && (hasVersion(4, 3) || hasExtension("GL_ARB_compute_shader")) && glClearBufferData != nullptr;
+
+	if (isDesktop && hasVersion(4, 6))
+	{
+		glMultiDrawElementsIndirectCount = reinterpret_cast<MultiDrawElementsIndirectCount>(mContext->getProcAddress("glMultiDrawElementsIndirectCount"));
+	}
+	else if (isDesktop && hasExtension("GL_ARB_indirect_parameters"))
+	{
+		glMultiDrawElementsIndirectCount = reinterpret_cast<MultiDrawElementsIndirectCount>(mContext->getProcAddress("glMultiDrawElementsIndirectCountARB"));
+	}
+	hasIndirectParameters = glMultiDrawElementsIndirectCount != nullptr;
+
+	if (isDesktop && (hasVersion(4, 4) || hasExtension("GL_ARB_buffer_storage")))
+	{
+		glBufferStorage = reinterpret_cast<BufferStorage>(mContext->getProcAddress("glBufferStorage"));
+	}
+	else if (!isDesktop && hasExtension("GL_EXT_buffer_storage"))
+	{
+		glBufferStorage = reinterpret_cast<BufferStorage>(mContext->getProcAddress("glBufferStorageEXT"));
+	}
+	hasBufferStorage = glBufferStorage != nullptr;
+
+	if (isDesktop && (hasVersion(3, 3) || hasExtension("GL_ARB_timer_query")))
+	{
+		glQueryCounter = reinterpret_cast<QueryCounter>(mContext->getProcAddress("glQueryCounter"));
+		glGetQueryObjectui64v = reinterpret_cast<GetQueryObjectui64v>(mContext->getProcAddress("glGetQueryObjectui64v"));
+	}
+	else if (!isDesktop && hasExtension("GL_EXT_disjoint_timer_query"))
+	{
+		glQueryCounter = reinterpret_cast<QueryCounter>(mContext->getProcAddress("glQueryCounterEXT"));
+		glGetQueryObjectui64v = reinterpret_cast<GetQueryObjectui64v>(mContext->getProcAddress("glGetQueryObjectui64vEXT"));
+	}
+	hasTimerQuery = glQueryCounter != nullptr && glGetQueryObjectui64v != nullptr;
+
+	if (hasExtension("GL_KHR_parallel_shader_compile"))
+	{
+		glMaxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreads>(mContext->getProcAddress("glMaxShaderCompilerThreadsKHR"));
+	}
+	else if (isDesktop && hasExtension("GL_ARB_parallel_shader_compile"))
+	{
+		glMaxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreads>(mContext->getProcAddress("glMaxShaderCompilerThreadsARB"));
+	}
+	hasParallelShaderCompile = glMaxShaderCompilerThreads != nullptr;
+
+	hasTextureCompressionBC = hasExtension("GL_EXT_texture_compression_s3tc") || hasExtension("GL_EXT_texture_compression_dxt1");
+
+	if (isDesktop && (hasVersion(4, 5) || hasExtension("GL_ARB_clip_control")))
+	{
+		glClipControl = reinterpret_cast<ClipControl>(mContext->getProcAddress("glClipControl"));
+	}
+	else if (!isDesktop && hasExtension("GL_EXT_clip_control"))
+	{
+		glClipControl = reinterpret_cast<ClipControl>(mContext->getProcAddress("glClipControlEXT"));
+	}
+	hasClipControl = glClipControl != nullptr;
+
+	if (isDesktop ? hasVersion(3, 1) : hasVersion(3, 2))
+	{
+		glTexBuffer = reinterpret_cast<TexBuffer>(mContext->getProcAddress("glTexBuffer"));
+	}
+	else if (!isDesktop && hasExtension("GL_EXT_texture_buffer"))
+	{
+		glTexBuffer = reinterpret_cast<TexBuffer>(mContext->getProcAddress("glTexBufferEXT"));
+	}
+	hasTextureBuffer = glTexBuffer != nullptr;
+}
+
+QOpenGLContext* GLExtensions::getContext() const
+{
+	return mContext;
+}
+
+bool GLExtensions::hasVersion(int major, int minor) const
+{
+	return majorVersion > major || (majorVersion == major && minorVersion >= minor);
+}
+
+bool GLExtensions::hasExtension(const char* name) const
+{
+	return mContext && mContext->hasExtension(QByteArray(name));
+}
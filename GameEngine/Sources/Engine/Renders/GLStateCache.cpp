@@ -0,0 +1,428 @@
+#include "Engine/Renders/GLStateCache.h"
+
+#include <algorithm>
+
+GLStateCache& GLStateCache::instance()
+{
+	static GLStateCache cache;
+	return cache;
+}
+
+GLStateCache::GLStateCache() : mIssuedCount(0), mElidedCount(0), mIsDepthReversed(false), mIsDepthZeroToOne(false)
+{
+	invalidate();
+}
+
+void GLStateCache::init()
+{
+	initializeOpenGLFunctions();
+	mExtensions.init();
+	invalidate();
+}
+
+void GLStateCache::invalidate()
+{
+	mProgram = UNKNOWN;
+	mVertexArray = UNKNOWN;
+	std::fill(std::begin(mBuffers), std::end(mBuffers), UNKNOWN);
+	mActiveTexture = UNKNOWN;
+	for (auto& unit : mTextures)
+	{
+		std::fill(std::begin(unit), std::end(unit), UNKNOWN);
+	}
+	for (auto& capability : mCapabilities)
+	{
+		capability.isEnabled = UNKNOWN;
+	}
+	mFrontPolygonMode = UNKNOWN;
+	mBackPolygonMode = UNKNOWN;
+	mCullFace = UNKNOWN;
+	mBlendSource = UNKNOWN;
+	mBlendDestination = UNKNOWN;
+	mDepthFunc = UNKNOWN;
+	mClipDepthMode = UNKNOWN;
+	mIsClearDepthKnown = false;
+	mDepthMask = UNKNOWN;
+	mColorMask = UNKNOWN;
+	mIsClearColorKnown = false;
+}
+
+void GLStateCache::beginFrame()
+{
+	// The widget binds its framebuffer and Qt may draw between frames with its own state
+	invalidate();
+	mIssuedCount = 0;
+	mElidedCount = 0;
+}
+
+int GLStateCache::getIssuedCount() const
+{
+	return mIssuedCount;
+}
+
+int GLStateCache::getElidedCount() const
+{
+	return mElidedCount;
+}
+
+bool GLStateCache::update(GLuint& cached, GLuint value)
+{
+	if (cached == value)
+	{
+		mElidedCount++;
+		return false;
+	}
+
+	cached = value;
+	mIssuedCount++;
+	return true;
+}
+
+int GLStateCache::getBufferSlot(GLenum target)
+{
+	switch (target)
+	{
+	case GL_ARRAY_BUFFER: return BUFFER_ARRAY;
+	case GL_ELEMENT_ARRAY_BUFFER: return BUFFER_ELEMENT_ARRAY;
+	case GL_COPY_READ_BUFFER: return BUFFER_COPY_READ;
+	case GL_COPY_WRITE_BUFFER: return BUFFER_COPY_WRITE;
+	case GL_DRAW_INDIRECT_BUFFER: return BUFFER_DRAW_INDIRECT;
+	case GL_PARAMETER_BUFFER: return BUFFER_PARAMETER;
+	case GL_SHADER_STORAGE_BUFFER: return BUFFER_SHADER_STORAGE;
+	case GL_UNIFORM_BUFFER: return BUFFER_UNIFORM;
+	case GL_PIXEL_PACK_BUFFER: return BUFFER_PIXEL_PACK;
+	case GL_PIXEL_UNPACK_BUFFER: return BUFFER_PIXEL_UNPACK;
+	default: return -1;
+	}
+}
+
+int GLStateCache::getTextureSlot(GLenum target)
+{
+	switch (target)
+	{
+	case GL_TEXTURE_2D: return TEXTURE_2D;
+	case GL_TEXTURE_2D_ARRAY: return TEXTURE_2D_ARRAY;
+	case GL_TEXTURE_3D: return TEXTURE_3D;
+	case GL_TEXTURE_CUBE_MAP: return TEXTURE_CUBE_MAP;
+	case GL_TEXTURE_BUFFER: return TEXTURE_BUFFER;
+	default: return -1;
+	}
+}
+
+void GLStateCache::useProgram(GLuint program)
+{
+	if (update(mProgram, program))
+	{
+		glUseProgram(program);
+	}
+}
+
+GLuint GLStateCache::getProgram() const
+{
+	return mProgram == UNKNOWN ? 0 : mProgram;
+}
+
+void GLStateCache::bindVertexArray(GLuint vertexArray)
+{
+	if (update(mVertexArray, vertexArray))
+	{
+		glBindVertexArray(vertexArray);
+		mBuffers[BUFFER_ELEMENT_ARRAY] = UNKNOWN;
+	}
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+	int slot = getBufferSlot(target);
+	if (slot < 0)
+	{
+		mIssuedCount++;
+		glBindBuffer(target, buffer);
+		return;
+	}
+
+	if (update(mBuffers[slot], buffer))
+	{
+		glBindBuffer(target, buffer);
+	}
+}
+
+void GLStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+	mIssuedCount++;
+	glBindBufferBase(target, index, buffer);
+
+	int slot = getBufferSlot(target);
+	if (slot >= 0)
+	{
+		mBuffers[slot] = buffer;
+	}
+}
+
+void GLStateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+	mIssuedCount++;
+	glBindBufferRange(target, index, buffer, offset, size);
+
+	int slot = getBufferSlot(target);
+	if (slot >= 0)
+	{
+		mBuffers[slot] = buffer;
+	}
+}
+
+void GLStateCache::activeTexture(int unit)
+{
+	if (update(mActiveTexture, static_cast<GLuint>(unit)))
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+	}
+}
+
+void GLStateCache::bindTexture(int unit, GLenum target, GLuint texture)
+{
+	int slot = getTextureSlot(target);
+	if (slot < 0 || unit < 0 || unit >= MAX_TEXTURE_UNITS)
+	{
+		activeTexture(unit);
+		mIssuedCount++;
+		glBindTexture(target, texture);
+		return;
+	}
+
+	// The active unit only matters to the bind itself, so it is left wherever it ends up
+	if (mTextures[unit][slot] == texture)
+	{
+		mElidedCount++;
+		return;
+	}
+
+	activeTexture(unit);
+	update(mTextures[unit][slot], texture);
+	glBindTexture(target, texture);
+}
+
+void GLStateCache::setIsEnabled(GLenum capability, bool isEnabled)
+{
+	auto it = std::find_if(mCapabilities.begin(), mCapabilities.end(), [capability](const Capability& entry) {
+		return entry.capability == capability;
+	});
+	if (it == mCapabilities.end())
+	{
+		mCapabilities.push_back({ capability, UNKNOWN });
+		it = mCapabilities.end() - 1;
+	}
+
+	if (update(it->isEnabled, isEnabled ? 1 : 0))
+	{
+		if (isEnabled)
+			glEnable(capability);
+		else
+			glDisable(capability);
+	}
+}
+
+void GLStateCache::setPolygonMode(GLenum mode, GLenum face)
+{
+	GLuint frontMode = face == GL_BACK ? GL_FILL : mode;
+	GLuint backMode = face == GL_FRONT ? GL_FILL : mode;
+	bool isFrontChanged = update(mFrontPolygonMode, frontMode);
+	bool isBackChanged = update(mBackPolygonMode, backMode);
+	if (isFrontChanged && isBackChanged && frontMode == backMode)
+	{
+		glPolygonMode(GL_FRONT_AND_BACK, frontMode);
+		return;
+	}
+
+	if (isFrontChanged)
+	{
+		glPolygonMode(GL_FRONT, frontMode);
+	}
+	if (isBackChanged)
+	{
+		glPolygonMode(GL_BACK, backMode);
+	}
+}
+
+void GLStateCache::setCullFace(GLenum face)
+{
+	if (update(mCullFace, face))
+	{
+		glCullFace(face);
+	}
+}
+
+void GLStateCache::setBlendFunc(GLenum source, GLenum destination)
+{
+	if (mBlendSource == source && mBlendDestination == destination)
+	{
+		mElidedCount++;
+		return;
+	}
+
+	mBlendSource = source;
+	mBlendDestination = destination;
+	mIssuedCount++;
+	glBlendFunc(source, destination);
+}
+
+GLenum GLStateCache::getReversedDepthFunc(GLenum function)
+{
+	switch (function)
+	{
+	case GL_LESS: return GL_GREATER;
+	case GL_LEQUAL: return GL_GEQUAL;
+	case GL_GREATER: return GL_LESS;
+	case GL_GEQUAL: return GL_LEQUAL;
+	default: return function;
+	}
+}
+
+void GLStateCache::setDepthFunc(GLenum function)
+{
+	if (mIsDepthReversed)
+	{
+		function = getReversedDepthFunc(function);
+	}
+
+	if (update(mDepthFunc, function))
+	{
+		glDepthFunc(function);
+	}
+}
+
+void GLStateCache::setClearDepth(float depth)
+{
+	if (mIsClearDepthKnown && mClearDepth == depth)
+	{
+		mElidedCount++;
+		return;
+	}
+
+	mClearDepth = depth;
+	mIsClearDepthKnown = true;
+	mIssuedCount++;
+	glClearDepthf(depth);
+}
+
+void GLStateCache::setDepthMask(bool isEnabled)
+{
+	if (update(mDepthMask, isEnabled ? 1 : 0))
+	{
+		glDepthMask(isEnabled ? GL_TRUE : GL_FALSE);
+	}
+}
+
+void GLStateCache::setColorMask(bool isEnabled)
+{
+	if (update(mColorMask, isEnabled ? 1 : 0))
+	{
+		GLboolean mask = isEnabled ? GL_TRUE : GL_FALSE;
+		glColorMask(mask, mask, mask, mask);
+	}
+}
+
+void GLStateCache::setClearColor(float red, float green, float blue, float alpha)
+{
+	if (mIsClearColorKnown && mClearColor[0] == red && mClearColor[1] == green && mClearColor[2] == blue && mClearColor[3] == alpha)
+	{
+		mElidedCount++;
+		return;
+	}
+
+	mClearColor[0] = red;
+	mClearColor[1] = green;
+	mClearColor[2] = blue;
+	mClearColor[3] = alpha;
+	mIsClearColorKnown = true;
+	mIssuedCount++;
+	glClearColor(red, green, blue, alpha);
+}
+
+void GLStateCache::setIsDepthReversed(bool isReversed)
+{
+	if (isReversed == mIsDepthReversed)
+		return;
+
+	// The cached function is the one GL holds, so it has to be re-issued in the new convention
+	mIsDepthReversed = isReversed;
+	mDepthFunc = UNKNOWN;
+}
+
+bool GLStateCache::getIsDepthReversed() const
+{
+	return mIsDepthReversed;
+}
+
+void GLStateCache::setIsDepthZeroToOne(bool isZeroToOne)
+{
+	if (!mExtensions.hasClipControl)
+		return;
+
+	mIsDepthZeroToOne = isZeroToOne;
+	GLenum depthMode = isZeroToOne ? GL_ZERO_TO_ONE : GL_NEGATIVE_ONE_TO_ONE;
+	if (update(mClipDepthMode, depthMode))
+	{
+		mExtensions.glClipControl(GL_LOWER_LEFT, depthMode);
+	}
+}
+
+bool GLStateCache::getIsDepthZeroToOne() const
+{
+	return mIsDepthZeroToOne;
+}
+
+bool GLStateCache::getIsClipControlSupported() const
+{
+	return mExtensions.hasClipControl;
+}
+
+float GLStateCache::getFarDepth() const
+{
+	return mIsDepthReversed ? 0.0f : 1.0f;
+}
+
+void GLStateCache::deleteVertexArray(GLuint& vertexArray)
+{
+	if (vertexArray == 0)
+		return;
+
+	glDeleteVertexArrays(1, &vertexArray);
+	if (mVertexArray == vertexArray)
+	{
+		mVertexArray = 0;
+		mBuffers[BUFFER_ELEMENT_ARRAY] = UNKNOWN;
+	}
+	vertexArray = 0;
+}
+
+void GLStateCache::deleteBuffer(GLuint& buffer)
+{
+	if (buffer == 0)
+		return;
+
+	glDeleteBuffers(1, &buffer);
+	for (auto& binding : mBuffers)
+	{
+		if (binding == buffer)
+			binding = 0;
+	}
+	buffer = 0;
+}
+
+void GLStateCache::deleteTexture(GLuint& texture)
+{
+	if (texture == 0)
+		return;
+
+	glDeleteTextures(1, &texture);
+	for (auto& unit : mTextures)
+	{
+		for (auto& binding : unit)
+		{
+			if (binding == texture)
+				binding = 0;
+		}
+	}
+	texture = 0;
+}
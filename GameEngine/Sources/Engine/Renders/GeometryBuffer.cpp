@@ -0,0 +1,252 @@
+#include "Engine/Renders/GeometryBuffer.h"
+#include "Engine/Renders/GLStateCache.h"
+#include <iostream>
+
+GeometryBuffer::GeometryBuffer(unsigned int vertexCapacity, unsigned int indexCapacity)
+	: mIsStarted(false), mVAO(0), mDepthVAO(0), mVertexBuffer(0), mPositionBuffer(0), mIndexBuffer(0),
+	mVertexAllocator(vertexCapacity), mIndexAllocator(indexCapacity)
+{
+}
+
+GeometryBuffer::~GeometryBuffer()
+{
+}
+
+void GeometryBuffer::init()
+{
+	initializeOpenGLFunctions();
+}
+
+void GeometryBuffer::tryStart()
+{
+	if (!mIsStarted)
+	{
+		mIsStarted = true;
+		start();
+	}
+}
+
+void GeometryBuffer::start()
+{
+	glGenVertexArrays(1, &mVAO);
+	glGenVertexArrays(1, &mDepthVAO);
+	glGenBuffers(1, &mVertexBuffer);
+	glGenBuffers(1, &mPositionBuffer);
+	glGenBuffers(1, &mIndexBuffer);
+
+	GLStateCache& state = GLStateCache::instance();
+	state.bindBuffer(GL_COPY_WRITE_BUFFER, mVertexBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(mVertexAllocator.getCapacity()) * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
+	state.bindBuffer(GL_COPY_WRITE_BUFFER, mPositionBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(mVertexAllocator.getCapacity()) * sizeof(QVector3D), nullptr, GL_STATIC_DRAW);
+	state.bindBuffer(GL_COPY_WRITE_BUFFER, mIndexBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(mIndexAllocator.getCapacity()) * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+
+	setupVertexArrays();
+}
+
+void GeometryBuffer::setupVertexArrays()
+{
+	GLStateCache& state = GLStateCache::instance();
+
+	state.bindVertexArray(mVAO);
+	state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+	setupVertexLayout();
+
+	// Depth-only passes fetch 12 bytes per vertex instead of the whole interleaved Vertex
+	state.bindVertexArray(mDepthVAO);
+	state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+	state.bindBuffer(GL_ARRAY_BUFFER, mPositionBuffer);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(QVector3D), (void*)0);
+
+	state.bindVertexArray(0);
+}
+
+void GeometryBuffer::setupVertexLayout()
+{
+	// Expects mVAO to be bound
+	GLStateCache::instance().bindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+
+	// vertex positions
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+	// vertex normals
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+	// vertex texture coords
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoord));
+	// vertex color
+	glEnableVertexAttribArray(3);
+	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
+}
+
+void GeometryBuffer::clear()
+{
+	if (mIsStarted)
+	{
+		GLStateCache& state = GLStateCache::instance();
+		state.deleteVertexArray(mVAO);
+		state.deleteVertexArray(mDepthVAO);
+		state.deleteBuffer(mVertexBuffer);
+		state.deleteBuffer(mPositionBuffer);
+		state.deleteBuffer(mIndexBuffer);
+	}
+
+	mVAO = 0;
+	mDepthVAO = 0;
+	mVertexBuffer = 0;
+	mPositionBuffer = 0;
+	mIndexBuffer = 0;
+	mIsStarted = false;
+
+	mVertexAllocator.reset(mVertexAllocator.getCapacity());
+	mIndexAllocator.reset(mIndexAllocator.getCapacity());
+}
+
+GeometryAllocation GeometryBuffer::allocate(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+	GeometryAllocation allocation;
+	if (!mIsStarted || vertices.empty() || indices.empty())
+		return allocation;
+
+	unsigned int vertexCount = static_cast<unsigned int>(vertices.size());
+	unsigned int indexCount = static_cast<unsigned int>(indices.size());
+
+	allocation.vertexOffset = mVertexAllocator.allocate(vertexCount);
+	if (allocation.vertexOffset == BufferAllocator::INVALID_OFFSET)
+	{
+		// Both vertex streams are indexed by the same allocator, so they grow together
+		unsigned int oldCapacity = mVertexAllocator.getCapacity();
+		unsigned int newCapacity = getGrownCapacity(oldCapacity, oldCapacity + vertexCount);
+		growBuffer(mVertexBuffer, oldCapacity * sizeof(Vertex), newCapacity * sizeof(Vertex));
+		growBuffer(mPositionBuffer, oldCapacity * sizeof(QVector3D), newCapacity * sizeof(QVector3D));
+		mVertexAllocator.grow(newCapacity);
+		setupVertexArrays();
+		allocation.vertexOffset = mVertexAllocator.allocate(vertexCount);
+	}
+
+	allocation.indexOffset = mIndexAllocator.allocate(indexCount);
+	if (allocation.indexOffset == BufferAllocator::INVALID_OFFSET)
+	{
+		unsigned int oldCapacity = mIndexAllocator.getCapacity();
+		unsigned int newCapacity = getGrownCapacity(oldCapacity, oldCapacity + indexCount);
+		growBuffer(mIndexBuffer, oldCapacity * sizeof(unsigned int), newCapacity * sizeof(unsigned int));
+		mIndexAllocator.grow(newCapacity);
+		setupVertexArrays();
+		allocation.indexOffset = mIndexAllocator.allocate(indexCount);
+	}
+
+	if (!allocation.isValid())
+	{
+		std::cout << "ERROR::GEOMETRY_BUFFER::ALLOCATION_FAILED" << std::endl;
+		free(allocation);
+		return allocation;
+	}
+
+	allocation.vertexCount = vertexCount;
+	allocation.indexCount = indexCount;
+
+	// Upload through the copy target so the element binding of whatever VAO is bound stays untouched
+	GLStateCache& state = GLStateCache::instance();
+	state.bindBuffer(GL_COPY_WRITE_BUFFER, mVertexBuffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(allocation.vertexOffset) * sizeof(Vertex),
+		static_cast<GLsizeiptr>(vertexCount) * sizeof(Vertex), vertices.data());
+
+	std::vector<QVector3D> positions;
+	positions.reserve(vertices.size());
+	for (const auto& vertex : vertices)
+	{
+		positions.push_back(vertex.position);
+	}
+	state.bindBuffer(GL_COPY_WRITE_BUFFER, mPositionBuffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(allocation.vertexOffset) * sizeof(QVector3D),
+		static_cast<GLsizeiptr>(vertexCount) * sizeof(QVector3D), positions.data());
+
+	state.bindBuffer(GL_COPY_WRITE_BUFFER, mIndexBuffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(allocation.indexOffset) * sizeof(unsigned int),
+		static_cast<GLsizeiptr>(indexCount) * sizeof(unsigned int), indices.data());
+
+	return allocation;
+}
+
+void GeometryBuffer::free(GeometryAllocation& allocation)
+{
+	if (allocation.vertexOffset != BufferAllocator::INVALID_OFFSET)
+	{
+		mVertexAllocator.free(allocation.vertexOffset, allocation.vertexCount);
+	}
+	if (allocation.indexOffset != BufferAllocator::INVALID_OFFSET)
+	{
+		mIndexAllocator.free(allocation.indexOffset, allocation.indexCount);
+	}
+
+	allocation = GeometryAllocation();
+}
+
+unsigned int GeometryBuffer::getGrownCapacity(unsigned int capacity, unsigned int minCapacity)
+{
+	unsigned int newCapacity = capacity > 0 ? capacity : 1;
+	while (newCapacity < minCapacity)
+	{
+		newCapacity *= 2;
+	}
+	return newCapacity;
+}
+
+void GeometryBuffer::growBuffer(GLuint& buffer, GLsizeiptr oldSize, GLsizeiptr newSize)
+{
+	GLuint newBuffer = 0;
+	glGenBuffers(1, &newBuffer);
+	GLStateCache& state = GLStateCache::instance();
+	state.bindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, GL_STATIC_DRAW);
+
+	state.bindBuffer(GL_COPY_READ_BUFFER, buffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldSize);
+
+	// The vertex arrays still point at the old storage until setupVertexArrays()
+	state.deleteBuffer(buffer);
+	buffer = newBuffer;
+}
+
+void GeometryBuffer::bind()
+{
+	GLStateCache::instance().bindVertexArray(mVAO);
+}
+
+void GeometryBuffer::bindDepth()
+{
+	GLStateCache::instance().bindVertexArray(mDepthVAO);
+}
+
+void GeometryBuffer::unbind()
+{
+	GLStateCache::instance().bindVertexArray(0);
+}
+
+GLuint GeometryBuffer::getVAO() const
+{
+	return mVAO;
+}
+
+GLuint GeometryBuffer::getVertexBuffer() const
+{
+	return mVertexBuffer;
+}
+
+GLuint GeometryBuffer::getIndexBuffer() const
+{
+	return mIndexBuffer;
+}
+
+const BufferAllocator& GeometryBuffer::getVertexAllocator() const
+{
+	return mVertexAllocator;
+}
+
+const BufferAllocator& GeometryBuffer::getIndexAllocator() const
+{
+	return mIndexAllocator;
+}
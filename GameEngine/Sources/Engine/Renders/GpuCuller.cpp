@@ -0,0 +1,204 @@
+#include "Engine/Renders/GpuCuller.h"
+#include "Engine/Profiling/Profiler.h"
+#include "Engine/Renders/Frustum.h"
+#include "Engine/Renders/GLStateCache.h"
+#include "Engine/Renders/IndirectRenderer.h"
+
+GpuCuller::GpuCuller()
+	: mIsStarted(false), mUseOcclusion(true), mOutputCommandBuffer(0), mFrameIndex(0),
+	mLastFrustumCulled(0), mLastOcclusionCulled(0)
+{
+	for (int i = 0; i < READBACK_FRAMES; ++i)
+	{
+		mCounterBuffers[i] = 0;
+		mCounterFences[i] = nullptr;
+	}
+}
+
+GpuCuller::~GpuCuller()
+{
+}
+
+void GpuCuller::init(const GLExtensions& extensions)
+{
+	initializeOpenGLFunctions();
+	mExtensions = extensions;
+	mHiZPyramid.init();
+}
+
+void GpuCuller::tryStart()
+{
+	if (!mIsStarted && mExtensions.hasComputeShader)
+	{
+		mIsStarted = true;
+		start();
+	}
+}
+
+void GpuCuller::start()
+{
+	mCullShader = std::make_unique<ShaderProgram>(":/Resources/Shaders/cull.comp");
+	mCullShader->init();
+	mCullShader->start();
+
+	glGenBuffers(1, &mOutputCommandBuffer);
+	glGenBuffers(READBACK_FRAMES, mCounterBuffers);
+
+	mHiZPyramid.tryStart();
+}
+
+void GpuCuller::clear()
+{
+	if (mIsStarted)
+	{
+		for (int i = 0; i < READBACK_FRAMES; ++i)
+		{
+			if (mCounterFences[i])
+			{
+				glDeleteSync(mCounterFences[i]);
+				mCounterFences[i] = nullptr;
+			}
+		}
+		for (int i = 0; i < READBACK_FRAMES; ++i)
+		{
+			GLStateCache::instance().deleteBuffer(mCounterBuffers[i]);
+		}
+		GLStateCache::instance().deleteBuffer(mOutputCommandBuffer);
+		mCullShader->clear();
+	}
+
+	mHiZPyramid.clear();
+	mCullShader.reset();
+	mOutputCommandBuffer = 0;
+	for (int i = 0; i < READBACK_FRAMES; ++i)
+	{
+		mCounterBuffers[i] = 0;
+	}
+	mIsStarted = false;
+}
+
+void GpuCuller::setUseOcclusion(bool useOcclusion)
+{
+	mUseOcclusion = useOcclusion;
+}
+
+bool GpuCuller::getUseOcclusion() const
+{
+	return mUseOcclusion;
+}
+
+void GpuCuller::readBackCounters(int frame)
+{
+	GLsync fence = mCounterFences[frame];
+	if (!fence)
+		return;
+
+	// Never wait: if the GPU is still behind, the previous numbers stay on display
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+	{
+		GLStateCache::instance().bindBuffer(GL_SHADER_STORAGE_BUFFER, mCounterBuffers[frame]);
+		const GLuint* counters = static_cast<const GLuint*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0,
+			COUNTER_VISIBLE_BASE * sizeof(GLuint), GL_MAP_READ_BIT));
+		if (counters)
+		{
+			mLastFrustumCulled = static_cast<int>(counters[COUNTER_FRUSTUM_CULLED]);
+			mLastOcclusionCulled = static_cast<int>(counters[COUNTER_OCCLUSION_CULLED]);
+			glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+		}
+	}
+
+	glDeleteSync(fence);
+	mCounterFences[frame] = nullptr;
+}
+
+void GpuCuller::cull(const UploadAllocation& inputCommands, const UploadAllocation& bounds, const std::vector<BucketRange>& buckets,
+	const QMatrix4x4& viewProjection, RenderStats& stats)
+{
+	if (!mIsStarted || buckets.empty())
+		return;
+
+	PROFILE_GPU_SCOPE("GPU Cull");
+
+	int frame = mFrameIndex;
+	mFrameIndex = (mFrameIndex + 1) % READBACK_FRAMES;
+	readBackCounters(frame);
+
+	GLuint commandCount = buckets.back().firstCommand + buckets.back().commandCount;
+	GLsizeiptr counterSize = static_cast<GLsizeiptr>(COUNTER_VISIBLE_BASE + buckets.size()) * sizeof(GLuint);
+
+	GLStateCache& state = GLStateCache::instance();
+	state.bindBuffer(GL_SHADER_STORAGE_BUFFER, mCounterBuffers[frame]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, counterSize, nullptr, GL_DYNAMIC_READ);
+	mExtensions.glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+	// Culled slots must stay as zero-instance draws
+	state.bindBuffer(GL_SHADER_STORAGE_BUFFER, mOutputCommandBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(commandCount) * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_DRAW);
+	mExtensions.glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+	state.bindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, inputCommands.buffer, inputCommands.offset, inputCommands.size);
+	state.bindBufferRange(GL_SHADER_STORAGE_BUFFER, 2, bounds.buffer, bounds.offset, bounds.size);
+	state.bindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, mOutputCommandBuffer);
+	state.bindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, mCounterBuffers[frame]);
+
+	Frustum frustum = Frustum::fromMatrix(viewProjection);
+	bool useOcclusion = mUseOcclusion && mHiZPyramid.getIsValid();
+
+	mCullShader->bind();
+	mCullShader->setUniformValueArray("mFrustumPlanes", frustum.planes, Frustum::PLANE_COUNT);
+	mCullShader->setUniformValue("mUseOcclusion", useOcclusion);
+	if (useOcclusion)
+	{
+		state.bindTexture(0, GL_TEXTURE_2D, mHiZPyramid.getTexture());
+		mCullShader->setUniformValue("mPyramid", 0);
+		mCullShader->setUniformValue("mPyramidLevels", mHiZPyramid.getLevelCount());
+		mCullShader->setUniformValue("mPrevViewProj", mHiZPyramid.getViewProjection());
+		mCullShader->setUniformValue("mIsReversedZ", mHiZPyramid.getIsReversedZ());
+		mCullShader->setUniformValue("mIsZeroToOne", mHiZPyramid.getIsZeroToOne());
+	}
+
+	for (size_t i = 0; i < buckets.size(); ++i)
+	{
+		if (buckets[i].commandCount == 0)
+			continue;
+
+		mCullShader->setUniformValue("mFirstCommand", static_cast<int>(buckets[i].firstCommand));
+		mCullShader->setUniformValue("mCommandCount", static_cast<int>(buckets[i].commandCount));
+		mCullShader->setUniformValue("mBucketIndex", static_cast<int>(i));
+		glDispatchCompute((buckets[i].commandCount + 63) / 64, 1, 1);
+	}
+
+	mCullShader->release();
+
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+	mCounterFences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	stats.gpuCullCandidates += static_cast<int>(commandCount);
+	stats.frustumCulled = mLastFrustumCulled;
+	stats.occlusionCulled = mLastOcclusionCulled;
+}
+
+void GpuCuller::endFrame(const QMatrix4x4& viewProjection, const RenderTarget& target)
+{
+	if (mIsStarted && mUseOcclusion)
+	{
+		mHiZPyramid.build(viewProjection, target);
+	}
+}
+
+GLuint GpuCuller::getOutputCommandBuffer() const
+{
+	return mOutputCommandBuffer;
+}
+
+GLuint GpuCuller::getCounterBuffer() const
+{
+	// The buffer written by the last cull() call
+	return mCounterBuffers[(mFrameIndex + READBACK_FRAMES - 1) % READBACK_FRAMES];
+}
+
+GLintptr GpuCuller::getVisibleCountOffset(int bucketIndex) const
+{
+	return static_cast<GLintptr>(COUNTER_VISIBLE_BASE + bucketIndex) * sizeof(GLuint);
+}
@@ -0,0 +1,231 @@
+#include "Engine/Renders/HiZPyramid.h"
+#include "Engine/Profiling/Profiler.h"
+#include "Engine/Renders/GLStateCache.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+HiZPyramid::HiZPyramid()
+	: mIsStarted(false), mIsValid(false), mIsBlitSupported(false), mDepthFramebuffer(0), mDepthTexture(0), mPyramidTexture(0),
+	mWidth(0), mHeight(0), mLevelCount(0), mIsReversedZ(false), mIsZeroToOne(false)
+{
+}
+
+HiZPyramid::~HiZPyramid()
+{
+}
+
+void HiZPyramid::init()
+{
+	initializeOpenGLFunctions();
+}
+
+void HiZPyramid::tryStart()
+{
+	if (!mIsStarted)
+	{
+		mIsStarted = true;
+		start();
+	}
+}
+
+void HiZPyramid::start()
+{
+	mReduceShader = std::make_unique<ShaderProgram>(":/Resources/Shaders/hiz.comp");
+	mReduceShader->init();
+	mReduceShader->start();
+
+	glGenFramebuffers(1, &mDepthFramebuffer);
+}
+
+void HiZPyramid::clear()
+{
+	if (mIsStarted)
+	{
+		releaseTextures();
+		glDeleteFramebuffers(1, &mDepthFramebuffer);
+		mReduceShader->clear();
+	}
+
+	mReduceShader.reset();
+	mDepthFramebuffer = 0;
+	mWidth = 0;
+	mHeight = 0;
+	mLevelCount = 0;
+	mIsValid = false;
+	mIsBlitSupported = false;
+	mIsStarted = false;
+}
+
+void HiZPyramid::releaseTextures()
+{
+	GLStateCache::instance().deleteTexture(mDepthTexture);
+	GLStateCache::instance().deleteTexture(mPyramidTexture);
+}
+
+GLenum HiZPyramid::getDepthFormat(GLuint framebuffer)
+{
+	// The default framebuffer names its buffers rather than attachment points
+	GLenum depthAttachment = framebuffer == 0 ? GL_DEPTH : GL_DEPTH_ATTACHMENT;
+	GLenum stencilAttachment = framebuffer == 0 ? GL_STENCIL : GL_STENCIL_ATTACHMENT;
+	GLint depthBits = 0;
+	GLint stencilBits = 0;
+	GLint componentType = GL_NONE;
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, depthAttachment, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &depthBits);
+	glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, depthAttachment, GL_FRAMEBUFFER_ATTACHMENT_COMPONENT_TYPE, &componentType);
+	glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, stencilAttachment, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &stencilBits);
+
+	// Depth blits only work between identical formats, stencil bits included
+	bool isFloat = componentType == GL_FLOAT;
+	if (depthBits == 24 && !isFloat)
+		return stencilBits == 8 ? GL_DEPTH24_STENCIL8 : GL_DEPTH_COMPONENT24;
+	if (depthBits == 32 && isFloat)
+		return stencilBits == 8 ? GL_DEPTH32F_STENCIL8 : GL_DEPTH_COMPONENT32F;
+	if (depthBits == 16 && stencilBits == 0)
+		return GL_DEPTH_COMPONENT16;
+	return GL_NONE;
+}
+
+void HiZPyramid::resize(const RenderTarget& target)
+{
+	releaseTextures();
+
+	int width = target.width;
+	int height = target.height;
+	mWidth = width;
+	mHeight = height;
+	mLevelCount = 1 + static_cast<int>(std::floor(std::log2(static_cast<float>(std::max(width, height)))));
+
+	GLenum depthFormat = getDepthFormat(target.framebuffer);
+	mIsBlitSupported = depthFormat != GL_NONE;
+	if (!mIsBlitSupported)
+	{
+		// Occlusion culling stays off rather than testing against garbage
+		std::cout << "WARNING::HIZ_PYRAMID::UNSUPPORTED_DEPTH_FORMAT" << std::endl;
+		glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+		return;
+	}
+
+	// Blit target in the scene's own depth format
+	GLStateCache& state = GLStateCache::instance();
+	glGenTextures(1, &mDepthTexture);
+	state.bindTexture(0, GL_TEXTURE_2D, mDepthTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, depthFormat, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glGenTextures(1, &mPyramidTexture);
+	state.bindTexture(0, GL_TEXTURE_2D, mPyramidTexture);
+	glTexStorage2D(GL_TEXTURE_2D, mLevelCount, GL_R32F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	bool hasStencil = depthFormat == GL_DEPTH24_STENCIL8 || depthFormat == GL_DEPTH32F_STENCIL8;
+	glBindFramebuffer(GL_FRAMEBUFFER, mDepthFramebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, hasStencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, mDepthTexture, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+}
+
+void HiZPyramid::build(const QMatrix4x4& viewProjection, const RenderTarget& target)
+{
+	if (!mIsStarted)
+		return;
+
+	PROFILE_GPU_SCOPE("HiZ Build");
+
+	int width = target.width;
+	int height = target.height;
+	if (width <= 0 || height <= 0)
+		return;
+
+	if (width != mWidth || height != mHeight)
+	{
+		resize(target);
+	}
+	if (!mIsBlitSupported)
+	{
+		mIsValid = false;
+		return;
+	}
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, target.framebuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mDepthFramebuffer);
+	glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+
+	mReduceShader->bind();
+	mReduceShader->setUniformValue("mSource", 0);
+	mReduceShader->setUniformValue("mIsReversedZ", GLStateCache::instance().getIsDepthReversed());
+
+	// Level 0 is a straight copy of the depth buffer into the float pyramid
+	GLStateCache& state = GLStateCache::instance();
+	state.bindTexture(0, GL_TEXTURE_2D, mDepthTexture);
+	mReduceShader->setUniformValue("mSourceLevel", 0);
+	mReduceShader->setUniformValue("mCopyLevel", true);
+	glBindImageTexture(0, mPyramidTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+	glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	state.bindTexture(0, GL_TEXTURE_2D, mPyramidTexture);
+	mReduceShader->setUniformValue("mCopyLevel", false);
+	for (int level = 1; level < mLevelCount; ++level)
+	{
+		int levelWidth = std::max(1, width >> level);
+		int levelHeight = std::max(1, height >> level);
+
+		mReduceShader->setUniformValue("mSourceLevel", level - 1);
+		glBindImageTexture(0, mPyramidTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		glDispatchCompute((levelWidth + 7) / 8, (levelHeight + 7) / 8, 1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+	}
+
+	mReduceShader->release();
+
+	mViewProjection = viewProjection;
+	mIsReversedZ = GLStateCache::instance().getIsDepthReversed();
+	mIsZeroToOne = GLStateCache::instance().getIsDepthZeroToOne();
+	mIsValid = true;
+}
+
+bool HiZPyramid::getIsValid() const
+{
+	return mIsValid;
+}
+
+GLuint HiZPyramid::getTexture() const
+{
+	return mPyramidTexture;
+}
+
+int HiZPyramid::getWidth() const
+{
+	return mWidth;
+}
+
+int HiZPyramid::getHeight() const
+{
+	return mHeight;
+}
+
+int HiZPyramid::getLevelCount() const
+{
+	return mLevelCount;
+}
+
+const QMatrix4x4& HiZPyramid::getViewProjection() const
+{
+	return mViewProjection;
+}
+
+bool HiZPyramid::getIsReversedZ() const
+{
+	return mIsReversedZ;
+}
+
+bool HiZPyramid::getIsZeroToOne() const
+{
+	return mIsZeroToOne;
+}
@@ -0,0 +1,200 @@
+#include "Engine/Renders/IdBufferPicker.h"
+#include "Engine/Profiling/Profiler.h"
+#include "Engine/Renders/GLStateCache.h"
+#include "Engine/Renders/Mesh.h"
+
+#include <iostream>
+#include <limits>
+
+IdBufferPicker::IdBufferPicker()
+	: mIsStarted(false), mFramebuffer(0), mColorBuffer(0), mDepthBuffer(0), mPixelBuffer(0), mFence(nullptr), mIsRequested(false)
+{
+}
+
+IdBufferPicker::~IdBufferPicker()
+{
+}
+
+void IdBufferPicker::init()
+{
+	initializeOpenGLFunctions();
+	mIdShader = std::make_unique<ShaderProgram>(":/Resources/Shaders/depth.vert", ":/Resources/Shaders/id.frag");
+	mIdShader->init();
+}
+
+void IdBufferPicker::tryStart()
+{
+	if (!mIsStarted)
+	{
+		mIsStarted = true;
+		start();
+	}
+}
+
+void IdBufferPicker::start()
+{
+	mIdShader->start();
+
+	glGenRenderbuffers(1, &mColorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, mColorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_R32UI, 1, 1);
+	glGenRenderbuffers(1, &mDepthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, mDepthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, 1, 1);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	GLint previousFramebuffer = 0;
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+	glGenFramebuffers(1, &mFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, mColorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, mDepthBuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "ERROR::ID_BUFFER_PICKER::FRAMEBUFFER_INCOMPLETE" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+	GLStateCache& state = GLStateCache::instance();
+	glGenBuffers(1, &mPixelBuffer);
+	state.bindBuffer(GL_PIXEL_PACK_BUFFER, mPixelBuffer);
+	glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(GLuint), nullptr, GL_STREAM_READ);
+	state.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void IdBufferPicker::clear()
+{
+	if (mIsStarted)
+	{
+		if (mFence)
+		{
+			glDeleteSync(mFence);
+			mFence = nullptr;
+		}
+		GLStateCache::instance().deleteBuffer(mPixelBuffer);
+		glDeleteFramebuffers(1, &mFramebuffer);
+		glDeleteRenderbuffers(1, &mColorBuffer);
+		glDeleteRenderbuffers(1, &mDepthBuffer);
+		mFramebuffer = 0;
+		mColorBuffer = 0;
+		mDepthBuffer = 0;
+		mIdShader->clear();
+	}
+
+	mIdShader.reset();
+	mPendingNodes.clear();
+	mIsRequested = false;
+	mIsStarted = false;
+}
+
+void IdBufferPicker::request(const QPointF& pixel, const QSizeF& viewportSize)
+{
+	mPixel = pixel;
+	mViewportSize = viewportSize;
+	mIsRequested = true;
+}
+
+bool IdBufferPicker::getIsBusy() const
+{
+	return mIsRequested || mFence != nullptr;
+}
+
+void IdBufferPicker::render(const SpatialIndex& index, const QMatrix4x4& view, const QMatrix4x4& projection)
+{
+	if (!mIsRequested || mFence || !mIsStarted || !mIdShader->getIsReady() || mViewportSize.isEmpty())
+		return;
+
+	PROFILE_GPU_SCOPE("ID Buffer Pick");
+	mIsRequested = false;
+
+	// Only what the pick ray passes through can cover its pixel
+	Ray ray = Ray::fromViewport(view, projection, mPixel, mViewportSize);
+	index.raycast(ray, std::numeric_limits<float>::max(), mCandidates);
+	mPendingNodes.clear();
+
+	// Stretches the picked pixel over the whole one-pixel target
+	float ndcX = static_cast<float>(2.0 * mPixel.x() / mViewportSize.width() - 1.0);
+	float ndcY = static_cast<float>(1.0 - 2.0 * mPixel.y() / mViewportSize.height());
+	QMatrix4x4 pickMatrix;
+	pickMatrix.scale(static_cast<float>(mViewportSize.width()), static_cast<float>(mViewportSize.height()), 1.0f);
+	pickMatrix.translate(-ndcX, -ndcY, 0.0f);
+
+	GLStateCache& state = GLStateCache::instance();
+	GLint drawFramebuffer = 0;
+	GLint readFramebuffer = 0;
+	GLint viewport[4];
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFramebuffer);
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFramebuffer);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+	glViewport(0, 0, 1, 1);
+	const GLuint background[4] = { 0, 0, 0, 0 };
+	const GLfloat farDepth = state.getFarDepth();
+	glClearBufferuiv(GL_COLOR, 0, background);
+	glClearBufferfv(GL_DEPTH, 0, &farDepth);
+
+	// Same depth convention as the camera's, so the nearest surface wins either way
+	state.setIsEnabled(GL_DEPTH_TEST, true);
+	state.setDepthFunc(GL_LESS);
+	state.setDepthMask(true);
+	state.setPolygonMode(GL_FILL);
+	state.setIsEnabled(GL_CULL_FACE, false);
+	state.setIsEnabled(GL_BLEND, false);
+
+	mIdShader->bind();
+	mIdShader->setUniformValue("mView", view);
+	mIdShader->setUniformValue("mProj", pickMatrix * projection);
+	for (const auto& candidate : mCandidates)
+	{
+		mPendingNodes.push_back(index.getNode(candidate.index));
+		mIdShader->setUniformValue("mObjectId", static_cast<int>(mPendingNodes.size()));
+		mIdShader->setUniformValue("mWorld", index.getWorldMatrix(candidate.index));
+		index.getMesh(candidate.index)->drawDepth();
+	}
+	mIdShader->release();
+
+	// Into the pack buffer rather than client memory, so the call returns without waiting
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	state.bindBuffer(GL_PIXEL_PACK_BUFFER, mPixelBuffer);
+	glReadPixels(0, 0, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+	state.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	mFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFramebuffer);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+bool IdBufferPicker::poll(Node*& node)
+{
+	if (!mFence)
+		return false;
+
+	// A zero timeout only asks; the flush makes sure the fence gets to the GPU at all
+	GLenum status = glClientWaitSync(mFence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	if (status == GL_TIMEOUT_EXPIRED)
+		return false;
+
+	glDeleteSync(mFence);
+	mFence = nullptr;
+	if (status == GL_WAIT_FAILED)
+	{
+		std::cout << "ERROR::ID_BUFFER_PICKER::WAIT_FAILED" << std::endl;
+		return false;
+	}
+
+	GLuint id = 0;
+	GLStateCache& state = GLStateCache::instance();
+	state.bindBuffer(GL_PIXEL_PACK_BUFFER, mPixelBuffer);
+	if (const GLuint* data = static_cast<const GLuint*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(GLuint), GL_MAP_READ_BIT)))
+	{
+		id = *data;
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	state.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	node = id > 0 && id <= mPendingNodes.size() ? mPendingNodes[id - 1] : nullptr;
+	mPendingNodes.clear();
+	return true;
+}
@@ -0,0 +1,355 @@
+#include "Engine/Renders/IndirectRenderer.h"
+#include "Engine/Enums/ShaderKeyword.h"
+#include "Engine/Profiling/Profiler.h"
+#include "Engine/Renders/GLStateCache.h"
+#include <algorithm>
+#include <iostream>
+
+IndirectRenderer::IndirectRenderer()
+	: mIsStarted(false), mIsEnabled(true), mIsGpuCulling(false), mIsDepthPrePass(false), mShader(nullptr), mLitShader(nullptr), mLighting(nullptr),
+	mIsPrepared(false), mIsDepthDrawn(false), mUseGpuCulling(false), mCommandBuffer(0), mCommandOffset(0)
+{
+}
+
+IndirectRenderer::~IndirectRenderer()
+{
+}
+
+void IndirectRenderer::init()
+{
+	initializeOpenGLFunctions();
+	mExtensions.init();
+	mGpuCuller.init(mExtensions);
+}
+
+void IndirectRenderer::tryStart()
+{
+	if (!mIsStarted && getIsSupported())
+	{
+		mIsStarted = true;
+		start();
+	}
+}
+
+void IndirectRenderer::start()
+{
+	mShaders = std::make_unique<ShaderVariants>(":/Resources/Shaders/indirect.vert", ":/Resources/Shaders/default.frag", getDefaultShaderKeywords());
+	mShaders->setIsAsync(true);
+	mShader = mShaders->getVariant(SHADER_KEYWORD_USE_COLOR);
+
+	mDepthShader = std::make_unique<ShaderProgram>(":/Resources/Shaders/depth_indirect.vert", ":/Resources/Shaders/depth.frag");
+	mDepthShader->init();
+	mDepthShader->start();
+
+	mGpuCuller.tryStart();
+}
+
+void IndirectRenderer::clear()
+{
+	if (mIsStarted)
+	{
+		mShaders->clear();
+		mDepthShader->clear();
+	}
+
+	mGpuCuller.clear();
+	mShaders.reset();
+	mShader = nullptr;
+	mLitShader = nullptr;
+	mDepthShader.reset();
+	mIsPrepared = false;
+	mBuckets.clear();
+	mIsStarted = false;
+}
+
+void IndirectRenderer::setIsEnabled(bool isEnabled)
+{
+	mIsEnabled = isEnabled;
+}
+
+bool IndirectRenderer::getIsEnabled() const
+{
+	return mIsEnabled;
+}
+
+bool IndirectRenderer::getIsSupported() const
+{
+	return mExtensions.hasMultiDrawIndirect && mExtensions.hasShaderDrawParameters && mExtensions.hasShaderStorageBuffer;
+}
+
+bool IndirectRenderer::getIsActive() const
+{
+	// Meshes take the regular draw path until the indirect shader has finished compiling
+	return mIsEnabled && mIsStarted && mShader->getIsReady();
+}
+
+void IndirectRenderer::setIsGpuCulling(bool isGpuCulling)
+{
+	mIsGpuCulling = isGpuCulling;
+}
+
+bool IndirectRenderer::getIsGpuCulling() const
+{
+	return mIsGpuCulling;
+}
+
+GpuCuller& IndirectRenderer::getGpuCuller()
+{
+	return mGpuCuller;
+}
+
+void IndirectRenderer::setIsDepthPrePass(bool isDepthPrePass)
+{
+	mIsDepthPrePass = isDepthPrePass;
+}
+
+bool IndirectRenderer::getIsDepthPrePass() const
+{
+	return mIsDepthPrePass;
+}
+
+void IndirectRenderer::setLighting(ClusteredLighting* lighting)
+{
+	mLighting = lighting;
+}
+
+void IndirectRenderer::begin()
+{
+	mIsPrepared = false;
+	mIsDepthDrawn = false;
+
+	if (mIsStarted)
+	{
+		mShader->poll();
+		if (mLitShader)
+		{
+			mLitShader->poll();
+		}
+	}
+
+	// Keep the bucket storage between frames so steady-state submission does not allocate
+	for (auto& bucket : mBuckets)
+	{
+		bucket.commands.clear();
+		bucket.worlds.clear();
+		bucket.bounds.clear();
+	}
+}
+
+IndirectRenderer::Bucket& IndirectRenderer::getBucket(GLenum drawMode, PolygonMode polygonMode)
+{
+	for (auto& bucket : mBuckets)
+	{
+		if (bucket.drawMode == drawMode && bucket.polygonMode == polygonMode)
+			return bucket;
+	}
+
+	Bucket bucket;
+	bucket.drawMode = drawMode;
+	bucket.polygonMode = polygonMode;
+	mBuckets.push_back(bucket);
+	return mBuckets.back();
+}
+
+bool IndirectRenderer::submit(const Mesh& mesh, const QMatrix4x4& world, PolygonMode polygonMode)
+{
+	if (!getIsActive())
+		return false;
+
+	const GeometryAllocation& allocation = mesh.getAllocation();
+	if (!allocation.isValid() || (mIsDepthPrePass && mesh.getIsCutout()))
+		return false;
+
+	Bucket& bucket = getBucket(mesh.getDrawMode(), polygonMode);
+
+	DrawElementsIndirectCommand command;
+	command.count = allocation.indexCount;
+	command.instanceCount = 1;
+	command.firstIndex = allocation.indexOffset;
+	command.baseVertex = static_cast<GLint>(allocation.vertexOffset);
+	command.baseInstance = 0;
+	bucket.commands.push_back(command);
+
+	const float* data = world.constData();
+	bucket.worlds.insert(bucket.worlds.end(), data, data + 16);
+
+	// Conservative world sphere: transformed center, radius scaled by the largest axis scale
+	QVector4D sphere = mesh.getBoundingSphere();
+	QVector3D center = world.map(sphere.toVector3D());
+	float scale = std::max({ world.column(0).toVector3D().length(), world.column(1).toVector3D().length(), world.column(2).toVector3D().length() });
+	bucket.bounds.push_back(center.x());
+	bucket.bounds.push_back(center.y());
+	bucket.bounds.push_back(center.z());
+	bucket.bounds.push_back(sphere.w() * scale);
+	return true;
+}
+
+bool IndirectRenderer::prepare(const QMatrix4x4& view, const QMatrix4x4& projection, UploadRingBuffer& uploadBuffer, RenderStats& stats)
+{
+	mIsPrepared = false;
+	if (!getIsActive())
+		return false;
+
+	PROFILE_GPU_SCOPE("Indirect Prepare");
+
+	// Flatten the buckets so commands and per-draw data go up in one upload each
+	mCommands.clear();
+	mWorlds.clear();
+	mBounds.clear();
+	mBucketRanges.clear();
+	for (const auto& bucket : mBuckets)
+	{
+		GpuCuller::BucketRange range;
+		range.firstCommand = static_cast<GLuint>(mCommands.size());
+		range.commandCount = static_cast<GLuint>(bucket.commands.size());
+		mBucketRanges.push_back(range);
+
+		for (const auto& command : bucket.commands)
+		{
+			mCommands.push_back(command);
+			mCommands.back().baseInstance = static_cast<GLuint>(mCommands.size() - 1);
+		}
+		mWorlds.insert(mWorlds.end(), bucket.worlds.begin(), bucket.worlds.end());
+		mBounds.insert(mBounds.end(), bucket.bounds.begin(), bucket.bounds.end());
+	}
+
+	if (mCommands.empty())
+		return false;
+
+	// Everything is written straight into mapped memory of the frame's ring region
+	GLsizeiptr alignment = uploadBuffer.getStorageAlignment();
+	UploadAllocation worlds = uploadBuffer.upload(mWorlds.data(), mWorlds.size() * sizeof(float), alignment);
+	UploadAllocation commands = uploadBuffer.upload(mCommands.data(), mCommands.size() * sizeof(DrawElementsIndirectCommand), alignment);
+	if (!worlds.isValid() || !commands.isValid())
+	{
+		std::cout << "ERROR::INDIRECT_RENDERER::UPLOAD_FAILED" << std::endl;
+		return false;
+	}
+
+	mWorldAllocation = worlds;
+	mUseGpuCulling = mIsGpuCulling && mExtensions.hasComputeShader;
+	if (mUseGpuCulling)
+	{
+		UploadAllocation bounds = uploadBuffer.upload(mBounds.data(), mBounds.size() * sizeof(float), alignment);
+		mGpuCuller.cull(commands, bounds, mBucketRanges, projection * view, stats);
+
+		// Compacted commands live at the start of the culler's own buffer
+		mCommandBuffer = mGpuCuller.getOutputCommandBuffer();
+		mCommandOffset = 0;
+	}
+	else
+	{
+		mCommandBuffer = commands.buffer;
+		mCommandOffset = commands.offset;
+	}
+
+	mIsPrepared = true;
+	return true;
+}
+
+bool IndirectRenderer::drawDepth(const QMatrix4x4& view, const QMatrix4x4& projection, RenderStats& stats)
+{
+	if (!mIsPrepared || !mIsDepthPrePass || !mDepthShader->getIsReady())
+		return false;
+
+	PROFILE_GPU_SCOPE("Indirect Depth");
+
+	GLStateCache& state = GLStateCache::instance();
+	state.setDepthFunc(GL_LESS);
+	state.setDepthMask(true);
+
+	stats.depthDrawCalls += drawBuckets(*mDepthShader, view, projection);
+	mIsDepthDrawn = true;
+	return true;
+}
+
+void IndirectRenderer::draw(const QMatrix4x4& view, const QMatrix4x4& projection, RenderStats& stats)
+{
+	if (!mIsPrepared)
+		return;
+
+	PROFILE_GPU_SCOPE("Indirect Flush");
+
+	// Everything indirect went through the depth pass, so only the visible fragments get shaded
+	GLStateCache& state = GLStateCache::instance();
+	state.setDepthFunc(mIsDepthDrawn ? GL_EQUAL : GL_LESS);
+	state.setDepthMask(!mIsDepthDrawn);
+
+	// Unlit until the lit variant has compiled, rather than flashing the fallback program
+	ShaderProgram* shader = mShader;
+	if (mLighting && mLighting->getIsActive())
+	{
+		if (!mLitShader)
+		{
+			mLitShader = mShaders->getVariant(SHADER_KEYWORD_USE_COLOR | SHADER_KEYWORD_USE_LIGHTING);
+		}
+		if (mLitShader->getIsReady())
+		{
+			shader = mLitShader;
+			shader->bind();
+			mLighting->apply(*shader);
+		}
+	}
+
+	stats.indirectDrawCalls += drawBuckets(*shader, view, projection);
+	for (const auto& range : mBucketRanges)
+	{
+		stats.indirectCommands += static_cast<int>(range.commandCount);
+	}
+
+	state.setDepthFunc(GL_LESS);
+	state.setDepthMask(true);
+}
+
+int IndirectRenderer::drawBuckets(ShaderProgram& shader, const QMatrix4x4& view, const QMatrix4x4& projection)
+{
+	GLStateCache& state = GLStateCache::instance();
+	state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, mCommandBuffer);
+	if (mUseGpuCulling && mExtensions.hasIndirectParameters)
+	{
+		state.bindBuffer(GL_PARAMETER_BUFFER, mGpuCuller.getCounterBuffer());
+	}
+	state.bindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, mWorldAllocation.buffer, mWorldAllocation.offset, mWorldAllocation.size);
+
+	shader.bind();
+	shader.setUniformValue("mView", view);
+	shader.setUniformValue("mProj", projection);
+
+	int drawCount = 0;
+	for (size_t i = 0; i < mBuckets.size(); ++i)
+	{
+		const Bucket& bucket = mBuckets[i];
+		const GpuCuller::BucketRange& range = mBucketRanges[i];
+		if (range.commandCount == 0)
+			continue;
+
+		const void* offset = (void*)(mCommandOffset + static_cast<size_t>(range.firstCommand) * sizeof(DrawElementsIndirectCommand));
+		state.setPolygonMode(static_cast<GLenum>(bucket.polygonMode));
+
+		if (mUseGpuCulling && mExtensions.hasIndirectParameters)
+		{
+			// Draw count comes straight from the cull pass's visible counter
+			mExtensions.glMultiDrawElementsIndirectCount(bucket.drawMode, GL_UNSIGNED_INT, offset,
+				mGpuCuller.getVisibleCountOffset(static_cast<int>(i)), static_cast<GLsizei>(range.commandCount), 0);
+		}
+		else
+		{
+			// Culled slots at the tail of the bucket are zero-instance commands
+			mExtensions.glMultiDrawElementsIndirect(bucket.drawMode, GL_UNSIGNED_INT, offset, static_cast<GLsizei>(range.commandCount), 0);
+		}
+		drawCount++;
+	}
+
+	// The indirect and storage bindings are left in place; the next frame rebinds only what changed
+	state.setPolygonMode(static_cast<GLenum>(PolygonMode::FILL));
+	shader.release();
+	return drawCount;
+}
+
+void IndirectRenderer::endFrame(const QMatrix4x4& view, const QMatrix4x4& projection, const RenderTarget& target)
+{
+	if (getIsActive() && mIsGpuCulling)
+	{
+		mGpuCuller.endFrame(projection * view, target);
+	}
+}
@@ -0,0 +1,220 @@
+#include "Engine/Renders/Material.h"
+
+#include <QHash>
+
+bool RasterState::operator==(const RasterState& other) const
+{
+	return polygonMode == other.polygonMode && drawBufferMode == other.drawBufferMode && cullMode == other.cullMode && blendMode == other.blendMode
+		&& isDepthTest == other.isDepthTest && isDepthWrite == other.isDepthWrite;
+}
+
+bool RasterState::operator!=(const RasterState& other) const
+{
+	return !(*this == other);
+}
+
+bool Material::UniformValue::operator==(const UniformValue& other) const
+{
+	return name == other.name && type == other.type && values == other.values;
+}
+
+bool Material::TextureBinding::operator==(const TextureBinding& other) const
+{
+	return path == other.path && sampler == other.sampler && layerUniform == other.layerUniform;
+}
+
+Material::Material() : mId(INVALID_ID), mShaders(nullptr), mVariant(0)
+{
+}
+
+Material::Material(ShaderVariants* shaders, ShaderVariants::Key variant) : mId(INVALID_ID), mShaders(shaders), mVariant(variant)
+{
+}
+
+void Material::setShader(ShaderVariants* shaders, ShaderVariants::Key variant)
+{
+	mShaders = shaders;
+	mVariant = variant;
+}
+
+ShaderVariants* Material::getShaders() const
+{
+	return mShaders;
+}
+
+ShaderVariants::Key Material::getVariant() const
+{
+	return mVariant;
+}
+
+ShaderProgram* Material::getShaderProgram(ShaderVariants::Key keywords) const
+{
+	return mShaders ? mShaders->getVariant(mVariant | keywords) : nullptr;
+}
+
+void Material::setUniform(const QByteArray& name, int value)
+{
+	float values[] = { static_cast<float>(value) };
+	setUniformValue(name, UniformType::Int, values, 1);
+}
+
+void Material::setUniform(const QByteArray& name, float value)
+{
+	setUniformValue(name, UniformType::Float, &value, 1);
+}
+
+void Material::setUniform(const QByteArray& name, const QVector2D& value)
+{
+	float values[] = { value.x(), value.y() };
+	setUniformValue(name, UniformType::Vec2, values, 2);
+}
+
+void Material::setUniform(const QByteArray& name, const QVector3D& value)
+{
+	float values[] = { value.x(), value.y(), value.z() };
+	setUniformValue(name, UniformType::Vec3, values, 3);
+}
+
+void Material::setUniform(const QByteArray& name, const QVector4D& value)
+{
+	float values[] = { value.x(), value.y(), value.z(), value.w() };
+	setUniformValue(name, UniformType::Vec4, values, 4);
+}
+
+void Material::setUniform(const QByteArray& name, const QColor& value)
+{
+	setUniform(name, QVector4D(value.redF(), value.greenF(), value.blueF(), value.alphaF()));
+}
+
+void Material::setUniform(const QByteArray& name, const QMatrix4x4& value)
+{
+	setUniformValue(name, UniformType::Mat4, value.constData(), 16);
+}
+
+void Material::setUniformValue(const QByteArray& name, UniformType type, const float* values, int count)
+{
+	for (auto& uniform : mUniforms)
+	{
+		if (uniform.name == name)
+		{
+			uniform.type = type;
+			uniform.values.assign(values, values + count);
+			return;
+		}
+	}
+
+	UniformValue uniform;
+	uniform.name = name;
+	uniform.type = type;
+	uniform.values.assign(values, values + count);
+	mUniforms.push_back(uniform);
+}
+
+void Material::setTexture(const QString& path, const QByteArray& sampler, const QByteArray& layerUniform)
+{
+	for (auto& texture : mTextures)
+	{
+		if (texture.sampler == sampler)
+		{
+			texture.path = path;
+			texture.layerUniform = layerUniform;
+			texture.textureId = Texture::INVALID_ID;
+			return;
+		}
+	}
+
+	TextureBinding texture;
+	texture.path = path;
+	texture.sampler = sampler;
+	texture.layerUniform = layerUniform;
+	mTextures.push_back(texture);
+}
+
+int Material::getTextureCount() const
+{
+	return static_cast<int>(mTextures.size());
+}
+
+void Material::setRasterState(const RasterState& rasterState)
+{
+	mRasterState = rasterState;
+}
+
+const RasterState& Material::getRasterState() const
+{
+	return mRasterState;
+}
+
+size_t Material::getHash() const
+{
+	size_t seed = qHashMulti(0, reinterpret_cast<quintptr>(mShaders), mVariant,
+		static_cast<int>(mRasterState.polygonMode), static_cast<int>(mRasterState.drawBufferMode), static_cast<int>(mRasterState.cullMode), static_cast<int>(mRasterState.blendMode),
+		mRasterState.isDepthTest, mRasterState.isDepthWrite);
+
+	for (const auto& uniform : mUniforms)
+	{
+		seed = qHashMulti(seed, uniform.name, static_cast<int>(uniform.type));
+		seed = qHashRange(uniform.values.begin(), uniform.values.end(), seed);
+	}
+	for (const auto& texture : mTextures)
+	{
+		seed = qHashMulti(seed, texture.path, texture.sampler, texture.layerUniform);
+	}
+	return seed;
+}
+
+bool Material::operator==(const Material& other) const
+{
+	return mShaders == other.mShaders && mVariant == other.mVariant && mRasterState == other.mRasterState
+		&& mUniforms == other.mUniforms && mTextures == other.mTextures;
+}
+
+int Material::getId() const
+{
+	return mId;
+}
+
+void Material::apply(ShaderProgram& shader, TextureManager* textureManager)
+{
+	for (const auto& uniform : mUniforms)
+	{
+		const float* v = uniform.values.data();
+		switch (uniform.type)
+		{
+		case UniformType::Int:
+			shader.setUniformValue(uniform.name.constData(), static_cast<int>(v[0]));
+			break;
+		case UniformType::Float:
+			shader.setUniformValue(uniform.name.constData(), v[0]);
+			break;
+		case UniformType::Vec2:
+			shader.setUniformValue(uniform.name.constData(), QVector2D(v[0], v[1]));
+			break;
+		case UniformType::Vec3:
+			shader.setUniformValue(uniform.name.constData(), QVector3D(v[0], v[1], v[2]));
+			break;
+		case UniformType::Vec4:
+			shader.setUniformValue(uniform.name.constData(), QVector4D(v[0], v[1], v[2], v[3]));
+			break;
+		case UniformType::Mat4:
+			shader.setUniformValue(uniform.name.constData(), QMatrix4x4(v).transposed());
+			break;
+		}
+	}
+
+	if (!textureManager)
+		return;
+
+	for (size_t unit = 0; unit < mTextures.size(); ++unit)
+	{
+		TextureBinding& texture = mTextures[unit];
+		if (texture.textureId == Texture::INVALID_ID)
+		{
+			texture.textureId = textureManager->request(texture.path);
+		}
+
+		int layer = textureManager->bind(texture.textureId, static_cast<int>(unit));
+		shader.setUniformValue(texture.sampler.constData(), static_cast<int>(unit));
+		shader.setUniformValue(texture.layerUniform.constData(), static_cast<float>(layer));
+	}
+}
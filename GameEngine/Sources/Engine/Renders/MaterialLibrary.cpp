@@ -0,0 +1,73 @@
+#include "Engine/Renders/MaterialLibrary.h"
+
+MaterialLibrary::MaterialLibrary() : mNextId(0)
+{
+}
+
+void MaterialLibrary::setDefaultShaders(ShaderVariants* shaders, ShaderVariants::Key variant)
+{
+	mDefaultMaterial = intern(Material(shaders, variant));
+}
+
+std::shared_ptr<Material> MaterialLibrary::getDefaultMaterial() const
+{
+	return mDefaultMaterial;
+}
+
+std::shared_ptr<Material> MaterialLibrary::intern(const Material& material)
+{
+	size_t hash = material.getHash();
+	auto range = mMaterials.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (*it->second == material)
+			return it->second;
+	}
+
+	auto interned = std::make_shared<Material>(material);
+	interned->mId = mNextId++;
+	mMaterials.emplace(hash, interned);
+	return interned;
+}
+
+std::shared_ptr<Material> MaterialLibrary::withPolygonMode(const std::shared_ptr<Material>& material, PolygonMode polygonMode,
+	DrawBufferMode drawBufferMode)
+{
+	if (!material)
+		return material;
+
+	const RasterState& current = material->getRasterState();
+	if (current.polygonMode == polygonMode && current.drawBufferMode == drawBufferMode)
+		return material;
+
+	Material variant = *material;
+	RasterState rasterState = variant.getRasterState();
+	rasterState.polygonMode = polygonMode;
+	rasterState.drawBufferMode = drawBufferMode;
+	variant.setRasterState(rasterState);
+	return intern(variant);
+}
+
+bool MaterialLibrary::getIsIndirectCompatible(const Material& material) const
+{
+	if (!mDefaultMaterial)
+		return false;
+
+	// Polygon mode is the one piece of state the indirect buckets carry; they always apply it to
+	// both faces, so a mode for one face only keeps the draw in the RenderQueue
+	RasterState rasterState = material.getRasterState();
+	rasterState.polygonMode = mDefaultMaterial->getRasterState().polygonMode;
+	return material.getShaders() == mDefaultMaterial->getShaders() && material.getVariant() == mDefaultMaterial->getVariant()
+		&& rasterState == mDefaultMaterial->getRasterState() && material.mUniforms.empty() && material.mTextures.empty();
+}
+
+int MaterialLibrary::getMaterialCount() const
+{
+	return static_cast<int>(mMaterials.size());
+}
+
+void MaterialLibrary::clear()
+{
+	mMaterials.clear();
+	mDefaultMaterial.reset();
+}
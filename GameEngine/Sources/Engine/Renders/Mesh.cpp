@@ -1,11 +1,15 @@
 #include "Engine/Renders/Mesh.h"
 
-Mesh::Mesh() : mIsStarted(false), mVAO(0), mVBO(0), mEBO(0), mDrawMode(GL_TRIANGLES) 
+#include <algorithm>
+#include <cmath>
+
+Mesh::Mesh() : mIsStarted(false), mGeometryBuffer(nullptr), mTextureManager(nullptr), mDrawMode(GL_TRIANGLES), mIsCutout(false)
 {
 
 }
 
 Mesh::Mesh(QString path, std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures)
+    : mIsStarted(false), mGeometryBuffer(nullptr), mTextureManager(nullptr), mIsCutout(false)
 {
 	this->path = path;
     this->vertices = vertices;
@@ -15,6 +19,7 @@ Mesh::Mesh(QString path, std::vector<Vertex> vertices, std::vector<unsigned int>
 }
 
 Mesh::Mesh(QString path, std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures, GLenum drawMode)
+    : mIsStarted(false), mGeometryBuffer(nullptr), mTextureManager(nullptr), mIsCutout(false)
 {
 	this->path = path;
 	this->vertices = vertices;
@@ -28,11 +33,13 @@ void Mesh::init()
     initializeOpenGLFunctions();
 }
 
-void Mesh::tryStart()
+void Mesh::tryStart(GeometryBuffer* geometryBuffer, TextureManager* textureManager)
 {
-	if (!mIsStarted && !path.isEmpty())
+	if (!mIsStarted && !path.isEmpty() && geometryBuffer)
 	{
         mIsStarted = true;
+        mGeometryBuffer = geometryBuffer;
+        mTextureManager = textureManager;
 		start();
 	}
 }
@@ -41,37 +48,53 @@ void Mesh::start()
 {
 
     setupMesh();
+
+    if (mTextureManager)
+    {
+        for (auto& texture : textures)
+        {
+            texture.id = mTextureManager->request(texture.path);
+        }
+    }
 }
 
 void Mesh::setupMesh() {
+    mAllocation = mGeometryBuffer->allocate(vertices, indices);
+    computeBounds();
 
-    glGenVertexArrays(1, &mVAO);
-    glGenBuffers(1, &mVBO);
-    glGenBuffers(1, &mEBO);
-
-    glBindVertexArray(mVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+    mIsCutout = std::any_of(vertices.begin(), vertices.end(), [](const Vertex& vertex) {
+        return vertex.color.w() <= CUTOUT_ALPHA;
+    });
+}
 
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+void Mesh::computeBounds()
+{
+    if (vertices.empty())
+    {
+        mBoundsMin = mBoundsMax = QVector3D();
+        mBoundingSphere = QVector4D();
+        return;
+    }
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int),
-        &indices[0], GL_STATIC_DRAW);
+    QVector3D boundsMin = vertices[0].position;
+    QVector3D boundsMax = vertices[0].position;
+    for (const auto& vertex : vertices)
+    {
+        const QVector3D& p = vertex.position;
+        boundsMin = QVector3D(std::min(boundsMin.x(), p.x()), std::min(boundsMin.y(), p.y()), std::min(boundsMin.z(), p.z()));
+        boundsMax = QVector3D(std::max(boundsMax.x(), p.x()), std::max(boundsMax.y(), p.y()), std::max(boundsMax.z(), p.z()));
+    }
 
-    // vertex positions
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    // vertex normals
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
-    // vertex texture coords
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoord));
-	// vertex color
-	glEnableVertexAttribArray(3);
-	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
+    QVector3D center = (boundsMin + boundsMax) * 0.5f;
+    float radiusSquared = 0.0f;
+    for (const auto& vertex : vertices)
+    {
+        radiusSquared = std::max(radiusSquared, (vertex.position - center).lengthSquared());
+    }
 
-    glBindVertexArray(0);
+    mBoundsMin = boundsMin;
+    mBoundsMax = boundsMax;
+    mBoundingSphere = QVector4D(center, std::sqrt(radiusSquared));
 }
 
 void Mesh::write(QJsonObject& json) const {
@@ -81,8 +104,8 @@ void Mesh::write(QJsonObject& json) const {
     QJsonArray texturesArray;
     for (const auto& texture : textures) {
         QJsonObject textureObject;
-        //texture.write(textureObject); // Assuming Texture class has a write method
-        //texturesArray.append(textureObject);
+        texture.write(textureObject);
+        texturesArray.append(textureObject);
     }
     json[SERIALIZE_MESH_TEXTURES] = texturesArray;
 
@@ -95,15 +118,16 @@ void Mesh::read(const QJsonObject& json) {
     vertices.clear();
     indices.clear();
     textures.clear();
+    mBVH.reset();
 
 
 
     QJsonArray texturesArray = json[SERIALIZE_MESH_TEXTURES].toArray();
     for (int i = 0; i < texturesArray.size(); ++i) {
         QJsonObject textureObject = texturesArray[i].toObject();
-        //Texture texture;
-        //texture.read(textureObject); // Assuming Texture class has a read method
-        //textures.push_back(texture);
+        Texture texture;
+        texture.read(textureObject);
+        textures.push_back(texture);
     }
 
     mDrawMode = static_cast<GLenum>(json[SERIALIZE_MESH_DRAW_MODE].toInt());
@@ -111,35 +135,86 @@ void Mesh::read(const QJsonObject& json) {
 
 void Mesh::clear()
 {
-	if (mIsStarted)
+	if (mIsStarted && mGeometryBuffer)
+	{
+		mGeometryBuffer->free(mAllocation);
+	}
+
+	mIsStarted = false;
+	mGeometryBuffer = nullptr;
+	mTextureManager = nullptr;
+	for (auto& texture : textures)
 	{
-		glDeleteVertexArrays(1, &mVAO);
-		glDeleteBuffers(1, &mVBO);
-		glDeleteBuffers(1, &mEBO);
+		texture.id = Texture::INVALID_ID;
 	}
 
 }
 
 
 void Mesh::draw(ShaderProgram& shader) {
-	/*unsigned int diffuseNr = 1;
-	unsigned int specularNr = 1;
-	for (unsigned int i = 0; i < textures.size(); i++)
+	if (!mAllocation.isValid())
+		return;
+
+	mGeometryBuffer->bind();
+
+	if (mTextureManager && !textures.empty())
 	{
-		glActiveTexture(GL_TEXTURE0 + i);
-		std::string number;
-		std::string name = textures[i].type;
-		if (name == "texture_diffuse")
-			number = std::to_string(diffuseNr++);
-		else if (name == "texture_specular")
-			number = std::to_string(specularNr++);
-
-		shader.setUniformInt((name + number).c_str(), i);
-		glBindTexture(GL_TEXTURE_2D, textures[i].ID);
-	}*/
-	glBindVertexArray(mVAO);
-	glDrawElements(mDrawMode, indices.size(), GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
-
-	glActiveTexture(GL_TEXTURE0);
+		// Textures of the same size share an array, so this is usually just a layer change
+		int layer = mTextureManager->bind(textures[0].id, 0);
+		shader.setUniformValue("sampler", 0);
+		shader.setUniformValue("mTextureLayer", static_cast<float>(layer));
+	}
+
+	glDrawElementsBaseVertex(mDrawMode, mAllocation.indexCount, GL_UNSIGNED_INT,
+		(void*)(static_cast<size_t>(mAllocation.indexOffset) * sizeof(unsigned int)), mAllocation.vertexOffset);
+}
+
+void Mesh::drawDepth()
+{
+	if (!mAllocation.isValid())
+		return;
+
+	mGeometryBuffer->bindDepth();
+	glDrawElementsBaseVertex(mDrawMode, mAllocation.indexCount, GL_UNSIGNED_INT,
+		(void*)(static_cast<size_t>(mAllocation.indexOffset) * sizeof(unsigned int)), mAllocation.vertexOffset);
+}
+
+const GeometryAllocation& Mesh::getAllocation() const
+{
+	return mAllocation;
+}
+
+GLenum Mesh::getDrawMode() const
+{
+	return mDrawMode;
+}
+
+QVector3D Mesh::getBoundsMin() const
+{
+	return mBoundsMin;
+}
+
+QVector3D Mesh::getBoundsMax() const
+{
+	return mBoundsMax;
+}
+
+QVector4D Mesh::getBoundingSphere() const
+{
+	return mBoundingSphere;
+}
+
+bool Mesh::getIsCutout() const
+{
+	return mIsCutout;
+}
+
+const MeshBVH& Mesh::getBVH()
+{
+	if (!mBVH)
+	{
+		mBVH = std::make_unique<MeshBVH>();
+		mBVH->buildCached(vertices, indices, mDrawMode);
+	}
+	return *mBVH;
 }
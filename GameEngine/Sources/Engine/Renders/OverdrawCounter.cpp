@@ -0,0 +1,127 @@
+#include "Engine/Renders/OverdrawCounter.h"
+
+#include <algorithm>
+
+OverdrawCounter::OverdrawCounter()
+	: mIsStarted(false), mIsEnabled(false), mIsCounting(false), mSlot(0), mFragments(0), mViewportArea(0)
+{
+	std::fill(std::begin(mQueries), std::end(mQueries), 0);
+	std::fill(std::begin(mIsPending), std::end(mIsPending), false);
+	std::fill(std::begin(mViewportAreas), std::end(mViewportAreas), 0);
+}
+
+OverdrawCounter::~OverdrawCounter()
+{
+}
+
+void OverdrawCounter::init()
+{
+	initializeOpenGLFunctions();
+	mExtensions.init();
+}
+
+void OverdrawCounter::start()
+{
+	glGenQueries(QUERY_FRAMES, mQueries);
+	mIsStarted = true;
+}
+
+void OverdrawCounter::clear()
+{
+	if (mIsStarted)
+	{
+		if (mIsCounting)
+		{
+			glEndQuery(GL_SAMPLES_PASSED);
+		}
+		glDeleteQueries(QUERY_FRAMES, mQueries);
+	}
+
+	std::fill(std::begin(mQueries), std::end(mQueries), 0);
+	std::fill(std::begin(mIsPending), std::end(mIsPending), false);
+	mIsStarted = false;
+	mIsCounting = false;
+	mFragments = 0;
+	mViewportArea = 0;
+}
+
+void OverdrawCounter::setIsEnabled(bool isEnabled)
+{
+	mIsEnabled = isEnabled;
+}
+
+bool OverdrawCounter::getIsEnabled() const
+{
+	return mIsEnabled;
+}
+
+bool OverdrawCounter::getIsSupported() const
+{
+	// GLES only has boolean occlusion queries
+	return mExtensions.isDesktop;
+}
+
+void OverdrawCounter::begin()
+{
+	if (!mIsEnabled || !getIsSupported() || mIsCounting)
+		return;
+
+	if (!mIsStarted)
+	{
+		start();
+	}
+
+	// The slot's previous query went in QUERY_FRAMES frames ago; if the GPU is still on it, drop it
+	collect(mSlot);
+	mIsPending[mSlot] = false;
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	mViewportAreas[mSlot] = static_cast<long long>(viewport[2]) * viewport[3];
+
+	glBeginQuery(GL_SAMPLES_PASSED, mQueries[mSlot]);
+	mIsCounting = true;
+}
+
+void OverdrawCounter::end()
+{
+	if (!mIsCounting)
+		return;
+
+	glEndQuery(GL_SAMPLES_PASSED);
+	mIsPending[mSlot] = true;
+	mIsCounting = false;
+	mSlot = (mSlot + 1) % QUERY_FRAMES;
+}
+
+void OverdrawCounter::collect(int slot)
+{
+	if (!mIsPending[slot])
+		return;
+
+	GLuint isAvailable = 0;
+	glGetQueryObjectuiv(mQueries[slot], GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+	if (!isAvailable)
+		return;
+
+	GLuint samples = 0;
+	glGetQueryObjectuiv(mQueries[slot], GL_QUERY_RESULT, &samples);
+	mFragments = samples;
+	mViewportArea = mViewportAreas[slot];
+	mIsPending[slot] = false;
+}
+
+void OverdrawCounter::resolve(RenderStats& stats)
+{
+	if (!mIsStarted)
+		return;
+
+	// Oldest first, so the newest available result wins
+	for (int i = 0; i < QUERY_FRAMES; ++i)
+	{
+		collect((mSlot + i) % QUERY_FRAMES);
+	}
+
+	stats.fragmentsShaded = mFragments;
+	stats.overdraw = mViewportArea > 0 ? static_cast<double>(mFragments) / mViewportArea : 0.0;
+}
@@ -0,0 +1,251 @@
+#include "Engine/Renders/RenderQueue.h"
+#include "Engine/Renders/GLStateCache.h"
+#include "Engine/Enums/ShaderKeyword.h"
+#include "Engine/Profiling/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+RenderQueue::RenderQueue() : mLighting(nullptr), mIsPrePassed(false), mHasRasterState(false), mIsSorted(false)
+{
+}
+
+void RenderQueue::setLighting(ClusteredLighting* lighting)
+{
+	mLighting = lighting;
+}
+
+ShaderVariants::Key RenderQueue::getKeywords() const
+{
+	return mLighting && mLighting->getIsActive() ? SHADER_KEYWORD_USE_LIGHTING : SHADER_KEYWORD_NONE;
+}
+
+void RenderQueue::begin()
+{
+	mCommands.clear();
+	mDepthOrder.clear();
+	mIsSorted = false;
+}
+
+void RenderQueue::submit(Mesh* mesh, Material* material, const QMatrix4x4& world)
+{
+	if (!mesh || !material)
+		return;
+
+	Command command;
+	command.sortKey = 0;
+	command.depth = 0.0f;
+	command.isPrePassed = false;
+	command.mesh = mesh;
+	command.material = material;
+	command.world = world;
+	mCommands.push_back(command);
+	mIsSorted = false;
+}
+
+bool RenderQueue::getIsDepthPrePassable(const Mesh& mesh, const Material& material)
+{
+	const RasterState& rasterState = material.getRasterState();
+	if (rasterState.blendMode != BlendMode::NONE || !rasterState.isDepthTest || !rasterState.isDepthWrite)
+		return false;
+
+	// Textured and cutout fragments may be discarded by the colour shader, which the depth shader cannot know
+	if (material.getTextureCount() > 0 || (material.getVariant() & SHADER_KEYWORD_USE_TEXTURE) != 0)
+		return false;
+
+	return !mesh.getIsCutout();
+}
+
+quint64 RenderQueue::getDepthBits(float depth)
+{
+	float bits = std::log2(1.0f + std::max(depth, 0.0f)) * 4096.0f;
+	return static_cast<quint64>(std::min(bits, 65535.0f));
+}
+
+void RenderQueue::sort(const QMatrix4x4& view, bool isDepthPrePass)
+{
+	mDepthOrder.clear();
+	mOrder.resize(mCommands.size());
+	ShaderVariants::Key keywords = getKeywords();
+
+	for (unsigned int i = 0; i < mCommands.size(); ++i)
+	{
+		Command& command = mCommands[i];
+		QVector3D center = command.world.map(command.mesh->getBoundingSphere().toVector3D());
+		command.depth = std::max(-view.map(center).z(), 0.0f);
+		ShaderProgram* shader = command.material->getShaderProgram(keywords);
+		// The fallback bound while a program compiles is not invariant with the depth shader, so
+		// its fragments could fail GL_EQUAL; those draws test and write depth as usual instead
+		command.isPrePassed = isDepthPrePass && shader && shader->getIsReady()
+			&& getIsDepthPrePassable(*command.mesh, *command.material);
+		quint64 program = shader ? shader->getProgramId() : 0;
+		quint64 materialId = static_cast<quint32>(command.material->getId());
+		quint64 depth = getDepthBits(command.depth);
+
+		if (command.material->getRasterState().blendMode != BlendMode::NONE)
+		{
+			// Back to front so each layer blends over what is behind it
+			command.sortKey = (1ull << 63) | ((0xFFFF - depth) << 47) | ((program & 0x7FFF) << 32) | materialId;
+		}
+		else
+		{
+			// Coarse front-to-back buckets let early-z reject hidden fragments while keeping most state
+			// grouping; pre-passed draws cannot overdraw, so they skip the bucket and sort by state only
+			quint64 bucket = command.isPrePassed ? 0 : depth >> 8;
+			command.sortKey = (bucket << 55) | ((program & 0x7FFFFF) << 32) | materialId;
+		}
+
+		mOrder[i] = i;
+		if (command.isPrePassed)
+		{
+			mDepthOrder.push_back(i);
+		}
+	}
+
+	std::stable_sort(mOrder.begin(), mOrder.end(), [this](unsigned int a, unsigned int b) {
+		return mCommands[a].sortKey < mCommands[b].sortKey;
+	});
+	std::sort(mDepthOrder.begin(), mDepthOrder.end(), [this](unsigned int a, unsigned int b) {
+		return mCommands[a].depth < mCommands[b].depth;
+	});
+	mIsSorted = true;
+}
+
+void RenderQueue::flushDepth(ShaderProgram& depthShader, const QMatrix4x4& view, const QMatrix4x4& projection, RenderStats& stats)
+{
+	if (mDepthOrder.empty())
+		return;
+
+	PROFILE_SCOPE("RenderQueue::flushDepth");
+
+	depthShader.bind();
+	depthShader.setUniformValue("mView", view);
+	depthShader.setUniformValue("mProj", projection);
+
+	GLStateCache& state = GLStateCache::instance();
+	state.setIsEnabled(GL_DEPTH_TEST, true);
+	state.setDepthFunc(GL_LESS);
+	state.setDepthMask(true);
+	for (unsigned int index : mDepthOrder)
+	{
+		const Command& command = mCommands[index];
+
+		// Culling and fill mode must match the colour pass, or it would find depths it never wrote
+		const RasterState& rasterState = command.material->getRasterState();
+		state.setPolygonMode(static_cast<GLenum>(rasterState.polygonMode), static_cast<GLenum>(rasterState.drawBufferMode));
+		state.setIsEnabled(GL_CULL_FACE, rasterState.cullMode != CullMode::NONE);
+		if (rasterState.cullMode != CullMode::NONE)
+		{
+			state.setCullFace(static_cast<GLenum>(rasterState.cullMode));
+		}
+
+		depthShader.setUniformValue("mWorld", command.world);
+		command.mesh->drawDepth();
+		stats.depthDrawCalls++;
+	}
+
+	depthShader.release();
+}
+
+void RenderQueue::flush(const QMatrix4x4& view, const QMatrix4x4& projection, TextureManager* textureManager, RenderStats& stats)
+{
+	if (mCommands.empty())
+		return;
+
+	PROFILE_SCOPE("RenderQueue::flush");
+
+	if (!mIsSorted)
+	{
+		sort(view, false);
+	}
+
+	mHasRasterState = false;
+	ShaderVariants::Key keywords = getKeywords();
+
+	ShaderProgram* currentShader = nullptr;
+	Material* currentMaterial = nullptr;
+	for (unsigned int index : mOrder)
+	{
+		const Command& command = mCommands[index];
+		ShaderProgram* shader = command.material->getShaderProgram(keywords);
+		if (!shader)
+			continue;
+
+		if (shader != currentShader)
+		{
+			shader->bind();
+			shader->setUniformValue("mView", view);
+			shader->setUniformValue("mProj", projection);
+			shader->setUniformValue("mTexScale", QVector2D(1.0f, 1.0f));
+			if (keywords & SHADER_KEYWORD_USE_LIGHTING)
+			{
+				mLighting->apply(*shader);
+			}
+			currentShader = shader;
+			currentMaterial = nullptr;
+			stats.shaderBinds++;
+		}
+
+		if (command.material != currentMaterial)
+		{
+			command.material->apply(*shader, textureManager);
+			currentMaterial = command.material;
+			stats.materialBinds++;
+		}
+		applyRasterState(command.material->getRasterState(), command.isPrePassed, stats);
+
+		shader->setUniformValue("mWorld", command.world);
+		command.mesh->draw(*shader);
+		stats.drawCalls++;
+	}
+
+	if (currentShader)
+	{
+		currentShader->release();
+	}
+	applyRasterState(RasterState(), false, stats);
+	mCommands.clear();
+	mDepthOrder.clear();
+	mIsSorted = false;
+}
+
+int RenderQueue::getCommandCount() const
+{
+	return static_cast<int>(mCommands.size());
+}
+
+void RenderQueue::applyRasterState(const RasterState& rasterState, bool isPrePassed, RenderStats& stats)
+{
+	if (mHasRasterState && rasterState == mRasterState && isPrePassed == mIsPrePassed)
+		return;
+
+	// The cache drops whatever part of the state is already set
+	GLStateCache& state = GLStateCache::instance();
+	state.setPolygonMode(static_cast<GLenum>(rasterState.polygonMode), static_cast<GLenum>(rasterState.drawBufferMode));
+
+	state.setIsEnabled(GL_CULL_FACE, rasterState.cullMode != CullMode::NONE);
+	if (rasterState.cullMode != CullMode::NONE)
+	{
+		state.setCullFace(static_cast<GLenum>(rasterState.cullMode));
+	}
+
+	state.setIsEnabled(GL_BLEND, rasterState.blendMode != BlendMode::NONE);
+	if (rasterState.blendMode == BlendMode::ALPHA)
+	{
+		state.setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+	else if (rasterState.blendMode == BlendMode::ADDITIVE)
+	{
+		state.setBlendFunc(GL_SRC_ALPHA, GL_ONE);
+	}
+
+	// Pre-passed draws only shade the fragments that won the depth pass, and the depth is already there
+	state.setIsEnabled(GL_DEPTH_TEST, rasterState.isDepthTest);
+	state.setDepthFunc(isPrePassed ? GL_EQUAL : GL_LESS);
+	state.setDepthMask(rasterState.isDepthWrite && !isPrePassed);
+
+	mRasterState = rasterState;
+	mIsPrePassed = isPrePassed;
+	mHasRasterState = true;
+	stats.rasterStateChanges++;
+}
@@ -0,0 +1,55 @@
+#include "Engine/Renders/RenderSnapshot.h"
+#include "Engine/Nodes/Camera.h"
+
+#include <algorithm>
+
+QMatrix4x4 RenderItem::getWorldMatrix(float alpha) const
+{
+	if (isStatic || alpha >= 1.0f)
+		return world;
+
+	QMatrix4x4 matrix;
+	matrix.translate(previousPosition + (position - previousPosition) * alpha);
+	matrix.rotate(QQuaternion::slerp(previousRotation, rotation, alpha));
+	matrix.scale(previousScale + (scale - previousScale) * alpha);
+	return matrix;
+}
+
+LightData LightItem::getLightData(float alpha) const
+{
+	if (alpha >= 1.0f)
+		return light;
+
+	LightData interpolated = light;
+	interpolated.position = previousPosition + (light.position - previousPosition) * alpha;
+	interpolated.direction = (previousDirection + (light.direction - previousDirection) * alpha).normalized();
+	return interpolated;
+}
+
+void RenderSnapshot::reset()
+{
+	stepIndex = -1;
+	items.clear();
+	lights.clear();
+}
+
+bool RenderSnapshot::isValid() const
+{
+	return stepIndex >= 0;
+}
+
+QMatrix4x4 RenderSnapshot::getViewMatrix(float alpha) const
+{
+	QVector3D position = previousCameraPosition + (cameraPosition - previousCameraPosition) * alpha;
+	QQuaternion rotation = QQuaternion::slerp(previousCameraRotation, cameraRotation, alpha);
+	return Camera::makeViewMatrix(position, rotation);
+}
+
+float RenderSnapshot::getAlpha(std::chrono::steady_clock::time_point now) const
+{
+	if (fixedDeltaTime <= 0.0f)
+		return 1.0f;
+
+	float elapsed = std::chrono::duration<float>(now - publishTime).count();
+	return std::clamp(elapsed / fixedDeltaTime, 0.0f, 1.0f);
+}
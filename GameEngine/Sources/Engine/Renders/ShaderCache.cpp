@@ -0,0 +1,116 @@
+#include "Engine/Renders/ShaderCache.h"
+
+#include <iostream>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+ShaderCache& ShaderCache::instance()
+{
+	static ShaderCache cache;
+	return cache;
+}
+
+ShaderCache::ShaderCache() : mIsEnabled(true), mHitCount(0), mMissCount(0)
+{
+	mDirectory = QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("shaders");
+}
+
+void ShaderCache::setIsEnabled(bool isEnabled)
+{
+	mIsEnabled = isEnabled;
+}
+
+bool ShaderCache::getIsEnabled() const
+{
+	return mIsEnabled;
+}
+
+void ShaderCache::setDirectory(const QString& directory)
+{
+	mDirectory = directory;
+}
+
+QString ShaderCache::getDirectory() const
+{
+	return mDirectory;
+}
+
+bool ShaderCache::read(const QByteArray& key, GLenum& format, QByteArray& binary)
+{
+	if (!mIsEnabled)
+		return false;
+
+	QFile file(getPath(key));
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		mMissCount++;
+		return false;
+	}
+
+	QDataStream stream(&file);
+	quint32 magic = 0;
+	quint32 version = 0;
+	quint32 binaryFormat = 0;
+	stream >> magic >> version >> binaryFormat >> binary;
+	if (stream.status() != QDataStream::Ok || magic != FILE_MAGIC || version != FILE_VERSION || binary.isEmpty())
+	{
+		file.close();
+		remove(key);
+		mMissCount++;
+		return false;
+	}
+
+	format = static_cast<GLenum>(binaryFormat);
+	mHitCount++;
+	return true;
+}
+
+void ShaderCache::write(const QByteArray& key, GLenum format, const QByteArray& binary)
+{
+	if (!mIsEnabled || binary.isEmpty())
+		return;
+
+	if (!QDir().mkpath(mDirectory))
+	{
+		std::cout << "ERROR::SHADER_CACHE::DIRECTORY_FAILED " << mDirectory.toStdString() << std::endl;
+		return;
+	}
+
+	// Written aside and renamed, so a crash never leaves a truncated entry behind
+	QSaveFile file(getPath(key));
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		std::cout << "ERROR::SHADER_CACHE::WRITE_FAILED " << file.fileName().toStdString() << std::endl;
+		return;
+	}
+
+	QDataStream stream(&file);
+	stream << FILE_MAGIC << FILE_VERSION << static_cast<quint32>(format) << binary;
+	if (!file.commit())
+	{
+		std::cout << "ERROR::SHADER_CACHE::WRITE_FAILED " << file.fileName().toStdString() << std::endl;
+	}
+}
+
+void ShaderCache::remove(const QByteArray& key)
+{
+	QFile::remove(getPath(key));
+}
+
+int ShaderCache::getHitCount() const
+{
+	return mHitCount;
+}
+
+int ShaderCache::getMissCount() const
+{
+	return mMissCount;
+}
+
+QString ShaderCache::getPath(const QByteArray& key) const
+{
+	return QDir(mDirectory).filePath(QString::fromLatin1(key) + ".bin");
+}
@@ -1,45 +1,96 @@
 #include "Engine/Renders/ShaderProgram.h"
+#include "Engine/Renders/GLStateCache.h"
+#include "Engine/Renders/ShaderCache.h"
+#include "Engine/Renders/ShaderWatcher.h"
+#include <QCryptographicHash>
 #include <QFile>
-#include <QTextStream>
+#include <QFileInfo>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 ShaderProgram::ShaderProgram(QString vertexPath, QString fragmentPath)
-    : mIsStarted(false), mProgram(nullptr)
+    : mIsStarted(false), mProgramId(0), mStatus(Status::Empty), mIsAsync(false), mIsFromCache(false),
+    mIsFallbackBound(false), mFallback(nullptr), mIsReloadCopy(false)
 {
-    try
+    // Hot reload reads the same files from the source tree instead of the resources
+    vertexPath = ShaderWatcher::instance().resolvePath(vertexPath);
+    fragmentPath = ShaderWatcher::instance().resolvePath(fragmentPath);
+    if (!readSource(vertexPath, vertexCode) || !readSource(fragmentPath, fragmentCode))
     {
-        // open files
-        QFile vShaderFile(vertexPath);
-        QFile fShaderFile(fragmentPath);
-
-        if (!vShaderFile.open(QIODevice::ReadOnly | QIODevice::Text) || !fShaderFile.open(QIODevice::ReadOnly | QIODevice::Text))
-        {
-            throw std::runtime_error("Failed to open shader files");
-        }
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: Failed to open shader files" << std::endl;
+        return;
+    }
 
-        QTextStream vShaderStream(&vShaderFile);
-        QTextStream fShaderStream(&fShaderFile);
+    this->vertexPath = vertexPath;
+    this->fragmentPath = fragmentPath;
+}
 
-        // read file's buffer contents into strings
-        vertexCode = vShaderStream.readAll();
-        fragmentCode = fShaderStream.readAll();
+ShaderProgram::ShaderProgram(QString computePath)
+    : mIsStarted(false), mProgramId(0), mStatus(Status::Empty), mIsAsync(false), mIsFromCache(false),
+    mIsFallbackBound(false), mFallback(nullptr), mIsReloadCopy(false)
+{
+    computePath = ShaderWatcher::instance().resolvePath(computePath);
+    if (!readSource(computePath, computeCode))
+    {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: Failed to open shader file " << computePath.toStdString() << std::endl;
+        return;
+    }
 
-        this->vertexPath = vertexPath;
-        this->fragmentPath = fragmentPath;
+    this->computePath = computePath;
+}
 
-        // close file handlers
-        vShaderFile.close();
-        fShaderFile.close();
+ShaderProgram::~ShaderProgram()
+{
+    // Dropped variants and reloads never see clear(); without their context the objects die with it
+    QOpenGLContext* context = mExtensions.getContext();
+    if ((mProgramId != 0 || !mStages.empty() || mReload) && context && QOpenGLContext::currentContext() == context)
+    {
+        clear();
     }
-    catch (const std::exception& e)
+    ShaderWatcher::instance().unwatch(this);
+}
+
+bool ShaderProgram::readSource(const QString& path, QString& code)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    code = QString::fromUtf8(file.readAll());
+    return true;
+}
+
+QByteArray ShaderProgram::injectDefines(const QString& code) const
+{
+    QByteArray source = code.toUtf8();
+    if (mDefines.isEmpty())
+        return source;
+
+    QByteArray defines;
+    for (const QString& define : mDefines)
     {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
+        defines += "#define " + define.toUtf8() + "\n";
     }
+
+    // #version has to stay first; #line keeps compiler messages pointing at the file's own lines
+    int versionEnd = source.startsWith("#version") ? source.indexOf('\n') : -1;
+    if (versionEnd < 0)
+        return defines + "#line 1\n" + source;
+
+    return source.left(versionEnd + 1) + defines + "#line 2\n" + source.mid(versionEnd + 1);
 }
 
 void ShaderProgram::init()
 {
     initializeOpenGLFunctions();
+    mExtensions.init();
+
+    if (mExtensions.hasParallelShaderCompile)
+    {
+        // Let the driver pick how many compiler threads to use
+        mExtensions.glMaxShaderCompilerThreads(0xFFFFFFFF);
+    }
 }
 
 void ShaderProgram::start()
@@ -48,159 +99,748 @@ void ShaderProgram::start()
         return;
 
     mIsStarted = true;
+    mIsFromCache = false;
+    mLog.clear();
 
-    mProgram = new QOpenGLShaderProgram();
+    if (!mIsReloadCopy)
+    {
+        ShaderWatcher::instance().watch(this);
+    }
 
-    if (!mProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexCode))
+    createProgram();
+    mCacheKey = makeCacheKey();
+    if (loadBinary())
     {
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << mProgram->log().toStdString() << std::endl;
+        mIsFromCache = true;
+        mStatus = Status::Ready;
+        return;
     }
-    if (!mProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentCode))
+
+    if (!computeCode.isEmpty())
     {
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << mProgram->log().toStdString() << std::endl;
+        compileStage(GL_COMPUTE_SHADER, computeCode);
     }
-    if (!mProgram->link())
+    else
     {
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << mProgram->log().toStdString() << std::endl;
+        compileStage(GL_VERTEX_SHADER, vertexCode);
+        compileStage(GL_FRAGMENT_SHADER, fragmentCode);
+    }
+
+    glProgramParameteri(mProgramId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(mProgramId);
+    mStatus = Status::Compiling;
+
+    // Without the extension every status query blocks, so the link is simply finished here
+    if (!mIsAsync || !mExtensions.hasParallelShaderCompile)
+    {
+        finishLink();
     }
 }
 
 void ShaderProgram::clear()
 {
-    if (mProgram)
+    ShaderWatcher::instance().unwatch(this);
+    if (mReload)
+    {
+        mReload->clear();
+        mReload.reset();
+    }
+
+    for (GLuint stage : mStages)
+    {
+        glDeleteShader(stage);
+    }
+    mStages.clear();
+
+    if (mProgramId != 0)
     {
-        mProgram->release();
-        delete mProgram;
-        mProgram = nullptr;
+        glDeleteProgram(mProgramId);
+        mProgramId = 0;
     }
 
+    mPendingUniforms.clear();
+    mUniformLocations.clear();
+    mStatus = Status::Empty;
+    mIsFromCache = false;
+    mIsFallbackBound = false;
     mIsStarted = false;
 }
 
-void ShaderProgram::bind()
+void ShaderProgram::setDefines(const QStringList& defines)
 {
-	if (mProgram)
-	{
-		mProgram->bind();
-	}
+    mDefines = defines;
 }
 
-void ShaderProgram::release()
+QStringList ShaderProgram::getDefines() const
 {
-	if (mProgram)
-	{
-		mProgram->release();
-	}
+    return mDefines;
 }
 
-void ShaderProgram::bindAttributeLocation(const char* name, int location)
+void ShaderProgram::setIsAsync(bool isAsync)
+{
+    mIsAsync = isAsync;
+}
+
+bool ShaderProgram::getIsAsync() const
 {
-    if (mProgram)
+    return mIsAsync;
+}
+
+void ShaderProgram::setFallback(ShaderProgram* fallback)
+{
+    mFallback = fallback;
+}
+
+void ShaderProgram::poll()
+{
+    if (mReload)
     {
-        mProgram->bindAttributeLocation(name, location);
+        mReload->poll();
+        if (mReload->mStatus != Status::Compiling)
+        {
+            finishReload();
+        }
+    }
+
+    if (mStatus != Status::Compiling)
+        return;
+
+    GLint isCompleted = GL_FALSE;
+    glGetProgramiv(mProgramId, GL_COMPLETION_STATUS_KHR, &isCompleted);
+    if (isCompleted == GL_TRUE)
+    {
+        finishLink();
     }
 }
 
-void ShaderProgram::setUniformValue(const char* name, bool value)
+ShaderProgram::Status ShaderProgram::getStatus() const
+{
+    return mStatus;
+}
+
+QString ShaderProgram::getLog() const
 {
-    if (mProgram)
+    return mLog;
+}
+
+QString ShaderProgram::getName() const
+{
+    if (!computePath.isEmpty())
+        return QFileInfo(computePath).fileName();
+
+    QString name = QFileInfo(vertexPath).fileName() + " + " + QFileInfo(fragmentPath).fileName();
+    if (!mDefines.isEmpty())
     {
-        mProgram->setUniformValue(name, value);
+        name += " [" + mDefines.join(' ') + "]";
     }
+    return name;
 }
 
-void ShaderProgram::setUniformValue(const char* name, int value)
+bool ShaderProgram::getIsReady() const
+{
+    return mStatus == Status::Ready;
+}
+
+bool ShaderProgram::getIsFromCache() const
 {
-    if (mProgram)
+    return mIsFromCache;
+}
+
+GLuint ShaderProgram::getProgramId() const
+{
+    return mProgramId;
+}
+
+bool ShaderProgram::reload()
+{
+    if (!mIsStarted)
+        return false;
+
+    mLog.clear();
+    if (mReload)
+    {
+        // A newer save supersedes the build still in flight
+        mReload->clear();
+        mReload.reset();
+    }
+
+    std::unique_ptr<ShaderProgram> reload;
+    if (!computePath.isEmpty())
+    {
+        reload.reset(new ShaderProgram(computePath));
+    }
+    else
+    {
+        reload.reset(new ShaderProgram(vertexPath, fragmentPath));
+    }
+
+    if (reload->vertexCode.isEmpty() && reload->fragmentCode.isEmpty() && reload->computeCode.isEmpty())
+    {
+        mLog = "Failed to read " + getName();
+        return false;
+    }
+
+    // Editors often write a file twice per save
+    if (reload->vertexCode == vertexCode && reload->fragmentCode == fragmentCode && reload->computeCode == computeCode)
+        return false;
+
+    reload->mIsReloadCopy = true;
+    reload->mDefines = mDefines;
+    reload->mAttributeLocations = mAttributeLocations;
+    reload->mIsAsync = mIsAsync;
+    reload->init();
+    reload->start();
+
+    mReload = std::move(reload);
+    if (mReload->mStatus != Status::Compiling)
     {
-        mProgram->setUniformValue(name, value);
+        finishReload();
     }
+    return true;
 }
 
-void ShaderProgram::setUniformValue(const char* name, float value)
+bool ShaderProgram::getIsReloading() const
+{
+    return mReload != nullptr;
+}
+
+void ShaderProgram::finishReload()
 {
-    if (mProgram)
+    if (mReload->mStatus == Status::Ready)
     {
-        mProgram->setUniformValue(name, value);
+        // Adopt the new program; locations of the old one mean nothing to it
+        GLuint previousId = mProgramId;
+        mProgramId = mReload->mProgramId;
+        mReload->mProgramId = 0;
+        mUniformLocations.clear();
+        mPendingUniforms.clear();
+        if (previousId != 0)
+        {
+            // Uniforms set once at init would otherwise be back at their defaults
+            copyUniforms(previousId);
+            glDeleteProgram(previousId);
+        }
+        mIsFromCache = mReload->mIsFromCache;
+        mCacheKey = mReload->mCacheKey;
+        vertexCode = mReload->vertexCode;
+        fragmentCode = mReload->fragmentCode;
+        computeCode = mReload->computeCode;
+        mStatus = Status::Ready;
+        mLog.clear();
+    }
+    else
+    {
+        mLog = mReload->mLog;
     }
+
+    mReload->clear();
+    mReload.reset();
 }
 
-void ShaderProgram::setUniformValue(const char* name, const QMatrix4x4& value)
+void ShaderProgram::copyUniforms(GLuint sourceId)
 {
-    if (mProgram)
+    GLint uniformCount = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(sourceId, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(sourceId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    if (uniformCount <= 0)
+        return;
+
+    GLStateCache& state = GLStateCache::instance();
+    GLuint previousProgram = state.getProgram();
+    state.useProgram(mProgramId);
+
+    QByteArray nameBuffer(qMax(maxNameLength, 1), '\0');
+    for (GLint i = 0; i < uniformCount; ++i)
     {
-        mProgram->setUniformValue(name, value);
+        GLint size = 0;
+        GLenum type = 0;
+        GLsizei length = 0;
+        glGetActiveUniform(sourceId, static_cast<GLuint>(i), maxNameLength, &length, &size, &type, nameBuffer.data());
+
+        // Arrays are listed once as name[0]; every element has a location of its own
+        QByteArray name(nameBuffer.constData(), length);
+        if (name.endsWith("[0]"))
+        {
+            name.chop(3);
+        }
+
+        for (GLint element = 0; element < size; ++element)
+        {
+            QByteArray elementName = size > 1 ? name + "[" + QByteArray::number(element) + "]" : name;
+            GLint sourceLocation = glGetUniformLocation(sourceId, elementName.constData());
+            GLint location = getUniformLocation(elementName.constData());
+            // Block members have no location, and the new source may have dropped the uniform
+            if (sourceLocation < 0 || location < 0)
+                continue;
+
+            GLfloat floats[16];
+            GLint ints[4];
+            GLuint uints[4];
+            switch (type)
+            {
+            case GL_FLOAT:
+                glGetUniformfv(sourceId, sourceLocation, floats);
+                glUniform1fv(location, 1, floats);
+                break;
+            case GL_FLOAT_VEC2:
+                glGetUniformfv(sourceId, sourceLocation, floats);
+                glUniform2fv(location, 1, floats);
+                break;
+            case GL_FLOAT_VEC3:
+                glGetUniformfv(sourceId, sourceLocation, floats);
+                glUniform3fv(location, 1, floats);
+                break;
+            case GL_FLOAT_VEC4:
+                glGetUniformfv(sourceId, sourceLocation, floats);
+                glUniform4fv(location, 1, floats);
+                break;
+            case GL_FLOAT_MAT2:
+                glGetUniformfv(sourceId, sourceLocation, floats);
+                glUniformMatrix2fv(location, 1, GL_FALSE, floats);
+                break;
+            case GL_FLOAT_MAT3:
+                glGetUniformfv(sourceId, sourceLocation, floats);
+                glUniformMatrix3fv(location, 1, GL_FALSE, floats);
+                break;
+            case GL_FLOAT_MAT4:
+                glGetUniformfv(sourceId, sourceLocation, floats);
+                glUniformMatrix4fv(location, 1, GL_FALSE, floats);
+                break;
+            case GL_FLOAT_MAT2x3:
+                glGetUniformfv(sourceId, sourceLocation, floats);
+                glUniformMatrix2x3fv(location, 1, GL_FALSE, floats);
+                break;
+            case GL_FLOAT_MAT2x4:
+                glGetUniformfv(sourceId, sourceLocation, floats);
+                glUniformMatrix2x4fv(location, 1, GL_FALSE, floats);
+                break;
+            case GL_FLOAT_MAT3x2:
+                glGetUniformfv(sourceId, sourceLocation, floats);
+                glUniformMatrix3x2fv(location, 1, GL_FALSE, floats);
+                break;
+            case GL_FLOAT_MAT3x4:
+                glGetUniformfv(sourceId, sourceLocation, floats);
+                glUniformMatrix3x4fv(location, 1, GL_FALSE, floats);
+                break;
+            case GL_FLOAT_MAT4x2:
+                glGetUniformfv(sourceId, sourceLocation, floats);
+                glUniformMatrix4x2fv(location, 1, GL_FALSE, floats);
+                break;
+            case GL_FLOAT_MAT4x3:
+                glGetUniformfv(sourceId, sourceLocation, floats);
+                glUniformMatrix4x3fv(location, 1, GL_FALSE, floats);
+                break;
+            case GL_UNSIGNED_INT:
+                glGetUniformuiv(sourceId, sourceLocation, uints);
+                glUniform1uiv(location, 1, uints);
+                break;
+            case GL_UNSIGNED_INT_VEC2:
+                glGetUniformuiv(sourceId, sourceLocation, uints);
+                glUniform2uiv(location, 1, uints);
+                break;
+            case GL_UNSIGNED_INT_VEC3:
+                glGetUniformuiv(sourceId, sourceLocation, uints);
+                glUniform3uiv(location, 1, uints);
+                break;
+            case GL_UNSIGNED_INT_VEC4:
+                glGetUniformuiv(sourceId, sourceLocation, uints);
+                glUniform4uiv(location, 1, uints);
+                break;
+            case GL_INT_VEC2:
+            case GL_BOOL_VEC2:
+                glGetUniformiv(sourceId, sourceLocation, ints);
+                glUniform2iv(location, 1, ints);
+                break;
+            case GL_INT_VEC3:
+            case GL_BOOL_VEC3:
+                glGetUniformiv(sourceId, sourceLocation, ints);
+                glUniform3iv(location, 1, ints);
+                break;
+            case GL_INT_VEC4:
+            case GL_BOOL_VEC4:
+                glGetUniformiv(sourceId, sourceLocation, ints);
+                glUniform4iv(location, 1, ints);
+                break;
+            default:
+                // int, bool and the sampler and image units, all set as a single int
+                glGetUniformiv(sourceId, sourceLocation, ints);
+                glUniform1iv(location, 1, ints);
+                break;
+            }
+        }
     }
+
+    // A bound old program is about to be deleted, so the new one takes its place
+    state.useProgram(previousProgram == sourceId ? mProgramId : previousProgram);
 }
 
-void ShaderProgram::setUniformValue(const char* name, const QVector2D& value)
+void ShaderProgram::createProgram()
 {
-    if (mProgram)
+    mProgramId = glCreateProgram();
+    for (const auto& attribute : mAttributeLocations)
     {
-        mProgram->setUniformValue(name, value);
+        glBindAttribLocation(mProgramId, attribute.second, attribute.first.constData());
     }
 }
 
-void ShaderProgram::setUniformValue(const char* name, const QVector3D& value)
+QByteArray ShaderProgram::makeCacheKey()
 {
-    if (mProgram)
+    // Any driver or source change lands on a different entry instead of a rejected binary
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArrayView("ShaderProgram/1"));
+    hash.addData(QByteArrayView(reinterpret_cast<const char*>(glGetString(GL_VENDOR))));
+    hash.addData(QByteArrayView(reinterpret_cast<const char*>(glGetString(GL_RENDERER))));
+    hash.addData(QByteArrayView(reinterpret_cast<const char*>(glGetString(GL_VERSION))));
+    hash.addData(injectDefines(vertexCode));
+    hash.addData(QByteArrayView("\0", 1));
+    hash.addData(injectDefines(fragmentCode));
+    hash.addData(QByteArrayView("\0", 1));
+    hash.addData(injectDefines(computeCode));
+    for (const auto& attribute : mAttributeLocations)
     {
-        mProgram->setUniformValue(name, value);
+        hash.addData(attribute.first + "=" + QByteArray::number(attribute.second) + ";");
     }
+    return hash.result().toHex();
 }
 
-void ShaderProgram::setUniformValue(const char* name, const QVector4D& value)
+bool ShaderProgram::loadBinary()
 {
-    if (mProgram)
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if (formatCount <= 0)
+        return false;
+
+    GLenum format = 0;
+    QByteArray binary;
+    ShaderCache& cache = ShaderCache::instance();
+    if (!cache.read(mCacheKey, format, binary))
+        return false;
+
+    glProgramBinary(mProgramId, format, binary.constData(), static_cast<GLsizei>(binary.size()));
+
+    GLint isLinked = GL_FALSE;
+    glGetProgramiv(mProgramId, GL_LINK_STATUS, &isLinked);
+    if (isLinked == GL_TRUE)
+        return true;
+
+    // Stale for this driver; start over from a clean program and compile from source
+    cache.remove(mCacheKey);
+    glDeleteProgram(mProgramId);
+    createProgram();
+    return false;
+}
+
+void ShaderProgram::storeBinary()
+{
+    GLint length = 0;
+    glGetProgramiv(mProgramId, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    QByteArray binary(length, Qt::Uninitialized);
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(mProgramId, length, &written, &format, binary.data());
+    if (written <= 0)
+        return;
+
+    binary.truncate(written);
+    ShaderCache::instance().write(mCacheKey, format, binary);
+}
+
+void ShaderProgram::compileStage(GLenum type, const QString& code)
+{
+    QByteArray source = injectDefines(code);
+    const char* sourceData = source.constData();
+
+    // Status is only queried after the link, which keeps parallel compilation from blocking here
+    GLuint stage = glCreateShader(type);
+    glShaderSource(stage, 1, &sourceData, nullptr);
+    glCompileShader(stage);
+    glAttachShader(mProgramId, stage);
+    mStages.push_back(stage);
+}
+
+void ShaderProgram::finishLink()
+{
+    GLint isLinked = GL_FALSE;
+    glGetProgramiv(mProgramId, GL_LINK_STATUS, &isLinked);
+    if (isLinked != GL_TRUE)
+    {
+        logStageErrors();
+
+        GLint length = 0;
+        glGetProgramiv(mProgramId, GL_INFO_LOG_LENGTH, &length);
+        QByteArray log(qMax(length, 1), '\0');
+        glGetProgramInfoLog(mProgramId, length, nullptr, log.data());
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << log.constData() << std::endl;
+        mLog += QString::fromUtf8(log.constData());
+    }
+
+    for (GLuint stage : mStages)
+    {
+        glDetachShader(mProgramId, stage);
+        glDeleteShader(stage);
+    }
+    mStages.clear();
+
+    if (isLinked != GL_TRUE)
+    {
+        mStatus = Status::Failed;
+        mPendingUniforms.clear();
+        return;
+    }
+
+    storeBinary();
+    mStatus = Status::Ready;
+
+    if (mPendingUniforms.empty())
+        return;
+
+    // The cache knows the current program, so restoring it needs no glGet round trip
+    GLStateCache& state = GLStateCache::instance();
+    GLuint previousProgram = state.getProgram();
+    state.useProgram(mProgramId);
+    for (const auto& uniform : mPendingUniforms)
     {
-        mProgram->setUniformValue(name, value);
+        applyUniform(uniform.name.constData(), uniform.setter);
     }
+    state.useProgram(previousProgram);
+    mPendingUniforms.clear();
 }
 
-void ShaderProgram::setUniformValue(const char* name, const QColor& color)
+void ShaderProgram::logStageErrors()
 {
-    if (mProgram)
+    for (GLuint stage : mStages)
     {
-        mProgram->setUniformValue(name, color);
+        GLint isCompiled = GL_FALSE;
+        glGetShaderiv(stage, GL_COMPILE_STATUS, &isCompiled);
+        if (isCompiled == GL_TRUE)
+            continue;
+
+        GLint type = 0;
+        glGetShaderiv(stage, GL_SHADER_TYPE, &type);
+        const char* label = type == GL_VERTEX_SHADER ? "VERTEX" : type == GL_FRAGMENT_SHADER ? "FRAGMENT" : "COMPUTE";
+
+        GLint length = 0;
+        glGetShaderiv(stage, GL_INFO_LOG_LENGTH, &length);
+        QByteArray log(qMax(length, 1), '\0');
+        glGetShaderInfoLog(stage, length, nullptr, log.data());
+        std::cout << "ERROR::SHADER::" << label << "::COMPILATION_FAILED\n" << log.constData() << std::endl;
+        mLog += QString("%1: %2\n").arg(label, QString::fromUtf8(log.constData()));
     }
 }
 
-void ShaderProgram::setUniformValue(const char* name, const QPoint& point)
+void ShaderProgram::bind()
 {
-    if (mProgram)
+    poll();
+
+    if (mStatus == Status::Ready)
+    {
+        GLStateCache::instance().useProgram(mProgramId);
+        mIsFallbackBound = false;
+    }
+    else if (mStatus == Status::Compiling && mFallback && mFallback->getIsReady())
     {
-        mProgram->setUniformValue(name, point);
+        mFallback->bind();
+        mIsFallbackBound = true;
     }
 }
 
-void ShaderProgram::setUniformValue(const char* name, const QPointF& point)
+void ShaderProgram::release()
 {
-    if (mProgram)
+    if (mStatus == Status::Ready || mIsFallbackBound)
     {
-        mProgram->setUniformValue(name, point);
+        GLStateCache::instance().useProgram(0);
     }
+    mIsFallbackBound = false;
 }
 
-void ShaderProgram::setUniformValue(const char* name, const QSize& size)
+void ShaderProgram::bindAttributeLocation(const char* name, int location)
 {
-    if (mProgram)
+    for (auto& attribute : mAttributeLocations)
     {
-        mProgram->setUniformValue(name, size);
+        if (attribute.first == name)
+        {
+            attribute.second = location;
+            return;
+        }
     }
+    mAttributeLocations.push_back(std::make_pair(QByteArray(name), location));
 }
 
-void ShaderProgram::setUniformValue(const char* name, const QSizeF& size)
+template <typename Upload>
+void ShaderProgram::setUniform(const char* name, const Upload& upload)
 {
-    if (mProgram)
+    if (mStatus == Status::Ready)
+    {
+        GLint location = getUniformLocation(name);
+        if (location >= 0)
+        {
+            upload(location);
+        }
+        return;
+    }
+    if (mStatus == Status::Compiling)
     {
-        mProgram->setUniformValue(name, size);
+        deferUniform(name, UniformSetter(upload));
     }
 }
 
+void ShaderProgram::deferUniform(const char* name, const UniformSetter& setter)
+{
+    if (mIsFallbackBound)
+    {
+        mFallback->applyUniform(name, setter);
+    }
+
+    // Only the latest value of each uniform needs replaying
+    for (auto& uniform : mPendingUniforms)
+    {
+        if (uniform.name == name)
+        {
+            uniform.setter = setter;
+            return;
+        }
+    }
+    mPendingUniforms.push_back({ QByteArray(name), setter });
+}
+
+void ShaderProgram::applyUniform(const char* name, const UniformSetter& setter)
+{
+    GLint location = getUniformLocation(name);
+    if (location >= 0)
+    {
+        setter(location);
+    }
+}
+
+GLint ShaderProgram::getUniformLocation(const char* name)
+{
+    // Wraps the caller's string without copying it for the lookup
+    QByteArray key = QByteArray::fromRawData(name, static_cast<qsizetype>(strlen(name)));
+    auto it = mUniformLocations.constFind(key);
+    if (it != mUniformLocations.constEnd())
+        return it.value();
+
+    GLint location = glGetUniformLocation(mProgramId, name);
+    mUniformLocations.insert(QByteArray(name), location);
+    return location;
+}
+
+void ShaderProgram::setUniformValue(const char* name, bool value)
+{
+    setUniform(name, [this, value](GLint location) { glUniform1i(location, value ? 1 : 0); });
+}
+
+void ShaderProgram::setUniformValue(const char* name, int value)
+{
+    setUniform(name, [this, value](GLint location) { glUniform1i(location, value); });
+}
+
+void ShaderProgram::setUniformValue(const char* name, float value)
+{
+    setUniform(name, [this, value](GLint location) { glUniform1f(location, value); });
+}
+
+void ShaderProgram::setUniformValue(const char* name, const QMatrix4x4& value)
+{
+    setUniform(name, [this, value](GLint location) { glUniformMatrix4fv(location, 1, GL_FALSE, value.constData()); });
+}
+
+void ShaderProgram::setUniformValue(const char* name, const QVector2D& value)
+{
+    setUniform(name, [this, value](GLint location) { glUniform2f(location, value.x(), value.y()); });
+}
+
+void ShaderProgram::setUniformValue(const char* name, const QVector3D& value)
+{
+    setUniform(name, [this, value](GLint location) { glUniform3f(location, value.x(), value.y(), value.z()); });
+}
+
+void ShaderProgram::setUniformValue(const char* name, const QVector4D& value)
+{
+    setUniform(name, [this, value](GLint location) { glUniform4f(location, value.x(), value.y(), value.z(), value.w()); });
+}
+
+void ShaderProgram::setUniformValue(const char* name, const QColor& color)
+{
+    setUniformValue(name, QVector4D(color.redF(), color.greenF(), color.blueF(), color.alphaF()));
+}
+
+void ShaderProgram::setUniformValue(const char* name, const QPoint& point)
+{
+    setUniformValue(name, QVector2D(point));
+}
+
+void ShaderProgram::setUniformValue(const char* name, const QPointF& point)
+{
+    setUniformValue(name, QVector2D(point));
+}
+
+void ShaderProgram::setUniformValue(const char* name, const QSize& size)
+{
+    setUniformValue(name, QVector2D(size.width(), size.height()));
+}
+
+void ShaderProgram::setUniformValue(const char* name, const QSizeF& size)
+{
+    setUniformValue(name, QVector2D(size.width(), size.height()));
+}
+
 void ShaderProgram::setUniformValue(const char* name, const QTransform& value)
 {
-    if (mProgram)
+    // Same column-major mat3 layout QOpenGLShaderProgram uploads
+    const GLfloat matrix[9] = {
+        GLfloat(value.m11()), GLfloat(value.m12()), GLfloat(value.m13()),
+        GLfloat(value.m21()), GLfloat(value.m22()), GLfloat(value.m23()),
+        GLfloat(value.m31()), GLfloat(value.m32()), GLfloat(value.m33())
+    };
+    setUniform(name, [this, matrix](GLint location) { glUniformMatrix3fv(location, 1, GL_FALSE, matrix); });
+}
+
+void ShaderProgram::setUniformValueArray(const char* name, const QVector4D* values, int count)
+{
+    if (mStatus == Status::Ready)
     {
-        mProgram->setUniformValue(name, value);
+        setUniform(name, [this, values, count](GLint location) {
+            glUniform4fv(location, count, reinterpret_cast<const GLfloat*>(values));
+        });
+        return;
     }
-}
\ No newline at end of file
+
+    // The caller's array may be gone by the time a pending link finishes
+    std::vector<QVector4D> copy(values, values + count);
+    setUniform(name, [this, copy](GLint location) {
+        glUniform4fv(location, static_cast<GLsizei>(copy.size()), reinterpret_cast<const GLfloat*>(copy.data()));
+    });
+}
+
+void ShaderProgram::setUniformValueArray(const char* name, const QMatrix4x4* values, int count)
+{
+    // QMatrix4x4 keeps a flag next to its floats, so the array has to be packed first
+    if (mStatus == Status::Ready)
+    {
+        // Kept across calls, so repeated uploads stop allocating once it has grown
+        mMatrixScratch.resize(static_cast<size_t>(count) * 16);
+        for (int i = 0; i < count; ++i)
+        {
+            std::copy(values[i].constData(), values[i].constData() + 16, mMatrixScratch.begin() + i * 16);
+        }
+        setUniform(name, [this, count](GLint location) {
+            glUniformMatrix4fv(location, count, GL_FALSE, mMatrixScratch.data());
+        });
+        return;
+    }
+
+    std::vector<GLfloat> copy;
+    copy.reserve(static_cast<size_t>(count) * 16);
+    for (int i = 0; i < count; ++i)
+    {
+        copy.insert(copy.end(), values[i].constData(), values[i].constData() + 16);
+    }
+    setUniform(name, [this, copy](GLint location) {
+        glUniformMatrix4fv(location, static_cast<GLsizei>(copy.size() / 16), GL_FALSE, copy.data());
+    });
+}
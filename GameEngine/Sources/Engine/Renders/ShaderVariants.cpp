@@ -0,0 +1,102 @@
+#include "Engine/Renders/ShaderVariants.h"
+
+ShaderVariants::ShaderVariants(const QString& vertexPath, const QString& fragmentPath, const QStringList& keywords)
+	: mVertexPath(vertexPath), mFragmentPath(fragmentPath), mKeywords(keywords), mIsAsync(false), mFallback(nullptr)
+{
+}
+
+ShaderVariants::~ShaderVariants()
+{
+}
+
+void ShaderVariants::setIsAsync(bool isAsync)
+{
+	mIsAsync = isAsync;
+}
+
+void ShaderVariants::setFallback(ShaderProgram* fallback)
+{
+	mFallback = fallback;
+}
+
+void ShaderVariants::bindAttributeLocation(const char* name, int location)
+{
+	mAttributeLocations.push_back(std::make_pair(QByteArray(name), location));
+}
+
+ShaderVariants::Key ShaderVariants::getKeywordBit(const QString& keyword) const
+{
+	int index = mKeywords.indexOf(keyword);
+	if (index < 0)
+	{
+		std::cout << "ERROR::SHADER_VARIANTS::UNKNOWN_KEYWORD " << keyword.toStdString() << std::endl;
+		return 0;
+	}
+	return 1u << index;
+}
+
+ShaderVariants::Key ShaderVariants::makeKey(const QStringList& keywords) const
+{
+	Key key = 0;
+	for (const QString& keyword : keywords)
+	{
+		key |= getKeywordBit(keyword);
+	}
+	return key;
+}
+
+QStringList ShaderVariants::getKeywords(Key key) const
+{
+	QStringList keywords;
+	for (int i = 0; i < mKeywords.size(); ++i)
+	{
+		if (key & (1u << i))
+		{
+			keywords.append(mKeywords[i]);
+		}
+	}
+	return keywords;
+}
+
+ShaderProgram* ShaderVariants::getVariant(Key key)
+{
+	key &= (1u << mKeywords.size()) - 1;
+
+	auto it = mVariants.find(key);
+	if (it != mVariants.end())
+		return it->second.get();
+
+	auto variant = std::make_unique<ShaderProgram>(mVertexPath, mFragmentPath);
+	variant->setDefines(getKeywords(key));
+	variant->setIsAsync(mIsAsync);
+	variant->setFallback(mFallback);
+	for (const auto& attribute : mAttributeLocations)
+	{
+		variant->bindAttributeLocation(attribute.first.constData(), attribute.second);
+	}
+	variant->init();
+	variant->start();
+
+	ShaderProgram* program = variant.get();
+	mVariants[key] = std::move(variant);
+	return program;
+}
+
+void ShaderVariants::warmUp(Key key)
+{
+	getVariant(key);
+}
+
+void ShaderVariants::clear()
+{
+	for (auto& variant : mVariants)
+	{
+		variant.second->clear();
+	}
+	mVariants.clear();
+}
+
+int ShaderVariants::getVariantCount() const
+{
+	return static_cast<int>(mVariants.size());
+}
@@ -0,0 +1,146 @@
+#include "Engine/Renders/ShaderWatcher.h"
+#include "Engine/Renders/ShaderProgram.h"
+
+#include <algorithm>
+#include <iostream>
+#include <QDir>
+#include <QFileInfo>
+
+ShaderWatcher& ShaderWatcher::instance()
+{
+	static ShaderWatcher watcher;
+	return watcher;
+}
+
+ShaderWatcher::ShaderWatcher() : mWatcher(nullptr)
+{
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+	delete mWatcher;
+}
+
+void ShaderWatcher::setSourceDirectory(const QString& directory)
+{
+	mSourceDirectory = directory;
+	if (mSourceDirectory.isEmpty() || mWatcher)
+		return;
+
+	// Created on demand so nothing touches the file system when hot reload is off
+	mWatcher = new QFileSystemWatcher();
+	QObject::connect(mWatcher, &QFileSystemWatcher::fileChanged, [this](const QString& path) {
+		onFileChanged(path);
+	});
+}
+
+QString ShaderWatcher::getSourceDirectory() const
+{
+	return mSourceDirectory;
+}
+
+bool ShaderWatcher::getIsEnabled() const
+{
+	return !mSourceDirectory.isEmpty();
+}
+
+QString ShaderWatcher::resolvePath(const QString& path) const
+{
+	if (!getIsEnabled() || !path.startsWith(RESOURCE_SHADER_PREFIX))
+		return path;
+
+	QString diskPath = QDir(mSourceDirectory).filePath(path.mid(QString(RESOURCE_SHADER_PREFIX).size()));
+	if (!QFileInfo::exists(diskPath))
+	{
+		std::cout << "ERROR::SHADER_WATCHER::FILE_NOT_FOUND " << diskPath.toStdString() << std::endl;
+		return path;
+	}
+	return diskPath;
+}
+
+void ShaderWatcher::watch(ShaderProgram* program)
+{
+	if (!mWatcher || std::find(mPrograms.begin(), mPrograms.end(), program) != mPrograms.end())
+		return;
+
+	mPrograms.push_back(program);
+	for (const QString& path : { program->vertexPath, program->fragmentPath, program->computePath })
+	{
+		if (!path.isEmpty() && !path.startsWith(":") && !mWatcher->files().contains(path))
+		{
+			mWatcher->addPath(path);
+		}
+	}
+}
+
+void ShaderWatcher::unwatch(ShaderProgram* program)
+{
+	auto remove = [program](std::vector<ShaderProgram*>& programs) {
+		programs.erase(std::remove(programs.begin(), programs.end(), program), programs.end());
+	};
+	remove(mPrograms);
+	remove(mDirtyPrograms);
+	remove(mReloadingPrograms);
+}
+
+void ShaderWatcher::update()
+{
+	for (ShaderProgram* program : mDirtyPrograms)
+	{
+		if (program->reload())
+		{
+			mReloadingPrograms.push_back(program);
+		}
+		else if (!program->getLog().isEmpty())
+		{
+			if (mReloadCallback)
+				mReloadCallback(program->getName(), false, program->getLog());
+		}
+	}
+	mDirtyPrograms.clear();
+
+	for (auto it = mReloadingPrograms.begin(); it != mReloadingPrograms.end();)
+	{
+		ShaderProgram* program = *it;
+		program->poll();
+		if (program->getIsReloading())
+		{
+			++it;
+			continue;
+		}
+
+		bool isSuccess = program->getLog().isEmpty();
+		if (mReloadCallback)
+		{
+			mReloadCallback(program->getName(), isSuccess, program->getLog());
+		}
+		it = mReloadingPrograms.erase(it);
+	}
+}
+
+void ShaderWatcher::setReloadCallback(const ReloadCallback& callback)
+{
+	mReloadCallback = callback;
+}
+
+void ShaderWatcher::onFileChanged(const QString& path)
+{
+	// Editors that save by replacing the file drop it from the watch list
+	if (!mWatcher->files().contains(path) && QFileInfo::exists(path))
+	{
+		mWatcher->addPath(path);
+	}
+
+	for (ShaderProgram* program : mPrograms)
+	{
+		if (isProgramPath(program, path) && std::find(mDirtyPrograms.begin(), mDirtyPrograms.end(), program) == mDirtyPrograms.end())
+		{
+			mDirtyPrograms.push_back(program);
+		}
+	}
+}
+
+bool ShaderWatcher::isProgramPath(const ShaderProgram* program, const QString& path)
+{
+	return program->vertexPath == path || program->fragmentPath == path || program->computePath == path;
+}
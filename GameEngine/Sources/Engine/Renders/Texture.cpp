@@ -0,0 +1,15 @@
+#include "Engine/Renders/Texture.h"
+#include "Engine/Constants/SerializePath.h"
+
+void Texture::write(QJsonObject& json) const
+{
+    json[SERIALIZE_TEXTURE_PATH] = path;
+    json[SERIALIZE_TEXTURE_TYPE] = QString::fromStdString(type);
+}
+
+void Texture::read(const QJsonObject& json)
+{
+    path = json[SERIALIZE_TEXTURE_PATH].toString();
+    type = json[SERIALIZE_TEXTURE_TYPE].toString().toStdString();
+    id = INVALID_ID;
+}
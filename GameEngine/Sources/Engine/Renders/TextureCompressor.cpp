@@ -0,0 +1,218 @@
+#include "Engine/Renders/TextureCompressor.h"
+
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace
+{
+	quint16 toRGB565(int r, int g, int b)
+	{
+		return static_cast<quint16>(((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 | ((b * 31 + 127) / 255));
+	}
+
+	void fromRGB565(quint16 color, int rgb[3])
+	{
+		int r = (color >> 11) & 31;
+		int g = (color >> 5) & 63;
+		int b = color & 31;
+		rgb[0] = (r << 3) | (r >> 2);
+		rgb[1] = (g << 2) | (g >> 4);
+		rgb[2] = (b << 3) | (b >> 2);
+	}
+}
+
+bool TextureCompressor::isOpaque(const QImage& image)
+{
+	if (!image.hasAlphaChannel())
+		return true;
+
+	for (int y = 0; y < image.height(); ++y)
+	{
+		const uchar* line = image.constScanLine(y);
+		for (int x = 0; x < image.width(); ++x)
+		{
+			if (line[x * 4 + 3] != 255)
+				return false;
+		}
+	}
+	return true;
+}
+
+int TextureCompressor::getBC1LevelSize(int width, int height)
+{
+	return std::max(1, (width + 3) / 4) * std::max(1, (height + 3) / 4) * BC1_BLOCK_BYTES;
+}
+
+QByteArray TextureCompressor::compressBC1(const QImage& image)
+{
+	int width = image.width();
+	int height = image.height();
+	QByteArray blocks(getBC1LevelSize(width, height), Qt::Uninitialized);
+	uchar* block = reinterpret_cast<uchar*>(blocks.data());
+
+	const uchar* pixels[16];
+	for (int blockY = 0; blockY < height; blockY += 4)
+	{
+		for (int blockX = 0; blockX < width; blockX += 4)
+		{
+			// Levels below 4x4 repeat their edge texels to fill the block
+			for (int i = 0; i < 16; ++i)
+			{
+				int x = std::min(blockX + (i & 3), width - 1);
+				int y = std::min(blockY + (i >> 2), height - 1);
+				pixels[i] = image.constScanLine(y) + x * 4;
+			}
+			compressBlock(pixels, block);
+			block += BC1_BLOCK_BYTES;
+		}
+	}
+	return blocks;
+}
+
+void TextureCompressor::compressBlock(const uchar* pixels[16], uchar* block)
+{
+	// Endpoints from the colour bounding box, inset slightly so the interpolated
+	// entries land inside the block's range instead of on its extremes
+	int minColor[3] = { 255, 255, 255 };
+	int maxColor[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; ++i)
+	{
+		for (int c = 0; c < 3; ++c)
+		{
+			minColor[c] = std::min(minColor[c], static_cast<int>(pixels[i][c]));
+			maxColor[c] = std::max(maxColor[c], static_cast<int>(pixels[i][c]));
+		}
+	}
+	for (int c = 0; c < 3; ++c)
+	{
+		int inset = (maxColor[c] - minColor[c]) / 16;
+		minColor[c] += inset;
+		maxColor[c] -= inset;
+	}
+
+	quint16 color0 = toRGB565(maxColor[0], maxColor[1], maxColor[2]);
+	quint16 color1 = toRGB565(minColor[0], minColor[1], minColor[2]);
+	quint32 indices = 0;
+
+	// color0 > color1 selects the four-colour mode; equal endpoints leave every index at 0
+	if (color0 < color1)
+	{
+		std::swap(color0, color1);
+	}
+	if (color0 != color1)
+	{
+		int palette[4][3];
+		fromRGB565(color0, palette[0]);
+		fromRGB565(color1, palette[1]);
+		for (int c = 0; c < 3; ++c)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		for (int i = 0; i < 16; ++i)
+		{
+			int bestIndex = 0;
+			int bestDistance = INT_MAX;
+			for (int p = 0; p < 4; ++p)
+			{
+				int dr = pixels[i][0] - palette[p][0];
+				int dg = pixels[i][1] - palette[p][1];
+				int db = pixels[i][2] - palette[p][2];
+				int distance = dr * dr + dg * dg + db * db;
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestIndex = p;
+				}
+			}
+			indices |= static_cast<quint32>(bestIndex) << (i * 2);
+		}
+	}
+
+	block[0] = static_cast<uchar>(color0 & 0xFF);
+	block[1] = static_cast<uchar>(color0 >> 8);
+	block[2] = static_cast<uchar>(color1 & 0xFF);
+	block[3] = static_cast<uchar>(color1 >> 8);
+	for (int i = 0; i < 4; ++i)
+	{
+		block[4 + i] = static_cast<uchar>((indices >> (i * 8)) & 0xFF);
+	}
+}
+
+QByteArray TextureCompressor::makeCacheKey(const QByteArray& source)
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(QByteArrayView("TextureCompressor/BC1/1"));
+	hash.addData(source);
+	return hash.result().toHex();
+}
+
+bool TextureCompressor::readCache(const QByteArray& key, int& size, std::vector<QByteArray>& levels)
+{
+	QFile file(getCachePath(key));
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream stream(&file);
+	quint32 magic = 0;
+	quint32 version = 0;
+	qint32 cachedSize = 0;
+	qint32 levelCount = 0;
+	stream >> magic >> version >> cachedSize >> levelCount;
+	if (stream.status() != QDataStream::Ok || magic != FILE_MAGIC || version != FILE_VERSION || cachedSize <= 0 || levelCount <= 0)
+		return false;
+
+	levels.clear();
+	for (int level = 0; level < levelCount; ++level)
+	{
+		QByteArray data;
+		stream >> data;
+		int levelSize = std::max(1, cachedSize >> level);
+		if (stream.status() != QDataStream::Ok || data.size() != getBC1LevelSize(levelSize, levelSize))
+			return false;
+		levels.push_back(data);
+	}
+
+	size = cachedSize;
+	return true;
+}
+
+void TextureCompressor::writeCache(const QByteArray& key, int size, const std::vector<QByteArray>& levels)
+{
+	QString path = getCachePath(key);
+	if (!QDir().mkpath(QFileInfo(path).path()))
+		return;
+
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		std::cout << "ERROR::TEXTURE_COMPRESSOR::WRITE_FAILED " << path.toStdString() << std::endl;
+		return;
+	}
+
+	QDataStream stream(&file);
+	stream << FILE_MAGIC << FILE_VERSION << static_cast<qint32>(size) << static_cast<qint32>(levels.size());
+	for (const QByteArray& level : levels)
+	{
+		stream << level;
+	}
+	if (!file.commit())
+	{
+		std::cout << "ERROR::TEXTURE_COMPRESSOR::WRITE_FAILED " << path.toStdString() << std::endl;
+	}
+}
+
+QString TextureCompressor::getCachePath(const QByteArray& key)
+{
+	QDir directory(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("textures"));
+	return directory.filePath(QString::fromLatin1(key) + ".bc1");
+}
@@ -0,0 +1,318 @@
+#include "Engine/Renders/TextureManager.h"
+#include "Engine/Renders/TextureCompressor.h"
+#include "Engine/Renders/GLStateCache.h"
+#include "Engine/Profiling/Profiler.h"
+
+#include <algorithm>
+#include <iostream>
+#include <QFile>
+#include <QImage>
+#include <QMutexLocker>
+#include <QThreadPool>
+
+namespace
+{
+	const char* DEFAULT_TEXTURE_PATH = ":/Resources/Textures/Blank.png";
+}
+
+TextureManager::TextureManager()
+	: mIsStarted(false), mIsCompressionEnabled(true), mMaxArrayLayers(256),
+	mDecodeQueue(std::make_shared<DecodeQueue>()), mPendingCount(0)
+{
+}
+
+TextureManager::~TextureManager()
+{
+}
+
+void TextureManager::init()
+{
+	initializeOpenGLFunctions();
+	mExtensions.init();
+}
+
+void TextureManager::tryStart()
+{
+	if (!mIsStarted)
+	{
+		mIsStarted = true;
+		start();
+	}
+}
+
+void TextureManager::start()
+{
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &mMaxArrayLayers);
+
+	// The default texture is decoded in place so every id resolves to something from the start
+	TextureEntry defaultEntry;
+	defaultEntry.path = DEFAULT_TEXTURE_PATH;
+	mTextures.push_back(defaultEntry);
+	mTextureIds.insert(defaultEntry.path, DEFAULT_TEXTURE_ID);
+
+	DecodedTexture decoded = decode(DEFAULT_TEXTURE_ID, DEFAULT_TEXTURE_PATH, false);
+	if (decoded.isValid)
+	{
+		upload(decoded);
+	}
+	else
+	{
+		std::cout << "ERROR::TEXTURE_MANAGER::DEFAULT_TEXTURE_MISSING " << DEFAULT_TEXTURE_PATH << std::endl;
+	}
+}
+
+void TextureManager::clear()
+{
+	if (mIsStarted)
+	{
+		for (auto& array : mArrays)
+		{
+			GLStateCache::instance().deleteTexture(array.texture);
+		}
+	}
+
+	// In-flight jobs keep the old queue alive and deliver into it unseen
+	mDecodeQueue = std::make_shared<DecodeQueue>();
+	mArrays.clear();
+	mTextures.clear();
+	mTextureIds.clear();
+	mPendingCount = 0;
+	mIsStarted = false;
+}
+
+void TextureManager::setIsCompressionEnabled(bool isEnabled)
+{
+	mIsCompressionEnabled = isEnabled;
+}
+
+bool TextureManager::getIsCompressionEnabled() const
+{
+	return mIsCompressionEnabled;
+}
+
+int TextureManager::request(const QString& path)
+{
+	auto it = mTextureIds.constFind(path);
+	if (it != mTextureIds.constEnd())
+		return it.value();
+
+	int id = static_cast<int>(mTextures.size());
+	TextureEntry entry;
+	entry.path = path;
+	mTextures.push_back(entry);
+	mTextureIds.insert(path, id);
+	mPendingCount++;
+
+	bool isCompressionEnabled = mIsCompressionEnabled && mExtensions.hasTextureCompressionBC;
+	std::shared_ptr<DecodeQueue> queue = mDecodeQueue;
+	QThreadPool::globalInstance()->start([queue, id, path, isCompressionEnabled]() {
+		DecodedTexture decoded = decode(id, path, isCompressionEnabled);
+		QMutexLocker locker(&queue->mutex);
+		queue->finished.push_back(std::move(decoded));
+	});
+	return id;
+}
+
+TextureLocation TextureManager::getLocation(int id) const
+{
+	if (id >= 0 && id < static_cast<int>(mTextures.size()) && mTextures[id].state == TextureState::Ready)
+		return mTextures[id].location;
+
+	if (!mTextures.empty() && mTextures[DEFAULT_TEXTURE_ID].state == TextureState::Ready)
+		return mTextures[DEFAULT_TEXTURE_ID].location;
+
+	return TextureLocation();
+}
+
+int TextureManager::bind(int id, int unit)
+{
+	TextureLocation location = getLocation(id);
+	GLStateCache::instance().bindTexture(unit, GL_TEXTURE_2D_ARRAY, location.array);
+	return location.layer;
+}
+
+void TextureManager::update()
+{
+	if (!mIsStarted)
+		return;
+
+	std::vector<DecodedTexture> finished;
+	{
+		QMutexLocker locker(&mDecodeQueue->mutex);
+		if (mDecodeQueue->finished.empty())
+			return;
+
+		// Spread large batches over several frames to keep upload stalls short
+		size_t count = std::min(mDecodeQueue->finished.size(), static_cast<size_t>(MAX_UPLOADS_PER_FRAME));
+		auto begin = mDecodeQueue->finished.begin();
+		finished.assign(std::make_move_iterator(begin), std::make_move_iterator(begin + count));
+		mDecodeQueue->finished.erase(begin, begin + count);
+	}
+
+	PROFILE_SCOPE("TextureManager::update");
+	for (const DecodedTexture& decoded : finished)
+	{
+		mPendingCount--;
+		if (decoded.isValid)
+		{
+			upload(decoded);
+		}
+		else
+		{
+			mTextures[decoded.id].state = TextureState::Failed;
+			std::cout << "ERROR::TEXTURE_MANAGER::DECODE_FAILED " << mTextures[decoded.id].path.toStdString() << std::endl;
+		}
+	}
+}
+
+int TextureManager::getTextureCount() const
+{
+	return static_cast<int>(mTextures.size());
+}
+
+int TextureManager::getPendingCount() const
+{
+	return mPendingCount;
+}
+
+int TextureManager::getArrayCount() const
+{
+	return static_cast<int>(mArrays.size());
+}
+
+int TextureManager::getLevelCount(int size)
+{
+	int levelCount = 1;
+	while ((size >> levelCount) > 0)
+	{
+		levelCount++;
+	}
+	return levelCount;
+}
+
+TextureManager::DecodedTexture TextureManager::decode(int id, const QString& path, bool isCompressionEnabled)
+{
+	DecodedTexture decoded;
+	decoded.id = id;
+
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly))
+		return decoded;
+	QByteArray source = file.readAll();
+
+	QByteArray cacheKey;
+	if (isCompressionEnabled)
+	{
+		cacheKey = TextureCompressor::makeCacheKey(source);
+		if (TextureCompressor::readCache(cacheKey, decoded.size, decoded.levels))
+		{
+			decoded.isCompressed = true;
+			decoded.isValid = true;
+			return decoded;
+		}
+	}
+
+	QImage image = QImage::fromData(source);
+	if (image.isNull())
+		return decoded;
+
+	// Square power-of-two layers keep a full mip chain and let differently shaped images share an array
+	int size = 1;
+	while (size < std::max(image.width(), image.height()) && size < MAX_TEXTURE_SIZE)
+	{
+		size <<= 1;
+	}
+
+	QImage level = image.convertToFormat(QImage::Format_RGBA8888).mirrored();
+	if (level.width() != size || level.height() != size)
+	{
+		level = level.scaled(size, size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+	}
+
+	bool isCompressed = isCompressionEnabled && TextureCompressor::isOpaque(level);
+	int levelCount = getLevelCount(size);
+	for (int i = 0; i < levelCount; ++i)
+	{
+		if (i > 0)
+		{
+			int levelSize = std::max(1, size >> i);
+			level = level.scaled(levelSize, levelSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+		}
+
+		if (isCompressed)
+		{
+			decoded.levels.push_back(TextureCompressor::compressBC1(level));
+		}
+		else
+		{
+			decoded.levels.push_back(QByteArray(reinterpret_cast<const char*>(level.constBits()), level.sizeInBytes()));
+		}
+	}
+
+	if (isCompressed)
+	{
+		TextureCompressor::writeCache(cacheKey, size, decoded.levels);
+	}
+
+	decoded.size = size;
+	decoded.isCompressed = isCompressed;
+	decoded.isValid = true;
+	return decoded;
+}
+
+void TextureManager::upload(const DecodedTexture& decoded)
+{
+	GLenum internalFormat = decoded.isCompressed ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_RGBA8;
+	TextureArray& array = getArray(decoded.size, internalFormat, static_cast<int>(decoded.levels.size()));
+	int layer = array.layerCount++;
+
+	GLStateCache::instance().bindTexture(0, GL_TEXTURE_2D_ARRAY, array.texture);
+	for (int level = 0; level < static_cast<int>(decoded.levels.size()); ++level)
+	{
+		int levelSize = std::max(1, decoded.size >> level);
+		const QByteArray& data = decoded.levels[level];
+		if (decoded.isCompressed)
+		{
+			glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, levelSize, levelSize, 1,
+				internalFormat, static_cast<GLsizei>(data.size()), data.constData());
+		}
+		else
+		{
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, levelSize, levelSize, 1,
+				GL_RGBA, GL_UNSIGNED_BYTE, data.constData());
+		}
+	}
+
+	TextureEntry& entry = mTextures[decoded.id];
+	entry.state = TextureState::Ready;
+	entry.location.array = array.texture;
+	entry.location.layer = layer;
+}
+
+TextureManager::TextureArray& TextureManager::getArray(int size, GLenum internalFormat, int levelCount)
+{
+	for (auto& array : mArrays)
+	{
+		if (array.size == size && array.internalFormat == internalFormat && array.layerCount < array.layerCapacity)
+			return array;
+	}
+
+	// Arrays are immutable storage, so a full one is followed by a new one rather than grown
+	int layerBytes = internalFormat == GL_RGBA8 ? size * size * 4 : TextureCompressor::getBC1LevelSize(size, size);
+	TextureArray array;
+	array.size = size;
+	array.internalFormat = internalFormat;
+	array.levelCount = levelCount;
+	array.layerCapacity = std::max(1, std::min(static_cast<int>(mMaxArrayLayers), ARRAY_BYTE_BUDGET / layerBytes));
+
+	glGenTextures(1, &array.texture);
+	GLStateCache::instance().bindTexture(0, GL_TEXTURE_2D_ARRAY, array.texture);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, levelCount, internalFormat, size, size, array.layerCapacity);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	mArrays.push_back(array);
+	return mArrays.back();
+}
@@ -0,0 +1,277 @@
+#include "Engine/Renders/UploadRingBuffer.h"
+#include "Engine/Renders/GLStateCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <QElapsedTimer>
+
+UploadRingBuffer::UploadRingBuffer(GLsizeiptr frameSize)
+	: mIsStarted(false), mIsPersistent(false), mBuffer(0), mMappedData(nullptr),
+	mFrameSize(frameSize), mStorageAlignment(256), mFrameIndex(FRAME_COUNT - 1), mCursor(0),
+	mFrameUploadBytes(0), mFrameWaitMs(0.0)
+{
+	for (int i = 0; i < FRAME_COUNT; ++i)
+	{
+		mFences[i] = nullptr;
+	}
+}
+
+UploadRingBuffer::~UploadRingBuffer()
+{
+}
+
+void UploadRingBuffer::init()
+{
+	initializeOpenGLFunctions();
+	mExtensions.init();
+}
+
+void UploadRingBuffer::tryStart()
+{
+	if (!mIsStarted)
+	{
+		mIsStarted = true;
+		start();
+	}
+}
+
+void UploadRingBuffer::start()
+{
+	GLint alignment = 0;
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	GLint uniformAlignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+	mStorageAlignment = std::max<GLsizeiptr>({ 16, alignment, uniformAlignment });
+
+	mIsPersistent = mExtensions.hasBufferStorage;
+	createBuffer();
+}
+
+void UploadRingBuffer::createBuffer()
+{
+	glGenBuffers(1, &mBuffer);
+	GLStateCache::instance().bindBuffer(GL_COPY_WRITE_BUFFER, mBuffer);
+
+	GLsizeiptr totalSize = mFrameSize * FRAME_COUNT;
+	if (mIsPersistent)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		mExtensions.glBufferStorage(GL_COPY_WRITE_BUFFER, totalSize, nullptr, flags);
+		mMappedData = static_cast<char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalSize, flags));
+
+		if (!mMappedData)
+		{
+			std::cout << "ERROR::UPLOAD_RING_BUFFER::PERSISTENT_MAP_FAILED" << std::endl;
+			GLStateCache::instance().deleteBuffer(mBuffer);
+
+			// Immutable storage cannot be respecified, fall back to mapping per allocation
+			mIsPersistent = false;
+			createBuffer();
+			return;
+		}
+	}
+	else
+	{
+		glBufferData(GL_COPY_WRITE_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+	}
+}
+
+void UploadRingBuffer::retireBuffer()
+{
+	if (mBuffer == 0)
+		return;
+
+	if (mMappedData)
+	{
+		GLStateCache::instance().bindBuffer(GL_COPY_WRITE_BUFFER, mBuffer);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		mMappedData = nullptr;
+	}
+
+	// Allocations made earlier this frame still name the old buffer, so deletion waits for the next frame
+	mRetiredBuffers.push_back(mBuffer);
+	mBuffer = 0;
+
+	for (int i = 0; i < FRAME_COUNT; ++i)
+	{
+		if (mFences[i])
+		{
+			glDeleteSync(mFences[i]);
+			mFences[i] = nullptr;
+		}
+	}
+}
+
+void UploadRingBuffer::deleteRetiredBuffers()
+{
+	for (GLuint& buffer : mRetiredBuffers)
+	{
+		GLStateCache::instance().deleteBuffer(buffer);
+	}
+	mRetiredBuffers.clear();
+}
+
+void UploadRingBuffer::clear()
+{
+	if (mIsStarted)
+	{
+		retireBuffer();
+		deleteRetiredBuffers();
+	}
+
+	mRetiredBuffers.clear();
+	mBuffer = 0;
+	mMappedData = nullptr;
+	mFrameIndex = FRAME_COUNT - 1;
+	mCursor = 0;
+	mIsStarted = false;
+}
+
+void UploadRingBuffer::waitForFence(GLsync fence)
+{
+	QElapsedTimer waitTimer;
+	waitTimer.start();
+
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	while (true)
+	{
+		GLenum result = glClientWaitSync(fence, flags, 1000000);
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+			break;
+		if (result == GL_WAIT_FAILED)
+		{
+			std::cout << "ERROR::UPLOAD_RING_BUFFER::FENCE_WAIT_FAILED" << std::endl;
+			break;
+		}
+		flags = 0;
+	}
+
+	mFrameWaitMs += waitTimer.nsecsElapsed() / 1000000.0;
+}
+
+void UploadRingBuffer::beginFrame()
+{
+	mFrameUploadBytes = 0;
+	mFrameWaitMs = 0.0;
+
+	if (!mIsStarted)
+		return;
+
+	deleteRetiredBuffers();
+
+	mFrameIndex = (mFrameIndex + 1) % FRAME_COUNT;
+	mCursor = 0;
+
+	// Only blocks when the CPU is FRAME_COUNT frames ahead of the GPU
+	if (mFences[mFrameIndex])
+	{
+		waitForFence(mFences[mFrameIndex]);
+		glDeleteSync(mFences[mFrameIndex]);
+		mFences[mFrameIndex] = nullptr;
+	}
+}
+
+void UploadRingBuffer::endFrame()
+{
+	if (!mIsStarted)
+		return;
+
+	if (mFences[mFrameIndex])
+	{
+		glDeleteSync(mFences[mFrameIndex]);
+	}
+	mFences[mFrameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+UploadAllocation UploadRingBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment)
+{
+	UploadAllocation allocation;
+	if (!mIsStarted || size <= 0)
+		return allocation;
+
+	GLsizeiptr alignedCursor = (mCursor + alignment - 1) / alignment * alignment;
+	if (alignedCursor + size > mFrameSize)
+	{
+		// Regions are fixed slices of the buffer, so growing means a fresh buffer
+		mFrameSize = std::max(mFrameSize * 2, size * 2);
+		retireBuffer();
+		createBuffer();
+		alignedCursor = 0;
+	}
+
+	allocation.buffer = mBuffer;
+	allocation.offset = mFrameIndex * mFrameSize + alignedCursor;
+	allocation.size = size;
+
+	if (mIsPersistent)
+	{
+		allocation.data = mMappedData + allocation.offset;
+	}
+	else
+	{
+		GLStateCache::instance().bindBuffer(GL_COPY_WRITE_BUFFER, mBuffer);
+		allocation.data = glMapBufferRange(GL_COPY_WRITE_BUFFER, allocation.offset, size,
+			GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+
+		if (!allocation.data)
+		{
+			std::cout << "ERROR::UPLOAD_RING_BUFFER::MAP_FAILED" << std::endl;
+			return UploadAllocation();
+		}
+	}
+
+	mCursor = alignedCursor + size;
+	mFrameUploadBytes += size;
+	return allocation;
+}
+
+void UploadRingBuffer::commit(const UploadAllocation& allocation)
+{
+	if (mIsPersistent || !allocation.isValid())
+		return;
+
+	GLStateCache::instance().bindBuffer(GL_COPY_WRITE_BUFFER, allocation.buffer);
+	glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+}
+
+UploadAllocation UploadRingBuffer::upload(const void* data, GLsizeiptr size, GLsizeiptr alignment)
+{
+	UploadAllocation allocation = allocate(size, alignment);
+	if (allocation.isValid())
+	{
+		std::memcpy(allocation.data, data, static_cast<size_t>(size));
+		commit(allocation);
+	}
+	return allocation;
+}
+
+bool UploadRingBuffer::getIsStarted() const
+{
+	return mIsStarted;
+}
+
+bool UploadRingBuffer::getIsPersistent() const
+{
+	return mIsPersistent;
+}
+
+GLsizeiptr UploadRingBuffer::getFrameSize() const
+{
+	return mFrameSize;
+}
+
+GLsizeiptr UploadRingBuffer::getStorageAlignment() const
+{
+	return mStorageAlignment;
+}
+
+long long UploadRingBuffer::getFrameUploadBytes() const
+{
+	return mFrameUploadBytes;
+}
+
+double UploadRingBuffer::getFrameWaitMs() const
+{
+	return mFrameWaitMs;
+}
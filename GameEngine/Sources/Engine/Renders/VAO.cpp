@@ -1,19 +1,20 @@
 #include "Engine/Renders/VAO.h"
+#include "Engine/Renders/GLStateCache.h"
 
 VAO::VAO(const void* data, GLsizeiptr size) {
     initializeOpenGLFunctions();
     glGenVertexArrays(1, &mID);
-    glBindVertexArray(mID);
+    GLStateCache::instance().bindVertexArray(mID);
 }
 
 VAO::~VAO() {
-    glDeleteVertexArrays(1, &mID);
+    GLStateCache::instance().deleteVertexArray(mID);
 }
 
 void VAO::bind() {
-    glBindVertexArray(mID);
+    GLStateCache::instance().bindVertexArray(mID);
 }
 
 void VAO::unbind() {
-    glBindVertexArray(0);
+    GLStateCache::instance().bindVertexArray(0);
 }
\ No newline at end of file
@@ -1,19 +1,20 @@
 #include "Engine/Renders/VBO.h"
+#include "Engine/Renders/GLStateCache.h"
 
 VBO::VBO(const void* data, GLsizeiptr size) {
     glGenBuffers(1, &ID);
-    glBindBuffer(GL_ARRAY_BUFFER, ID);
+    GLStateCache::instance().bindBuffer(GL_ARRAY_BUFFER, ID);
     glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
 }
 
 VBO::~VBO() {
-    glDeleteBuffers(1, &ID);
+    GLStateCache::instance().deleteBuffer(ID);
 }
 
 void VBO::bind() {
-    glBindBuffer(GL_ARRAY_BUFFER, ID);
+    GLStateCache::instance().bindBuffer(GL_ARRAY_BUFFER, ID);
 }
 
 void VBO::unbind() {
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLStateCache::instance().bindBuffer(GL_ARRAY_BUFFER, 0);
 }
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "Engine/Scenes/EngineLoop.h"
+#include "Engine/Profiling/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+EngineLoop::EngineLoop(float fixedDeltaTime, int maxStepsPerFrame)
+	: mScene(nullptr), mInputPublisher(nullptr),
+	mFixedDeltaTime(fixedDeltaTime), mMaxStepsPerFrame(maxStepsPerFrame),
+	mLastTickNs(0), mAccumulator(0.0), mSimulationTime(0.0), mStepCount(0)
+{
+}
+
+void EngineLoop::setScene(IScene* scene)
+{
+	mScene = scene;
+}
+
+void EngineLoop::setInputPublisher(InputPublisher* inputPublisher)
+{
+	mInputPublisher = inputPublisher;
+}
+
+void EngineLoop::setFixedDeltaTime(float fixedDeltaTime)
+{
+	mFixedDeltaTime = std::max(fixedDeltaTime, 0.0001f);
+}
+
+float EngineLoop::getFixedDeltaTime() const
+{
+	return mFixedDeltaTime;
+}
+
+void EngineLoop::setMaxStepsPerFrame(int maxStepsPerFrame)
+{
+	mMaxStepsPerFrame = std::max(maxStepsPerFrame, 1);
+}
+
+int EngineLoop::getMaxStepsPerFrame() const
+{
+	return mMaxStepsPerFrame;
+}
+
+void EngineLoop::reset()
+{
+	mClock.restart();
+	mLastTickNs = 0;
+	mAccumulator = 0.0;
+}
+
+void EngineLoop::tick()
+{
+	if (!mClock.isValid())
+	{
+		reset();
+	}
+
+	qint64 nowNs = mClock.nsecsElapsed();
+	double frameDeltaTime = (nowNs - mLastTickNs) / 1000000000.0;
+	mLastTickNs = nowNs;
+
+	tick(frameDeltaTime);
+}
+
+void EngineLoop::step()
+{
+	// Interpolation blends from the state before this step to the state after it
+	mScene->storePreviousState();
+
+	QElapsedTimer phaseTimer;
+	phaseTimer.start();
+	if (mInputPublisher)
+	{
+		PROFILE_SCOPE("Input");
+		mInputPublisher->update(mFixedDeltaTime);
+	}
+	mLastTimings.inputMs += phaseTimer.nsecsElapsed() / 1000000.0;
+
+	phaseTimer.restart();
+	mScene->update(mFixedDeltaTime);
+	mLastTimings.updateMs += phaseTimer.nsecsElapsed() / 1000000.0;
+
+	mSimulationTime += mFixedDeltaTime;
+	mStepCount++;
+}
+
+void EngineLoop::tick(double frameDeltaTime)
+{
+	if (!mScene)
+		return;
+
+	QElapsedTimer frameTimer;
+	frameTimer.start();
+
+	mScene->start();
+	simulate(frameDeltaTime);
+	mScene->setInterpolationAlpha(mLastTimings.alpha);
+
+	QElapsedTimer renderTimer;
+	renderTimer.start();
+	mScene->render();
+	mLastTimings.renderMs = renderTimer.nsecsElapsed() / 1000000.0;
+	mLastTimings.frameMs = frameTimer.nsecsElapsed() / 1000000.0;
+
+	const double smoothing = 0.05;
+	mAverageTimings.renderMs += (mLastTimings.renderMs - mAverageTimings.renderMs) * smoothing;
+	mAverageTimings.frameMs += (mLastTimings.frameMs - mAverageTimings.frameMs) * smoothing;
+}
+
+int EngineLoop::simulate(double frameDeltaTime)
+{
+	mLastTimings = FrameTimings();
+	if (!mScene)
+		return 0;
+
+	mAccumulator += std::max(frameDeltaTime, 0.0);
+	while (mAccumulator >= mFixedDeltaTime && mLastTimings.steps < mMaxStepsPerFrame)
+	{
+		PROFILE_SCOPE("Simulation Step");
+		step();
+		mAccumulator -= mFixedDeltaTime;
+		mLastTimings.steps++;
+	}
+
+	// Past the cap the simulation runs slower than real time instead of falling further behind
+	if (mAccumulator >= mFixedDeltaTime)
+	{
+		mAccumulator = std::fmod(mAccumulator, static_cast<double>(mFixedDeltaTime));
+		mLastTimings.isCatchUpCapped = true;
+	}
+
+	mLastTimings.alpha = static_cast<float>(mAccumulator / mFixedDeltaTime);
+
+	const double smoothing = 0.05;
+	mAverageTimings.inputMs += (mLastTimings.inputMs - mAverageTimings.inputMs) * smoothing;
+	mAverageTimings.updateMs += (mLastTimings.updateMs - mAverageTimings.updateMs) * smoothing;
+	mAverageTimings.steps = mLastTimings.steps;
+	mAverageTimings.alpha = mLastTimings.alpha;
+	mAverageTimings.isCatchUpCapped = mLastTimings.isCatchUpCapped;
+	return mLastTimings.steps;
+}
+
+const FrameTimings& EngineLoop::getLastTimings() const
+{
+	return mLastTimings;
+}
+
+const FrameTimings& EngineLoop::getAverageTimings() const
+{
+	return mAverageTimings;
+}
+
+double EngineLoop::getSimulationTime() const
+{
+	return mSimulationTime;
+}
+
+long long EngineLoop::getStepCount() const
+{
+	return mStepCount;
+}
+
+double EngineLoop::getTimeUntilNextStep() const
+{
+	return std::max(mFixedDeltaTime - mAccumulator, 0.0);
+}
\ No newline at end of file
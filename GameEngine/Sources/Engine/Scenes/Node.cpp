@@ -1,6 +1,10 @@
 #include "Engine/Scenes/Node.h"
+#include "Engine/Interfaces/IScene.h"
 
-Node::Node()
+#include <algorithm>
+#include <iostream>
+
+Node::Node() : mIsStarted(false), mScenePtr(nullptr), mParent(nullptr)
 {
 	mIsAlive = true;
 }
@@ -55,6 +59,29 @@ void Node::tryRender(ShaderProgram& shaderProgram)
 	}
 }
 
+void Node::tryStorePreviousState()
+{
+	storePreviousState();
+
+	for (auto& child : mChildren)
+	{
+		child->tryStorePreviousState();
+	}
+}
+
+void Node::trySnapshot(RenderSnapshot& snapshot)
+{
+	if (mIsAlive)
+	{
+		this->snapshot(snapshot);
+	}
+
+	for (auto& child : mChildren)
+	{
+		child->trySnapshot(snapshot);
+	}
+}
+
 void Node::clear()
 {
 	for (auto& child : mChildren)
@@ -100,14 +127,25 @@ IScene* Node::getScene() const {
 }
 
 void Node::setParent(Node* parent) {
-    if (mParent) {
-        mParent->removeChild(this);
+    if (parent == mParent || parent == this) {
+        return;
+    }
+    if (!parent && !mScenePtr) {
+        std::cout << "ERROR::NODE::SET_PARENT::NO_OWNER: " << mName.toStdString() << " has no scene to hold it once detached" << std::endl;
+        return;
     }
 
-    mParent = parent;
+    std::unique_ptr<Node> self = mParent ? mParent->takeChild(this) : mScenePtr ? mScenePtr->takeNode(this) : nullptr;
+    if (!self) {
+        std::cout << "ERROR::NODE::SET_PARENT::NO_OWNER: " << mName.toStdString() << " is not owned yet; use addChild" << std::endl;
+        return;
+    }
 
-    if (mParent) {
-        mParent->addChild(std::unique_ptr<Node>(this));
+    if (parent) {
+        parent->addChild(std::move(self));
+    }
+    else {
+        mScenePtr->addNode(self.release());
     }
 }
 
@@ -183,16 +221,40 @@ void Node::render(ShaderProgram& shaderProgram)
 
 }
 
+void Node::storePreviousState()
+{
+}
+
+void Node::snapshot(RenderSnapshot& snapshot)
+{
+}
+
+void Node::onParentChanged()
+{
+}
+
+void Node::addChild(Node* child) {
+    addChild(std::unique_ptr<Node>(child));
+}
+
 void Node::addChild(std::unique_ptr<Node> child) {
+    child->mParent = this;
+    child->onParentChanged();
     mChildren.push_back(std::move(child));
 }
 
-void Node::removeChild(Node* child) {
-    auto it = std::remove_if(mChildren.begin(), mChildren.end(),
+std::unique_ptr<Node> Node::takeChild(Node* child) {
+    auto it = std::find_if(mChildren.begin(), mChildren.end(),
         [child](const std::unique_ptr<Node>& ptr) {
             return ptr.get() == child;
         });
-    if (it != mChildren.end()) {
-        mChildren.erase(it, mChildren.end());
+    if (it == mChildren.end()) {
+        return nullptr;
     }
+
+    std::unique_ptr<Node> taken = std::move(*it);
+    mChildren.erase(it);
+    taken->mParent = nullptr;
+    taken->onParentChanged();
+    return taken;
 }
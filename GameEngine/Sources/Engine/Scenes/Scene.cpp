@@ -1,10 +1,30 @@
 #include "Engine/Scenes/Scene.h"
 #include "Engine/Constants/SerializePath.h"
+#include "Engine/Enums/ShaderKeyword.h"
+#include "Engine/Profiling/Profiler.h"
+#include "Engine/Renders/GLStateCache.h"
+#include "Engine/Renders/RenderSnapshot.h"
 
-Scene::Scene()
+Scene::Scene() : mDefaultShader(nullptr), mIsDepthPrePass(false), mInterpolationAlpha(1.0f)
 {
 	mMeshes = std::vector<std::shared_ptr<Mesh>>();
 	mChildrenNodes = std::vector<std::unique_ptr<Node>>();
+	mGeometryBuffer = std::make_shared<GeometryBuffer>();
+	mIndirectRenderer = std::make_shared<IndirectRenderer>();
+	mMaterialLibrary = std::make_shared<MaterialLibrary>();
+	mRenderQueue = std::make_shared<RenderQueue>();
+	mUploadBuffer = std::make_shared<UploadRingBuffer>();
+	mTextureManager = std::make_shared<TextureManager>();
+	mOverdrawCounter = std::make_shared<OverdrawCounter>();
+	mLighting = std::make_shared<ClusteredLighting>();
+	mShadows = std::make_shared<CascadedShadowMaps>();
+	mSpatialIndex = std::make_shared<SpatialIndex>();
+	mIdPicker = std::make_shared<IdBufferPicker>();
+	mCollisionWorld = std::make_shared<CollisionWorld>();
+	mPhysicsWorld = std::make_shared<PhysicsWorld>();
+	mLighting->setShadows(mShadows.get());
+	mRenderQueue->setLighting(mLighting.get());
+	mIndirectRenderer->setLighting(mLighting.get());
 
 	camera = new Camera();
 }
@@ -15,14 +35,29 @@ Scene::~Scene()
 
 void Scene::load()
 {
-	ShaderProgram* defaultShader = new ShaderProgram(":/Resources/Shaders/default.vert", ":/Resources/Shaders/default.frag");
-	mDefaultShader = std::shared_ptr<ShaderProgram>(defaultShader);
+	mDefaultShaders = std::make_shared<ShaderVariants>(":/Resources/Shaders/default.vert", ":/Resources/Shaders/default.frag", getDefaultShaderKeywords());
+	mFallbackShader = std::make_shared<ShaderProgram>(":/Resources/Shaders/fallback.vert", ":/Resources/Shaders/fallback.frag");
+	mDepthShader = std::make_shared<ShaderProgram>(":/Resources/Shaders/depth.vert", ":/Resources/Shaders/depth.frag");
+
+	// Variants are drawn with the fallback until the driver finishes linking them
+	mDefaultShaders->setIsAsync(true);
+	mDefaultShaders->setFallback(mFallbackShader.get());
 
 }
 
 void Scene::init()
 {
-	mDefaultShader->init();
+	GLStateCache::instance().init();
+	mFallbackShader->init();
+	mDepthShader->init();
+	mGeometryBuffer->init();
+	mIndirectRenderer->init();
+	mOverdrawCounter->init();
+	mLighting->init();
+	mShadows->init();
+	mIdPicker->init();
+	mUploadBuffer->init();
+	mTextureManager->init();
 
 	for (auto& mesh : mMeshes)
 	{
@@ -41,24 +76,33 @@ void Scene::init()
 void Scene::create()
 {
 	// Bind attribute locations before linking
-	mDefaultShader->bindAttributeLocation("position", 0);
-	mDefaultShader->bindAttributeLocation("normal", 1);
-	mDefaultShader->bindAttributeLocation("texCoord", 2);
-	mDefaultShader->bindAttributeLocation("color", 3);
-
-	mDefaultShader->start();
-	mDefaultShader->bind();
-	mDefaultShader->setUniformValue("mUseTexture", false);
-	mDefaultShader->setUniformValue("mUseColor", true);
-	mDefaultShader->release();
+	mDefaultShaders->bindAttributeLocation("position", 0);
+	mDefaultShaders->bindAttributeLocation("normal", 1);
+	mDefaultShaders->bindAttributeLocation("texCoord", 2);
+	mDefaultShaders->bindAttributeLocation("color", 3);
+
+	mFallbackShader->start();
+	mDepthShader->start();
+	// Untextured vertex colours; texturing is a separate variant rather than a per-fragment branch
+	mDefaultShader = mDefaultShaders->getVariant(SHADER_KEYWORD_USE_COLOR);
+	mMaterialLibrary->setDefaultShaders(mDefaultShaders.get(), SHADER_KEYWORD_USE_COLOR);
 }
 
 void Scene::start()
 {
+	PROFILE_SCOPE("Scene::start");
+
+	mGeometryBuffer->tryStart();
+	mIndirectRenderer->tryStart();
+	mLighting->tryStart();
+	mShadows->tryStart();
+	mIdPicker->tryStart();
+	mUploadBuffer->tryStart();
+	mTextureManager->tryStart();
 
 	for (auto& mesh : mMeshes)
 	{
-		mesh->tryStart();
+		mesh->tryStart(mGeometryBuffer.get(), mTextureManager.get());
 	}
 
 	for (auto& node : mChildrenNodes)
@@ -71,23 +115,206 @@ void Scene::start()
 
 void Scene::update(float deltaTime)
 {
+	PROFILE_SCOPE("Scene::update");
+
 	camera->tryUpdate(deltaTime);
 	for (auto& node : mChildrenNodes)
 	{
 		node->tryUpdate(deltaTime);
 	}
+
+	// Contacts of the positions this step ended with, which rigid bodies are then solved against
+	mCollisionWorld->step();
+	mPhysicsWorld->step(deltaTime, *mCollisionWorld);
 }
 
 void Scene::render()
 {
+	PROFILE_GPU_SCOPE("Scene::render");
+
+	QElapsedTimer submitTimer;
+	beginRenderFrame(submitTimer);
+
 	mDefaultShader->bind();
+	mDefaultShader->setUniformValue("mTexScale", QVector2D(1.0f, 1.0f));
 	camera->tryRender(*mDefaultShader);
 
-	for (auto& node : mChildrenNodes)
+	// Every mesh lives in the same vertex/index storage, so the VAO is bound once per pass
+	mGeometryBuffer->bind();
+	mIndirectRenderer->begin();
+	mRenderQueue->begin();
+	mLighting->begin();
+	mShadows->begin();
+	mSpatialIndex->begin();
 	{
-		node->tryRender(*mDefaultShader);
+		PROFILE_GPU_SCOPE("Scene Nodes");
+		for (auto& node : mChildrenNodes)
+		{
+			node->tryRender(*mDefaultShader);
+		}
 	}
 	mDefaultShader->release();
+	drawPasses(camera->getViewMatrix(), camera->getProjectionMatrix(), camera->getNear(), camera->getFar());
+
+	endRenderFrame(camera->getViewMatrix(), camera->getProjectionMatrix(), submitTimer);
+}
+
+void Scene::buildSnapshot(RenderSnapshot& snapshot)
+{
+	PROFILE_SCOPE("Scene::buildSnapshot");
+
+	snapshot.reset();
+	snapshot.previousCameraPosition = camera->transform->getPreviousWorldPosition();
+	snapshot.previousCameraRotation = camera->transform->getPreviousWorldRotation();
+	snapshot.cameraPosition = camera->transform->getWorldPosition();
+	snapshot.cameraRotation = camera->transform->getWorldRotation();
+	snapshot.projection = camera->getProjectionMatrix();
+	snapshot.nearPlane = camera->getNear();
+	snapshot.farPlane = camera->getFar();
+	snapshot.isShadowCasting = mShadows->getIsEnabled();
+	snapshot.frustum = Frustum::fromMatrix(snapshot.projection * Camera::makeViewMatrix(snapshot.cameraPosition, snapshot.cameraRotation));
+
+	for (auto& node : mChildrenNodes)
+	{
+		node->trySnapshot(snapshot);
+	}
+}
+
+void Scene::renderSnapshot(const RenderSnapshot& snapshot, float alpha)
+{
+	PROFILE_GPU_SCOPE("Scene::renderSnapshot");
+
+	QElapsedTimer submitTimer;
+	beginRenderFrame(submitTimer);
+	camera->clearFramebuffer();
+
+	QMatrix4x4 view = snapshot.getViewMatrix(alpha);
+	Material* defaultMaterial = mMaterialLibrary->getDefaultMaterial().get();
+
+	mGeometryBuffer->bind();
+	mIndirectRenderer->begin();
+	mRenderQueue->begin();
+	mLighting->begin();
+	mShadows->begin();
+	mSpatialIndex->begin();
+	{
+		PROFILE_GPU_SCOPE("Scene Nodes");
+		for (const auto& light : snapshot.lights)
+		{
+			mLighting->submit(light.getLightData(alpha));
+		}
+		for (const auto& item : snapshot.items)
+		{
+			Mesh* mesh = item.mesh.get();
+			Material* material = item.material ? item.material.get() : defaultMaterial;
+			QMatrix4x4 world = item.getWorldMatrix(alpha);
+			mShadows->submit(mesh, material, world, item.isStatic);
+			if (!item.isVisible)
+				continue;
+
+			mSpatialIndex->insert(item.node, mesh, world);
+
+			if (item.isStatic && mMaterialLibrary->getIsIndirectCompatible(*material)
+				&& mIndirectRenderer->submit(*mesh, item.world, material->getRasterState().polygonMode))
+				continue;
+
+			mRenderQueue->submit(mesh, material, world);
+		}
+	}
+	drawPasses(view, snapshot.projection, snapshot.nearPlane, snapshot.farPlane);
+
+	endRenderFrame(view, snapshot.projection, submitTimer);
+}
+
+QMutex& Scene::getSimulationMutex()
+{
+	return mSimulationMutex;
+}
+
+void Scene::beginRenderFrame(QElapsedTimer& submitTimer)
+{
+	submitTimer.start();
+	mRenderStats.reset();
+	GLStateCache::instance().beginFrame();
+	mUploadBuffer->beginFrame();
+	mTextureManager->update();
+}
+
+void Scene::drawPasses(const QMatrix4x4& view, const QMatrix4x4& projection, float nearPlane, float farPlane)
+{
+	// Before anything picks its shader variant, since lit frames draw with USE_LIGHTING
+	mLighting->build(view, projection, nearPlane, farPlane, mRenderTarget, mRenderStats);
+	if (const LightData* shadowLight = mLighting->getShadowLight())
+	{
+		mShadows->render(view, projection, nearPlane, farPlane, *shadowLight, mRenderTarget, mRenderStats);
+	}
+
+	// Static meshes queued during the traversal go out in one multi-draw per bucket, and both the
+	// depth and colour pass draw from the same uploaded commands
+	mIndirectRenderer->prepare(view, projection, *mUploadBuffer, mRenderStats);
+
+	bool isDepthPrePass = mIsDepthPrePass && mDepthShader->getIsReady();
+	mRenderQueue->sort(view, isDepthPrePass);
+
+	GLStateCache& state = GLStateCache::instance();
+	if (isDepthPrePass)
+	{
+		PROFILE_GPU_SCOPE("Depth Pre-Pass");
+		state.setColorMask(false);
+		mGeometryBuffer->bindDepth();
+		mIndirectRenderer->drawDepth(view, projection, mRenderStats);
+		mRenderQueue->flushDepth(*mDepthShader, view, projection, mRenderStats);
+		state.setColorMask(true);
+	}
+
+	// Opaque indirect draws first, so blended queue draws land on top of them
+	mOverdrawCounter->begin();
+	mGeometryBuffer->bind();
+	mIndirectRenderer->draw(view, projection, mRenderStats);
+	mRenderQueue->flush(view, projection, mTextureManager.get(), mRenderStats);
+	mOverdrawCounter->end();
+
+	mSpatialIndex->setCamera(view, projection);
+	mIdPicker->render(*mSpatialIndex, view, projection);
+}
+
+void Scene::endRenderFrame(const QMatrix4x4& view, const QMatrix4x4& projection, const QElapsedTimer& submitTimer)
+{
+	mGeometryBuffer->unbind();
+	mUploadBuffer->endFrame();
+
+	// Depth of this frame feeds the occlusion test of the next one
+	mIndirectRenderer->endFrame(view, projection, mRenderTarget);
+
+	// Qt composites the widget after us and expects the first texture unit to be active
+	GLStateCache& state = GLStateCache::instance();
+	state.activeTexture(0);
+
+	mRenderStats.stateCallsIssued = state.getIssuedCount();
+	mRenderStats.stateCallsElided = state.getElidedCount();
+	mRenderStats.uploadBytes = mUploadBuffer->getFrameUploadBytes();
+	mRenderStats.uploadWaitMs = mUploadBuffer->getFrameWaitMs();
+	mOverdrawCounter->resolve(mRenderStats);
+	mRenderStats.cpuSubmitMs = submitTimer.nsecsElapsed() / 1000000.0;
+}
+
+void Scene::storePreviousState()
+{
+	camera->tryStorePreviousState();
+	for (auto& node : mChildrenNodes)
+	{
+		node->tryStorePreviousState();
+	}
+}
+
+void Scene::setInterpolationAlpha(float alpha)
+{
+	mInterpolationAlpha = alpha;
+}
+
+float Scene::getInterpolationAlpha() const
+{
+	return mInterpolationAlpha;
 }
 
 void Scene::clear()
@@ -104,13 +331,38 @@ void Scene::clear()
 
 	camera->clear();
 
-	mDefaultShader->clear();
+	mIndirectRenderer->clear();
+	mMaterialLibrary->clear();
+	mUploadBuffer->clear();
+	mTextureManager->clear();
+	mOverdrawCounter->clear();
+	mLighting->clear();
+	mShadows->clear();
+	mIdPicker->clear();
+	mSpatialIndex->begin();
+	mGeometryBuffer->clear();
+	mDefaultShaders->clear();
+	mDefaultShader = nullptr;
+	mFallbackShader->clear();
+	mDepthShader->clear();
 }
 
 IScene* Scene::clone() const
 {
 	Scene* scene = new Scene();
 	scene->mMeshes = mMeshes;
+	scene->mGeometryBuffer = mGeometryBuffer;
+	scene->mIndirectRenderer = mIndirectRenderer;
+	scene->mMaterialLibrary = mMaterialLibrary;
+	scene->mRenderQueue = mRenderQueue;
+	scene->mUploadBuffer = mUploadBuffer;
+	scene->mTextureManager = mTextureManager;
+	scene->mOverdrawCounter = mOverdrawCounter;
+	scene->mLighting = mLighting;
+	scene->mShadows = mShadows;
+	scene->mSpatialIndex = mSpatialIndex;
+	scene->mIdPicker = mIdPicker;
+	scene->mIsDepthPrePass = mIsDepthPrePass;
 
 	scene->inputPublisher = inputPublisher;
 
@@ -186,6 +438,8 @@ void Scene::removeMesh(std::shared_ptr<Mesh> mesh)
 
 void Scene::addNode(Node* node)
 {
+	// Known before start, so the node can already be reparented within the scene
+	node->setScene(this);
 	mChildrenNodes.push_back(std::unique_ptr<Node>(node));
 }
 
@@ -200,6 +454,20 @@ void Scene::removeNode(Node* node)
 	}
 }
 
+std::unique_ptr<Node> Scene::takeNode(Node* node)
+{
+	auto it = std::find_if(mChildrenNodes.begin(), mChildrenNodes.end(),
+		[node](const std::unique_ptr<Node>& ptr) {
+			return ptr.get() == node;
+		});
+	if (it == mChildrenNodes.end())
+		return nullptr;
+
+	std::unique_ptr<Node> taken = std::move(*it);
+	mChildrenNodes.erase(it);
+	return taken;
+}
+
 std::vector<Node*> Scene::getNodes() const
 {
 	std::vector<Node*> children;
@@ -231,6 +499,97 @@ Camera* Scene::getCamera() const
 	return this->camera;
 }
 
+ShaderVariants* Scene::getDefaultShaders() const
+{
+	return mDefaultShaders.get();
+}
+
+TextureManager* Scene::getTextureManager() const
+{
+	return mTextureManager.get();
+}
+
+IndirectRenderer* Scene::getIndirectRenderer() const
+{
+	return mIndirectRenderer.get();
+}
+
+MaterialLibrary* Scene::getMaterialLibrary() const
+{
+	return mMaterialLibrary.get();
+}
+
+RenderQueue* Scene::getRenderQueue() const
+{
+	return mRenderQueue.get();
+}
+
+UploadRingBuffer* Scene::getUploadBuffer() const
+{
+	return mUploadBuffer.get();
+}
+
+RenderStats& Scene::getRenderStats()
+{
+	return mRenderStats;
+}
+
+void Scene::setRenderTarget(const RenderTarget& target)
+{
+	mRenderTarget = target;
+}
+
+const RenderTarget& Scene::getRenderTarget() const
+{
+	return mRenderTarget;
+}
+
+void Scene::setIsDepthPrePass(bool isDepthPrePass)
+{
+	mIsDepthPrePass = isDepthPrePass;
+	mIndirectRenderer->setIsDepthPrePass(isDepthPrePass);
+}
+
+bool Scene::getIsDepthPrePass() const
+{
+	return mIsDepthPrePass;
+}
+
+OverdrawCounter* Scene::getOverdrawCounter() const
+{
+	return mOverdrawCounter.get();
+}
+
+ClusteredLighting* Scene::getLighting() const
+{
+	return mLighting.get();
+}
+
+CascadedShadowMaps* Scene::getShadows() const
+{
+	return mShadows.get();
+}
+
+SpatialIndex* Scene::getSpatialIndex() const
+{
+	return mSpatialIndex.get();
+}
+
+IdBufferPicker* Scene::getIdPicker() const
+{
+	return mIdPicker.get();
+}
+
+CollisionWorld* Scene::getCollisionWorld() const
+{
+	return mCollisionWorld.get();
+}
+
+PhysicsWorld* Scene::getPhysicsWorld() const
+{
+	return mPhysicsWorld.get();
+}
+
 std::shared_ptr<Mesh> Scene::getMesh(int index) const
 {
 	return mMeshes[index];
@@ -0,0 +1,776 @@
+#include "Engine/Spatial/MeshBVH.h"
+#include "Engine/Profiling/Profiler.h"
+#include "Engine/Threading/ParallelFor.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MESH_BVH_SSE
+#endif
+
+static_assert(sizeof(MeshBVH::Node) == 32, "BVH nodes are meant to pack two to a cache line");
+
+namespace
+{
+	// Nodes this deep are left as leaves however many triangles they hold
+	const int MAX_DEPTH = 63;
+	const int STACK_SIZE = 64;
+	// Stack traversals hold one pending sibling per level above the node they pop, d entries at
+	// depth d, then push its two children. Only interior nodes push, and they are at most
+	// MAX_DEPTH - 1 deep, so the stack peaks at MAX_DEPTH + 1. The raycast defers just the far
+	// child and peaks at MAX_DEPTH.
+	static_assert(MAX_DEPTH + 1 <= STACK_SIZE, "Traversal stacks must hold the pending siblings and children of the deepest interior node");
+	const float TRAVERSAL_COST = 1.0f; // Of visiting a node, relative to testing one triangle
+
+	// Per-triangle inputs of a build; only the order is rearranged while splitting
+	struct BuildData
+	{
+		std::vector<QVector3D> positions; // Three per triangle
+		std::vector<int> ids;
+		std::vector<QVector3D> boundsMin;
+		std::vector<QVector3D> boundsMax;
+		std::vector<QVector3D> centroids;
+		std::vector<int> order;
+	};
+
+	// Range left for a worker, rooted at a node of the top tree
+	struct Subtree
+	{
+		int nodeIndex;
+		int depth;
+		std::vector<MeshBVH::Node> nodes;
+	};
+
+	QVector3D minimum(const QVector3D& a, const QVector3D& b)
+	{
+		return QVector3D(std::min(a.x(), b.x()), std::min(a.y(), b.y()), std::min(a.z(), b.z()));
+	}
+
+	QVector3D maximum(const QVector3D& a, const QVector3D& b)
+	{
+		return QVector3D(std::max(a.x(), b.x()), std::max(a.y(), b.y()), std::max(a.z(), b.z()));
+	}
+
+	float getHalfArea(const QVector3D& boundsMin, const QVector3D& boundsMax)
+	{
+		QVector3D extent = boundsMax - boundsMin;
+		return extent.x() * extent.y() + extent.y() * extent.z() + extent.z() * extent.x();
+	}
+
+	void updateBounds(MeshBVH::Node& node, const BuildData& data)
+	{
+		const float infinity = std::numeric_limits<float>::max();
+		QVector3D boundsMin(infinity, infinity, infinity);
+		QVector3D boundsMax(-infinity, -infinity, -infinity);
+		for (int i = node.first; i < node.first + node.count; ++i)
+		{
+			int triangle = data.order[i];
+			boundsMin = minimum(boundsMin, data.boundsMin[triangle]);
+			boundsMax = maximum(boundsMax, data.boundsMax[triangle]);
+		}
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			node.boundsMin[axis] = boundsMin[axis];
+			node.boundsMax[axis] = boundsMax[axis];
+		}
+	}
+
+	// Partitions the node's range at the cheapest bin boundary; returns the left count, 0 for a leaf
+	int splitNode(const MeshBVH::Node& node, BuildData& data)
+	{
+		const float infinity = std::numeric_limits<float>::max();
+		QVector3D centroidMin(infinity, infinity, infinity);
+		QVector3D centroidMax(-infinity, -infinity, -infinity);
+		for (int i = node.first; i < node.first + node.count; ++i)
+		{
+			centroidMin = minimum(centroidMin, data.centroids[data.order[i]]);
+			centroidMax = maximum(centroidMax, data.centroids[data.order[i]]);
+		}
+
+		float bestCost = infinity;
+		int bestAxis = -1;
+		int bestBin = 0;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			float extent = centroidMax[axis] - centroidMin[axis];
+			if (extent <= 0.0f)
+				continue;
+
+			int counts[MeshBVH::BIN_COUNT] = {};
+			QVector3D binMin[MeshBVH::BIN_COUNT];
+			QVector3D binMax[MeshBVH::BIN_COUNT];
+			std::fill(std::begin(binMin), std::end(binMin), QVector3D(infinity, infinity, infinity));
+			std::fill(std::begin(binMax), std::end(binMax), QVector3D(-infinity, -infinity, -infinity));
+
+			float scale = MeshBVH::BIN_COUNT / extent;
+			for (int i = node.first; i < node.first + node.count; ++i)
+			{
+				int triangle = data.order[i];
+				int bin = std::min(MeshBVH::BIN_COUNT - 1, static_cast<int>((data.centroids[triangle][axis] - centroidMin[axis]) * scale));
+				counts[bin]++;
+				binMin[bin] = minimum(binMin[bin], data.boundsMin[triangle]);
+				binMax[bin] = maximum(binMax[bin], data.boundsMax[triangle]);
+			}
+
+			// Sweep from the right for the area and count past each boundary, then from the left
+			float rightCosts[MeshBVH::BIN_COUNT];
+			int rightCount = 0;
+			QVector3D rightMin(infinity, infinity, infinity);
+			QVector3D rightMax(-infinity, -infinity, -infinity);
+			for (int bin = MeshBVH::BIN_COUNT - 1; bin > 0; --bin)
+			{
+				rightCount += counts[bin];
+				rightMin = minimum(rightMin, binMin[bin]);
+				rightMax = maximum(rightMax, binMax[bin]);
+				rightCosts[bin] = rightCount > 0 ? rightCount * getHalfArea(rightMin, rightMax) : -1.0f;
+			}
+
+			int leftCount = 0;
+			QVector3D leftMin(infinity, infinity, infinity);
+			QVector3D leftMax(-infinity, -infinity, -infinity);
+			for (int bin = 0; bin < MeshBVH::BIN_COUNT - 1; ++bin)
+			{
+				leftCount += counts[bin];
+				leftMin = minimum(leftMin, binMin[bin]);
+				leftMax = maximum(leftMax, binMax[bin]);
+				if (leftCount == 0 || rightCosts[bin + 1] < 0.0f)
+					continue;
+
+				float cost = leftCount * getHalfArea(leftMin, leftMax) + rightCosts[bin + 1];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin = bin;
+				}
+			}
+		}
+
+		QVector3D boundsMin(node.boundsMin[0], node.boundsMin[1], node.boundsMin[2]);
+		QVector3D boundsMax(node.boundsMax[0], node.boundsMax[1], node.boundsMax[2]);
+		float leafCost = node.count * getHalfArea(boundsMin, boundsMax);
+		float splitCost = TRAVERSAL_COST * getHalfArea(boundsMin, boundsMax) + bestCost;
+
+		auto begin = data.order.begin() + node.first;
+		auto end = begin + node.count;
+		if (bestAxis < 0)
+		{
+			// Every centroid coincides, so no plane separates them; halve large ranges anyway
+			return node.count > MeshBVH::MAX_LEAF_TRIANGLES ? node.count / 2 : 0;
+		}
+		if (node.count <= MeshBVH::MAX_LEAF_TRIANGLES && splitCost >= leafCost)
+			return 0;
+
+		float scale = MeshBVH::BIN_COUNT / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+		float origin = centroidMin[bestAxis];
+		auto middle = std::partition(begin, end, [&data, bestAxis, bestBin, scale, origin](int triangle) {
+			int bin = std::min(MeshBVH::BIN_COUNT - 1, static_cast<int>((data.centroids[triangle][bestAxis] - origin) * scale));
+			return bin <= bestBin;
+		});
+		return static_cast<int>(middle - begin);
+	}
+
+	// Splits down from the node; with subtrees set, ranges of at most subtreeSize are left to them
+	void subdivide(std::vector<MeshBVH::Node>& nodes, int nodeIndex, int depth, BuildData& data, std::vector<Subtree>* subtrees, int subtreeSize)
+	{
+		MeshBVH::Node node = nodes[nodeIndex];
+		if (depth >= MAX_DEPTH)
+			return;
+		if (subtrees && node.count <= subtreeSize)
+		{
+			subtrees->push_back({ nodeIndex, depth, {} });
+			return;
+		}
+
+		int leftCount = splitNode(node, data);
+		if (leftCount <= 0 || leftCount >= node.count)
+			return;
+
+		int leftIndex = static_cast<int>(nodes.size());
+		MeshBVH::Node left = {};
+		left.first = node.first;
+		left.count = leftCount;
+		MeshBVH::Node right = {};
+		right.first = node.first + leftCount;
+		right.count = node.count - leftCount;
+		updateBounds(left, data);
+		updateBounds(right, data);
+		nodes.push_back(left);
+		nodes.push_back(right);
+
+		nodes[nodeIndex].first = leftIndex;
+		nodes[nodeIndex].count = 0;
+
+		subdivide(nodes, leftIndex, depth + 1, data, subtrees, subtreeSize);
+		subdivide(nodes, leftIndex + 1, depth + 1, data, subtrees, subtreeSize);
+	}
+
+	// Entry distance of the ray into the node's box, if it gets there before maxDistance
+	bool intersectsNode(const MeshBVH::Node& node, const float origin[3], const float inverseDirection[3], float maxDistance, float& distance)
+	{
+		float tMin = 0.0f;
+		float tMax = maxDistance;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			float t0 = (node.boundsMin[axis] - origin[axis]) * inverseDirection[axis];
+			float t1 = (node.boundsMax[axis] - origin[axis]) * inverseDirection[axis];
+			tMin = std::max(tMin, std::min(t0, t1));
+			tMax = std::min(tMax, std::max(t0, t1));
+		}
+		distance = tMin;
+		return tMin <= tMax;
+	}
+
+	// Möller-Trumbore on the stored vertex and edges, double-sided
+	bool intersectsTriangle(const Ray& ray, const MeshBVH::Triangle& triangle, float& distance, float& u, float& v)
+	{
+		const float epsilon = 1e-8f;
+		QVector3D p = QVector3D::crossProduct(ray.direction, triangle.edge2);
+		float determinant = QVector3D::dotProduct(triangle.edge1, p);
+		if (std::abs(determinant) < epsilon)
+			return false;
+
+		float inverseDeterminant = 1.0f / determinant;
+		QVector3D s = ray.origin - triangle.vertex;
+		u = QVector3D::dotProduct(s, p) * inverseDeterminant;
+		if (u < 0.0f || u > 1.0f)
+			return false;
+
+		QVector3D q = QVector3D::crossProduct(s, triangle.edge1);
+		v = QVector3D::dotProduct(ray.direction, q) * inverseDeterminant;
+		if (v < 0.0f || u + v > 1.0f)
+			return false;
+
+		distance = QVector3D::dotProduct(triangle.edge2, q) * inverseDeterminant;
+		return distance >= 0.0f;
+	}
+}
+
+MeshBVH::MeshBVH() : mIsFromCache(false)
+{
+}
+
+void MeshBVH::getTriangles(const std::vector<unsigned int>& indices, GLenum drawMode, std::vector<unsigned int>& triangles)
+{
+	triangles.clear();
+	size_t count = indices.size();
+	switch (drawMode)
+	{
+	case GL_TRIANGLES:
+		triangles.assign(indices.begin(), indices.begin() + count / 3 * 3);
+		break;
+	case GL_TRIANGLE_STRIP:
+		for (size_t i = 2; i < count; ++i)
+		{
+			// Every other triangle of a strip is wound the other way round
+			bool isOdd = (i & 1) != 0;
+			triangles.push_back(indices[i - 2]);
+			triangles.push_back(isOdd ? indices[i] : indices[i - 1]);
+			triangles.push_back(isOdd ? indices[i - 1] : indices[i]);
+		}
+		break;
+	case GL_TRIANGLE_FAN:
+		for (size_t i = 2; i < count; ++i)
+		{
+			triangles.push_back(indices[0]);
+			triangles.push_back(indices[i - 1]);
+			triangles.push_back(indices[i]);
+		}
+		break;
+	default:
+		// Points and lines have no surface to hit
+		break;
+	}
+}
+
+void MeshBVH::build(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, GLenum drawMode)
+{
+	PROFILE_SCOPE("MeshBVH::build");
+
+	mNodes.clear();
+	mTriangles.clear();
+	mTriangleIds.clear();
+	mIsFromCache = false;
+
+	std::vector<unsigned int> triangles;
+	getTriangles(indices, drawMode, triangles);
+
+	BuildData data;
+	size_t capacity = triangles.size() / 3;
+	data.positions.reserve(capacity * 3);
+	data.ids.reserve(capacity);
+	data.boundsMin.reserve(capacity);
+	data.boundsMax.reserve(capacity);
+	data.centroids.reserve(capacity);
+	for (size_t i = 0; i + 2 < triangles.size(); i += 3)
+	{
+		unsigned int a = triangles[i];
+		unsigned int b = triangles[i + 1];
+		unsigned int c = triangles[i + 2];
+		if (a >= vertices.size() || b >= vertices.size() || c >= vertices.size())
+			continue;
+
+		QVector3D v0 = vertices[a].position;
+		QVector3D v1 = vertices[b].position;
+		QVector3D v2 = vertices[c].position;
+		if (QVector3D::crossProduct(v1 - v0, v2 - v0).lengthSquared() <= 0.0f)
+			continue;
+
+		data.positions.push_back(v0);
+		data.positions.push_back(v1);
+		data.positions.push_back(v2);
+		data.ids.push_back(static_cast<int>(i / 3));
+		data.boundsMin.push_back(minimum(v0, minimum(v1, v2)));
+		data.boundsMax.push_back(maximum(v0, maximum(v1, v2)));
+		data.centroids.push_back((v0 + v1 + v2) / 3.0f);
+	}
+
+	int triangleCount = static_cast<int>(data.ids.size());
+	if (triangleCount == 0)
+		return;
+
+	data.order.resize(triangleCount);
+	for (int i = 0; i < triangleCount; ++i)
+	{
+		data.order[i] = i;
+	}
+
+	mNodes.reserve(static_cast<size_t>(triangleCount) * 2);
+	Node root = {};
+	root.first = 0;
+	root.count = triangleCount;
+	updateBounds(root, data);
+	mNodes.push_back(root);
+
+	if (triangleCount < PARALLEL_TRIANGLES)
+	{
+		subdivide(mNodes, 0, 0, data, nullptr, 0);
+	}
+	else
+	{
+		// The top levels are split here until the ranges are small enough to spread over the
+		// pool; each worker builds its ranges into their own node arrays, which touch disjoint
+		// parts of the order, and those are appended afterwards
+		QThreadPool* pool = QThreadPool::globalInstance();
+		int subtreeSize = std::max(triangleCount / (std::max(pool->maxThreadCount(), 1) * 4), PARALLEL_TRIANGLES / 8);
+		std::vector<Subtree> subtrees;
+		subdivide(mNodes, 0, 0, data, &subtrees, subtreeSize);
+
+		ParallelFor::run(static_cast<int>(subtrees.size()), 1, [this, &data, &subtrees](int, int begin, int end) {
+			for (int i = begin; i < end; ++i)
+			{
+				Subtree& subtree = subtrees[i];
+				subtree.nodes.push_back(mNodes[subtree.nodeIndex]);
+				subdivide(subtree.nodes, 0, subtree.depth, data, nullptr, 0);
+			}
+		});
+
+		for (const Subtree& subtree : subtrees)
+		{
+			// Local indices past the subtree's root move to the end of the shared array
+			int offset = static_cast<int>(mNodes.size()) - 1;
+			Node subtreeRoot = subtree.nodes[0];
+			if (subtreeRoot.count == 0)
+			{
+				subtreeRoot.first += offset;
+			}
+			mNodes[subtree.nodeIndex] = subtreeRoot;
+			for (size_t i = 1; i < subtree.nodes.size(); ++i)
+			{
+				Node node = subtree.nodes[i];
+				if (node.count == 0)
+				{
+					node.first += offset;
+				}
+				mNodes.push_back(node);
+			}
+		}
+	}
+
+	mTriangles.resize(triangleCount);
+	mTriangleIds.resize(triangleCount);
+	for (int i = 0; i < triangleCount; ++i)
+	{
+		int source = data.order[i];
+		const QVector3D* positions = &data.positions[static_cast<size_t>(source) * 3];
+		mTriangles[i] = { positions[0], positions[1] - positions[0], positions[2] - positions[0] };
+		mTriangleIds[i] = data.ids[source];
+	}
+	mNodes.shrink_to_fit();
+}
+
+void MeshBVH::buildCached(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, GLenum drawMode)
+{
+	// Small meshes build faster than their cache file opens
+	size_t triangleEstimate = drawMode == GL_TRIANGLES ? indices.size() / 3 : indices.size();
+	if (triangleEstimate < static_cast<size_t>(CACHE_TRIANGLES))
+	{
+		build(vertices, indices, drawMode);
+		return;
+	}
+
+	QByteArray key = makeCacheKey(vertices, indices, drawMode);
+	if (readCache(key))
+		return;
+
+	build(vertices, indices, drawMode);
+	writeCache(key);
+}
+
+bool MeshBVH::getIsEmpty() const
+{
+	return mNodes.empty();
+}
+
+int MeshBVH::getTriangleCount() const
+{
+	return static_cast<int>(mTriangleIds.size());
+}
+
+int MeshBVH::getNodeCount() const
+{
+	return static_cast<int>(mNodes.size());
+}
+
+bool MeshBVH::getIsFromCache() const
+{
+	return mIsFromCache;
+}
+
+bool MeshBVH::raycast(const Ray& ray, float maxDistance, MeshRayHit& hit) const
+{
+	if (mNodes.empty())
+		return false;
+
+	QVector3D inverse = ray.getInverseDirection();
+	const float origin[3] = { ray.origin.x(), ray.origin.y(), ray.origin.z() };
+	const float inverseDirection[3] = { inverse.x(), inverse.y(), inverse.z() };
+
+	float closest = maxDistance;
+	bool isHit = false;
+	float entry = 0.0f;
+	if (!intersectsNode(mNodes[0], origin, inverseDirection, closest, entry))
+		return false;
+
+	struct Entry
+	{
+		int node;
+		float distance;
+	};
+	Entry stack[STACK_SIZE];
+	int stackSize = 0;
+	int nodeIndex = 0;
+	while (true)
+	{
+		const Node& node = mNodes[nodeIndex];
+		if (node.count > 0)
+		{
+			for (int i = node.first; i < node.first + node.count; ++i)
+			{
+				float distance, u, v;
+				if (intersectsTriangle(ray, mTriangles[i], distance, u, v) && distance < closest)
+				{
+					closest = distance;
+					hit.distance = distance;
+					hit.triangle = mTriangleIds[i];
+					hit.u = u;
+					hit.v = v;
+					isHit = true;
+				}
+			}
+		}
+		else
+		{
+			// Nearer child first, so the farther one is often skipped by the time it is popped
+			float leftDistance, rightDistance;
+			bool isLeftHit = intersectsNode(mNodes[node.first], origin, inverseDirection, closest, leftDistance);
+			bool isRightHit = intersectsNode(mNodes[node.first + 1], origin, inverseDirection, closest, rightDistance);
+			if (isLeftHit && isRightHit)
+			{
+				bool isLeftNear = leftDistance <= rightDistance;
+				// Always true for trees capped at MAX_DEPTH; only a damaged cache file could fill it
+				if (stackSize < STACK_SIZE)
+				{
+					stack[stackSize++] = isLeftNear ? Entry{ node.first + 1, rightDistance } : Entry{ node.first, leftDistance };
+				}
+				nodeIndex = isLeftNear ? node.first : node.first + 1;
+				continue;
+			}
+			if (isLeftHit || isRightHit)
+			{
+				nodeIndex = isLeftHit ? node.first : node.first + 1;
+				continue;
+			}
+		}
+
+		// Pop the next subtree the ray still reaches before the closest hit
+		bool hasNext = false;
+		while (stackSize > 0)
+		{
+			Entry next = stack[--stackSize];
+			if (next.distance <= closest)
+			{
+				nodeIndex = next.node;
+				hasNext = true;
+				break;
+			}
+		}
+		if (!hasNext)
+			break;
+	}
+	return isHit;
+}
+
+int MeshBVH::raycastPacket(const Ray* rays, int count, float maxDistance, MeshRayHit* hits) const
+{
+	count = std::clamp(count, 0, static_cast<int>(PACKET_SIZE));
+	if (mNodes.empty() || count == 0)
+		return 0;
+
+	// Rays are laid out by component, one lane per ray; unused lanes get a negative range that
+	// no box test passes
+	alignas(16) float originX[PACKET_SIZE], originY[PACKET_SIZE], originZ[PACKET_SIZE];
+	alignas(16) float inverseX[PACKET_SIZE], inverseY[PACKET_SIZE], inverseZ[PACKET_SIZE];
+	alignas(16) float closest[PACKET_SIZE];
+	for (int lane = 0; lane < PACKET_SIZE; ++lane)
+	{
+		const Ray& ray = rays[std::min(lane, count - 1)];
+		QVector3D inverse = ray.getInverseDirection();
+		originX[lane] = ray.origin.x();
+		originY[lane] = ray.origin.y();
+		originZ[lane] = ray.origin.z();
+		inverseX[lane] = inverse.x();
+		inverseY[lane] = inverse.y();
+		inverseZ[lane] = inverse.z();
+		closest[lane] = lane < count ? maxDistance : -1.0f;
+	}
+
+#ifdef MESH_BVH_SSE
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 rayOriginX = _mm_load_ps(originX);
+	const __m128 rayOriginY = _mm_load_ps(originY);
+	const __m128 rayOriginZ = _mm_load_ps(originZ);
+	const __m128 rayInverseX = _mm_load_ps(inverseX);
+	const __m128 rayInverseY = _mm_load_ps(inverseY);
+	const __m128 rayInverseZ = _mm_load_ps(inverseZ);
+#endif
+
+	// Lanes whose ray reaches the node's box before its closest hit
+	auto testNode = [&](const Node& node) {
+#ifdef MESH_BVH_SSE
+		__m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin[0]), rayOriginX), rayInverseX);
+		__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax[0]), rayOriginX), rayInverseX);
+		__m128 tMin = _mm_max_ps(zero, _mm_min_ps(t0, t1));
+		__m128 tMax = _mm_min_ps(_mm_load_ps(closest), _mm_max_ps(t0, t1));
+		t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin[1]), rayOriginY), rayInverseY);
+		t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax[1]), rayOriginY), rayInverseY);
+		tMin = _mm_max_ps(tMin, _mm_min_ps(t0, t1));
+		tMax = _mm_min_ps(tMax, _mm_max_ps(t0, t1));
+		t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMin[2]), rayOriginZ), rayInverseZ);
+		t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.boundsMax[2]), rayOriginZ), rayInverseZ);
+		tMin = _mm_max_ps(tMin, _mm_min_ps(t0, t1));
+		tMax = _mm_min_ps(tMax, _mm_max_ps(t0, t1));
+		return _mm_movemask_ps(_mm_cmple_ps(tMin, tMax));
+#else
+		int mask = 0;
+		for (int lane = 0; lane < PACKET_SIZE; ++lane)
+		{
+			const float origin[3] = { originX[lane], originY[lane], originZ[lane] };
+			const float inverseDirection[3] = { inverseX[lane], inverseY[lane], inverseZ[lane] };
+			float distance;
+			if (intersectsNode(node, origin, inverseDirection, closest[lane], distance))
+			{
+				mask |= 1 << lane;
+			}
+		}
+		return mask;
+#endif
+	};
+
+	int hitMask = 0;
+	int stack[STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const Node& node = mNodes[stack[--stackSize]];
+		int mask = testNode(node);
+		if (mask == 0)
+			continue;
+
+		if (node.count == 0)
+		{
+			if (stackSize + 2 <= STACK_SIZE)
+			{
+				stack[stackSize++] = node.first + 1;
+				stack[stackSize++] = node.first;
+			}
+			continue;
+		}
+
+		for (int lane = 0; lane < count; ++lane)
+		{
+			if ((mask & (1 << lane)) == 0)
+				continue;
+
+			for (int i = node.first; i < node.first + node.count; ++i)
+			{
+				float distance, u, v;
+				if (intersectsTriangle(rays[lane], mTriangles[i], distance, u, v) && distance < closest[lane])
+				{
+					closest[lane] = distance;
+					hits[lane].distance = distance;
+					hits[lane].triangle = mTriangleIds[i];
+					hits[lane].u = u;
+					hits[lane].v = v;
+					hitMask |= 1 << lane;
+				}
+			}
+		}
+	}
+	return hitMask;
+}
+
+void MeshBVH::queryBox(const QVector3D& boxMin, const QVector3D& boxMax, std::vector<int>& triangles) const
+{
+	if (mNodes.empty())
+		return;
+
+	auto overlaps = [&boxMin, &boxMax](const float nodeMin[3], const float nodeMax[3]) {
+		return nodeMin[0] <= boxMax.x() && nodeMax[0] >= boxMin.x()
+			&& nodeMin[1] <= boxMax.y() && nodeMax[1] >= boxMin.y()
+			&& nodeMin[2] <= boxMax.z() && nodeMax[2] >= boxMin.z();
+	};
+
+	int stack[STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const Node& node = mNodes[stack[--stackSize]];
+		if (!overlaps(node.boundsMin, node.boundsMax))
+			continue;
+
+		if (node.count == 0)
+		{
+			if (stackSize + 2 <= STACK_SIZE)
+			{
+				stack[stackSize++] = node.first + 1;
+				stack[stackSize++] = node.first;
+			}
+			continue;
+		}
+
+		for (int i = node.first; i < node.first + node.count; ++i)
+		{
+			const Triangle& triangle = mTriangles[i];
+			QVector3D v1 = triangle.vertex + triangle.edge1;
+			QVector3D v2 = triangle.vertex + triangle.edge2;
+			QVector3D triangleMin = minimum(triangle.vertex, minimum(v1, v2));
+			QVector3D triangleMax = maximum(triangle.vertex, maximum(v1, v2));
+			const float bounds[2][3] = {
+				{ triangleMin.x(), triangleMin.y(), triangleMin.z() },
+				{ triangleMax.x(), triangleMax.y(), triangleMax.z() }
+			};
+			if (overlaps(bounds[0], bounds[1]))
+			{
+				triangles.push_back(mTriangleIds[i]);
+			}
+		}
+	}
+}
+
+QByteArray MeshBVH::makeCacheKey(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, GLenum drawMode)
+{
+	std::vector<QVector3D> positions;
+	positions.reserve(vertices.size());
+	for (const auto& vertex : vertices)
+	{
+		positions.push_back(vertex.position);
+	}
+
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(QByteArrayView("MeshBVH/SAH/2"));
+	hash.addData(QByteArrayView(reinterpret_cast<const char*>(&drawMode), sizeof(drawMode)));
+	hash.addData(QByteArrayView(reinterpret_cast<const char*>(positions.data()), static_cast<qsizetype>(positions.size() * sizeof(QVector3D))));
+	hash.addData(QByteArrayView(reinterpret_cast<const char*>(indices.data()), static_cast<qsizetype>(indices.size() * sizeof(unsigned int))));
+	return hash.result().toHex();
+}
+
+bool MeshBVH::readCache(const QByteArray& key)
+{
+	QFile file(getCachePath(key));
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream stream(&file);
+	quint32 magic = 0;
+	quint32 version = 0;
+	qint32 nodeCount = 0;
+	qint32 triangleCount = 0;
+	stream >> magic >> version >> nodeCount >> triangleCount;
+	if (stream.status() != QDataStream::Ok || magic != FILE_MAGIC || version != FILE_VERSION || nodeCount <= 0 || triangleCount <= 0)
+		return false;
+
+	// Raw arrays in this machine's layout, the cache never leaves it
+	std::vector<Node> nodes(nodeCount);
+	std::vector<Triangle> triangles(triangleCount);
+	std::vector<int> ids(triangleCount);
+	int nodeBytes = static_cast<int>(nodes.size() * sizeof(Node));
+	int triangleBytes = static_cast<int>(triangles.size() * sizeof(Triangle));
+	int idBytes = static_cast<int>(ids.size() * sizeof(int));
+	if (stream.readRawData(reinterpret_cast<char*>(nodes.data()), nodeBytes) != nodeBytes
+		|| stream.readRawData(reinterpret_cast<char*>(triangles.data()), triangleBytes) != triangleBytes
+		|| stream.readRawData(reinterpret_cast<char*>(ids.data()), idBytes) != idBytes)
+		return false;
+
+	mNodes = std::move(nodes);
+	mTriangles = std::move(triangles);
+	mTriangleIds = std::move(ids);
+	mIsFromCache = true;
+	return true;
+}
+
+void MeshBVH::writeCache(const QByteArray& key) const
+{
+	if (mNodes.empty())
+		return;
+
+	QString path = getCachePath(key);
+	if (!QDir().mkpath(QFileInfo(path).path()))
+		return;
+
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		std::cout << "ERROR::MESH_BVH::WRITE_FAILED " << path.toStdString() << std::endl;
+		return;
+	}
+
+	QDataStream stream(&file);
+	stream << FILE_MAGIC << FILE_VERSION << static_cast<qint32>(mNodes.size()) << static_cast<qint32>(mTriangles.size());
+	stream.writeRawData(reinterpret_cast<const char*>(mNodes.data()), static_cast<int>(mNodes.size() * sizeof(Node)));
+	stream.writeRawData(reinterpret_cast<const char*>(mTriangles.data()), static_cast<int>(mTriangles.size() * sizeof(Triangle)));
+	stream.writeRawData(reinterpret_cast<const char*>(mTriangleIds.data()), static_cast<int>(mTriangleIds.size() * sizeof(int)));
+	if (!file.commit())
+	{
+		std::cout << "ERROR::MESH_BVH::WRITE_FAILED " << path.toStdString() << std::endl;
+	}
+}
+
+QString MeshBVH::getCachePath(const QByteArray& key)
+{
+	QDir directory(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("bvh"));
+	return directory.filePath(QString::fromLatin1(key) + ".bvh");
+}
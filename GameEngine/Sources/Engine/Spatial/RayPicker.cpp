@@ -0,0 +1,58 @@
+#include "Engine/Spatial/RayPicker.h"
+#include "Engine/Profiling/Profiler.h"
+#include "Engine/Renders/Mesh.h"
+
+#include <limits>
+
+RayPicker::RayPicker()
+{
+}
+
+bool RayPicker::pick(const SpatialIndex& index, const QPointF& pixel, const QSizeF& viewportSize, PickResult& result)
+{
+	if (viewportSize.isEmpty())
+		return false;
+
+	Ray ray = Ray::fromViewport(index.getViewMatrix(), index.getProjectionMatrix(), pixel, viewportSize);
+	return pick(index, ray, result);
+}
+
+bool RayPicker::pick(const SpatialIndex& index, const Ray& ray, PickResult& result)
+{
+	PROFILE_SCOPE("RayPicker::pick");
+
+	index.raycast(ray, std::numeric_limits<float>::max(), mCandidates);
+
+	float closest = std::numeric_limits<float>::max();
+	bool isHit = false;
+	for (const auto& candidate : mCandidates)
+	{
+		if (candidate.distance > closest)
+			break;
+
+		const QMatrix4x4& world = index.getWorldMatrix(candidate.index);
+		bool isInvertible = false;
+		QMatrix4x4 inverseWorld = world.inverted(&isInvertible);
+		if (!isInvertible)
+			continue;
+
+		// The BVH lives in mesh space; its hit distance is converted back through the world point
+		Ray localRay = ray.transformed(inverseWorld);
+		MeshRayHit hit;
+		if (!index.getMesh(candidate.index)->getBVH().raycast(localRay, std::numeric_limits<float>::max(), hit))
+			continue;
+
+		QVector3D position = world.map(localRay.at(hit.distance));
+		float distance = QVector3D::dotProduct(position - ray.origin, ray.direction);
+		if (distance >= closest)
+			continue;
+
+		closest = distance;
+		result.node = index.getNode(candidate.index);
+		result.distance = distance;
+		result.position = position;
+		result.triangle = hit.triangle;
+		isHit = true;
+	}
+	return isHit;
+}
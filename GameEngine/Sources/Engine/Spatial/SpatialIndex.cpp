@@ -0,0 +1,111 @@
+#include "Engine/Spatial/SpatialIndex.h"
+#include "Engine/Renders/Mesh.h"
+
+#include <algorithm>
+#include <cmath>
+
+SpatialIndex::SpatialIndex()
+{
+}
+
+void SpatialIndex::begin()
+{
+	// Keeps the storage, so steady-state frames do not allocate
+	mCentersX.clear();
+	mCentersY.clear();
+	mCentersZ.clear();
+	mRadii.clear();
+	mNodes.clear();
+	mMeshes.clear();
+	mWorlds.clear();
+}
+
+void SpatialIndex::insert(Node* node, Mesh* mesh, const QMatrix4x4& world)
+{
+	if (!mesh)
+		return;
+
+	QVector4D sphere = mesh->getBoundingSphere();
+	float scale = std::max({ world.column(0).toVector3D().length(), world.column(1).toVector3D().length(), world.column(2).toVector3D().length() });
+	QVector3D center = world.map(sphere.toVector3D());
+
+	mCentersX.push_back(center.x());
+	mCentersY.push_back(center.y());
+	mCentersZ.push_back(center.z());
+	mRadii.push_back(sphere.w() * scale);
+	mNodes.push_back(node);
+	mMeshes.push_back(mesh);
+	mWorlds.push_back(world);
+}
+
+void SpatialIndex::setCamera(const QMatrix4x4& view, const QMatrix4x4& projection)
+{
+	mView = view;
+	mProjection = projection;
+}
+
+const QMatrix4x4& SpatialIndex::getViewMatrix() const
+{
+	return mView;
+}
+
+const QMatrix4x4& SpatialIndex::getProjectionMatrix() const
+{
+	return mProjection;
+}
+
+int SpatialIndex::getCount() const
+{
+	return static_cast<int>(mNodes.size());
+}
+
+Node* SpatialIndex::getNode(int index) const
+{
+	return mNodes[index];
+}
+
+Mesh* SpatialIndex::getMesh(int index) const
+{
+	return mMeshes[index];
+}
+
+const QMatrix4x4& SpatialIndex::getWorldMatrix(int index) const
+{
+	return mWorlds[index];
+}
+
+void SpatialIndex::raycast(const Ray& ray, float maxDistance, std::vector<Candidate>& candidates) const
+{
+	candidates.clear();
+
+	const float originX = ray.origin.x();
+	const float originY = ray.origin.y();
+	const float originZ = ray.origin.z();
+	const float directionX = ray.direction.x();
+	const float directionY = ray.direction.y();
+	const float directionZ = ray.direction.z();
+
+	// Same test as Ray::intersectsSphere, written out over the arrays so it vectorizes
+	const int count = getCount();
+	for (int i = 0; i < count; ++i)
+	{
+		float offsetX = originX - mCentersX[i];
+		float offsetY = originY - mCentersY[i];
+		float offsetZ = originZ - mCentersZ[i];
+		float b = offsetX * directionX + offsetY * directionY + offsetZ * directionZ;
+		float c = offsetX * offsetX + offsetY * offsetY + offsetZ * offsetZ - mRadii[i] * mRadii[i];
+		float discriminant = b * b - c;
+		if (discriminant < 0.0f || (c > 0.0f && b > 0.0f))
+			continue;
+
+		float distance = std::max(-b - std::sqrt(discriminant), 0.0f);
+		if (distance <= maxDistance)
+		{
+			candidates.push_back({ i, distance });
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+		return a.distance < b.distance;
+	});
+}
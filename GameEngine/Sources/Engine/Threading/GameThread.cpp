@@ -0,0 +1,103 @@
+#include "Engine/Threading/GameThread.h"
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+GameThread::GameThread(IScene* scene, InputPublisher* inputPublisher, float fixedDeltaTime)
+	: mScene(scene), mLoop(fixedDeltaTime)
+{
+	mLoop.setScene(scene);
+	mLoop.setInputPublisher(inputPublisher);
+	setObjectName("Game Thread"); // Names its row in profiler traces
+}
+
+GameThread::~GameThread()
+{
+	stop();
+}
+
+void GameThread::stop()
+{
+	requestInterruption();
+	wait();
+}
+
+bool GameThread::acquireSnapshot()
+{
+	return mSnapshots.acquire();
+}
+
+const RenderSnapshot& GameThread::getSnapshot() const
+{
+	return mSnapshots.getReadBuffer();
+}
+
+FrameTimings GameThread::getAverageTimings() const
+{
+	QMutexLocker locker(&mTimingsMutex);
+	return mAverageTimings;
+}
+
+float GameThread::getFixedDeltaTime() const
+{
+	return mLoop.getFixedDeltaTime();
+}
+
+void GameThread::run()
+{
+	QElapsedTimer clock;
+	clock.start();
+	qint64 lastNs = 0;
+
+	// The renderer has something to draw before the first step completes
+	{
+		QMutexLocker locker(&mScene->getSimulationMutex());
+		publishSnapshot();
+	}
+	mSnapshots.publish();
+
+	while (!isInterruptionRequested())
+	{
+		qint64 nowNs = clock.nsecsElapsed();
+		double frameDeltaTime = (nowNs - lastNs) / 1000000000.0;
+		lastNs = nowNs;
+
+		int steps = 0;
+		{
+			QMutexLocker locker(&mScene->getSimulationMutex());
+			steps = mLoop.simulate(frameDeltaTime);
+			if (steps > 0)
+			{
+				publishSnapshot();
+			}
+		}
+
+		if (steps > 0)
+		{
+			mSnapshots.publish();
+
+			QMutexLocker locker(&mTimingsMutex);
+			mAverageTimings = mLoop.getAverageTimings();
+		}
+
+		// Sleep off the rest of the step; under a millisecond just yield, sleeps are too coarse
+		unsigned long waitUs = static_cast<unsigned long>(mLoop.getTimeUntilNextStep() * 1000000.0);
+		if (waitUs >= 1000)
+		{
+			QThread::usleep(waitUs);
+		}
+		else
+		{
+			QThread::yieldCurrentThread();
+		}
+	}
+}
+
+void GameThread::publishSnapshot()
+{
+	RenderSnapshot& snapshot = mSnapshots.getWriteBuffer();
+	mScene->buildSnapshot(snapshot);
+	snapshot.stepIndex = mLoop.getStepCount();
+	snapshot.fixedDeltaTime = mLoop.getFixedDeltaTime();
+	snapshot.publishTime = std::chrono::steady_clock::now();
+}
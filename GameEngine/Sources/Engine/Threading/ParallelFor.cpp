@@ -0,0 +1,53 @@
+#include "Engine/Threading/ParallelFor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <QSemaphore>
+#include <QThreadPool>
+
+int ParallelFor::getChunkCount(int count, int grainSize)
+{
+	if (count <= 0)
+		return 0;
+
+	grainSize = std::max(grainSize, 1);
+	return (count + grainSize - 1) / grainSize;
+}
+
+void ParallelFor::run(int count, int grainSize, const Body& body, bool isParallel)
+{
+	int chunkCount = getChunkCount(count, grainSize);
+	grainSize = std::max(grainSize, 1);
+	if (chunkCount == 0)
+		return;
+
+	if (!isParallel || chunkCount == 1)
+	{
+		for (int chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			body(chunk, chunk * grainSize, std::min((chunk + 1) * grainSize, count));
+		}
+		return;
+	}
+
+	std::atomic<int> next(0);
+	auto work = [&body, &next, chunkCount, grainSize, count]() {
+		for (int chunk = next++; chunk < chunkCount; chunk = next++)
+		{
+			body(chunk, chunk * grainSize, std::min((chunk + 1) * grainSize, count));
+		}
+	};
+
+	QThreadPool* pool = QThreadPool::globalInstance();
+	QSemaphore finished;
+	int helperCount = 0;
+	int wantedHelpers = std::min(chunkCount - 1, std::max(pool->maxThreadCount(), 1));
+	for (int i = 0; i < wantedHelpers; ++i)
+	{
+		if (!pool->tryStart([&work, &finished]() { work(); finished.release(); }))
+			break;
+		helperCount++;
+	}
+	work();
+	finished.acquire(helperCount);
+}
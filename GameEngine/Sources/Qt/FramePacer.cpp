@@ -0,0 +1,224 @@
+#include "Qt/FramePacer.h"
+
+#include <QEvent>
+#include <QSurfaceFormat>
+#include <algorithm>
+#include <cmath>
+
+FramePacer::FramePacer(QOpenGLWidget* widget)
+    : QObject(widget), mWidget(widget), mMode(FramePacingMode::VSYNC), mTargetFps(DEFAULT_TARGET_FPS),
+    mIsStarted(false), mIsPaused(false), mIsFramePending(false), mNextDeadlineNs(0), mLastSwapNs(-1), mIntervalCursor(0) {
+    mIntervalsMs.reserve(HISTORY_SIZE);
+    mClock.start();
+
+    mCapTimer.setSingleShot(true);
+    mCapTimer.setTimerType(Qt::PreciseTimer);
+    connect(&mCapTimer, &QTimer::timeout, this, &FramePacer::requestFrame);
+    connect(mWidget, &QOpenGLWidget::frameSwapped, this, &FramePacer::onFrameSwapped);
+
+    mWidget->installEventFilter(this);
+}
+
+FramePacer::~FramePacer() {
+}
+
+void FramePacer::setMode(FramePacingMode mode) {
+    mMode = mode;
+
+    QSurfaceFormat format = mWidget->format();
+    switch (mode) {
+    case FramePacingMode::VSYNC:
+        format.setSwapInterval(1);
+        break;
+    case FramePacingMode::ADAPTIVE:
+        format.setSwapInterval(-1);
+        break;
+    default:
+        format.setSwapInterval(0);
+        break;
+    }
+    mWidget->setFormat(format);
+}
+
+FramePacingMode FramePacer::getMode() const {
+    return mMode;
+}
+
+void FramePacer::setTargetFps(double targetFps) {
+    mTargetFps = std::max(targetFps, 1.0);
+    mNextDeadlineNs = mClock.nsecsElapsed();
+}
+
+double FramePacer::getTargetFps() const {
+    return mTargetFps;
+}
+
+void FramePacer::start() {
+    mIsStarted = true;
+
+    // The window may not exist yet at construction, minimizing is only seen on it
+    if (mWidget->window() != mWidget) {
+        mWidget->window()->installEventFilter(this);
+    }
+
+    updatePaused();
+    requestFrame();
+}
+
+bool FramePacer::getIsPaused() const {
+    return mIsPaused;
+}
+
+FramePacingStats FramePacer::getStats() const {
+    FramePacingStats stats;
+    stats.isPaused = mIsPaused;
+    if (mIntervalsMs.empty()) {
+        return stats;
+    }
+
+    double sum = 0.0;
+    for (double interval : mIntervalsMs) {
+        sum += interval;
+        stats.maxIntervalMs = std::max(stats.maxIntervalMs, interval);
+    }
+    stats.averageIntervalMs = sum / mIntervalsMs.size();
+
+    double variance = 0.0;
+    for (double interval : mIntervalsMs) {
+        double deviation = interval - stats.averageIntervalMs;
+        variance += deviation * deviation;
+    }
+    stats.jitterMs = std::sqrt(variance / mIntervalsMs.size());
+    return stats;
+}
+
+bool FramePacer::parseMode(const QString& text, FramePacingMode& mode, double& targetFps) {
+    if (text == "uncapped") {
+        mode = FramePacingMode::UNCAPPED;
+    }
+    else if (text == "vsync") {
+        mode = FramePacingMode::VSYNC;
+    }
+    else if (text == "adaptive") {
+        mode = FramePacingMode::ADAPTIVE;
+    }
+    else if (text.startsWith("cap:")) {
+        bool isValid = false;
+        double fps = text.mid(4).toDouble(&isValid);
+        if (!isValid || fps <= 0.0) {
+            return false;
+        }
+        mode = FramePacingMode::FIXED_CAP;
+        targetFps = fps;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+QString FramePacer::getModeName(FramePacingMode mode) {
+    switch (mode) {
+    case FramePacingMode::UNCAPPED: return "Uncapped";
+    case FramePacingMode::VSYNC: return "VSync";
+    case FramePacingMode::ADAPTIVE: return "Adaptive VSync";
+    case FramePacingMode::FIXED_CAP: return "Capped";
+    }
+    return QString();
+}
+
+bool FramePacer::eventFilter(QObject* watched, QEvent* event) {
+    switch (event->type()) {
+    case QEvent::Show:
+    case QEvent::Hide:
+    case QEvent::WindowStateChange:
+        updatePaused();
+        break;
+    default:
+        break;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void FramePacer::onFrameSwapped() {
+    mIsFramePending = false;
+
+    qint64 nowNs = mClock.nsecsElapsed();
+    if (mLastSwapNs >= 0) {
+        double intervalMs = (nowNs - mLastSwapNs) / 1000000.0;
+        if (static_cast<int>(mIntervalsMs.size()) < HISTORY_SIZE) {
+            mIntervalsMs.push_back(intervalMs);
+        }
+        else {
+            mIntervalsMs[mIntervalCursor] = intervalMs;
+        }
+        mIntervalCursor = (mIntervalCursor + 1) % HISTORY_SIZE;
+    }
+    mLastSwapNs = nowNs;
+
+    scheduleNextFrame();
+}
+
+void FramePacer::requestFrame() {
+    if (!mIsStarted || mIsPaused || mIsFramePending) {
+        return;
+    }
+
+    mIsFramePending = true;
+    mWidget->update();
+}
+
+bool FramePacer::shouldRender() const {
+    if (!mWidget->isVisible()) {
+        return false;
+    }
+    return !(mWidget->window()->windowState() & Qt::WindowMinimized);
+}
+
+void FramePacer::updatePaused() {
+    bool isPaused = !shouldRender();
+    if (isPaused == mIsPaused) {
+        return;
+    }
+
+    mIsPaused = isPaused;
+    if (mIsPaused) {
+        mCapTimer.stop();
+        mIsFramePending = false;
+    }
+    else {
+        // The gap while paused is not a frame interval
+        mLastSwapNs = -1;
+        mNextDeadlineNs = mClock.nsecsElapsed();
+        requestFrame();
+    }
+}
+
+void FramePacer::scheduleNextFrame() {
+    if (mIsPaused) {
+        return;
+    }
+
+    if (mMode != FramePacingMode::FIXED_CAP) {
+        // With vsync the swap itself blocks, so the next frame can start right away
+        requestFrame();
+        return;
+    }
+
+    // Deadlines advance by whole periods so the average rate holds; after a long stall they
+    // restart from now instead of bursting to catch up
+    qint64 periodNs = static_cast<qint64>(1000000000.0 / mTargetFps);
+    qint64 nowNs = mClock.nsecsElapsed();
+    mNextDeadlineNs += periodNs;
+    if (mNextDeadlineNs < nowNs - periodNs) {
+        mNextDeadlineNs = nowNs;
+    }
+
+    int waitMs = static_cast<int>((mNextDeadlineNs - nowNs) / 1000000);
+    if (waitMs <= 0) {
+        requestFrame();
+    }
+    else {
+        mCapTimer.start(waitMs);
+    }
+}
@@ -0,0 +1,610 @@
+#include "Qt/Headless/HeadlessRunner.h"
+#include "Engine/Loaders/ModelLoader.h"
+#include "Engine/Nodes/Collider.h"
+#include "Engine/Nodes/Light.h"
+#include "Engine/Nodes/MeshRenderer.h"
+#include "Engine/Nodes/RigidBody.h"
+#include "Engine/Profiling/Profiler.h"
+#include "Engine/Spatial/RayPicker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QRandomGenerator>
+#include <QSurfaceFormat>
+#include <QThreadPool>
+
+bool HeadlessOptions::parse(const QStringList& arguments)
+{
+	for (int i = 1; i < arguments.size(); ++i)
+	{
+		const QString& argument = arguments[i];
+		bool hasValue = i + 1 < arguments.size();
+		bool isValid = true;
+
+		if (argument == "--headless")
+		{
+			continue;
+		}
+		else if (argument == "--frames" && hasValue)
+		{
+			frameCount = arguments[++i].toInt(&isValid);
+			isValid = isValid && frameCount > 0;
+		}
+		else if (argument == "--dt" && hasValue)
+		{
+			deltaTime = arguments[++i].toFloat(&isValid);
+			isValid = isValid && deltaTime > 0.0f;
+		}
+		else if (argument == "--size" && hasValue)
+		{
+			QStringList size = arguments[++i].split('x');
+			bool isHeightValid = false;
+			isValid = size.size() == 2;
+			if (isValid)
+			{
+				width = size[0].toInt(&isValid);
+				height = size[1].toInt(&isHeightValid);
+			}
+			isValid = isValid && isHeightValid && width > 0 && height > 0;
+		}
+		else if (argument == "--dump-dir" && hasValue)
+		{
+			dumpDirectory = arguments[++i];
+		}
+		else if (argument == "--dump-every" && hasValue)
+		{
+			dumpInterval = arguments[++i].toInt(&isValid);
+			isValid = isValid && dumpInterval > 0;
+		}
+		else if (argument == "--trace" && hasValue)
+		{
+			tracePath = arguments[++i];
+		}
+		else if (argument == "--depth-prepass")
+		{
+			isDepthPrePass = true;
+		}
+		else if (argument == "--overdraw")
+		{
+			isOverdrawMeasured = true;
+		}
+		else if (argument == "--reversed-z")
+		{
+			isReversedZ = true;
+		}
+		else if (argument == "--no-shadows")
+		{
+			isShadowed = false;
+		}
+		else if (argument == "--lights" && hasValue)
+		{
+			lightCount = arguments[++i].toInt(&isValid);
+			isValid = isValid && lightCount >= 0;
+		}
+		else if (argument == "--bench-picking" && hasValue)
+		{
+			pickObjectCount = arguments[++i].toInt(&isValid);
+			isValid = isValid && pickObjectCount > 0;
+		}
+		else if (argument == "--bench-broadphase")
+		{
+			isBroadphaseBenched = true;
+		}
+		else if (argument == "--bodies" && hasValue)
+		{
+			bodyCount = arguments[++i].toInt(&isValid);
+			isValid = isValid && bodyCount >= 0;
+		}
+		else if (argument == "--physics-single-thread")
+		{
+			isPhysicsMultithreaded = false;
+		}
+		else
+		{
+			isValid = false;
+		}
+
+		if (!isValid)
+		{
+			std::cout << "ERROR::HEADLESS::INVALID_ARGUMENT " << argument.toStdString() << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+HeadlessRunner::HeadlessRunner(const HeadlessOptions& options) : mOptions(options)
+{
+}
+
+HeadlessRunner::~HeadlessRunner()
+{
+	// GL objects have to go while the context is still current
+	if (mContext && mSurface)
+	{
+		mContext->makeCurrent(mSurface.get());
+		mFramebuffer.reset();
+		mContext->doneCurrent();
+	}
+}
+
+bool HeadlessRunner::createContext()
+{
+	QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+	format.setDepthBufferSize(24);
+	format.setStencilBufferSize(8);
+
+	mContext = std::make_unique<QOpenGLContext>();
+	mContext->setFormat(format);
+	if (!mContext->create())
+	{
+		std::cout << "ERROR::HEADLESS::CONTEXT_CREATION_FAILED" << std::endl;
+		return false;
+	}
+
+	mSurface = std::make_unique<QOffscreenSurface>();
+	mSurface->setFormat(mContext->format());
+	mSurface->create();
+	if (!mSurface->isValid() || !mContext->makeCurrent(mSurface.get()))
+	{
+		std::cout << "ERROR::HEADLESS::SURFACE_CREATION_FAILED" << std::endl;
+		return false;
+	}
+
+	initializeOpenGLFunctions();
+
+	QOpenGLFramebufferObjectFormat framebufferFormat;
+	framebufferFormat.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+	mFramebuffer = std::make_unique<QOpenGLFramebufferObject>(mOptions.width, mOptions.height, framebufferFormat);
+	if (!mFramebuffer->isValid())
+	{
+		std::cout << "ERROR::HEADLESS::FRAMEBUFFER_CREATION_FAILED" << std::endl;
+		return false;
+	}
+
+	QSurfaceFormat actual = mContext->format();
+	std::cout << "Headless context: OpenGL " << actual.majorVersion() << "." << actual.minorVersion()
+		<< (mContext->isOpenGLES() ? " ES" : "") << ", " << reinterpret_cast<const char*>(glGetString(GL_RENDERER)) << std::endl;
+	return true;
+}
+
+int HeadlessRunner::run(IScene* scene)
+{
+	if (!createContext())
+		return 1;
+
+	if (!mOptions.dumpDirectory.isEmpty() && !QDir().mkpath(mOptions.dumpDirectory))
+	{
+		std::cout << "ERROR::HEADLESS::DUMP_DIRECTORY_FAILED " << mOptions.dumpDirectory.toStdString() << std::endl;
+		return 1;
+	}
+
+	InputPublisher inputPublisher;
+	scene->setInputPublisher(&inputPublisher);
+	scene->setIsDepthPrePass(mOptions.isDepthPrePass);
+	scene->getOverdrawCounter()->setIsEnabled(mOptions.isOverdrawMeasured);
+	if (scene->getCamera())
+	{
+		scene->getCamera()->setIsReversedZ(mOptions.isReversedZ);
+	}
+	scene->getShadows()->setIsEnabled(mOptions.isShadowed);
+	addLights(scene);
+	addBodies(scene);
+	scene->getCollisionWorld()->setIsMultithreaded(mOptions.isPhysicsMultithreaded);
+	scene->getPhysicsWorld()->setIsMultithreaded(mOptions.isPhysicsMultithreaded);
+
+	// Same lifecycle as OpenGLWidget, with the framebuffer object standing in for the widget's
+	mFramebuffer->bind();
+	glViewport(0, 0, mOptions.width, mOptions.height);
+	RenderTarget target;
+	target.framebuffer = mFramebuffer->handle();
+	target.width = mOptions.width;
+	target.height = mOptions.height;
+	scene->setRenderTarget(target);
+	scene->init();
+	scene->create();
+	scene->start();
+	inputPublisher.resizeGLEvent(mOptions.width, mOptions.height);
+
+	Profiler& profiler = Profiler::instance();
+	profiler.initGpu();
+
+	// One simulation step per frame keeps runs deterministic regardless of how fast they render
+	EngineLoop loop(mOptions.deltaTime);
+	loop.setScene(scene);
+	loop.setInputPublisher(&inputPublisher);
+	FrameTimings phaseTotals;
+
+	std::vector<double> frameTimesMs;
+	frameTimesMs.reserve(mOptions.frameCount);
+
+	QElapsedTimer runTimer;
+	runTimer.start();
+	qint64 lastFrameNs = 0;
+
+	for (int frame = 0; frame < mOptions.frameCount; ++frame)
+	{
+		profiler.beginFrame();
+
+		mFramebuffer->bind();
+		glViewport(0, 0, mOptions.width, mOptions.height);
+
+		loop.tick(mOptions.deltaTime);
+
+		const FrameTimings& timings = loop.getLastTimings();
+		phaseTotals.inputMs += timings.inputMs;
+		phaseTotals.updateMs += timings.updateMs;
+		phaseTotals.renderMs += timings.renderMs;
+		phaseTotals.steps += timings.steps;
+
+		if (!mOptions.dumpDirectory.isEmpty() && (frame % mOptions.dumpInterval == 0 || frame == mOptions.frameCount - 1))
+		{
+			dumpFrame(frame);
+		}
+
+		profiler.endFrame();
+
+		// Frames are not finished individually, so the interval reflects throughput with the GPU pipelined
+		qint64 nowNs = runTimer.nsecsElapsed();
+		frameTimesMs.push_back((nowNs - lastFrameNs) / 1000000.0);
+		lastFrameNs = nowNs;
+	}
+
+	glFinish();
+	double totalMs = runTimer.nsecsElapsed() / 1000000.0;
+
+	printReport(frameTimesMs, totalMs, phaseTotals, scene->getRenderStats());
+	const CollisionStats& collisionStats = scene->getCollisionWorld()->getStats();
+	if (collisionStats.bodies > 0)
+	{
+		std::cout << "Last step: collision bodies " << collisionStats.bodies << "  pairs " << collisionStats.pairs
+			<< "  contacts " << collisionStats.contacts << "  broadphase " << collisionStats.broadphaseMs
+			<< " ms  narrowphase " << collisionStats.narrowphaseMs << " ms" << std::endl;
+	}
+	const PhysicsStats& physicsStats = scene->getPhysicsWorld()->getStats();
+	if (physicsStats.bodies > 0)
+	{
+		std::cout << "Last step: rigid bodies " << physicsStats.bodies << "  constraints " << physicsStats.constraints
+			<< "  islands " << physicsStats.islands << " (largest " << physicsStats.largestIsland << " constraints)  solve "
+			<< physicsStats.solveMs << " ms  integrate " << physicsStats.integrateMs << " ms" << std::endl;
+		std::cout << "Pose checksum " << std::hex << std::setw(16) << std::setfill('0') << getPoseChecksum(scene)
+			<< std::dec << std::setfill(' ') << std::endl;
+	}
+	if (mOptions.pickObjectCount > 0)
+	{
+		benchPicking(scene);
+	}
+	if (mOptions.isBroadphaseBenched)
+	{
+		benchBroadphase();
+	}
+
+	if (!mOptions.tracePath.isEmpty())
+	{
+		profiler.exportChromeTrace(mOptions.tracePath);
+	}
+
+	scene->clear();
+	profiler.clearGpu();
+	scene->setInputPublisher(nullptr);
+	mFramebuffer->release();
+	return 0;
+}
+
+void HeadlessRunner::addLights(IScene* scene) const
+{
+	QRandomGenerator random(1234);
+	for (int i = 0; i < mOptions.lightCount; ++i)
+	{
+		Light* light = new Light(LightType::POINT);
+		light->transform->setLocalPosition(QVector3D(
+			random.bounded(-40.0, 40.0), random.bounded(-5.0, 15.0), random.bounded(-40.0, 40.0)));
+		light->setColor(QColor::fromHsvF(random.bounded(1.0), 0.6, 1.0));
+		light->setIntensity(4.0f);
+		light->setRange(static_cast<float>(random.bounded(2.0, 6.0)));
+		scene->addNode(light);
+	}
+}
+
+void HeadlessRunner::addBodies(IScene* scene) const
+{
+	if (mOptions.bodyCount == 0)
+		return;
+
+	ModelLoader loader = ModelLoader::Builder().SetUseNormalColor(true).Build();
+	std::shared_ptr<Mesh> cube = std::shared_ptr<Mesh>(loader.loadCube());
+	std::shared_ptr<Mesh> sphere = std::shared_ptr<Mesh>(loader.loadSphere(16, 16));
+	scene->addMesh(cube);
+	scene->addMesh(sphere);
+
+	// Eight layers, spaced so nothing starts out overlapping
+	const float spacing = 1.5f;
+	int side = static_cast<int>(std::ceil(std::sqrt(mOptions.bodyCount / 8.0)));
+	float groundSize = side * spacing + 8.0f;
+
+	Collider* ground = new Collider(ColliderShape::AABB);
+	ground->setHalfExtents(QVector3D(groundSize, 0.5f, groundSize) * 0.5f);
+	MeshRenderer* groundMesh = new MeshRenderer(cube);
+	ground->addChild(groundMesh);
+	groundMesh->transform->setLocalScale(QVector3D(groundSize, 0.5f, groundSize));
+	groundMesh->setIsStatic(true);
+	ground->transform->setLocalPosition(QVector3D(0.0f, -1.25f, 0.0f));
+	scene->addNode(ground);
+
+	QRandomGenerator random(1234);
+	for (int i = 0; i < mOptions.bodyCount; ++i)
+	{
+		bool isBox = i % 3 != 0;
+		RigidBody* body = new RigidBody();
+
+		// Parts first, while the body still sits at the origin, so their local pose is the identity
+		Collider* collider = new Collider(isBox ? ColliderShape::OBB : ColliderShape::SPHERE);
+		body->addChild(collider);
+		MeshRenderer* mesh = new MeshRenderer(isBox ? cube : sphere);
+		body->addChild(mesh);
+		if (!isBox)
+		{
+			mesh->transform->setLocalScale(QVector3D(0.5f, 0.5f, 0.5f));
+		}
+
+		int column = i % (side * side);
+		int layer = i / (side * side);
+		body->transform->setLocalPosition(QVector3D(
+			(column % side - side * 0.5f) * spacing + static_cast<float>(random.bounded(-0.2, 0.2)),
+			1.0f + layer * spacing,
+			(column / side - side * 0.5f) * spacing + static_cast<float>(random.bounded(-0.2, 0.2))));
+		body->transform->setLocalRotation(QQuaternion::fromEulerAngles(
+			static_cast<float>(random.bounded(-30.0, 30.0)), static_cast<float>(random.bounded(360.0)), 0.0f));
+		body->setFriction(0.6f);
+		body->setRestitution(isBox ? 0.1f : 0.4f);
+		scene->addNode(body);
+	}
+}
+
+quint64 HeadlessRunner::getPoseChecksum(IScene* scene) const
+{
+	// FNV-1a over the exact bits, since a replay has to match to the last one
+	quint64 checksum = 14695981039346656037ULL;
+	auto add = [&checksum](float value) {
+		quint32 bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		for (int byte = 0; byte < 4; ++byte)
+		{
+			checksum = (checksum ^ ((bits >> (byte * 8)) & 0xFF)) * 1099511628211ULL;
+		}
+	};
+
+	PhysicsWorld* world = scene->getPhysicsWorld();
+	for (int i = 0; i < world->getBodyCount(); ++i)
+	{
+		Transform* transform = world->getBody(i)->transform.get();
+		QVector3D position = transform->getWorldPosition();
+		QQuaternion rotation = transform->getWorldRotation();
+		add(position.x());
+		add(position.y());
+		add(position.z());
+		add(rotation.scalar());
+		add(rotation.x());
+		add(rotation.y());
+		add(rotation.z());
+	}
+	return checksum;
+}
+
+void HeadlessRunner::benchPicking(IScene* scene) const
+{
+	const SpatialIndex& drawn = *scene->getSpatialIndex();
+	if (drawn.getCount() == 0)
+	{
+		std::cout << "ERROR::HEADLESS::NOTHING_TO_PICK" << std::endl;
+		return;
+	}
+
+	// Spread through the camera's view, so most rays have candidates to test
+	QMatrix4x4 inverseView = drawn.getViewMatrix().inverted();
+	QRandomGenerator random(1234);
+	SpatialIndex index;
+	index.setCamera(drawn.getViewMatrix(), drawn.getProjectionMatrix());
+	float spread = std::cbrt(static_cast<float>(mOptions.pickObjectCount)) * 1.5f;
+	for (int i = 0; i < mOptions.pickObjectCount; ++i)
+	{
+		int source = i % drawn.getCount();
+		QVector3D viewPosition(
+			static_cast<float>(random.bounded(-1.0, 1.0)) * spread,
+			static_cast<float>(random.bounded(-1.0, 1.0)) * spread,
+			-static_cast<float>(random.bounded(2.0, 2.0 + 2.0 * spread)));
+		QMatrix4x4 world;
+		world.translate(inverseView.map(viewPosition));
+		index.insert(drawn.getNode(source), drawn.getMesh(source), world);
+	}
+
+	// The first pick builds the BVHs of the meshes involved
+	RayPicker picker;
+	PickResult result;
+	QSizeF viewportSize(mOptions.width, mOptions.height);
+	picker.pick(index, QPointF(mOptions.width * 0.5, mOptions.height * 0.5), viewportSize, result);
+
+	const int rayCount = 1000;
+	std::vector<double> timesMs;
+	timesMs.reserve(rayCount);
+	int hits = 0;
+	for (int i = 0; i < rayCount; ++i)
+	{
+		QPointF pixel(random.bounded(static_cast<double>(mOptions.width)), random.bounded(static_cast<double>(mOptions.height)));
+		QElapsedTimer timer;
+		timer.start();
+		hits += picker.pick(index, pixel, viewportSize, result) ? 1 : 0;
+		timesMs.push_back(timer.nsecsElapsed() / 1000000.0);
+	}
+
+	std::sort(timesMs.begin(), timesMs.end());
+	double totalMs = 0.0;
+	for (double time : timesMs)
+	{
+		totalMs += time;
+	}
+	std::cout << "Picking " << index.getCount() << " objects, " << rayCount << " rays: avg " << totalMs / rayCount
+		<< " ms  p99 " << timesMs[rayCount * 99 / 100] << " ms  max " << timesMs.back() << " ms  hits " << hits << std::endl;
+
+	// Rebuilt from scratch, bypassing the cache, for the build time of the largest mesh
+	Mesh* largest = drawn.getMesh(0);
+	for (int i = 1; i < drawn.getCount(); ++i)
+	{
+		if (drawn.getMesh(i)->indices.size() > largest->indices.size())
+			largest = drawn.getMesh(i);
+	}
+	MeshBVH bvh;
+	QElapsedTimer buildTimer;
+	buildTimer.start();
+	bvh.build(largest->vertices, largest->indices, largest->getDrawMode());
+	std::cout << "Largest mesh BVH: triangles " << bvh.getTriangleCount() << "  nodes " << bvh.getNodeCount()
+		<< "  build " << buildTimer.nsecsElapsed() / 1000000.0 << " ms" << std::endl;
+}
+
+void HeadlessRunner::benchBroadphase() const
+{
+	// Same density at both counts, so each body has about as many neighbours either way
+	const float density = 0.2f;
+	const int tickCount = 120;
+	const int bodyCounts[] = { 10000, 100000 };
+	int threadCount = QThreadPool::globalInstance()->maxThreadCount();
+
+	for (int bodyCount : bodyCounts)
+	{
+		for (bool isMultithreaded : { false, true })
+		{
+			CollisionWorld world;
+			world.setIsMultithreaded(isMultithreaded);
+			QRandomGenerator random(1234);
+			float halfSize = std::cbrt(bodyCount / density) * 0.5f;
+
+			std::vector<ColliderData> shapes(bodyCount);
+			std::vector<QVector3D> velocities(bodyCount);
+			for (int i = 0; i < bodyCount; ++i)
+			{
+				// Mostly spheres, with a tenth each of the other shapes
+				ColliderData& shape = shapes[i];
+				int kind = i % 10;
+				shape.shape = kind < 7 ? ColliderShape::SPHERE : kind == 7 ? ColliderShape::AABB : kind == 8 ? ColliderShape::OBB : ColliderShape::CAPSULE;
+				shape.center = QVector3D(
+					static_cast<float>(random.bounded(-1.0, 1.0)) * halfSize,
+					static_cast<float>(random.bounded(-1.0, 1.0)) * halfSize,
+					static_cast<float>(random.bounded(-1.0, 1.0)) * halfSize);
+				shape.rotation = QQuaternion::fromEulerAngles(
+					static_cast<float>(random.bounded(360.0)), static_cast<float>(random.bounded(360.0)), static_cast<float>(random.bounded(360.0)));
+				shape.radius = static_cast<float>(random.bounded(0.25, 0.75));
+				shape.halfHeight = shape.radius;
+				shape.halfExtents = QVector3D(shape.radius, shape.radius, shape.radius);
+				velocities[i] = QVector3D(
+					static_cast<float>(random.bounded(-2.0, 2.0)),
+					static_cast<float>(random.bounded(-2.0, 2.0)),
+					static_cast<float>(random.bounded(-2.0, 2.0)));
+				world.addBody(shape);
+			}
+
+			// The first step sorts from scratch; the rest are the steady state being measured
+			world.step();
+			double broadphaseMs = 0.0;
+			double narrowphaseMs = 0.0;
+			qint64 pairs = 0;
+			qint64 contacts = 0;
+			int resorts = 0;
+			for (int tick = 0; tick < tickCount; ++tick)
+			{
+				for (int i = 0; i < bodyCount; ++i)
+				{
+					// Bounces off the walls of the volume
+					QVector3D position = shapes[i].center + velocities[i] * mOptions.deltaTime;
+					for (int axis = 0; axis < 3; ++axis)
+					{
+						if (std::abs(position[axis]) > halfSize)
+						{
+							velocities[i][axis] = -velocities[i][axis];
+							position[axis] = std::clamp(position[axis], -halfSize, halfSize);
+						}
+					}
+					shapes[i].center = position;
+					world.setBody(i, shapes[i]);
+				}
+				world.step();
+
+				const CollisionStats& stats = world.getStats();
+				broadphaseMs += stats.broadphaseMs;
+				narrowphaseMs += stats.narrowphaseMs;
+				pairs += stats.pairs;
+				contacts += stats.contacts;
+				resorts += stats.isResorted ? 1 : 0;
+			}
+
+			std::cout << "Broadphase " << bodyCount << " bodies, " << (isMultithreaded ? threadCount : 1) << " thread(s): broadphase avg "
+				<< broadphaseMs / tickCount << " ms  narrowphase avg " << narrowphaseMs / tickCount << " ms  pairs/step "
+				<< pairs / tickCount << "  contacts/step " << contacts / tickCount << "  pairs/s "
+				<< static_cast<qint64>(pairs / (std::max(broadphaseMs, 0.001) / 1000.0)) << "  full sorts " << resorts << std::endl;
+		}
+	}
+}
+
+void HeadlessRunner::dumpFrame(int frame)
+{
+	QString path = QDir(mOptions.dumpDirectory).filePath(QString("frame_%1.png").arg(frame, 5, 10, QChar('0')));
+	if (!mFramebuffer->toImage().save(path))
+	{
+		std::cout << "ERROR::HEADLESS::DUMP_FAILED " << path.toStdString() << std::endl;
+	}
+}
+
+void HeadlessRunner::printReport(const std::vector<double>& frameTimesMs, double totalMs, const FrameTimings& phaseTotals, const RenderStats& lastStats) const
+{
+	if (frameTimesMs.empty())
+		return;
+
+	std::vector<double> sorted = frameTimesMs;
+	std::sort(sorted.begin(), sorted.end());
+
+	auto percentile = [&sorted](double p) {
+		size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+		return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+	};
+
+	std::cout << "Frames: " << sorted.size() << "  total " << totalMs << " ms  avg " << totalMs / sorted.size()
+		<< " ms  (" << sorted.size() * 1000.0 / totalMs << " fps)" << std::endl;
+	std::cout << "Frame time ms: min " << sorted.front() << "  p50 " << percentile(50) << "  p90 " << percentile(90)
+		<< "  p95 " << percentile(95) << "  p99 " << percentile(99) << "  max " << sorted.back() << std::endl;
+
+	double frames = static_cast<double>(sorted.size());
+	double budgetMs = mOptions.deltaTime * 1000.0;
+	std::cout << "Phase avg ms (budget " << budgetMs << "): input " << phaseTotals.inputMs / frames
+		<< "  update " << phaseTotals.updateMs / frames << "  render submit " << phaseTotals.renderMs / frames
+		<< "  steps " << phaseTotals.steps << std::endl;
+	std::cout << "Last frame: draw calls " << lastStats.drawCalls << "  indirect draws " << lastStats.indirectDrawCalls
+		<< "  indirect commands " << lastStats.indirectCommands << "  frustum culled " << lastStats.frustumCulled
+		<< "  occlusion culled " << lastStats.occlusionCulled << "  upload bytes " << lastStats.uploadBytes << std::endl;
+	std::cout << "Last frame: shader binds " << lastStats.shaderBinds << "  material binds " << lastStats.materialBinds
+		<< "  raster state changes " << lastStats.rasterStateChanges << "  GL state calls issued " << lastStats.stateCallsIssued
+		<< "  elided " << lastStats.stateCallsElided << std::endl;
+	if (mOptions.isDepthPrePass)
+	{
+		std::cout << "Last frame: depth pre-pass draws " << lastStats.depthDrawCalls << std::endl;
+	}
+	if (mOptions.lightCount > 0)
+	{
+		std::cout << "Last frame: lights " << lastStats.lights << "  cluster light indices " << lastStats.lightIndices
+			<< "  dropped " << lastStats.lightsDropped << std::endl;
+	}
+	if (lastStats.shadowCascades > 0)
+	{
+		std::cout << "Last frame: shadow cascades " << lastStats.shadowCascades << "  cached " << lastStats.shadowCachedCascades
+			<< "  shadow draws " << lastStats.shadowDrawCalls << std::endl;
+	}
+	if (mOptions.isOverdrawMeasured)
+	{
+		std::cout << "Last frame: fragments shaded " << lastStats.fragmentsShaded << "  overdraw " << lastStats.overdraw
+			<< " per pixel" << std::endl;
+	}
+}
@@ -1,5 +1,7 @@
 #include "Qt/Hierarchy/HierarchyWidget.h"
 
+#include <QTreeWidgetItemIterator>
+
 HierarchyWidget::HierarchyWidget(QWidget* parent) : QDockWidget(tr("Hierarchy"), parent) {
     mHierarchyTree = new QTreeWidget();
     mHierarchyTree->setHeaderLabel("Scene View");
@@ -52,3 +54,18 @@ void HierarchyWidget::populateHierarchyView(IScene* scene) {
     }
 }
 
+void HierarchyWidget::selectNode(Node* node) {
+    if (!node) {
+        mHierarchyTree->clearSelection();
+        return;
+    }
+
+    for (QTreeWidgetItemIterator it(mHierarchyTree); *it; ++it) {
+        HierarchyItem* item = dynamic_cast<HierarchyItem*>(*it);
+        if (item && item->getNode() == node) {
+            mHierarchyTree->scrollToItem(item);
+            mHierarchyTree->setCurrentItem(item);
+            return;
+        }
+    }
+}
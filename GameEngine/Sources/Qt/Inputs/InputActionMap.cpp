@@ -0,0 +1,227 @@
+#include "Qt/Inputs/InputActionMap.h"
+
+#include <iostream>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QKeySequence>
+
+InputActionMap::InputActionMap()
+{
+}
+
+bool InputActionMap::load(const QString& path)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly)) {
+		std::cout << "ERROR::INPUT_ACTION_MAP::FILE_NOT_FOUND " << path.toStdString() << std::endl;
+		return false;
+	}
+
+	QJsonParseError error;
+	QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+	if (document.isNull() || !document.isObject()) {
+		std::cout << "ERROR::INPUT_ACTION_MAP::PARSE_FAILED " << path.toStdString() << " " << error.errorString().toStdString() << std::endl;
+		return false;
+	}
+
+	return read(document.object());
+}
+
+bool InputActionMap::read(const QJsonObject& json)
+{
+	clear();
+	bool isValid = true;
+
+	QJsonObject actions = json["actions"].toObject();
+	for (auto it = actions.begin(); it != actions.end(); ++it) {
+		Action action;
+		action.name = it.key();
+		isValid = readBindings(it.value(), action.name, action.bindings) && isValid;
+		mActions.push_back(action);
+	}
+
+	QJsonObject axes = json["axes"].toObject();
+	for (auto it = axes.begin(); it != axes.end(); ++it) {
+		QJsonObject axisObject = it.value().toObject();
+		Axis axis;
+		axis.name = it.key();
+		axis.scale = static_cast<float>(axisObject["scale"].toDouble(1.0));
+
+		QString source = axisObject["source"].toString("Buttons");
+		if (source == "MouseX") {
+			axis.source = AxisSource::MouseX;
+		}
+		else if (source == "MouseY") {
+			axis.source = AxisSource::MouseY;
+		}
+		else if (source == "Wheel") {
+			axis.source = AxisSource::Wheel;
+		}
+		else if (source == "Buttons") {
+			isValid = readBindings(axisObject["positive"], axis.name, axis.positive) && isValid;
+			isValid = readBindings(axisObject["negative"], axis.name, axis.negative) && isValid;
+		}
+		else {
+			std::cout << "ERROR::INPUT_ACTION_MAP::UNKNOWN_AXIS_SOURCE " << source.toStdString() << std::endl;
+			isValid = false;
+		}
+		mAxes.push_back(axis);
+	}
+
+	return isValid;
+}
+
+void InputActionMap::clear()
+{
+	mActions.clear();
+	mAxes.clear();
+}
+
+int InputActionMap::findAction(const QString& name) const
+{
+	for (size_t i = 0; i < mActions.size(); ++i) {
+		if (mActions[i].name == name) {
+			return static_cast<int>(i);
+		}
+	}
+	return INVALID_ID;
+}
+
+int InputActionMap::findAxis(const QString& name) const
+{
+	for (size_t i = 0; i < mAxes.size(); ++i) {
+		if (mAxes[i].name == name) {
+			return static_cast<int>(i);
+		}
+	}
+	return INVALID_ID;
+}
+
+void InputActionMap::update(const InputSnapshot& input)
+{
+	for (auto& action : mActions) {
+		bool wasDown = action.isDown;
+		bool isTapped = false;
+		action.isDown = false;
+		for (const auto& binding : action.bindings) {
+			bool isBindingDown = input.isDown(binding.device, binding.slot);
+			action.isDown = action.isDown || isBindingDown;
+			isTapped = isTapped || (!isBindingDown && input.wasPressed(binding.device, binding.slot));
+		}
+		action.wasPressed = (action.isDown && !wasDown) || isTapped;
+		action.wasReleased = (!action.isDown && wasDown) || isTapped;
+	}
+
+	QPointF mouseDelta = input.getMouseDelta();
+	for (auto& axis : mAxes) {
+		float value = 0.0f;
+		switch (axis.source) {
+		case AxisSource::Buttons:
+			value = (isAnyDown(input, axis.positive) ? 1.0f : 0.0f) - (isAnyDown(input, axis.negative) ? 1.0f : 0.0f);
+			break;
+		case AxisSource::MouseX:
+			value = static_cast<float>(mouseDelta.x());
+			break;
+		case AxisSource::MouseY:
+			value = static_cast<float>(mouseDelta.y());
+			break;
+		case AxisSource::Wheel:
+			value = input.getWheelDelta();
+			break;
+		}
+		axis.value = value * axis.scale;
+	}
+}
+
+bool InputActionMap::isDown(int action) const
+{
+	return action >= 0 && action < static_cast<int>(mActions.size()) && mActions[action].isDown;
+}
+
+bool InputActionMap::wasPressed(int action) const
+{
+	return action >= 0 && action < static_cast<int>(mActions.size()) && mActions[action].wasPressed;
+}
+
+bool InputActionMap::wasReleased(int action) const
+{
+	return action >= 0 && action < static_cast<int>(mActions.size()) && mActions[action].wasReleased;
+}
+
+float InputActionMap::getAxis(int axis) const
+{
+	if (axis < 0 || axis >= static_cast<int>(mAxes.size())) {
+		return 0.0f;
+	}
+	return mAxes[axis].value;
+}
+
+int InputActionMap::getActionCount() const
+{
+	return static_cast<int>(mActions.size());
+}
+
+int InputActionMap::getAxisCount() const
+{
+	return static_cast<int>(mAxes.size());
+}
+
+bool InputActionMap::parseBinding(const QString& text, Binding& binding)
+{
+	static const struct { const char* name; InputDevice device; int code; } NAMED_BINDINGS[] = {
+		{ "MouseLeft", InputDevice::Mouse, Qt::LeftButton },
+		{ "MouseRight", InputDevice::Mouse, Qt::RightButton },
+		{ "MouseMiddle", InputDevice::Mouse, Qt::MiddleButton },
+		{ "MouseBack", InputDevice::Mouse, Qt::BackButton },
+		{ "MouseForward", InputDevice::Mouse, Qt::ForwardButton },
+		// Modifiers on their own are not key sequences
+		{ "Shift", InputDevice::Keyboard, Qt::Key_Shift },
+		{ "Ctrl", InputDevice::Keyboard, Qt::Key_Control },
+		{ "Alt", InputDevice::Keyboard, Qt::Key_Alt },
+		{ "Meta", InputDevice::Keyboard, Qt::Key_Meta },
+	};
+
+	for (const auto& named : NAMED_BINDINGS) {
+		if (text == named.name) {
+			binding.device = named.device;
+			binding.slot = named.device == InputDevice::Mouse ? InputSnapshot::getButtonSlot(named.code) : InputSnapshot::getKeySlot(named.code);
+			return binding.slot >= 0;
+		}
+	}
+
+	QKeySequence sequence = QKeySequence::fromString(text);
+	if (sequence.count() != 1) {
+		return false;
+	}
+
+	binding.device = InputDevice::Keyboard;
+	binding.slot = InputSnapshot::getKeySlot(sequence[0].key());
+	return binding.slot >= 0;
+}
+
+bool InputActionMap::readBindings(const QJsonValue& value, const QString& owner, std::vector<Binding>& bindings)
+{
+	bool isValid = true;
+	for (const QJsonValue& element : value.toArray()) {
+		Binding binding;
+		if (parseBinding(element.toString(), binding)) {
+			bindings.push_back(binding);
+		}
+		else {
+			std::cout << "ERROR::INPUT_ACTION_MAP::UNKNOWN_BINDING " << owner.toStdString() << " " << element.toString().toStdString() << std::endl;
+			isValid = false;
+		}
+	}
+	return isValid;
+}
+
+bool InputActionMap::isAnyDown(const InputSnapshot& input, const std::vector<Binding>& bindings)
+{
+	for (const auto& binding : bindings) {
+		if (input.isDown(binding.device, binding.slot)) {
+			return true;
+		}
+	}
+	return false;
+}
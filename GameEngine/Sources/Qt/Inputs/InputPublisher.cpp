@@ -1,10 +1,11 @@
 #include "Qt/Inputs/InputPublisher.h"
+#include "Engine/Constants/ResourcePath.h"
 
 
 
-InputPublisher::InputPublisher()
+InputPublisher::InputPublisher() : mDroppedEventCount(0)
 {
-	mSubscribers = QList<InputSubscriber*>();
+	mActionMap.load(DEFAULT_INPUT_CONFIG_PATH);
 }
 
 InputPublisher::~InputPublisher()
@@ -12,128 +13,178 @@ InputPublisher::~InputPublisher()
 	clear();
 }
 
-void InputPublisher::subscribe(InputSubscriber* subscriber) {
-    mSubscribers.append(subscriber);
+void InputPublisher::subscribe(InputSubscriber* subscriber, unsigned int subscriptions) {
+    for (int group = 0; group < INPUT_SUBSCRIPTION_GROUP_COUNT; ++group) {
+        if (subscriptions & (1u << group)) {
+            mSubscribers[group].append(subscriber);
+        }
+    }
 }
 
 void InputPublisher::unsubscribe(InputSubscriber* subscriber) {
-    mSubscribers.removeOne(subscriber);
+    for (auto& subscribers : mSubscribers) {
+        subscribers.removeOne(subscriber);
+    }
 }
 
 void InputPublisher::clear()
 {
-    mSubscribers.clear();
+    for (auto& subscribers : mSubscribers) {
+        subscribers.clear();
+    }
+
+    // Only called while nothing is stepping the simulation
+    InputEvent event;
+    while (mEventQueue.pop(event)) {
+    }
+    mInputSnapshot.clear();
+}
+
+void InputPublisher::enqueue(InputEventType type, int code, float x, float y, quint64 timestamp)
+{
+    InputEvent event;
+    event.type = type;
+    event.code = code;
+    event.x = x;
+    event.y = y;
+    event.timestamp = timestamp;
+
+    if (!mEventQueue.push(event)) {
+        mDroppedEventCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+const InputSnapshot& InputPublisher::getInputSnapshot() const
+{
+    return mInputSnapshot;
+}
+
+InputActionMap& InputPublisher::getActionMap()
+{
+    return mActionMap;
+}
+
+int InputPublisher::getDroppedEventCount() const
+{
+    return mDroppedEventCount.load(std::memory_order_relaxed);
 }
 
 void InputPublisher::keyPressEvent(QKeyEvent* event) {
-	for (const auto& subscriber : mSubscribers) {
-		subscriber->updateKeyPress(event);
-	}
+    // Held keys stay Hold in the snapshot, repeats carry nothing new
+    if (event->isAutoRepeat()) {
+        return;
+    }
+    enqueue(InputEventType::KeyPress, event->key(), 0.0f, 0.0f, event->timestamp());
 }
 
 void InputPublisher::keyReleaseEvent(QKeyEvent* event) {
-	for (const auto& subscriber : mSubscribers) {
-		subscriber->updateKeyRelease(event);
-	}
+    if (event->isAutoRepeat()) {
+        return;
+    }
+    enqueue(InputEventType::KeyRelease, event->key(), 0.0f, 0.0f, event->timestamp());
 }
 
 void InputPublisher::resizeGLEvent(int w, int h)
 {
-	for (const auto& subscriber : mSubscribers) {
+	for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_RESIZE_GL]) {
 		subscriber->updateResizeGL(w, h);
 	}
 }
 
 void InputPublisher::update(float deltaTime)
 {
-	for (const auto& subscriber : mSubscribers) {
+    mInputSnapshot.beginStep();
+
+    InputEvent event;
+    while (mEventQueue.pop(event)) {
+        mInputSnapshot.apply(event);
+    }
+
+    mActionMap.update(mInputSnapshot);
+
+	for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_STEP]) {
+		subscriber->updateInput(mInputSnapshot, mActionMap, deltaTime);
 		subscriber->update(deltaTime);
 	}
 }
 
 void InputPublisher::mousePressEvent(QMouseEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
-        subscriber->updateMousePress(event);
-    }
+    enqueue(InputEventType::MousePress, event->button(), event->position().x(), event->position().y(), event->timestamp());
 }
 
 void InputPublisher::mouseReleaseEvent(QMouseEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
-        subscriber->updateMouseRelease(event);
-    }
+    enqueue(InputEventType::MouseRelease, event->button(), event->position().x(), event->position().y(), event->timestamp());
 }
 
 void InputPublisher::mouseDoubleClickEvent(QMouseEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
-        subscriber->updateMouseDoubleClick(event);
-    }
+    // Qt sends press, release, double click, release; the double click stands in for the second press
+    enqueue(InputEventType::MousePress, event->button(), event->position().x(), event->position().y(), event->timestamp());
 }
 
 void InputPublisher::mouseMoveEvent(QMouseEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
-        subscriber->updateMouseMove(event);
-    }
+    enqueue(InputEventType::MouseMove, 0, event->position().x(), event->position().y(), event->timestamp());
 }
 
 #if QT_CONFIG(wheelevent)
 void InputPublisher::wheelEvent(QWheelEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
-        subscriber->updateWheel(event);
-    }
+    // Angle deltas are in eighths of a degree
+    enqueue(InputEventType::Wheel, 0, event->angleDelta().x() / 8.0f, event->angleDelta().y() / 8.0f, event->timestamp());
 }
 #endif
 
 void InputPublisher::focusInEvent(QFocusEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
+    for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_FOCUS]) {
         subscriber->updateFocusIn(event);
     }
 }
 
 void InputPublisher::focusOutEvent(QFocusEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
+    enqueue(InputEventType::FocusOut, 0, 0.0f, 0.0f, 0);
+
+    for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_FOCUS]) {
         subscriber->updateFocusOut(event);
     }
 }
 
 void InputPublisher::enterEvent(QEnterEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
+    for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_WIDGET]) {
         subscriber->updateEnter(event);
     }
 }
 
 void InputPublisher::leaveEvent(QEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
+    for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_WIDGET]) {
         subscriber->updateLeave(event);
     }
 }
 
 void InputPublisher::paintEvent(QPaintEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
+    for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_WIDGET]) {
         subscriber->updatePaint(event);
     }
 }
 
 void InputPublisher::moveEvent(QMoveEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
+    for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_WIDGET]) {
         subscriber->updateMove(event);
     }
 }
 
 void InputPublisher::resizeEvent(QResizeEvent* event) {
-    for (auto& subscriber : mSubscribers) {
+    for (auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_WIDGET]) {
         subscriber->updateResize(event);
     }
 }
 
 void InputPublisher::closeEvent(QCloseEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
+    for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_WIDGET]) {
         subscriber->updateClose(event);
     }
 }
 
 #ifndef QT_NO_CONTEXTMENU
 void InputPublisher::contextMenuEvent(QContextMenuEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
+    for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_OTHER]) {
         subscriber->updateContextMenu(event);
     }
 }
@@ -141,7 +192,7 @@ void InputPublisher::contextMenuEvent(QContextMenuEvent* event) {
 
 #if QT_CONFIG(tabletevent)
 void InputPublisher::tabletEvent(QTabletEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
+    for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_OTHER]) {
         subscriber->updateTablet(event);
     }
 }
@@ -149,7 +200,7 @@ void InputPublisher::tabletEvent(QTabletEvent* event) {
 
 #ifndef QT_NO_ACTION
 void InputPublisher::actionEvent(QActionEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
+    for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_OTHER]) {
         subscriber->updateAction(event);
     }
 }
@@ -157,38 +208,38 @@ void InputPublisher::actionEvent(QActionEvent* event) {
 
 #if QT_CONFIG(draganddrop)
 void InputPublisher::dragEnterEvent(QDragEnterEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
+    for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_OTHER]) {
         subscriber->updateDragEnter(event);
     }
 }
 
 void InputPublisher::dragMoveEvent(QDragMoveEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
+    for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_OTHER]) {
         subscriber->updateDragMove(event);
     }
 }
 
 void InputPublisher::dragLeaveEvent(QDragLeaveEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
+    for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_OTHER]) {
         subscriber->updateDragLeave(event);
     }
 }
 
 void InputPublisher::dropEvent(QDropEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
+    for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_OTHER]) {
         subscriber->updateDrop(event);
     }
 }
 #endif
 
 void InputPublisher::showEvent(QShowEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
+    for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_WIDGET]) {
         subscriber->updateShow(event);
     }
 }
 
 void InputPublisher::hideEvent(QHideEvent* event) {
-    for (const auto& subscriber : mSubscribers) {
+    for (const auto& subscriber : mSubscribers[INPUT_SUBSCRIPTION_WIDGET]) {
         subscriber->updateHide(event);
     }
 }
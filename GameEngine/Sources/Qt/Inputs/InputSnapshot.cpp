@@ -0,0 +1,232 @@
+#include "Qt/Inputs/InputSnapshot.h"
+
+template<size_t SIZE>
+void InputSnapshot::Bits<SIZE>::press(int slot)
+{
+	if (!down[slot]) {
+		down[slot] = true;
+		pressed[slot] = true;
+	}
+}
+
+template<size_t SIZE>
+void InputSnapshot::Bits<SIZE>::release(int slot)
+{
+	if (down[slot]) {
+		down[slot] = false;
+		released[slot] = true;
+	}
+}
+
+template<size_t SIZE>
+bool InputSnapshot::Bits<SIZE>::tryGetState(int slot, InputState& state) const
+{
+	if (down[slot]) {
+		state = pressed[slot] ? InputState::Pressed : InputState::Hold;
+		return true;
+	}
+	if (released[slot]) {
+		state = pressed[slot] ? InputState::Tap : InputState::Released;
+		return true;
+	}
+	return false;
+}
+
+int InputSnapshot::getKeySlot(int key)
+{
+	if (key >= 0 && key < 256) {
+		return key;
+	}
+	if ((key & ~0xFF) == 0x01000000) {
+		return 256 + (key & 0xFF);
+	}
+	return -1;
+}
+
+int InputSnapshot::getButtonSlot(int button)
+{
+	if (button <= 0 || (button & (button - 1)) != 0) {
+		return -1;
+	}
+
+	int slot = 0;
+	while ((button >>= 1) != 0) {
+		slot++;
+	}
+	return slot < BUTTON_SLOT_COUNT ? slot : -1;
+}
+
+InputSnapshot::InputSnapshot()
+	: mHasMousePosition(false), mWheelDelta(0.0f), mEventCount(0)
+{
+}
+
+void InputSnapshot::beginStep()
+{
+	mKeys.pressed.reset();
+	mKeys.released.reset();
+	mButtons.pressed.reset();
+	mButtons.released.reset();
+	mMouseDelta = QPointF();
+	mWheelDelta = 0.0f;
+	mEventCount = 0;
+}
+
+void InputSnapshot::apply(const InputEvent& event)
+{
+	mEventCount++;
+
+	switch (event.type) {
+	case InputEventType::KeyPress:
+	case InputEventType::KeyRelease: {
+		int slot = getKeySlot(event.code);
+		if (slot < 0) {
+			break;
+		}
+		if (event.type == InputEventType::KeyPress) {
+			mKeys.press(slot);
+		}
+		else {
+			mKeys.release(slot);
+		}
+		break;
+	}
+	case InputEventType::MousePress:
+	case InputEventType::MouseRelease: {
+		int slot = getButtonSlot(event.code);
+		if (slot < 0) {
+			break;
+		}
+		if (event.type == InputEventType::MousePress) {
+			mButtons.press(slot);
+		}
+		else {
+			mButtons.release(slot);
+		}
+		break;
+	}
+	case InputEventType::MouseMove: {
+		// The first position only anchors the delta
+		QPointF position(event.x, event.y);
+		if (mHasMousePosition) {
+			mMouseDelta += position - mMousePosition;
+		}
+		mMousePosition = position;
+		mHasMousePosition = true;
+		break;
+	}
+	case InputEventType::Wheel:
+		mWheelDelta += event.y;
+		break;
+	case InputEventType::FocusOut:
+		// Releases would go to another widget, so nothing may stay held
+		mKeys.released |= mKeys.down;
+		mKeys.down.reset();
+		mButtons.released |= mButtons.down;
+		mButtons.down.reset();
+		mHasMousePosition = false;
+		break;
+	}
+}
+
+bool InputSnapshot::tryGetKeyState(int key, InputState& state) const
+{
+	int slot = getKeySlot(key);
+	return slot >= 0 && mKeys.tryGetState(slot, state);
+}
+
+bool InputSnapshot::isKeyDown(int key) const
+{
+	return isDown(InputDevice::Keyboard, getKeySlot(key));
+}
+
+bool InputSnapshot::wasKeyPressed(int key) const
+{
+	return wasPressed(InputDevice::Keyboard, getKeySlot(key));
+}
+
+bool InputSnapshot::wasKeyReleased(int key) const
+{
+	return wasReleased(InputDevice::Keyboard, getKeySlot(key));
+}
+
+bool InputSnapshot::tryGetButtonState(int button, InputState& state) const
+{
+	int slot = getButtonSlot(button);
+	return slot >= 0 && mButtons.tryGetState(slot, state);
+}
+
+bool InputSnapshot::isButtonDown(int button) const
+{
+	return isDown(InputDevice::Mouse, getButtonSlot(button));
+}
+
+bool InputSnapshot::wasButtonPressed(int button) const
+{
+	return wasPressed(InputDevice::Mouse, getButtonSlot(button));
+}
+
+bool InputSnapshot::wasButtonReleased(int button) const
+{
+	return wasReleased(InputDevice::Mouse, getButtonSlot(button));
+}
+
+bool InputSnapshot::isDown(InputDevice device, int slot) const
+{
+	if (slot < 0) {
+		return false;
+	}
+	return device == InputDevice::Keyboard ? mKeys.down[slot] : mButtons.down[slot];
+}
+
+bool InputSnapshot::wasPressed(InputDevice device, int slot) const
+{
+	if (slot < 0) {
+		return false;
+	}
+	return device == InputDevice::Keyboard ? mKeys.pressed[slot] : mButtons.pressed[slot];
+}
+
+bool InputSnapshot::wasReleased(InputDevice device, int slot) const
+{
+	if (slot < 0) {
+		return false;
+	}
+	return device == InputDevice::Keyboard ? mKeys.released[slot] : mButtons.released[slot];
+}
+
+QPointF InputSnapshot::getMousePosition() const
+{
+	return mMousePosition;
+}
+
+QPointF InputSnapshot::getMouseDelta() const
+{
+	return mMouseDelta;
+}
+
+bool InputSnapshot::getIsMouseMoved() const
+{
+	return !mMouseDelta.isNull();
+}
+
+float InputSnapshot::getWheelDelta() const
+{
+	return mWheelDelta;
+}
+
+int InputSnapshot::getEventCount() const
+{
+	return mEventCount;
+}
+
+void InputSnapshot::clear()
+{
+	mKeys = Bits<KEY_SLOT_COUNT>();
+	mButtons = Bits<BUTTON_SLOT_COUNT>();
+	mHasMousePosition = false;
+	mMousePosition = QPointF();
+	mMouseDelta = QPointF();
+	mWheelDelta = 0.0f;
+	mEventCount = 0;
+}
@@ -1,7 +1,11 @@
 #include "Qt/Inspector/InspectorNodeVisitor.h"
+#include "Engine/Interfaces/IScene.h"
 #include "Engine/Nodes/Camera.h"
+#include "Engine/Nodes/Collider.h"
 #include "Engine/Nodes/Container.h"
+#include "Engine/Nodes/Light.h"
 #include "Engine/Nodes/MeshRenderer.h"
+#include "Engine/Nodes/RigidBody.h"
 #include "Engine/Scenes/Node.h"
 
 #include "Qt/Inspector/NodeWidgets/NodeWidget.h"
@@ -46,6 +50,9 @@ void* InspectorNodeVisitor::visitContainer(Container* node) {
     
     std::shared_ptr<Transform> transform = node->transform;
     TransformWidget* transformWidget = new TransformWidget(transform);
+    if (node->getScene()) {
+        transformWidget->setSimulationMutex(&node->getScene()->getSimulationMutex());
+    }
 
     mStackItems.append(transformWidget);
 
@@ -64,4 +71,22 @@ void* InspectorNodeVisitor::visitCamera(Camera* node) {
 	visitContainer(node);
 
     return nullptr;
-}
\ No newline at end of file
+}
+
+void* InspectorNodeVisitor::visitLight(Light* node) {
+	visitContainer(node);
+
+    return nullptr;
+}
+
+void* InspectorNodeVisitor::visitCollider(Collider* node) {
+	visitContainer(node);
+
+    return nullptr;
+}
+
+void* InspectorNodeVisitor::visitRigidBody(RigidBody* node) {
+	visitContainer(node);
+
+    return nullptr;
+}
@@ -1,8 +1,9 @@
 // TransformWidget.cpp
 #include "Qt/Inspector/NodeWidgets/TransformWidget.h"
 #include <cmath>
+#include <QMutexLocker>
 
-TransformWidget::TransformWidget(std::shared_ptr<Transform> transform, QWidget* parent) : QWidget(parent), mTransform() {
+TransformWidget::TransformWidget(std::shared_ptr<Transform> transform, QWidget* parent) : QWidget(parent), mTransform(), mSimulationMutex(nullptr) {
     QVBoxLayout* widgetLayout = new QVBoxLayout(this);
 
     SectionWidget* section = new SectionWidget("Transform", 0, this);
@@ -99,6 +100,11 @@ void TransformWidget::setTransform(std::shared_ptr<Transform> transform) {
 	mIsUpdating = false;
 }
 
+void TransformWidget::setSimulationMutex(QMutex* simulationMutex)
+{
+    mSimulationMutex = simulationMutex;
+}
+
 void TransformWidget::clearTransform()
 {
     mTransform.reset();
@@ -134,6 +140,7 @@ void TransformWidget::onPositionChanged() {
 		return;
 	}
     if (auto transform = mTransform.lock()) {
+        QMutexLocker locker(mSimulationMutex);
         transform->setWorldPosition(getPosition());
     }
     emit transformChanged();
@@ -144,6 +151,7 @@ void TransformWidget::onRotationChanged() {
         return;
     }
 	if (auto transform = mTransform.lock()) {
+		QMutexLocker locker(mSimulationMutex);
 		transform->setWorldRotation(getRotation());
 	}
     emit transformChanged();
@@ -154,6 +162,7 @@ void TransformWidget::onScaleChanged() {
         return;
     }
 	if (auto transform = mTransform.lock()) {
+		QMutexLocker locker(mSimulationMutex);
 		transform->setWorldScale(getScale());
 	}
     emit transformChanged();
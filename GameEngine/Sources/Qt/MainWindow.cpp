@@ -1,9 +1,16 @@
 // MainWindow.cpp
 #include "Qt/MainWindow.h"
 
+#include "Engine/Renders/ShaderWatcher.h"
 #include "TestGame/Scenes/TestScene.h"
 
-MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), mPlayingScene(new Scene()), mEditingScene(nullptr) {
+#include <QCoreApplication>
+#include <QDir>
+#include <iostream>
+
+MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), mPlayingScene(new Scene()), mEditingScene(nullptr), mShaderStatusLabel(nullptr) {
+
+    configureShaderReload();
 
     mEditingScene = new TestScene();
     mEditingScene->load();
@@ -11,6 +18,10 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), mPlayingScene(new
     createControlButtons();
     createDockWidgets();
 
+    QTimer* budgetTimer = new QTimer(this);
+    connect(budgetTimer, &QTimer::timeout, this, &MainWindow::updateFrameBudget);
+    budgetTimer->start(500);
+
 }
 
 MainWindow::~MainWindow() {
@@ -29,8 +40,11 @@ void MainWindow::createDockWidgets() {
 
     // Create the camera view dock widget
     mCameraViewDock = new QDockWidget(tr("Camera View"), this);
-    OpenGLWidget* openGLWidget = new OpenGLWidget(mEditingScene, this); // Create an instance of OpenGLWidget
-    mCameraViewDock->setWidget(openGLWidget);
+    mOpenGLWidget = new OpenGLWidget(mEditingScene, this); // Create an instance of OpenGLWidget
+    mOpenGLWidget->setIsThreaded(QCoreApplication::arguments().contains("--threaded"));
+    mOpenGLWidget->setIsGpuPicking(QCoreApplication::arguments().contains("--gpu-picking"));
+    configureFramePacing(mOpenGLWidget->getFramePacer());
+    mCameraViewDock->setWidget(mOpenGLWidget);
     mCameraViewDock->setAllowedAreas(Qt::AllDockWidgetAreas);
 
     // Create the inspector dock widget
@@ -43,8 +57,15 @@ void MainWindow::createDockWidgets() {
     addDockWidget(Qt::LeftDockWidgetArea, mCameraViewDock);
     addDockWidget(Qt::RightDockWidgetArea, mInspectorDock);
 
+    // Create the profiler dock widget, tabbed with the inspector
+    mProfilerWidget = new ProfilerWidget(this);
+    addDockWidget(Qt::RightDockWidgetArea, mProfilerWidget);
+    tabifyDockWidget(mInspectorDock, mProfilerWidget);
+    mInspectorDock->raise();
+
     // Connect signals
     connect(mHierarchyWidget, &HierarchyWidget::itemSelectionChanged, mInspectorWidget, &InspectorWidget::updateInspectorView);
+    connect(mOpenGLWidget, &OpenGLWidget::nodePicked, mHierarchyWidget, &HierarchyWidget::selectNode);
 }
 
 void MainWindow::createControlButtons() {
@@ -66,6 +87,78 @@ void MainWindow::createControlButtons() {
     connect(pauseButton, &QPushButton::clicked, this, &MainWindow::onPauseButtonClicked);
 }
 
+void MainWindow::configureFramePacing(FramePacer* framePacer) {
+    // --pacing uncapped|vsync|adaptive|cap:<fps>, vsync by default
+    FramePacingMode mode = FramePacingMode::VSYNC;
+    double targetFps = FramePacer::DEFAULT_TARGET_FPS;
+
+    QStringList arguments = QCoreApplication::arguments();
+    int index = arguments.indexOf("--pacing");
+    if (index >= 0 && index + 1 < arguments.size() && !FramePacer::parseMode(arguments[index + 1], mode, targetFps)) {
+        std::cout << "ERROR::MAIN_WINDOW::INVALID_PACING " << arguments[index + 1].toStdString() << std::endl;
+    }
+
+    framePacer->setMode(mode);
+    framePacer->setTargetFps(targetFps);
+}
+
+void MainWindow::configureShaderReload() {
+    // --shader-dir <path to Resources/Shaders> reads shaders from disk and rebuilds them on save
+    QStringList arguments = QCoreApplication::arguments();
+    int index = arguments.indexOf("--shader-dir");
+    if (index < 0 || index + 1 >= arguments.size()) {
+        return;
+    }
+
+    QString directory = arguments[index + 1];
+    if (!QDir(directory).exists()) {
+        std::cout << "ERROR::MAIN_WINDOW::INVALID_SHADER_DIR " << directory.toStdString() << std::endl;
+        return;
+    }
+
+    mShaderStatusLabel = new QLabel(tr("Shaders: watching %1").arg(directory), this);
+    statusBar()->addPermanentWidget(mShaderStatusLabel);
+
+    ShaderWatcher& watcher = ShaderWatcher::instance();
+    watcher.setSourceDirectory(directory);
+    watcher.setReloadCallback([this](const QString& name, bool isSuccess, const QString& log) {
+        if (isSuccess) {
+            mShaderStatusLabel->setStyleSheet(QString());
+            mShaderStatusLabel->setText(tr("Shader reloaded: %1").arg(name));
+            mShaderStatusLabel->setToolTip(QString());
+        }
+        else {
+            // The previous program keeps drawing; the full log is on hover
+            mShaderStatusLabel->setStyleSheet("color: red;");
+            mShaderStatusLabel->setText(tr("Shader error: %1: %2").arg(name, log.section('\n', 0, 0).trimmed()));
+            mShaderStatusLabel->setToolTip(log);
+        }
+    });
+}
+
+void MainWindow::updateFrameBudget() {
+    FrameTimings timings = mOpenGLWidget->getAverageTimings();
+    double budgetMs = mOpenGLWidget->getFixedDeltaTime() * 1000.0;
+
+    FramePacer* framePacer = mOpenGLWidget->getFramePacer();
+    FramePacingStats pacing = framePacer->getStats();
+    QString pacingText = pacing.isPaused ? QString("paused")
+        : QString("%1 fps, jitter %2 ms, worst %3 ms")
+            .arg(pacing.averageIntervalMs > 0.0 ? 1000.0 / pacing.averageIntervalMs : 0.0, 0, 'f', 1)
+            .arg(pacing.jitterMs, 0, 'f', 2)
+            .arg(pacing.maxIntervalMs, 0, 'f', 1);
+
+    statusBar()->showMessage(QString("Input %1 ms | Update %2 ms | Render %3 ms | Frame %4 / %5 ms budget%6 | %7: %8")
+        .arg(timings.inputMs, 0, 'f', 2)
+        .arg(timings.updateMs, 0, 'f', 2)
+        .arg(timings.renderMs, 0, 'f', 2)
+        .arg(timings.frameMs, 0, 'f', 2)
+        .arg(budgetMs, 0, 'f', 1)
+        .arg(timings.isCatchUpCapped ? " (catch-up capped)" : "")
+        .arg(FramePacer::getModeName(framePacer->getMode()))
+        .arg(pacingText));
+}
+
 void MainWindow::onPlayButtonClicked() {
     if (!mEditingScene) {
         mEditingScene = mPlayingScene->clone(); // Duplicate the current scene
@@ -1,5 +1,9 @@
 #include "Qt/OpenGLWidget.h"
+#include "Engine/Profiling/Profiler.h"
+#include "Engine/Renders/ShaderWatcher.h"
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QMutexLocker>
 #include <QApplication>
 #include <QOpenGLFunctions>
 #include <QKeyEvent>
@@ -11,28 +15,87 @@
 
 
 
-OpenGLWidget::OpenGLWidget(IScene* scene, QWidget* parent) : QOpenGLWidget(parent), QOpenGLFunctions() {
+OpenGLWidget::OpenGLWidget(IScene* scene, QWidget* parent) : QOpenGLWidget(parent), QOpenGLFunctions(), mIsThreaded(false), mAverageRenderMs(0.0), mIsGpuPicking(false) {
     setFocusPolicy(Qt::StrongFocus);
     setMouseTracking(true);
-    QTimer* timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, this, QOverload<>::of(&OpenGLWidget::update));
-    timer->start(16); // ~60 FPS
-    
+    // Repaints are driven by swaps, not a free-running timer
+    mFramePacer = new FramePacer(this);
+
 	mInputPublisher = new InputPublisher();
 
 	mCurrentScene = scene;
 	mCurrentScene->setInputPublisher(mInputPublisher);
 
-    elapsedTimer = new QElapsedTimer();
+    mEngineLoop.setScene(mCurrentScene);
+    mEngineLoop.setInputPublisher(mInputPublisher);
 }
 
 OpenGLWidget::~OpenGLWidget()
 {
-    delete elapsedTimer;
+    stopGameThread();
+}
+
+EngineLoop& OpenGLWidget::getEngineLoop()
+{
+    return mEngineLoop;
+}
+
+FramePacer* OpenGLWidget::getFramePacer() const
+{
+    return mFramePacer;
+}
+
+void OpenGLWidget::setIsThreaded(bool isThreaded)
+{
+    mIsThreaded = isThreaded;
+}
+
+bool OpenGLWidget::getIsThreaded() const
+{
+    return mIsThreaded;
+}
+
+FrameTimings OpenGLWidget::getAverageTimings() const
+{
+    if (!mGameThread)
+        return mEngineLoop.getAverageTimings();
+
+    // Simulation phases come from the game thread, the frame is only the render on this one
+    FrameTimings timings = mGameThread->getAverageTimings();
+    timings.renderMs = mAverageRenderMs;
+    timings.frameMs = mAverageRenderMs;
+    return timings;
+}
+
+float OpenGLWidget::getFixedDeltaTime() const
+{
+    return mGameThread ? mGameThread->getFixedDeltaTime() : mEngineLoop.getFixedDeltaTime();
+}
+
+void OpenGLWidget::setIsGpuPicking(bool isGpuPicking)
+{
+    mIsGpuPicking = isGpuPicking;
+}
+
+bool OpenGLWidget::getIsGpuPicking() const
+{
+    return mIsGpuPicking;
+}
+
+void OpenGLWidget::stopGameThread()
+{
+    if (mGameThread)
+    {
+        mGameThread->stop();
+        mGameThread.reset();
+    }
 }
 
 void OpenGLWidget::initializeGL() {
 
+    // The scene is about to be torn down, nothing may step it meanwhile
+    stopGameThread();
+
     initializeOpenGLFunctions();
     mInputPublisher->clear();
     mCurrentScene->clear();
@@ -40,8 +103,18 @@ void OpenGLWidget::initializeGL() {
 	mCurrentScene->init();
     mCurrentScene->create();
 
-    elapsedTimer->start();
+    Profiler::instance().initGpu();
 
+    mEngineLoop.reset();
+
+    if (mIsThreaded)
+    {
+        mCurrentScene->start();
+        mGameThread = std::make_unique<GameThread>(mCurrentScene, mInputPublisher, mEngineLoop.getFixedDeltaTime());
+        mGameThread->start();
+    }
+
+    mFramePacer->start();
 }
 
 void OpenGLWidget::resizeGL(int w, int h) {
@@ -50,32 +123,126 @@ void OpenGLWidget::resizeGL(int w, int h) {
     // Update the projection matrix
     glViewport(0, 0, w, h);
 
+    QMutexLocker locker(&mCurrentScene->getSimulationMutex());
     mInputPublisher->resizeGLEvent(w, h);
 
 }
 
 void OpenGLWidget::paintGL() {
- 	qint64 currentFrame = elapsedTimer->elapsed();
-    deltaTime = (currentFrame - lastFrame) / 1000.0f; // Convert milliseconds to seconds
-    lastFrame = currentFrame;
+    Profiler& profiler = Profiler::instance();
+    profiler.beginFrame();
+
+    // Edited shader files are rebuilt here, where the context is current
+    ShaderWatcher::instance().update();
+
+    // The widget's framebuffer is recreated on resize, so it is handed over every frame
+    const qreal pixelRatio = devicePixelRatioF();
+    RenderTarget target;
+    target.framebuffer = defaultFramebufferObject();
+    target.width = qRound(width() * pixelRatio);
+    target.height = qRound(height() * pixelRatio);
+    mCurrentScene->setRenderTarget(target);
+
+    if (mGameThread)
+    {
+        paintSnapshot();
+    }
+    else
+    {
+        // Simulation runs in fixed steps, rendering interpolates between them
+        mEngineLoop.tick();
+    }
+
+    pollGpuPick();
+    profiler.endFrame();
+}
+
+void OpenGLWidget::paintSnapshot() {
+    QElapsedTimer renderTimer;
+    renderTimer.start();
+
+    {
+        // Nodes added since the last frame get their GL resources here, on the context's thread
+        QMutexLocker locker(&mCurrentScene->getSimulationMutex());
+        mCurrentScene->start();
+    }
+
+    mGameThread->acquireSnapshot();
+    const RenderSnapshot& snapshot = mGameThread->getSnapshot();
+    if (snapshot.isValid())
+    {
+        mCurrentScene->renderSnapshot(snapshot, snapshot.getAlpha(std::chrono::steady_clock::now()));
+    }
+    else
+    {
+        mCurrentScene->getCamera()->clearFramebuffer();
+    }
+
+    const double smoothing = 0.05;
+    mAverageRenderMs += (renderTimer.nsecsElapsed() / 1000000.0 - mAverageRenderMs) * smoothing;
+}
 
-    mCurrentScene->start();
+void OpenGLWidget::pick(const QPointF& pixel) {
+    // The index holds what the last frame drew, which is what the user clicked on
+    QSizeF viewportSize(width(), height());
+    if (mIsGpuPicking)
+    {
+        mCurrentScene->getIdPicker()->request(pixel, viewportSize);
+        return;
+    }
+
+    PickResult result;
+    bool isHit = mRayPicker.pick(*mCurrentScene->getSpatialIndex(), pixel, viewportSize, result);
+    emit nodePicked(isHit ? result.node : nullptr);
+}
 
-    mInputPublisher->update(deltaTime);
-	mCurrentScene->update(deltaTime);
-	mCurrentScene->render();
+void OpenGLWidget::pollGpuPick() {
+    Node* node = nullptr;
+    if (mCurrentScene->getIdPicker()->poll(node))
+    {
+        emit nodePicked(node);
+    }
 }
 
+// Input is only queued here; the simulation picks it up on its next step, on whichever thread runs it
 void OpenGLWidget::keyPressEvent(QKeyEvent* event) {
 	mInputPublisher->keyPressEvent(event);
-    
 }
 
 void OpenGLWidget::keyReleaseEvent(QKeyEvent* event) {
     mInputPublisher->keyReleaseEvent(event);
 }
 
+void OpenGLWidget::mousePressEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton)
+    {
+        mPressPosition = event->position();
+    }
+    mInputPublisher->mousePressEvent(event);
+}
+
+void OpenGLWidget::mouseReleaseEvent(QMouseEvent* event) {
+    const qreal clickDistance = 4.0;
+    if (event->button() == Qt::LeftButton && (event->position() - mPressPosition).manhattanLength() < clickDistance)
+    {
+        pick(event->position());
+    }
+    mInputPublisher->mouseReleaseEvent(event);
+}
+
+void OpenGLWidget::mouseDoubleClickEvent(QMouseEvent* event) {
+    mInputPublisher->mouseDoubleClickEvent(event);
+}
 
 void OpenGLWidget::mouseMoveEvent(QMouseEvent* event) {
     mInputPublisher->mouseMoveEvent(event);
-}
\ No newline at end of file
+}
+
+void OpenGLWidget::wheelEvent(QWheelEvent* event) {
+    mInputPublisher->wheelEvent(event);
+}
+
+void OpenGLWidget::focusOutEvent(QFocusEvent* event) {
+    QOpenGLWidget::focusOutEvent(event);
+    mInputPublisher->focusOutEvent(event);
+}
@@ -0,0 +1,129 @@
+#include "Qt/Profiler/ProfilerTimelineView.h"
+
+#include <algorithm>
+#include <utility>
+
+ProfilerTimelineView::ProfilerTimelineView(QWidget* parent) : QWidget(parent), mSelectedFrameIndex(-1) {
+    setMinimumHeight(HISTORY_HEIGHT + 8 * ROW_HEIGHT);
+}
+
+void ProfilerTimelineView::setFrames(std::vector<ProfileFrame> frames) {
+    mFrames = std::move(frames);
+    update();
+}
+
+const ProfileFrame* ProfilerTimelineView::getSelectedFrame() const {
+    if (mFrames.empty()) return nullptr;
+
+    if (mSelectedFrameIndex >= 0) {
+        for (const auto& frame : mFrames) {
+            if (frame.frameIndex == mSelectedFrameIndex) return &frame;
+        }
+    }
+    return &mFrames.back();
+}
+
+void ProfilerTimelineView::mousePressEvent(QMouseEvent* event) {
+    if (event->position().y() > HISTORY_HEIGHT || mFrames.empty()) return;
+
+    // Clicking the history selects a frame, clicking past the newest bar follows the latest again
+    int barCount = Profiler::FRAME_CAPACITY;
+    int bar = static_cast<int>(event->position().x() * barCount / std::max(width(), 1));
+    int first = barCount - static_cast<int>(mFrames.size());
+    if (bar < first || bar >= barCount - 1) {
+        mSelectedFrameIndex = -1;
+    }
+    else {
+        mSelectedFrameIndex = mFrames[bar - first].frameIndex;
+    }
+    update();
+}
+
+void ProfilerTimelineView::paintEvent(QPaintEvent* event) {
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+
+    QRect historyArea(0, 0, width(), HISTORY_HEIGHT);
+    paintHistory(painter, historyArea);
+
+    int laneHeight = (height() - HISTORY_HEIGHT) / 2;
+    paintLane(painter, QRect(0, HISTORY_HEIGHT, width(), laneHeight), "CPU", false);
+    paintLane(painter, QRect(0, HISTORY_HEIGHT + laneHeight, width(), laneHeight), "GPU", true);
+}
+
+void ProfilerTimelineView::paintHistory(QPainter& painter, const QRect& area) {
+    const double budgetMs = 1000.0 / 60.0;
+    double maxMs = budgetMs * 2.0;
+    for (const auto& frame : mFrames) {
+        maxMs = std::max(maxMs, frame.cpuDurationMs);
+    }
+
+    const ProfileFrame* selected = getSelectedFrame();
+    double barWidth = static_cast<double>(area.width()) / Profiler::FRAME_CAPACITY;
+    int first = Profiler::FRAME_CAPACITY - static_cast<int>(mFrames.size());
+
+    for (size_t i = 0; i < mFrames.size(); ++i) {
+        const ProfileFrame& frame = mFrames[i];
+        int barHeight = static_cast<int>(frame.cpuDurationMs / maxMs * area.height());
+        QRectF bar(area.left() + (first + i) * barWidth, area.bottom() - barHeight, std::max(barWidth - 1.0, 1.0), barHeight);
+
+        QColor color = frame.cpuDurationMs > budgetMs ? QColor(220, 90, 70) : QColor(90, 170, 90);
+        if (selected && frame.frameIndex == selected->frameIndex) color = QColor(70, 130, 220);
+        painter.fillRect(bar, color);
+    }
+
+    int budgetY = area.bottom() - static_cast<int>(budgetMs / maxMs * area.height());
+    painter.setPen(QPen(palette().text().color(), 1, Qt::DashLine));
+    painter.drawLine(area.left(), budgetY, area.right(), budgetY);
+    painter.drawText(area.adjusted(4, 2, -4, 0), Qt::AlignTop | Qt::AlignLeft, QString("%1 ms").arg(maxMs, 0, 'f', 1));
+}
+
+void ProfilerTimelineView::paintLane(QPainter& painter, const QRect& area, const QString& title, bool isGpu) {
+    painter.setPen(palette().mid().color());
+    painter.drawLine(area.topLeft(), area.topRight());
+
+    const ProfileFrame* frame = getSelectedFrame();
+    double frameMs = frame ? (isGpu ? frame->gpuDurationMs : frame->cpuDurationMs) : -1.0;
+
+    painter.setPen(palette().text().color());
+    QString header = frameMs >= 0.0 ? QString("%1  %2 ms").arg(title).arg(frameMs, 0, 'f', 3) : QString("%1  n/a").arg(title);
+    painter.drawText(area.adjusted(4, 2, -4, 0), Qt::AlignTop | Qt::AlignLeft, header);
+    if (!frame || frameMs <= 0.0) return;
+
+    QRect chart = area.adjusted(0, ROW_HEIGHT, 0, 0);
+    double scale = chart.width() / frameMs;
+    QFontMetrics metrics = painter.fontMetrics();
+
+    // Scopes of other threads stack below the frame thread's, each thread as deep as it nested
+    std::vector<int> rowBases;
+    for (const auto& event : frame->events) {
+        if (event.thread >= static_cast<int>(rowBases.size())) rowBases.resize(event.thread + 1, 0);
+        rowBases[event.thread] = std::max(rowBases[event.thread], event.depth + 1);
+    }
+    int rowCount = 0;
+    for (int& rowBase : rowBases) {
+        rowCount += std::exchange(rowBase, rowCount);
+    }
+
+    for (const auto& event : frame->events) {
+        double startMs = isGpu ? event.gpuStartMs : event.cpuStartMs;
+        double durationMs = isGpu ? event.gpuDurationMs : event.cpuDurationMs;
+        if (durationMs < 0.0) continue;
+
+        int row = isGpu ? event.depth : rowBases[event.thread] + event.depth;
+        QRectF box(chart.left() + startMs * scale, chart.top() + row * ROW_HEIGHT,
+            std::max(durationMs * scale, 1.0), ROW_HEIGHT - 2);
+        if (box.top() > chart.bottom()) continue;
+
+        // Stable colour per scope name
+        QColor color = QColor::fromHsv(static_cast<int>(qHash(QByteArray(event.name)) % 360), 110, 210);
+        painter.fillRect(box, color);
+
+        QString label = QString("%1 %2 ms").arg(event.name).arg(durationMs, 0, 'f', 3);
+        painter.setPen(Qt::black);
+        painter.drawText(box.adjusted(3, 0, -3, 0), Qt::AlignVCenter | Qt::AlignLeft,
+            metrics.elidedText(label, Qt::ElideRight, static_cast<int>(box.width()) - 6));
+    }
+}
@@ -0,0 +1,61 @@
+#include "Qt/Profiler/ProfilerWidget.h"
+
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+ProfilerWidget::ProfilerWidget(QWidget* parent) : QDockWidget(tr("Profiler"), parent) {
+    QWidget* content = new QWidget();
+    QVBoxLayout* layout = new QVBoxLayout();
+    layout->setContentsMargins(2, 2, 2, 2);
+
+    QHBoxLayout* toolbar = new QHBoxLayout();
+    mPauseCheckBox = new QCheckBox(tr("Pause"), content);
+    QPushButton* exportButton = new QPushButton(tr("Export Trace..."), content);
+    mSummaryLabel = new QLabel(content);
+    toolbar->addWidget(mPauseCheckBox);
+    toolbar->addWidget(exportButton);
+    toolbar->addWidget(mSummaryLabel, 1);
+
+    mTimelineView = new ProfilerTimelineView(content);
+
+    layout->addLayout(toolbar);
+    layout->addWidget(mTimelineView, 1);
+    content->setLayout(layout);
+
+    setWidget(content);
+    setAllowedAreas(Qt::AllDockWidgetAreas);
+
+    connect(exportButton, &QPushButton::clicked, this, &ProfilerWidget::exportTrace);
+
+    // Refreshing a few times a second is plenty and keeps the copies of the frame ring cheap
+    mRefreshTimer = new QTimer(this);
+    connect(mRefreshTimer, &QTimer::timeout, this, &ProfilerWidget::refresh);
+    mRefreshTimer->start(250);
+}
+
+ProfilerWidget::~ProfilerWidget() {
+}
+
+void ProfilerWidget::refresh() {
+    if (mPauseCheckBox->isChecked() || !isVisible()) return;
+
+    mTimelineView->setFrames(Profiler::instance().getFrames());
+
+    const ProfileFrame* frame = mTimelineView->getSelectedFrame();
+    if (!frame) {
+        mSummaryLabel->setText(tr("No frames"));
+        return;
+    }
+
+    QString gpuText = frame->gpuDurationMs >= 0.0 ? QString::number(frame->gpuDurationMs, 'f', 2) : QString("n/a");
+    mSummaryLabel->setText(QString("Frame %1  CPU %2 ms  GPU %3 ms")
+        .arg(frame->frameIndex).arg(frame->cpuDurationMs, 0, 'f', 2).arg(gpuText));
+}
+
+void ProfilerWidget::exportTrace() {
+    QString path = QFileDialog::getSaveFileName(this, tr("Export Chrome Trace"), "profile.json", tr("Trace (*.json)"));
+    if (path.isEmpty()) return;
+
+    Profiler::instance().exportChromeTrace(path);
+}
@@ -1,57 +1,54 @@
 #include "TestGame/Controllers/FPSCameraController.h"
 
 
-FPSCameraController::FPSCameraController(Camera* camera)
-    : mCamera(camera), mYaw(-90.0f), mPitch(0.0f), mFirstMouse(true), mLastX(0.0f), mLastY(0.0f), mSensitivity(0.1f), mSpeed(2.5f)
+FPSCameraController::FPSCameraController(Camera* camera, const InputActionMap& actions)
+    : mCamera(camera), mYaw(-90.0f), mPitch(0.0f), mSensitivity(1.0f), mSpeed(2.5f), mSprintMultiplier(3.0f)
 {
-	mKeyStates = std::unordered_map<int, bool>();
-	mKeyStates[Qt::Key_W] = false;
-	mKeyStates[Qt::Key_S] = false;
-	mKeyStates[Qt::Key_A] = false;
-	mKeyStates[Qt::Key_D] = false;
-	mKeyStates[Qt::Key_Q] = false;
-	mKeyStates[Qt::Key_E] = false;
+    // Resolved once; per-step queries are then array reads
+    mMoveForwardAxis = actions.findAxis("MoveForward");
+    mMoveRightAxis = actions.findAxis("MoveRight");
+    mMoveUpAxis = actions.findAxis("MoveUp");
+    mLookXAxis = actions.findAxis("LookX");
+    mLookYAxis = actions.findAxis("LookY");
+    mSprintAction = actions.findAction("Sprint");
 }
 
-void FPSCameraController::updateKeyPress(QKeyEvent* event)
+void FPSCameraController::updateInput(const InputSnapshot& input, const InputActionMap& actions, float deltaTime)
 {
-    mKeyStates[event->key()] = true;
-}
-
-void FPSCameraController::updateKeyRelease(QKeyEvent* event)
-{
-    mKeyStates[event->key()] = false;
-}
-
-void FPSCameraController::updateMouseMove(QMouseEvent* event)
-{
-    if (mFirstMouse) {
-        mLastX = event->position().x();
-        mLastY = event->position().y();
-        mFirstMouse = false;
+    // Motion arrives summed over the step, so the rotation is rebuilt once however fast the mouse reports
+    float lookX = actions.getAxis(mLookXAxis);
+    float lookY = actions.getAxis(mLookYAxis);
+    QQuaternion orientation = mCamera->transform->getLocalRotation();
+    if (lookX != 0.0f || lookY != 0.0f) {
+        mYaw -= lookX * mSensitivity;
+        mPitch -= lookY * mSensitivity;
+
+        if (mPitch > 89.0f)
+            mPitch = 89.0f;
+        if (mPitch < -89.0f)
+            mPitch = -89.0f;
+
+        QQuaternion yawRotation = QQuaternion::fromAxisAndAngle(QVector3D(0.0f, 1.0f, 0.0f), mYaw);
+        QQuaternion pitchRotation = QQuaternion::fromAxisAndAngle(QVector3D(1.0f, 0.0f, 0.0f), mPitch);
+        orientation = yawRotation * pitchRotation;
+
+        mCamera->transform->setLocalRotation(orientation);
     }
 
-    float xoffset = mLastX - event->position().x();
-    float yoffset = mLastY - event->position().y();
-    mLastX = event->position().x();
-    mLastY = event->position().y();
+    float forward = actions.getAxis(mMoveForwardAxis);
+    float right = actions.getAxis(mMoveRightAxis);
+    float upward = actions.getAxis(mMoveUpAxis);
+    if (forward == 0.0f && right == 0.0f && upward == 0.0f)
+        return;
 
-    xoffset *= mSensitivity;
-    yoffset *= mSensitivity;
-
-    mYaw += xoffset;
-    mPitch += yoffset;
-
-    if (mPitch > 89.0f)
-        mPitch = 89.0f;
-    if (mPitch < -89.0f)
-        mPitch = -89.0f;
-
-    QQuaternion yawRotation = QQuaternion::fromAxisAndAngle(QVector3D(0.0f, 1.0f, 0.0f), mYaw);
-    QQuaternion pitchRotation = QQuaternion::fromAxisAndAngle(QVector3D(1.0f, 0.0f, 0.0f), mPitch);
-    QQuaternion orientation = yawRotation * pitchRotation;
+    float cameraSpeed = mSpeed * deltaTime * (actions.isDown(mSprintAction) ? mSprintMultiplier : 1.0f);
+	QVector3D front = orientation.rotatedVector(QVector3D(0.0f, 0.0f, -1.0f));
+	QVector3D up = orientation.rotatedVector(QVector3D(0.0f, 1.0f, 0.0f));
+    QVector3D side = QVector3D::crossProduct(front, up).normalized();
 
-    mCamera->transform->setLocalRotation(orientation);
+    QVector3D position = mCamera->transform->getLocalPosition();
+    position += (front * forward + side * right + up * upward) * cameraSpeed;
+    mCamera->transform->setLocalPosition(position);
 }
 
 void FPSCameraController::updateResizeGL(int w, int h)
@@ -59,30 +56,3 @@ void FPSCameraController::updateResizeGL(int w, int h)
     mCamera->setAspectRatio(w, h);
 }
 
-
-void FPSCameraController::update(float deltaTime)
-{
-    float cameraSpeed = mSpeed * deltaTime;
-    QVector3D position = mCamera->transform->getLocalPosition();
-	QQuaternion orientation = mCamera->transform->getLocalRotation();
-	QVector3D front = orientation.rotatedVector(QVector3D(0.0f, 0.0f, -1.0f));
-	QVector3D up = orientation.rotatedVector(QVector3D(0.0f, 1.0f, 0.0f));
-
-    if (mKeyStates[Qt::Key_W])
-        position += cameraSpeed * front;
-    if (mKeyStates[Qt::Key_S])
-        position -= cameraSpeed * front;
-    if (mKeyStates[Qt::Key_A])
-        position -= QVector3D::crossProduct(front, up).normalized() * cameraSpeed;
-    if (mKeyStates[Qt::Key_D])
-        position += QVector3D::crossProduct(front, up).normalized() * cameraSpeed;
-    if (mKeyStates[Qt::Key_Q])
-        position -= cameraSpeed * up;
-    if (mKeyStates[Qt::Key_E])
-        position += cameraSpeed * up;
-
-    mCamera->transform->setLocalPosition(position);
-
-    
-}
-
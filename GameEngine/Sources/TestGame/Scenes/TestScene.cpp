@@ -63,6 +63,11 @@ void TestScene::load()
 	coneNode->transform->setLocalPosition(QVector3D(15.0f, 0.0f, 0.0f));
 	planeNode->transform->setLocalPosition(QVector3D(0.0f, 0.0f, 2.0f));
 
+	for (MeshRenderer* node : { teapotNode, triangleNode, quadNode, circleNode, cubeNode, sphereNode, icosphereNode, cylinderNode, coneNode, planeNode })
+	{
+		node->setIsStatic(true);
+	}
+
 	addNode(teapotNode);
 	addNode(triangleNode);
 	addNode(quadNode);
@@ -74,14 +79,32 @@ void TestScene::load()
 	addNode(coneNode);
 	addNode(planeNode);
 
+	Light* sunLight = new Light(LightType::DIRECTIONAL);
+	sunLight->transform->setLocalRotation(QQuaternion::fromEulerAngles(-50.0f, 30.0f, 0.0f));
+	sunLight->setIntensity(0.8f);
+	sunLight->setIsCastingShadows(true);
+	addNode(sunLight);
+
+	const QColor lampColors[] = { QColor(255, 120, 80), QColor(80, 200, 255), QColor(160, 255, 120) };
+	for (int i = 0; i < 3; ++i)
+	{
+		Light* lampLight = new Light(LightType::POINT);
+		lampLight->transform->setLocalPosition(QVector3D(-6.0f + 6.0f * i, 2.0f, 1.0f));
+		lampLight->setColor(lampColors[i]);
+		lampLight->setIntensity(6.0f);
+		lampLight->setRange(6.0f);
+		addNode(lampLight);
+	}
 }
 
 void TestScene::create()
 {
 	Scene::create();
 
-	mCameraController = new FPSCameraController(camera);
-	inputPublisher->subscribe(mCameraController);
+	mIndirectRenderer->setIsGpuCulling(true);
+
+	mCameraController = new FPSCameraController(camera, inputPublisher->getActionMap());
+	inputPublisher->subscribe(mCameraController, INPUT_SUBSCRIBE_STEP | INPUT_SUBSCRIBE_RESIZE_GL);
 }
 
 TestScene::~TestScene()
@@ -3,9 +3,42 @@
 #include <QQmlApplicationEngine>
 #include <QApplication>
 #include "Qt/MainWindow.h"
+#include "Qt/Headless/HeadlessRunner.h"
+#include "TestGame/Scenes/TestScene.h"
+
+// --headless [--frames N] [--dt S] [--size WxH] [--dump-dir DIR] [--dump-every N] [--trace FILE]
+//     Rendering: [--depth-prepass] [--overdraw] [--reversed-z] [--no-shadows] [--lights N]
+//     Benchmarks, run after the frames: [--bench-picking N] picks among N objects, [--bench-broadphase]
+//     Physics: [--bodies N] drops N rigid bodies onto a ground box and prints a pose checksum of the
+//     last step, which --physics-single-thread should reproduce exactly
+// HeadlessOptions::parse() is the authoritative list.
+static int runHeadless(int argc, char* argv[])
+{
+    // No window system needed; Mesa's llvmpipe renders through EGL on the offscreen platform
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+
+    HeadlessOptions options;
+    if (!options.parse(app.arguments()))
+        return 2;
+
+    TestScene scene;
+    scene.load();
+
+    HeadlessRunner runner(options);
+    return runner.run(&scene);
+}
 
 int main(int argc, char* argv[])
 {
+    for (int i = 1; i < argc; ++i)
+    {
+        if (qstrcmp(argv[i], "--headless") == 0)
+            return runHeadless(argc, argv);
+    }
+
 #if defined(Q_OS_WIN) && QT_VERSION_CHECK(5, 6, 0) <= QT_VERSION && QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
     